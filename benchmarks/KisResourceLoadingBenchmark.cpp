@@ -0,0 +1,129 @@
+/*
+ *  Copyright (c) 2019 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "KisResourceLoadingBenchmark.h"
+
+#include <QTest>
+#include <QImage>
+#include <QFile>
+
+#include <KoResourceServer.h>
+#include <KoResourcePaths.h>
+#include <resources/KoPattern.h>
+
+/**
+ * The number of resource files loaded on every iteration, big enough
+ * to resemble a real resource bundle
+ */
+const int NUM_RESOURCES = 500;
+const int RESOURCE_SIZE = 256;
+
+typedef KoResourceServerSimpleConstruction<KoPattern> PatternServer;
+
+namespace {
+
+QString indexFileName(const QString &type)
+{
+    return KoResourcePaths::locateLocal("data", type + ".index");
+}
+
+void loadAllResources(const QString &type, const QStringList &fileNames,
+                      bool concurrent, bool keepIndex)
+{
+    if (!keepIndex) {
+        QFile::remove(indexFileName(type));
+    }
+
+    PatternServer server(type, "*.png");
+    server.setConcurrentLoadingEnabled(concurrent);
+    server.loadResources(fileNames);
+
+    QCOMPARE(server.resourceCount(), fileNames.size());
+}
+
+}
+
+void KisResourceLoadingBenchmark::initTestCase()
+{
+    m_dir.reset(new QTemporaryDir());
+    QVERIFY(m_dir->isValid());
+
+    for (int i = 0; i < NUM_RESOURCES; i++) {
+        QImage image(RESOURCE_SIZE, RESOURCE_SIZE, QImage::Format_ARGB32);
+
+        // random noise doesn't compress, so decoding is as slow as it can be
+        quint32 *pixel = reinterpret_cast<quint32*>(image.bits());
+        for (int j = 0; j < RESOURCE_SIZE * RESOURCE_SIZE; j++) {
+            *pixel++ = qrand() | (qrand() << 16);
+        }
+
+        const QString fileName = m_dir->filePath(QString("pattern_%1.png").arg(i));
+        QVERIFY(image.save(fileName));
+        m_fileNames << fileName;
+    }
+}
+
+void KisResourceLoadingBenchmark::cleanupTestCase()
+{
+    QFile::remove(indexFileName("benchmark_patterns_serial"));
+    QFile::remove(indexFileName("benchmark_patterns_serial_indexed"));
+    QFile::remove(indexFileName("benchmark_patterns_concurrent"));
+    QFile::remove(indexFileName("benchmark_patterns_indexed"));
+
+    m_dir.reset();
+    m_fileNames.clear();
+}
+
+void KisResourceLoadingBenchmark::benchmarkSerialLoading()
+{
+    QBENCHMARK {
+        loadAllResources("benchmark_patterns_serial", m_fileNames, false, false);
+    }
+}
+
+/**
+ * Compare with benchmarkSerialLoading() to see the cost of reading and
+ * hashing the files, which the index saves
+ */
+void KisResourceLoadingBenchmark::benchmarkSerialLoadingWithIndex()
+{
+    // the first run fills the index
+    loadAllResources("benchmark_patterns_serial_indexed", m_fileNames, false, true);
+
+    QBENCHMARK {
+        loadAllResources("benchmark_patterns_serial_indexed", m_fileNames, false, true);
+    }
+}
+
+void KisResourceLoadingBenchmark::benchmarkConcurrentLoading()
+{
+    QBENCHMARK {
+        loadAllResources("benchmark_patterns_concurrent", m_fileNames, true, false);
+    }
+}
+
+void KisResourceLoadingBenchmark::benchmarkConcurrentLoadingWithIndex()
+{
+    // the first run fills the index
+    loadAllResources("benchmark_patterns_indexed", m_fileNames, true, true);
+
+    QBENCHMARK {
+        loadAllResources("benchmark_patterns_indexed", m_fileNames, true, true);
+    }
+}
+
+QTEST_MAIN(KisResourceLoadingBenchmark)
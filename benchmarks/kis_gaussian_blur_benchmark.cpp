@@ -0,0 +1,84 @@
+/*
+ *  Copyright (c) 2019 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_gaussian_blur_benchmark.h"
+#include "kis_benchmark_values.h"
+
+#include <QTest>
+#include <QBitArray>
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoColor.h>
+
+#include <kis_paint_device.h>
+#include <kis_gaussian_kernel.h>
+#include <kis_iterator_ng.h>
+
+Q_DECLARE_METATYPE(KisGaussianKernel::BlurMethod)
+
+void KisGaussianBlurBenchmark::initTestCase()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    m_device = new KisPaintDevice(cs);
+    KoColor color(cs);
+
+    srand(31524744);
+
+    KisSequentialIterator it(m_device, QRect(0, 0, GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT));
+    while (it.nextPixel()) {
+        color.fromQColor(QColor(rand() % 255, rand() % 255, rand() % 255, rand() % 255));
+        memcpy(it.rawData(), color.data(), cs->pixelSize());
+    }
+}
+
+void KisGaussianBlurBenchmark::cleanupTestCase()
+{
+    m_device = 0;
+}
+
+void KisGaussianBlurBenchmark::benchmarkGaussian_data()
+{
+    QTest::addColumn<qreal>("radius");
+    QTest::addColumn<KisGaussianKernel::BlurMethod>("method");
+
+    const qreal radii[] = {5.0, 30.0, 100.0, 250.0};
+
+    for (qreal radius : radii) {
+        QTest::newRow(QString("convolution-%1").arg(radius).toLatin1())
+            << radius << KisGaussianKernel::ConvolutionBlur;
+        QTest::newRow(QString("recursive-%1").arg(radius).toLatin1())
+            << radius << KisGaussianKernel::RecursiveBlur;
+    }
+}
+
+void KisGaussianBlurBenchmark::benchmarkGaussian()
+{
+    QFETCH(qreal, radius);
+    QFETCH(KisGaussianKernel::BlurMethod, method);
+
+    const QRect rc(0, 0, GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT);
+
+    QBENCHMARK {
+        KisPaintDeviceSP dev = new KisPaintDevice(*m_device);
+        KisGaussianKernel::applyGaussian(dev, rc, radius, radius,
+                                         QBitArray(), 0, false, method);
+    }
+}
+
+QTEST_MAIN(KisGaussianBlurBenchmark)
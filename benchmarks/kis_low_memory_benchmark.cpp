@@ -19,6 +19,8 @@
 #include "kis_low_memory_benchmark.h"
 
 #include <QTest>
+#include <QThread>
+#include <QElapsedTimer>
 
 #include "kis_benchmark_values.h"
 
@@ -36,7 +38,9 @@
 #include <brushengine/kis_paintop_registry.h>
 #include <brushengine/kis_paintop_preset.h>
 
+#include "tiles3/kis_tile_data.h"
 #include "tiles3/kis_tile_data_store.h"
+#include "tiles3/kis_tile_data_store_iterators.h"
 #include "kis_surrogate_undo_adapter.h"
 #include "kis_image_config.h"
 #define LOAD_PRESET_OR_RETURN(preset, fileName)                         \
@@ -228,4 +232,115 @@ void KisLowMemoryBenchmark::memory2000History100Pool500HugeBrush()
                       2000, 600, 500, 0);
 }
 
+/**
+ * Swaps out and in a set of tiles from several threads at once
+ * and reports the throughput of the tile data store. Every thread
+ * works with its own set of tiles, so the only points of contention
+ * are the locks of the store itself: swapping goes through the same
+ * path as the one used by the swapper thread and by the tiles being
+ * accessed by the iterators.
+ */
+class SwapWorker : public QThread
+{
+public:
+    SwapWorker(KisTileDataStore *store,
+               const QList<KisTileData*> &tiles,
+               int numCycles)
+        : m_store(store),
+          m_tiles(tiles),
+          m_numCycles(numCycles)
+    {
+    }
+
+    void run() override {
+        for (int i = 0; i < m_numCycles; i++) {
+            KisTileDataStoreIterator *iter = m_store->beginIteration();
+            Q_FOREACH (KisTileData *td, m_tiles) {
+                iter->trySwapOut(td);
+            }
+            // the tiles are actually compressed here
+            m_store->endIteration(iter);
+
+            Q_FOREACH (KisTileData *td, m_tiles) {
+                td->blockSwapping();
+                td->unblockSwapping();
+            }
+        }
+    }
+
+private:
+    KisTileDataStore *m_store;
+    QList<KisTileData*> m_tiles;
+    int m_numCycles;
+};
+
+void KisLowMemoryBenchmark::swapThreadScaling()
+{
+    // 16-bit RGBA tiles, 32 KiB each
+    const qint32 pixelSize = 8;
+    const quint8 defaultPixel[pixelSize] = {0};
+    const int numTilesPerThread = 512;
+    const int numCycles = 4;
+    const int maxThreads = QThread::idealThreadCount();
+
+    KisTileDataStore *store = KisTileDataStore::instance();
+
+    for (int numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+        QList<QList<KisTileData*>> tiles;
+
+        for (int i = 0; i < numThreads; i++) {
+            QList<KisTileData*> threadTiles;
+
+            for (int j = 0; j < numTilesPerThread; j++) {
+                KisTileData *td = store->createDefaultTileData(pixelSize, defaultPixel);
+                td->ref();
+
+                // a gradient-like content that is neither trivial nor random
+                quint8 *ptr = td->data();
+                const int dataSize = pixelSize * KisTileData::WIDTH * KisTileData::HEIGHT;
+                for (int k = 0; k < dataSize; k++) {
+                    ptr[k] = (k / pixelSize + j * 7 + (k % pixelSize) * 31) & 0xff;
+                }
+
+                threadTiles << td;
+            }
+
+            tiles << threadTiles;
+        }
+
+        QList<SwapWorker*> workers;
+        for (int i = 0; i < numThreads; i++) {
+            workers << new SwapWorker(store, tiles[i], numCycles);
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+
+        Q_FOREACH (SwapWorker *worker, workers) {
+            worker->start();
+        }
+
+        Q_FOREACH (SwapWorker *worker, workers) {
+            worker->wait();
+        }
+
+        const qint64 elapsed = qMax(qint64(1), timer.elapsed());
+        const qreal totalMiB =
+            2.0 * numCycles * numThreads * numTilesPerThread *
+            pixelSize * KisTileData::WIDTH * KisTileData::HEIGHT / MiB;
+
+        qDebug() << "Threads:" << numThreads
+                 << "time:" << elapsed << "ms"
+                 << "throughput:" << totalMiB * 1000.0 / elapsed << "MiB/s";
+
+        qDeleteAll(workers);
+
+        for (int i = 0; i < numThreads; i++) {
+            Q_FOREACH (KisTileData *td, tiles[i]) {
+                td->deref();
+            }
+        }
+    }
+}
+
 QTEST_MAIN(KisLowMemoryBenchmark)
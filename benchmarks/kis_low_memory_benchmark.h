@@ -31,6 +31,8 @@ private Q_SLOTS:
 
     void memory2000History100Pool500HugeBrush();
 
+    void swapThreadScaling();
+
 private:
     void benchmarkWideArea(const QString presetFileName,
                            const QRectF &rect, qreal vstep,
@@ -35,8 +35,8 @@
 
 #include "kis_mask_generator_benchmark.h"
 
-#include "kis_circle_mask_generator.h"
-#include "kis_rect_mask_generator.h"
+#include "kis_mask_generator.h"
+#include "kis_cubic_curve.h"
 
 void KisMaskGeneratorBenchmark::benchmarkCircle()
 {
@@ -108,4 +108,90 @@ void KisMaskGeneratorBenchmark::benchmarkSquare()
     }
 }
 
+template <class Generator>
+KisMaskGenerator* resetApplicator(Generator *gen, bool forceScalar)
+{
+    gen->resetMaskApplicator(forceScalar);
+    return gen;
+}
+
+KisMaskGenerator* createShapeGenerator(const QString &shape, qreal diameter, qreal fade, bool forceScalar)
+{
+    KisCubicCurve curve;
+    curve.fromString(QString("0,1;1,0"));
+
+    if (shape == "circle") {
+        return resetApplicator(new KisCircleMaskGenerator(diameter, 1.0, fade, fade, 2, true), forceScalar);
+    } else if (shape == "gauss_circle") {
+        return resetApplicator(new KisGaussCircleMaskGenerator(diameter, 1.0, fade, fade, 2, true), forceScalar);
+    } else if (shape == "curve_circle") {
+        return resetApplicator(new KisCurveCircleMaskGenerator(diameter, 1.0, fade, fade, 2, curve, true), forceScalar);
+    } else if (shape == "rect") {
+        return resetApplicator(new KisRectangleMaskGenerator(diameter, 1.0, fade, fade, 2, true), forceScalar);
+    } else if (shape == "gauss_rect") {
+        return resetApplicator(new KisGaussRectangleMaskGenerator(diameter, 1.0, fade, fade, 2, true), forceScalar);
+    } else if (shape == "curve_rect") {
+        return resetApplicator(new KisCurveRectangleMaskGenerator(diameter, 1.0, fade, fade, 2, curve, true), forceScalar);
+    }
+
+    return 0;
+}
+
+void KisMaskGeneratorBenchmark::benchmarkShapes_data()
+{
+    QTest::addColumn<QString>("shape");
+    QTest::addColumn<int>("size");
+    QTest::addColumn<qreal>("fade");
+    QTest::addColumn<bool>("forceScalar");
+
+    const QStringList shapes({"circle", "gauss_circle", "curve_circle",
+                              "rect", "gauss_rect", "curve_rect"});
+
+    Q_FOREACH (const QString &shape, shapes) {
+        Q_FOREACH (int size, QList<int>({16, 64, 300, 1000})) {
+            Q_FOREACH (qreal fade, QList<qreal>({1.0, 0.5})) {
+                for (int scalar = 0; scalar < 2; scalar++) {
+                    QTest::newRow(QString("%1_%2_%3_%4")
+                                  .arg(shape)
+                                  .arg(size)
+                                  .arg(fade < 1.0 ? "faded" : "sharp")
+                                  .arg(scalar ? "scalar" : "vector").toLatin1())
+                            << shape << size << fade << bool(scalar);
+                }
+            }
+        }
+    }
+}
+
+void KisMaskGeneratorBenchmark::benchmarkShapes()
+{
+    QFETCH(QString, shape);
+    QFETCH(int, size);
+    QFETCH(qreal, fade);
+    QFETCH(bool, forceScalar);
+
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisFixedPaintDeviceSP dev = new KisFixedPaintDevice(cs);
+    dev->setRect(QRect(0, 0, size, size));
+    dev->initialize();
+
+    MaskProcessingData data(dev, cs,
+                            0.0, 1.0,
+                            0.5 * size, 0.5 * size, 0);
+
+    QScopedPointer<KisMaskGenerator> gen(createShapeGenerator(shape, size, fade, forceScalar));
+    QVERIFY(gen);
+
+    KisBrushMaskApplicatorBase *applicator = gen->applicator();
+    applicator->initializeData(&data);
+
+    QVector<QRect> rects = KritaUtils::splitRectIntoPatches(dev->bounds(), QSize(63, 63));
+
+    QBENCHMARK{
+        Q_FOREACH (const QRect &rc, rects) {
+            applicator->process(rc);
+        }
+    }
+}
+
 QTEST_MAIN(KisMaskGeneratorBenchmark)
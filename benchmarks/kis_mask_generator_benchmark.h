@@ -30,6 +30,9 @@ private Q_SLOTS:
     void benchmarkSIMD_FadedBrush();
     void benchmarkSquare();
 
+    void benchmarkShapes_data();
+    void benchmarkShapes();
+
 };
 
 #endif
@@ -0,0 +1,223 @@
+/*
+ *  Copyright (c) 2019 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_tile_compression_benchmark.h"
+
+#include <QTest>
+#include <QBuffer>
+#include <QElapsedTimer>
+
+#include "kis_benchmark_values.h"
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include "kis_paint_device.h"
+#include "kis_paint_device_writer.h"
+#include "kis_datamanager.h"
+#include "kis_sequential_iterator.h"
+
+#include "tiles3/kis_tiled_data_manager.h"
+#include "tiles3/swap/kis_tile_compressor_2.h"
+#include "tiles3/swap/kis_compression_factory.h"
+
+
+class KisBufferPaintDeviceWriter : public KisPaintDeviceWriter
+{
+public:
+    KisBufferPaintDeviceWriter(QBuffer *buffer, const QString &tileCompression = QString())
+        : m_buffer(buffer),
+          m_tileCompression(tileCompression)
+    {
+    }
+
+    bool write(const QByteArray &data) override {
+        return m_buffer->write(data) == data.size();
+    }
+
+    bool write(const char* data, qint64 length) override {
+        return m_buffer->write(data, length) == length;
+    }
+
+    QString tileCompression() const override {
+        return m_tileCompression;
+    }
+
+private:
+    QBuffer *m_buffer;
+    QString m_tileCompression;
+};
+
+void KisTileCompressionBenchmark::initTestCase()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16();
+    m_device = new KisPaintDevice(cs);
+
+    /**
+     * Real paintings are neither flat nor noise. Emulate them with
+     * smooth gradients and a bit of grain on top of them.
+     */
+    srand(31524744);
+
+    KoColor color(cs);
+    KisSequentialIterator it(m_device, QRect(0, 0, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT));
+    while (it.nextPixel()) {
+        const int x = it.x();
+        const int y = it.y();
+        const int grain = rand() % 8;
+
+        color.fromQColor(QColor((x / 16 + grain) % 256,
+                                (y / 16 + grain) % 256,
+                                ((x + y) / 32) % 256));
+        memcpy(it.rawData(), color.data(), cs->pixelSize());
+    }
+}
+
+void KisTileCompressionBenchmark::cleanupTestCase()
+{
+    m_device = 0;
+}
+
+void KisTileCompressionBenchmark::addCompressionRows()
+{
+    QTest::addColumn<QString>("compression");
+
+    Q_FOREACH (const QString &name, KisCompressionFactory::availableCompressions()) {
+        QTest::newRow(name.toLatin1()) << name;
+    }
+}
+
+void KisTileCompressionBenchmark::benchmarkSwapOut_data()
+{
+    addCompressionRows();
+}
+
+void KisTileCompressionBenchmark::benchmarkSwapOut()
+{
+    QFETCH(QString, compression);
+
+    KisTileCompressor2 compressor(compression);
+    KisTiledDataManager *dm = m_device->dataManager().data();
+
+    const int numCols = TEST_IMAGE_WIDTH / KisTileData::WIDTH;
+    const int numRows = TEST_IMAGE_HEIGHT / KisTileData::HEIGHT;
+
+    QVector<KisTileSP> tiles;
+    for (int row = 0; row < numRows; row++) {
+        for (int col = 0; col < numCols; col++) {
+            tiles.append(dm->getTile(col, row, false));
+        }
+    }
+
+    const qint32 bufferSize = compressor.tileDataBufferSize(tiles.first()->tileData());
+    QByteArray buffer(bufferSize, 0);
+
+    qint64 rawBytes = 0;
+    qint64 compressedBytes = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    Q_FOREACH (KisTileSP tile, tiles) {
+        tile->lockForRead();
+        qint32 bytesWritten = 0;
+        compressor.compressTileData(tile->tileData(),
+                                    reinterpret_cast<quint8*>(buffer.data()),
+                                    bufferSize, bytesWritten);
+        tile->unlock();
+
+        rawBytes += tile->tileData()->pixelSize() * KisTileData::WIDTH * KisTileData::HEIGHT;
+        compressedBytes += bytesWritten;
+    }
+
+    const qint64 elapsed = qMax(qint64(1), timer.elapsed());
+
+    qDebug() << compression
+             << "ratio:" << qreal(compressedBytes) / rawBytes
+             << "MiB/s:" << qreal(rawBytes) / (1 << 20) / elapsed * 1000;
+
+    QBENCHMARK {
+        Q_FOREACH (KisTileSP tile, tiles) {
+            tile->lockForRead();
+            qint32 bytesWritten = 0;
+            compressor.compressTileData(tile->tileData(),
+                                        reinterpret_cast<quint8*>(buffer.data()),
+                                        bufferSize, bytesWritten);
+            tile->unlock();
+        }
+    }
+}
+
+void KisTileCompressionBenchmark::benchmarkSwapIn_data()
+{
+    addCompressionRows();
+}
+
+void KisTileCompressionBenchmark::benchmarkSwapIn()
+{
+    QFETCH(QString, compression);
+
+    KisTileCompressor2 compressor(compression);
+
+    const quint8 defaultPixel[8] = {0};
+    KisTiledDataManager dm(m_device->pixelSize(), defaultPixel);
+    KisTileSP tile = dm.getTile(0, 0, true);
+    tile->lockForWrite();
+
+    m_device->readBytes(tile->data(), QRect(0, 0, KisTileData::WIDTH, KisTileData::HEIGHT));
+
+    const qint32 bufferSize = compressor.tileDataBufferSize(tile->tileData());
+    QByteArray buffer(bufferSize, 0);
+    qint32 bytesWritten = 0;
+    compressor.compressTileData(tile->tileData(),
+                                reinterpret_cast<quint8*>(buffer.data()),
+                                bufferSize, bytesWritten);
+
+    QBENCHMARK {
+        for (int i = 0; i < 1024; i++) {
+            compressor.decompressTileData(reinterpret_cast<quint8*>(buffer.data()),
+                                          bytesWritten, tile->tileData());
+        }
+    }
+
+    tile->unlock();
+}
+
+void KisTileCompressionBenchmark::benchmarkSave_data()
+{
+    addCompressionRows();
+}
+
+void KisTileCompressionBenchmark::benchmarkSave()
+{
+    QFETCH(QString, compression);
+
+    qint64 size = 0;
+
+    QBENCHMARK {
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        KisBufferPaintDeviceWriter writer(&buffer, compression);
+        m_device->write(writer);
+        size = buffer.size();
+    }
+
+    qDebug() << compression << "saved size, MiB:" << qreal(size) / (1 << 20);
+}
+
+QTEST_MAIN(KisTileCompressionBenchmark)
@@ -0,0 +1,99 @@
+/*
+ *  Copyright (c) 2019 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_update_scheduler_benchmark.h"
+
+#include <QTest>
+#include <QThread>
+#include <QElapsedTimer>
+
+#include "kis_benchmark_values.h"
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_image.h>
+#include <kis_group_layer.h>
+#include <kis_paint_layer.h>
+#include "kis_paint_device.h"
+
+
+/**
+ * Measures how the update scheduler scales with the number of
+ * threads, when it is flooded with small merge jobs, like it
+ * happens during a multithreaded stroke.
+ */
+void KisUpdateSchedulerBenchmark::benchmarkMergeJobsScaling()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, cs, "scaling benchmark image");
+
+    const int numLayers = 8;
+    QVector<KisPaintLayerSP> layers;
+
+    for (int i = 0; i < numLayers; i++) {
+        KisPaintLayerSP layer = new KisPaintLayer(image, QString("layer %1").arg(i), OPACITY_OPAQUE_U8, cs);
+        layer->paintDevice()->fill(image->bounds(),
+                                   KoColor(QColor(10 * i, 255 - 10 * i, 128, 128), cs));
+
+        image->addNode(layer, image->root());
+        layers << layer;
+    }
+
+    image->refreshGraph();
+
+    const int numUpdates = 4096;
+    const int updateSize = 64;
+
+    srand(31524744);
+
+    QVector<QRect> updateRects;
+    for (int i = 0; i < numUpdates; i++) {
+        updateRects << QRect(rand() % (TEST_IMAGE_WIDTH - updateSize),
+                             rand() % (TEST_IMAGE_HEIGHT - updateSize),
+                             updateSize, updateSize);
+    }
+
+    const int maxThreads = qMax(1, QThread::idealThreadCount());
+    qreal singleThreadTime = 0;
+
+    for (int numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+        image->setWorkingThreadsLimit(numThreads);
+
+        QElapsedTimer timer;
+        timer.start();
+
+        for (int i = 0; i < numUpdates; i++) {
+            layers[i % numLayers]->setDirty(updateRects[i]);
+        }
+        image->waitForDone();
+
+        const qreal elapsed = qMax(qint64(1), timer.elapsed());
+
+        if (numThreads == 1) {
+            singleThreadTime = elapsed;
+        }
+
+        qDebug() << "threads:" << numThreads
+                 << "time, ms:" << elapsed
+                 << "speedup:" << singleThreadTime / elapsed;
+    }
+}
+
+QTEST_MAIN(KisUpdateSchedulerBenchmark)
@@ -96,6 +96,51 @@ private:
         return brushes;
     }
 
+    ///Reimplemented
+    QList<KisBrushSP> createResourcesForLoading(const QString & filename) override {
+        QList<KisBrushSP> brushes;
+
+        /**
+         * The collection is decoded in loadResource(), which may run
+         * concurrently, and is split into the tips afterwards
+         */
+        if (QFileInfo(filename).suffix().toLower() == "abr") {
+            brushes.append(new KisAbrBrushCollection(filename));
+        }
+        else {
+            brushes = createResources(filename);
+        }
+        return brushes;
+    }
+
+    ///Reimplemented
+    bool loadResource(KisBrushSP brush) override {
+        if (dynamic_cast<KisAbrBrushCollection*>(brush.data())) {
+            return brush->load();
+        }
+        return KisBrushResourceServer::loadResource(brush);
+    }
+
+    ///Reimplemented
+    QList<KisBrushSP> unpackLoadedResource(KisBrushSP brush) override {
+        KisAbrBrushCollection *collection = dynamic_cast<KisAbrBrushCollection*>(brush.data());
+        if (!collection) {
+            return KisBrushResourceServer::unpackLoadedResource(brush);
+        }
+
+        QList<KisBrushSP> brushes;
+        Q_FOREACH (KisAbrBrush * abrBrush, collection->brushes()) {
+            KisBrushSP tip(abrBrush);
+            if (!tip->valid() || tip->md5().isEmpty()) {
+                warnKrita << "Loading brush" << tip->name() << "from" << collection->filename() << "failed";
+                continue;
+            }
+            brushes.append(tip);
+            addTag(abrBrush, collection->filename());
+        }
+        return brushes;
+    }
+
     ///Reimplemented
     KisBrushSP createResource(const QString & filename) override {
 
@@ -122,6 +167,12 @@ private:
 KisBrushServer::KisBrushServer()
 {
     m_brushServer = new BrushResourceServer();
+
+    /**
+     * The brushes and the ABR collections decode their tips without
+     * touching any shared state
+     */
+    m_brushServer->setConcurrentLoadingEnabled(true);
     m_brushServer->loadResources(KoResourceServerProvider::blacklistFileNames(m_brushServer->fileNames(), m_brushServer->blackListedFiles()));
 
     Q_FOREACH (KisBrushSP brush, m_brushServer->resources()) {
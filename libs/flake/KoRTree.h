@@ -24,11 +24,17 @@
 
 #include <QPair>
 #include <QMap>
+#include <QHash>
 #include <QList>
 #include <QVector>
 #include <QPointF>
 #include <QRectF>
 #include <QVarLengthArray>
+#include <QtMath>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
 
 #include <QDebug>
 #include "kis_assert.h"
@@ -75,6 +81,19 @@ public:
      */
     virtual void insert(const QRectF& bb, const T& data);
 
+    /**
+     * @brief Replace the content of the tree with the given data items
+     *
+     * The tree is packed bottom-up with the Sort-Tile-Recursive algorithm,
+     * which is much faster than inserting the items one by one and produces
+     * nodes with less overlap. The items are considered to be inserted in the
+     * order they are passed, so the queries will return them in this order.
+     *
+     * @param bbs bounding boxes of the data items
+     * @param data the data items, every item should be present only once
+     */
+    void bulkLoad(const QVector<QRectF> &bbs, const QVector<T> &data);
+
     /**
      * @brief Show if a shape is a part of the tree
      * @param data
@@ -340,6 +359,10 @@ class LeafNode : virtual public Node
     QPair<int, int> pickNext(Node * node, QVector<bool> & marker, Node * group1, Node * group2);
     virtual void adjustTree(Node * node1, Node * node2);
     void insertHelper(const QRectF& bb, const T& data, int id);
+    static QRectF normalizedBoundingBox(const QRectF &bb);
+
+    // methods for bulk loading
+    QVector<QVector<int>> partitionSortTileRecursive(const QVector<QRectF> &bbs) const;
 
     // methods for delete
     void insert(Node * node);
@@ -348,7 +371,7 @@ class LeafNode : virtual public Node
     int m_capacity;
     int m_minimum;
     Node * m_root;
-    QMap<T, LeafNode *> m_leafMap;
+    QHash<T, LeafNode *> m_leafMap;
 };
 
 template <typename T>
@@ -372,13 +395,107 @@ template <typename T>
 void KoRTree<T>::insert(const QRectF& bb, const T& data)
 {
     // check if the shape is not already registered
-    KIS_SAFE_ASSERT_RECOVER_NOOP(!m_leafMap[data]);
+    KIS_SAFE_ASSERT_RECOVER_NOOP(!m_leafMap.value(data));
 
     insertHelper(bb, data, LeafNode::dataIdCounter++);
 }
 
 template <typename T>
-void KoRTree<T>::insertHelper(const QRectF& bb, const T& data, int id)
+void KoRTree<T>::bulkLoad(const QVector<QRectF> &bbs, const QVector<T> &data)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(bbs.size() == data.size());
+
+    clear();
+    if (data.isEmpty()) return;
+
+    QVector<QRectF> nbbs(bbs.size());
+    QVector<int> ids(bbs.size());
+    for (int i = 0; i < bbs.size(); ++i) {
+        nbbs[i] = normalizedBoundingBox(bbs[i]);
+        ids[i] = LeafNode::dataIdCounter++;
+    }
+
+    QVector<Node *> nodes;
+    Q_FOREACH (const QVector<int> &group, partitionSortTileRecursive(nbbs)) {
+        LeafNode * leaf = createLeafNode(m_capacity + 1, 0, 0);
+        Q_FOREACH (int index, group) {
+            leaf->insert(nbbs[index], data[index], ids[index]);
+            m_leafMap[data[index]] = leaf;
+        }
+        nodes.append(leaf);
+    }
+
+    int level = 0;
+    while (nodes.size() > 1) {
+        ++level;
+
+        QVector<QRectF> nodeBBs(nodes.size());
+        for (int i = 0; i < nodes.size(); ++i) {
+            nodeBBs[i] = nodes[i]->boundingBox();
+        }
+
+        QVector<Node *> parents;
+        Q_FOREACH (const QVector<int> &group, partitionSortTileRecursive(nodeBBs)) {
+            NonLeafNode * node = createNonLeafNode(m_capacity + 1, level, 0);
+            Q_FOREACH (int index, group) {
+                node->insert(nodeBBs[index], nodes[index]);
+            }
+            parents.append(node);
+        }
+        nodes = parents;
+    }
+
+    delete m_root;
+    m_root = nodes.first();
+}
+
+template <typename T>
+QVector<QVector<int>> KoRTree<T>::partitionSortTileRecursive(const QVector<QRectF> &bbs) const
+{
+    const int count = bbs.size();
+    const int numNodes = (count + m_capacity - 1) / m_capacity;
+    const int numSlices = qCeil(std::sqrt(qreal(numNodes)));
+
+    QVector<int> indexes(count);
+    std::iota(indexes.begin(), indexes.end(), 0);
+
+    std::sort(indexes.begin(), indexes.end(),
+              [&bbs] (int lhs, int rhs) {
+                  return bbs[lhs].center().x() < bbs[rhs].center().x();
+              });
+
+    QVector<QVector<int>> groups;
+    groups.reserve(numNodes + numSlices);
+
+    /**
+     * The slices and the nodes inside them are split evenly instead of being
+     * filled up to the capacity, otherwise the last node of every slice could
+     * end up with less than m_minimum children.
+     */
+    for (int slice = 0; slice < numSlices; ++slice) {
+        const int sliceStart = slice * count / numSlices;
+        const int sliceEnd = (slice + 1) * count / numSlices;
+        const int sliceSize = sliceEnd - sliceStart;
+        if (!sliceSize) continue;
+
+        std::sort(indexes.begin() + sliceStart, indexes.begin() + sliceEnd,
+                  [&bbs] (int lhs, int rhs) {
+                      return bbs[lhs].center().y() < bbs[rhs].center().y();
+                  });
+
+        const int numChunks = (sliceSize + m_capacity - 1) / m_capacity;
+        for (int chunk = 0; chunk < numChunks; ++chunk) {
+            const int chunkStart = sliceStart + chunk * sliceSize / numChunks;
+            const int chunkEnd = sliceStart + (chunk + 1) * sliceSize / numChunks;
+            groups.append(indexes.mid(chunkStart, chunkEnd - chunkStart));
+        }
+    }
+
+    return groups;
+}
+
+template <typename T>
+QRectF KoRTree<T>::normalizedBoundingBox(const QRectF &bb)
 {
     QRectF nbb(bb.normalized());
     // This has to be done as it is not possible to use QRectF::united() with a isNull()
@@ -398,6 +515,14 @@ void KoRTree<T>::insertHelper(const QRectF& bb, const T& data, int id)
         }
     }
 
+    return nbb;
+}
+
+template <typename T>
+void KoRTree<T>::insertHelper(const QRectF& bb, const T& data, int id)
+{
+    const QRectF nbb = normalizedBoundingBox(bb);
+
     LeafNode * leaf = m_root->chooseLeaf(nbb);
     //debugFlake << " leaf" << leaf->nodeId() << nbb;
 
@@ -444,7 +569,7 @@ void KoRTree<T>::insert(Node * node)
 template <typename T>
 bool KoRTree<T>::contains(const T &data)
 {
-    return m_leafMap[data];
+    return m_leafMap.value(data);
 }
 
 
@@ -452,7 +577,7 @@ template <typename T>
 void KoRTree<T>::remove(const T&data)
 {
     //debugFlake << "KoRTree remove";
-    LeafNode * leaf = m_leafMap[data];
+    LeafNode * leaf = m_leafMap.value(data);
 
     // Trying to remove unexistent leaf. Most probably, this leaf hasn't been added
     // to the shape manager correctly
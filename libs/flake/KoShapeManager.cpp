@@ -49,6 +49,7 @@
 
 #include <QPainter>
 #include <QTimer>
+#include <algorithm>
 #include <FlakeDebug.h>
 
 #include "kis_painting_tweaks.h"
@@ -64,28 +65,47 @@ bool KoShapeManager::Private::shapeUsedInRenderingTree(KoShape *shape)
 
 void KoShapeManager::Private::updateTree()
 {
+    /**
+     * When a big part of the document has changed at once (e.g. the whole
+     * layer has been transformed) it is cheaper to pack the tree from scratch
+     * than to remove and reinsert every changed shape.
+     */
+    const int minShapesForRebuild = 64;
+    const bool needsRebuild =
+        aggregate4update.size() > qMax(minShapesForRebuild, shapes.size() / 4);
+
+    // every detection is a tree query, so avoid them if nobody is interested
+    const bool needsCollisionDetection =
+        !needsRebuild || hasShapesWithCollisionDetection();
+
     // for detecting collisions between shapes.
     DetectCollision detector;
     bool selectionModified = false;
     bool anyModified = false;
     Q_FOREACH (KoShape *shape, aggregate4update) {
-        if (shapeIndexesBeforeUpdate.contains(shape))
+        if (needsCollisionDetection && shapeIndexesBeforeUpdate.contains(shape))
             detector.detect(tree, shape, shapeIndexesBeforeUpdate[shape]);
         selectionModified = selectionModified || selection->isSelected(shape);
         anyModified = true;
     }
 
-    foreach (KoShape *shape, aggregate4update) {
-        if (!shapeUsedInRenderingTree(shape)) continue;
+    if (needsRebuild) {
+        rebuildTree();
+    } else {
+        foreach (KoShape *shape, aggregate4update) {
+            if (!shapeUsedInRenderingTree(shape)) continue;
 
-        tree.remove(shape);
-        QRectF br(shape->boundingRect());
-        tree.insert(br, shape);
+            tree.remove(shape);
+            QRectF br(shape->boundingRect());
+            tree.insert(br, shape);
+        }
     }
 
     // do it again to see which shapes we intersect with _after_ moving.
-    foreach (KoShape *shape, aggregate4update) {
-        detector.detect(tree, shape, shapeIndexesBeforeUpdate[shape]);
+    if (needsCollisionDetection) {
+        foreach (KoShape *shape, aggregate4update) {
+            detector.detect(tree, shape, shapeIndexesBeforeUpdate[shape]);
+        }
     }
     aggregate4update.clear();
     shapeIndexesBeforeUpdate.clear();
@@ -99,6 +119,51 @@ void KoShapeManager::Private::updateTree()
     }
 }
 
+void KoShapeManager::Private::rebuildTree()
+{
+    QVector<QRectF> rects;
+    QVector<KoShape*> treeShapes;
+    rects.reserve(shapes.size());
+    treeShapes.reserve(shapes.size());
+
+    Q_FOREACH (KoShape *shape, shapes) {
+        if (!shapeUsedInRenderingTree(shape)) continue;
+
+        rects.append(shape->boundingRect());
+        treeShapes.append(shape);
+    }
+
+    tree.bulkLoad(rects, treeShapes);
+}
+
+bool KoShapeManager::Private::hasShapesWithCollisionDetection() const
+{
+    return std::any_of(shapes.begin(), shapes.end(),
+                       [] (KoShape *shape) {
+                           return shape->collisionDetection();
+                       });
+}
+
+void KoShapeManager::Private::addShapeRecursively(KoShape *shape, KoShapeManager::Repaint repaint)
+{
+    if (shapesSet.contains(shape))
+        return;
+    shape->priv()->addShapeManager(q);
+    shapes.append(shape);
+    shapesSet.insert(shape);
+
+    if (repaint == KoShapeManager::PaintShapeOnAdd) {
+        shape->update();
+    }
+
+    KoShapeContainer *container = dynamic_cast<KoShapeContainer*>(shape);
+    if (container) {
+        Q_FOREACH (KoShape *containerShape, container->shapes()) {
+            addShapeRecursively(containerShape, repaint);
+        }
+    }
+}
+
 void KoShapeManager::Private::paintGroup(KoShapeGroup *group, QPainter &painter, const KoViewConverter &converter, KoShapePaintingContext &paintContext)
 {
     QList<KoShape*> shapes = group->shapes();
@@ -149,6 +214,7 @@ KoShapeManager::~KoShapeManager()
 {
     d->unlinkFromShapesRecursively(d->shapes);
     d->shapes.clear();
+    d->shapesSet.clear();
 
     delete d;
 }
@@ -159,20 +225,33 @@ void KoShapeManager::setShapes(const QList<KoShape *> &shapes, Repaint repaint)
     d->selection->deselectAll();
     d->unlinkFromShapesRecursively(d->shapes);
     d->aggregate4update.clear();
+    d->shapeIndexesBeforeUpdate.clear();
     d->tree.clear();
     d->shapes.clear();
+    d->shapesSet.clear();
 
     Q_FOREACH (KoShape *shape, shapes) {
-        addShape(shape, repaint);
+        d->addShapeRecursively(shape, repaint);
+    }
+
+    d->rebuildTree();
+
+    if (d->hasShapesWithCollisionDetection()) {
+        Private::DetectCollision detector;
+        Q_FOREACH (KoShape *shape, d->shapes) {
+            detector.detect(d->tree, shape, shape->zIndex());
+        }
+        detector.fireSignals();
     }
 }
 
 void KoShapeManager::addShape(KoShape *shape, Repaint repaint)
 {
-    if (d->shapes.contains(shape))
+    if (d->shapesSet.contains(shape))
         return;
     shape->priv()->addShapeManager(this);
     d->shapes.append(shape);
+    d->shapesSet.insert(shape);
 
     if (d->shapeUsedInRenderingTree(shape)) {
         QRectF br(shape->boundingRect());
@@ -212,6 +291,7 @@ void KoShapeManager::remove(KoShape *shape)
         d->tree.remove(shape);
     }
     d->shapes.removeAll(shape);
+    d->shapesSet.remove(shape);
 
     // remove the children of a KoShapeContainer
     KoShapeContainer *container = dynamic_cast<KoShapeContainer*>(shape);
@@ -239,6 +319,7 @@ void KoShapeManager::ShapeInterface::notifyShapeDestructed(KoShape *shape)
     }
 
     q->d->shapes.removeAll(shape);
+    q->d->shapesSet.remove(shape);
 }
 
 
@@ -274,7 +355,7 @@ void KoShapeManager::paint(QPainter &painter, const KoViewConverter &converter,
         KoShapeContainer *parent = shape->parent();
         while (parent) {
             // parent must be part of the shape manager to be taken into account
-            if (!d->shapes.contains(parent))
+            if (!d->shapesSet.contains(parent))
                 break;
             if (parent->filterEffectStack() && !parent->filterEffectStack()->isEmpty()) {
                 addShapeToList = false;
@@ -533,30 +614,27 @@ KoShape *KoShapeManager::shapeAt(const QPointF &position, KoFlake::ShapeSelectio
 QList<KoShape *> KoShapeManager::shapesAt(const QRectF &rect, bool omitHiddenShapes, bool containedMode)
 {
     d->updateTree();
-    QList<KoShape*> shapes(containedMode ? d->tree.contained(rect) : d->tree.intersects(rect));
-
-    for (int count = shapes.count() - 1; count >= 0; count--) {
+    const QList<KoShape*> candidates(containedMode ? d->tree.contained(rect) : d->tree.intersects(rect));
 
-        KoShape *shape = shapes.at(count);
-
-        if (omitHiddenShapes && !shape->isVisible()) {
-            shapes.removeAt(count);
-        } else {
-            const QPainterPath outline = shape->absoluteTransformation(0).map(shape->outline());
+    QPainterPath containingPath;
+    containingPath.addRect(rect);
 
-            if (!containedMode && !outline.intersects(rect) && !outline.contains(rect)) {
-                shapes.removeAt(count);
+    // filter in a single pass, removing items from the list one by one is quadratic
+    QList<KoShape*> shapes;
+    shapes.reserve(candidates.size());
 
-            } else if (containedMode) {
+    Q_FOREACH (KoShape *shape, candidates) {
+        if (omitHiddenShapes && !shape->isVisible()) continue;
 
-                QPainterPath containingPath;
-                containingPath.addRect(rect);
+        const QPainterPath outline = shape->absoluteTransformation(0).map(shape->outline());
 
-                if (!containingPath.contains(outline)) {
-                    shapes.removeAt(count);
-                }
-            }
+        if (containedMode) {
+            if (!containingPath.contains(outline)) continue;
+        } else {
+            if (!outline.intersects(rect) && !outline.contains(rect)) continue;
         }
+
+        shapes.append(shape);
     }
 
     return shapes;
@@ -60,6 +60,24 @@ public:
      */
     void updateTree();
 
+    /**
+     * Packs the tree from scratch using all the shapes of the manager. It is
+     * much faster than reinserting a big number of shapes one by one.
+     */
+    void rebuildTree();
+
+    /**
+     * Returns whether any of the shapes of the manager wants to be notified
+     * about collisions. When none does, the collision detection can be skipped.
+     */
+    bool hasShapesWithCollisionDetection() const;
+
+    /**
+     * Adds the shape and its children to the list of shapes without touching
+     * the tree
+     */
+    void addShapeRecursively(KoShape *shape, KoShapeManager::Repaint repaint);
+
     /**
      * Returns whether the shape should be added to the RTree for collision and ROI
      * detection.
@@ -111,6 +129,7 @@ public:
     };
 
     QList<KoShape *> shapes;
+    QSet<KoShape *> shapesSet; // the same as 'shapes', but with fast lookups
     KoSelection *selection;
     KoCanvasBase *canvas;
     KoRTree<KoShape *> tree;
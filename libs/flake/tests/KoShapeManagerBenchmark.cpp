@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2019 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "KoShapeManagerBenchmark.h"
+
+#include <QTest>
+#include <QPainter>
+
+#include <MockShapes.h>
+#include <KoShapeManager.h>
+#include <KoViewConverter.h>
+
+/**
+ * Roughly the size of an imported SVG map
+ */
+const int gridSize = 250;
+const qreal cellSize = 10;
+
+void KoShapeManagerBenchmark::initTestCase()
+{
+    for (int row = 0; row < gridSize; row++) {
+        for (int col = 0; col < gridSize; col++) {
+            MockShape *shape = new MockShape();
+            shape->setPosition(QPointF(col * cellSize, row * cellSize));
+            shape->setSize(QSizeF(1.5 * cellSize, 1.5 * cellSize));
+            shape->setZIndex(row * gridSize + col);
+            m_shapes << shape;
+        }
+    }
+}
+
+void KoShapeManagerBenchmark::cleanupTestCase()
+{
+    qDeleteAll(m_shapes);
+    m_shapes.clear();
+}
+
+void KoShapeManagerBenchmark::testSetShapes()
+{
+    MockCanvas canvas;
+    KoShapeManager manager(&canvas);
+
+    QBENCHMARK {
+        manager.setShapes(m_shapes, KoShapeManager::AddWithoutRepaint);
+    }
+}
+
+void KoShapeManagerBenchmark::testShapeAt()
+{
+    MockCanvas canvas;
+    KoShapeManager manager(&canvas, m_shapes);
+
+    QBENCHMARK {
+        for (int i = 0; i < gridSize; i++) {
+            manager.shapeAt(QPointF(i * cellSize + 3, (gridSize - i) * cellSize - 3));
+        }
+    }
+}
+
+void KoShapeManagerBenchmark::testShapesAt()
+{
+    MockCanvas canvas;
+    KoShapeManager manager(&canvas, m_shapes);
+
+    const qreal rectSize = 20 * cellSize;
+
+    QBENCHMARK {
+        for (int i = 0; i < gridSize - 20; i += 10) {
+            manager.shapesAt(QRectF(i * cellSize, i * cellSize, rectSize, rectSize));
+        }
+    }
+}
+
+void KoShapeManagerBenchmark::testPaint()
+{
+    MockCanvas canvas;
+    KoShapeManager manager(&canvas, m_shapes);
+
+    QImage image(512, 512, QImage::Format_ARGB32);
+    KoViewConverter converter;
+
+    QBENCHMARK {
+        QPainter painter(&image);
+        painter.setClipRect(image.rect());
+        manager.paint(painter, converter, false);
+    }
+}
+
+void KoShapeManagerBenchmark::testMoveAllShapes()
+{
+    MockCanvas canvas;
+    KoShapeManager manager(&canvas, m_shapes);
+
+    QBENCHMARK {
+        Q_FOREACH (KoShape *shape, m_shapes) {
+            shape->setPosition(shape->position() + QPointF(1, 1));
+        }
+
+        // the tree is updated lazily on the first request
+        manager.shapeAt(QPointF());
+    }
+}
+
+QTEST_MAIN(KoShapeManagerBenchmark)
@@ -130,4 +130,54 @@ void TestShapeAt::testShadow()
     QCOMPARE(shape.boundingRect(), bbox);
 }
 
+void TestShapeAt::testManyShapes()
+{
+    const int gridSize = 40;
+    const qreal cellSize = 10;
+
+    QList<KoShape*> shapes;
+    for (int row = 0; row < gridSize; row++) {
+        for (int col = 0; col < gridSize; col++) {
+            MockShape *shape = new MockShape();
+            shape->setPosition(QPointF(col * cellSize, row * cellSize));
+            shape->setSize(QSizeF(8, 8));
+            shapes << shape;
+        }
+    }
+
+    MockCanvas canvas;
+    KoShapeManager manager(&canvas);
+
+    // the tree is packed in one go
+    manager.setShapes(shapes, KoShapeManager::AddWithoutRepaint);
+    QCOMPARE(manager.shapes().size(), gridSize * gridSize);
+
+    QCOMPARE(manager.shapeAt(QPointF(124, 74)), shapes[7 * gridSize + 12]);
+    QCOMPARE(manager.shapeAt(QPointF(399, 399)), (KoShape*)0);
+    QCOMPARE(manager.shapesAt(QRectF(0, 0, 95, 95)).size(), 100);
+    QCOMPARE(manager.shapesAt(QRectF(-1, -1, 100, 100), true, true).size(), 100);
+
+    // a few shapes are reinserted into the tree one by one
+    shapes[0]->setPosition(QPointF(-100, -100));
+    QCOMPARE(manager.shapeAt(QPointF(-96, -96)), shapes[0]);
+    QCOMPARE(manager.shapeAt(QPointF(4, 4)), (KoShape*)0);
+    QCOMPARE(manager.shapesAt(QRectF(0, 0, 95, 95)).size(), 99);
+
+    // moving the whole grid makes the tree to be repacked from scratch
+    Q_FOREACH (KoShape *shape, shapes) {
+        shape->setPosition(shape->position() + QPointF(5, 5));
+    }
+
+    QCOMPARE(manager.shapeAt(QPointF(-91, -91)), shapes[0]);
+    QCOMPARE(manager.shapeAt(QPointF(129, 79)), shapes[7 * gridSize + 12]);
+    QCOMPARE(manager.shapeAt(QPointF(124, 74)), (KoShape*)0);
+    QCOMPARE(manager.shapesAt(QRectF(0, 0, 100, 100)).size(), 99);
+
+    manager.remove(shapes[1]);
+    QCOMPARE(manager.shapes().size(), gridSize * gridSize - 1);
+    QCOMPARE(manager.shapeAt(QPointF(19, 9)), (KoShape*)0);
+
+    qDeleteAll(shapes);
+}
+
 QTEST_MAIN(TestShapeAt)
@@ -29,6 +29,7 @@ private Q_SLOTS:
     // tests
     void test();
     void testShadow();
+    void testManyShapes();
 
 };
 
@@ -0,0 +1,176 @@
+/*
+ *  Copyright (c) 2019 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisGroupBelowCache.h"
+
+#include <QMutex>
+#include <QRegion>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+
+#include "kis_node.h"
+#include "kis_paint_device.h"
+#include "kis_painter.h"
+#include "kis_projection_leaf.h"
+#include "kis_abstract_projection_plane.h"
+#include "kis_default_bounds_base.h"
+
+
+struct KisGroupBelowCache::Private
+{
+    QMutex mutex;
+
+    KisPaintDeviceSP device;
+
+    /**
+     * The area of the device that has already been generated
+     */
+    QRegion validRegion;
+
+    /**
+     * The stack of layers the cache has been generated for. The
+     * pointers are used for comparison only and are never
+     * dereferenced.
+     */
+    KisNode *filthyNode = 0;
+    QVector<KisNode*> belowNodes;
+    int levelOfDetail = 0;
+
+    int numCacheHits = 0;
+
+    void resetUnlocked() {
+        device = 0;
+        validRegion = QRegion();
+        filthyNode = 0;
+        belowNodes.clear();
+    }
+};
+
+KisGroupBelowCache::KisGroupBelowCache()
+    : m_d(new Private)
+{
+}
+
+KisGroupBelowCache::~KisGroupBelowCache()
+{
+}
+
+void KisGroupBelowCache::composite(KisNodeSP filthyNode,
+                                   const QVector<KisProjectionLeafSP> &belowLeaves,
+                                   KisPaintDeviceSP dst,
+                                   const QRect &rect)
+{
+    QVector<KisNode*> belowNodes;
+    belowNodes.reserve(belowLeaves.size());
+    Q_FOREACH (KisProjectionLeafSP leaf, belowLeaves) {
+        belowNodes << leaf->node().data();
+    }
+
+    const int levelOfDetail = dst->defaultBounds()->currentLevelOfDetail();
+
+    KisPaintDeviceSP device;
+    QRegion missingRegion;
+
+    {
+        QMutexLocker l(&m_d->mutex);
+
+        if (!m_d->device ||
+            m_d->filthyNode != filthyNode.data() ||
+            m_d->belowNodes != belowNodes ||
+            m_d->levelOfDetail != levelOfDetail ||
+            !(*m_d->device->colorSpace() == *dst->colorSpace()) ||
+            !(m_d->device->defaultPixel() == dst->defaultPixel())) {
+
+            m_d->resetUnlocked();
+
+            m_d->device = new KisPaintDevice(dst->colorSpace());
+            m_d->device->setDefaultBounds(dst->defaultBounds());
+            m_d->device->setDefaultPixel(dst->defaultPixel());
+
+            m_d->filthyNode = filthyNode.data();
+            m_d->belowNodes = belowNodes;
+            m_d->levelOfDetail = levelOfDetail;
+        }
+
+        device = m_d->device;
+        missingRegion = QRegion(rect) - m_d->validRegion;
+
+        if (missingRegion.isEmpty()) {
+            m_d->numCacheHits++;
+        }
+    }
+
+    /**
+     * The missing area is generated without holding the lock, so that
+     * the update jobs working on different areas of the group were not
+     * serialized. Only the requested rect is generated: the area
+     * around it might be being changed by a concurrent job right now.
+     * Two jobs may occasionally generate the same pixels, so the data
+     * is prepared on a temporary device and only then copied into the
+     * cache.
+     */
+    if (!missingRegion.isEmpty()) {
+        KisPaintDeviceSP tmp = new KisPaintDevice(device->colorSpace());
+        tmp->setDefaultBounds(device->defaultBounds());
+        tmp->setDefaultPixel(device->defaultPixel());
+
+        KisPainter gc(tmp);
+
+        Q_FOREACH (const QRect &rc, missingRegion.rects()) {
+            Q_FOREACH (KisProjectionLeafSP leaf, belowLeaves) {
+                if (!leaf->visible()) continue;
+                leaf->projectionPlane()->apply(&gc, rc);
+            }
+        }
+
+        Q_FOREACH (const QRect &rc, missingRegion.rects()) {
+            KisPainter::copyAreaOptimized(rc.topLeft(), tmp, device, rc);
+        }
+
+        QMutexLocker l(&m_d->mutex);
+
+        // the cache might have been reset while we were working
+        if (m_d->device == device) {
+            m_d->validRegion += missingRegion;
+        }
+    }
+
+    KisPainter::copyAreaOptimized(rect.topLeft(), device, dst, rect);
+}
+
+void KisGroupBelowCache::notifyNodeUpdated(KisNodeSP node)
+{
+    QMutexLocker l(&m_d->mutex);
+
+    if (m_d->filthyNode != node.data()) {
+        m_d->resetUnlocked();
+    }
+}
+
+void KisGroupBelowCache::reset()
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->resetUnlocked();
+}
+
+int KisGroupBelowCache::testingGetNumCacheHits() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->numCacheHits;
+}
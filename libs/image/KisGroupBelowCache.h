@@ -0,0 +1,91 @@
+/*
+ *  Copyright (c) 2019 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISGROUPBELOWCACHE_H
+#define KISGROUPBELOWCACHE_H
+
+#include "kritaimage_export.h"
+#include "kis_types.h"
+
+#include <QScopedPointer>
+#include <QVector>
+
+class QRect;
+
+/**
+ * KisGroupBelowCache keeps the composition of all the children of a
+ * group layer that lie below the node being currently updated (usually
+ * the layer the user paints on). While the user paints on a single
+ * layer, KisAsyncMerger doesn't need to blend all the lower layers for
+ * every update, it just copies their precomposed result from the cache.
+ *
+ * Only the areas requested by the updates are generated, the rest of
+ * the cache stays empty.
+ *
+ * The cache is valid only for the exact stack of layers it was
+ * generated for. When the updated node or the set of layers below it
+ * changes, the cache is dropped. KisAsyncMerger also resets it when any
+ * other child of the group is updated.
+ *
+ * All the methods are thread-safe.
+ */
+class KRITAIMAGE_EXPORT KisGroupBelowCache
+{
+public:
+    KisGroupBelowCache();
+    ~KisGroupBelowCache();
+
+    /**
+     * Writes the composition of \p belowLeaves into \p rect of \p dst.
+     * The parts of \p rect that are not present in the cache are generated.
+     *
+     * \p dst should be clean in \p rect, because the data is copied
+     * into it, not blended.
+     *
+     * \param filthyNode the node right above \p belowLeaves, which is
+     *                   being updated
+     */
+    void composite(KisNodeSP filthyNode,
+                   const QVector<KisProjectionLeafSP> &belowLeaves,
+                   KisPaintDeviceSP dst,
+                   const QRect &rect);
+
+    /**
+     * Tells the cache that \p node has been updated. If the node is
+     * not the one the cache has been generated for, the cache is
+     * dropped, because the layers below it might have changed.
+     */
+    void notifyNodeUpdated(KisNodeSP node);
+
+    /**
+     * Drops all the cached data
+     */
+    void reset();
+
+    /**
+     * The number of composite() calls that didn't need to generate
+     * anything, for unittests only
+     */
+    int testingGetNumCacheHits() const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISGROUPBELOWCACHE_H
@@ -46,6 +46,7 @@
 #include "kis_refresh_subtree_walker.h"
 
 #include "kis_abstract_projection_plane.h"
+#include "KisGroupBelowCache.h"
 
 
 //#define DEBUG_MERGER
@@ -212,6 +213,24 @@ void KisAsyncMerger::startMerge(KisBaseRectsWalker &walker, bool notifyClones) {
 
     const bool useTempProjections = walker.needRectVaries();
 
+    /**
+     * The composition of the layers lying below the updated one can be
+     * taken from the group's cache only when the layers are composited
+     * directly into the original of the group and nothing but the
+     * updated layer (and its parents) is going to change.
+     */
+    const bool canUseBelowCache =
+        !useTempProjections &&
+        (walker.type() == KisBaseRectsWalker::UPDATE ||
+         walker.type() == KisBaseRectsWalker::UPDATE_NO_FILTHY);
+
+    QVector<KisNodeSP> pathNodes;
+    if (canUseBelowCache) {
+        for (KisNodeSP node = walker.startNode(); node; node = node->parent()) {
+            pathNodes << node;
+        }
+    }
+
     while(!leafStack.isEmpty()) {
         KisMergeWalker::JobItem item = leafStack.pop();
         KisProjectionLeafSP currentLeaf = item.m_leaf;
@@ -240,6 +259,38 @@ void KisAsyncMerger::startMerge(KisBaseRectsWalker &walker, bool notifyClones) {
         if(!m_currentProjection)
             setupProjection(currentLeaf, applyRect, useTempProjections);
 
+        KisGroupLayer *group =
+            dynamic_cast<KisGroupLayer*>(currentLeaf->parent()->node().data());
+
+        /**
+         * The cache of the group must be invalidated only after the
+         * original and the projection of the leaf have been updated,
+         * otherwise a concurrent job might regenerate it from the old
+         * data in between.
+         */
+        BelowCacheInvalidation invalidation = NoInvalidation;
+
+        if (!canUseBelowCache) {
+            invalidation = ResetCache;
+        } else if (item.m_position & KisMergeWalker::N_BELOW_FILTHY) {
+            if (canDeferBelowItem(item, group)) {
+                DEBUG_NODE_ACTION("Deferring", "N_BELOW_FILTHY", currentLeaf, applyRect);
+                m_belowItems.append(item);
+                continue;
+            }
+
+            flushBelowItems();
+            m_belowCacheDisabled = true;
+        } else if (pathNodes.contains(currentLeaf->node())) {
+            if (m_belowItems.isEmpty()) {
+                invalidation = m_belowCacheDisabled ? ResetCache : NotifyCache;
+            } else {
+                compositeBelowItemsFromCache(currentLeaf, group);
+            }
+        } else {
+            flushBelowItems();
+        }
+
         KisUpdateOriginalVisitor originalVisitor(applyRect,
                                                  m_currentProjection,
                                                  walker.cropRect());
@@ -271,6 +322,10 @@ void KisAsyncMerger::startMerge(KisBaseRectsWalker &walker, bool notifyClones) {
             /* nothing to do */
         }
 
+        if (group) {
+            invalidateBelowCache(currentLeaf, group, invalidation);
+        }
+
         compositeWithProjection(currentLeaf, applyRect);
 
         if(item.m_position & KisMergeWalker::N_TOPMOST) {
@@ -287,6 +342,11 @@ void KisAsyncMerger::startMerge(KisBaseRectsWalker &walker, bool notifyClones) {
         doNotifyClones(walker);
     }
 
+    if(!m_belowItems.isEmpty()) {
+        warnImage << "BUG: The walker hasn't reached the filthy node of the group!";
+        flushBelowItems();
+    }
+
     if(m_currentProjection) {
         warnImage << "BUG: The walker hasn't reached the root layer!";
         warnImage << "     Start node:" << walker.startNode() << "Requested rect:" << walker.requestedRect();
@@ -300,6 +360,8 @@ void KisAsyncMerger::startMerge(KisBaseRectsWalker &walker, bool notifyClones) {
 void KisAsyncMerger::resetProjection() {
     m_currentProjection = 0;
     m_finalProjection = 0;
+    m_belowItems.clear();
+    m_belowCacheDisabled = false;
 }
 
 void KisAsyncMerger::setupProjection(KisProjectionLeafSP currentLeaf, const QRect& rect, bool useTempProjection) {
@@ -353,6 +415,53 @@ bool KisAsyncMerger::compositeWithProjection(KisProjectionLeafSP leaf, const QRe
     return true;
 }
 
+bool KisAsyncMerger::canDeferBelowItem(const KisBaseRectsWalker::JobItem &item, KisGroupLayer *group) const {
+    return m_currentProjection &&
+        group && !m_belowCacheDisabled &&
+        (m_belowItems.isEmpty() ||
+         m_belowItems.first().m_applyRect == item.m_applyRect);
+}
+
+void KisAsyncMerger::compositeBelowItemsFromCache(KisProjectionLeafSP filthyLeaf, KisGroupLayer *group) {
+    KIS_SAFE_ASSERT_RECOVER(group && m_currentProjection) {
+        flushBelowItems();
+        return;
+    }
+
+    QVector<KisProjectionLeafSP> leaves;
+    leaves.reserve(m_belowItems.size());
+    Q_FOREACH (const KisBaseRectsWalker::JobItem &item, m_belowItems) {
+        leaves << item.m_leaf;
+    }
+
+    const QRect rect = m_belowItems.first().m_applyRect;
+    group->belowCache()->composite(filthyLeaf->node(), leaves, m_currentProjection, rect);
+
+    DEBUG_NODE_ACTION("Compositing cached projection", "", filthyLeaf->parent(), rect);
+    m_belowItems.clear();
+}
+
+void KisAsyncMerger::invalidateBelowCache(KisProjectionLeafSP leaf, KisGroupLayer *group, BelowCacheInvalidation invalidation) {
+    switch (invalidation) {
+    case ResetCache:
+        group->belowCache()->reset();
+        break;
+    case NotifyCache:
+        group->belowCache()->notifyNodeUpdated(leaf->node());
+        break;
+    case NoInvalidation:
+        break;
+    }
+}
+
+void KisAsyncMerger::flushBelowItems() {
+    Q_FOREACH (const KisBaseRectsWalker::JobItem &item, m_belowItems) {
+        DEBUG_NODE_ACTION("Updating", "N_BELOW_FILTHY", item.m_leaf, item.m_applyRect);
+        compositeWithProjection(item.m_leaf, item.m_applyRect);
+    }
+    m_belowItems.clear();
+}
+
 void KisAsyncMerger::doNotifyClones(KisBaseRectsWalker &walker) {
     KisBaseRectsWalker::CloneNotificationsVector &vector =
         walker.cloneNotifications();
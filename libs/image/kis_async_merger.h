@@ -21,9 +21,11 @@
 
 #include "kritaimage_export.h"
 #include "kis_types.h"
+#include "kis_base_rects_walker.h"
+
+#include <QVector>
 
 class QRect;
-class KisBaseRectsWalker;
 
 class KRITAIMAGE_EXPORT KisAsyncMerger
 {
@@ -31,12 +33,23 @@ public:
     void startMerge(KisBaseRectsWalker &walker, bool notifyClones = true);
 
 private:
+    enum BelowCacheInvalidation {
+        NoInvalidation,
+        ResetCache,
+        NotifyCache
+    };
+
     inline void resetProjection();
     inline void setupProjection(KisProjectionLeafSP currentLeaf, const QRect& rect, bool useTempProjection);
     inline void writeProjection(KisProjectionLeafSP topmostLeaf, bool useTempProjection, const QRect &rect);
     inline bool compositeWithProjection(KisProjectionLeafSP leaf, const QRect &rect);
     inline void doNotifyClones(KisBaseRectsWalker &walker);
 
+    inline bool canDeferBelowItem(const KisBaseRectsWalker::JobItem &item, KisGroupLayer *group) const;
+    inline void compositeBelowItemsFromCache(KisProjectionLeafSP filthyLeaf, KisGroupLayer *group);
+    inline void invalidateBelowCache(KisProjectionLeafSP leaf, KisGroupLayer *group, BelowCacheInvalidation invalidation);
+    inline void flushBelowItems();
+
 private:
     /**
      * The place where intermediate results of layer's merge
@@ -62,6 +75,20 @@ private:
      * setupProjection()
      */
     KisPaintDeviceSP m_cachedPaintDevice;
+
+    /**
+     * The N_BELOW_FILTHY items of the current group, which composition
+     * is going to be fetched from the group's below-cache, when the
+     * merger reaches the filthy child of the group.
+     */
+    QVector<KisBaseRectsWalker::JobItem> m_belowItems;
+
+    /**
+     * Set when some N_BELOW_FILTHY items of the current group have
+     * already been composited directly, so the cache is not used
+     * until the group is finished.
+     */
+    bool m_belowCacheDisabled = false;
 };
 
 
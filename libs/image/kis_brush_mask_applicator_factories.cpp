@@ -24,6 +24,8 @@
 #include "kis_gauss_circle_mask_generator_p.h"
 #include "kis_curve_circle_mask_generator_p.h"
 #include "kis_gauss_rect_mask_generator_p.h"
+#include "kis_rect_mask_generator_p.h"
+#include "kis_curve_rect_mask_generator_p.h"
 
 #include "kis_brush_mask_applicators.h"
 #include "kis_brush_mask_applicator_base.h"
@@ -71,6 +73,22 @@ MaskApplicatorFactory<KisGaussRectangleMaskGenerator, KisBrushMaskVectorApplicat
     return new KisBrushMaskVectorApplicator<KisGaussRectangleMaskGenerator,Vc::CurrentImplementation::current()>(maskGenerator);
 }
 
+template<>
+template<>
+MaskApplicatorFactory<KisRectangleMaskGenerator, KisBrushMaskVectorApplicator>::ReturnType
+MaskApplicatorFactory<KisRectangleMaskGenerator, KisBrushMaskVectorApplicator>::create<Vc::CurrentImplementation::current()>(ParamType maskGenerator)
+{
+    return new KisBrushMaskVectorApplicator<KisRectangleMaskGenerator,Vc::CurrentImplementation::current()>(maskGenerator);
+}
+
+template<>
+template<>
+MaskApplicatorFactory<KisCurveRectangleMaskGenerator, KisBrushMaskVectorApplicator>::ReturnType
+MaskApplicatorFactory<KisCurveRectangleMaskGenerator, KisBrushMaskVectorApplicator>::create<Vc::CurrentImplementation::current()>(ParamType maskGenerator)
+{
+    return new KisBrushMaskVectorApplicator<KisCurveRectangleMaskGenerator,Vc::CurrentImplementation::current()>(maskGenerator);
+}
+
 
 #if defined HAVE_VC
 
@@ -432,4 +450,202 @@ FastRowProcessor::process<Vc::CurrentImplementation::current()>(float* buffer, i
     }
 }
 
+struct KisRectangleMaskGenerator::FastRowProcessor
+{
+    FastRowProcessor(KisRectangleMaskGenerator *maskGenerator)
+        : d(maskGenerator->d.data()) {}
+
+    template<Vc::Implementation _impl>
+    void process(float* buffer, int width, float y, float cosa, float sina,
+                 float centerX, float centerY);
+
+    KisRectangleMaskGenerator::Private *d;
+};
+
+template<> void KisRectangleMaskGenerator::
+FastRowProcessor::process<Vc::CurrentImplementation::current()>(float* buffer, int width, float y, float cosa, float sina,
+                                   float centerX, float centerY)
+{
+    const bool useSmoothing = d->copyOfAntialiasEdges;
+
+    float y_ = y - centerY;
+    float sinay_ = sina * y_;
+    float cosay_ = cosa * y_;
+
+    float* bufferPointer = buffer;
+
+    Vc::float_v currentIndices = Vc::float_v::IndexesFromZero();
+
+    Vc::float_v increment((float)Vc::float_v::size());
+    Vc::float_v vCenterX(centerX);
+
+    Vc::float_v vCosa(cosa);
+    Vc::float_v vSina(sina);
+    Vc::float_v vCosaY_(cosay_);
+    Vc::float_v vSinaY_(sinay_);
+
+    Vc::float_v vXCoeff(d->xcoeff);
+    Vc::float_v vYCoeff(d->ycoeff);
+
+    Vc::float_v vTransformedFadeX(d->transformedFadeX);
+    Vc::float_v vTransformedFadeY(d->transformedFadeY);
+
+    Vc::float_v vOne(Vc::One);
+
+    for (int i=0; i < width; i+= Vc::float_v::size()){
+
+        Vc::float_v x_ = currentIndices - vCenterX;
+
+        Vc::float_v xr = Vc::abs(x_ * vCosa - vSinaY_);
+        Vc::float_v yr = Vc::abs(x_ * vSina + vCosaY_);
+
+        Vc::float_v nxr = xr * vXCoeff;
+        Vc::float_v nyr = yr * vYCoeff;
+
+        Vc::float_m outsideMask = (nxr > vOne) | (nyr > vOne);
+
+        if (!outsideMask.isFull()) {
+            if (useSmoothing) {
+                xr += vOne;
+                yr += vOne;
+            }
+
+            Vc::float_v fxr = xr * vTransformedFadeX;
+            Vc::float_v fyr = yr * vTransformedFadeY;
+
+            Vc::float_v vFade(Vc::Zero);
+
+            // 255 * nxr * (fxr - 1) / (fxr - nxr)
+            Vc::float_m fadeXMask = (fxr > vOne) & ((fxr > fyr) | (fyr < vOne));
+            vFade(fadeXMask) = nxr * (fxr - vOne) / (fxr - nxr);
+
+            // 255 * nyr * (fyr - 1) / (fyr - nyr)
+            Vc::float_m fadeYMask = !fadeXMask & (fyr > vOne) & ((fyr > fxr) | (fxr < vOne));
+            vFade(fadeYMask) = nyr * (fyr - vOne) / (fyr - nyr);
+
+            // Mask out everything outside the rectangle
+            vFade(outsideMask) = vOne;
+
+            vFade.store(bufferPointer, Vc::Aligned);
+        } else {
+            // Mask out everything outside the rectangle
+            vOne.store(bufferPointer, Vc::Aligned);
+        }
+
+        currentIndices = currentIndices + increment;
+
+        bufferPointer += Vc::float_v::size();
+    }
+}
+
+struct KisCurveRectangleMaskGenerator::FastRowProcessor
+{
+    FastRowProcessor(KisCurveRectangleMaskGenerator *maskGenerator)
+        : d(maskGenerator->d.data()) {}
+
+    template<Vc::Implementation _impl>
+    void process(float* buffer, int width, float y, float cosa, float sina,
+                 float centerX, float centerY);
+
+    KisCurveRectangleMaskGenerator::Private *d;
+};
+
+template<> void KisCurveRectangleMaskGenerator::
+FastRowProcessor::process<Vc::CurrentImplementation::current()>(float* buffer, int width, float y, float cosa, float sina,
+                                   float centerX, float centerY)
+{
+    float y_ = y - centerY;
+    float sinay_ = sina * y_;
+    float cosay_ = cosa * y_;
+
+    float* bufferPointer = buffer;
+
+    qreal* curveDataPointer = d->curveData.data();
+
+    Vc::float_v currentIndices = Vc::float_v::IndexesFromZero();
+
+    Vc::float_v increment((float)Vc::float_v::size());
+    Vc::float_v vCenterX(centerX);
+
+    Vc::float_v vCosa(cosa);
+    Vc::float_v vSina(sina);
+    Vc::float_v vCosaY_(cosay_);
+    Vc::float_v vSinaY_(sinay_);
+
+    Vc::float_v vYCoeff(d->ycoeff);
+    Vc::float_v vXCoeff(d->xcoeff);
+    Vc::float_v vCurveResolution(d->curveResolution);
+
+    Vc::float_v vOne(Vc::One);
+    Vc::float_v vZero(Vc::Zero);
+    Vc::float_v vValMax(255.f);
+
+    for (int i=0; i < width; i+= Vc::float_v::size()){
+
+        Vc::float_v x_ = currentIndices - vCenterX;
+
+        Vc::float_v xr = Vc::abs(x_ * vCosa - vSinaY_);
+        Vc::float_v yr = Vc::abs(x_ * vSina + vCosaY_);
+
+        Vc::float_v vValue;
+
+        // check if we need to apply fader on values
+        Vc::float_m excludeMask = d->fadeMaker.needFade(xr,yr);
+        vValue(excludeMask) = vOne;
+
+        if (!excludeMask.isFull()) {
+            // the excluded pixels may point outside the curve data
+            Vc::float_v vSValue = Vc::min(Vc::round(xr * vXCoeff * vCurveResolution), vCurveResolution);
+            Vc::float_v vTValue = Vc::min(Vc::round(yr * vYCoeff * vCurveResolution), vCurveResolution);
+            vSValue.setZero(excludeMask);
+            vTValue.setZero(excludeMask);
+
+            Vc::SimdArray<quint16,Vc::float_v::size()> vSIndex(vSValue);
+            Vc::SimdArray<quint16,Vc::float_v::size()> vTIndex(vTValue);
+            Vc::SimdArray<quint16,Vc::float_v::size()> vSIndexInverted(vCurveResolution - vSValue);
+            Vc::SimdArray<quint16,Vc::float_v::size()> vTIndexInverted(vCurveResolution - vTValue);
+
+            Vc::float_v vCurvedS(Vc::Zero);
+            Vc::float_v vCurvedSInverted(Vc::Zero);
+            Vc::float_v vCurvedT(Vc::Zero);
+            Vc::float_v vCurvedTInverted(Vc::Zero);
+
+            vCurvedS.gather(curveDataPointer, vSIndex);
+            vCurvedSInverted.gather(curveDataPointer, vSIndexInverted);
+            vCurvedT.gather(curveDataPointer, vTIndex);
+            vCurvedTInverted.gather(curveDataPointer, vTIndexInverted);
+
+            Vc::float_v vBlend = vCurvedS * (vOne - vCurvedSInverted) *
+                                 vCurvedT * (vOne - vCurvedTInverted);
+
+            Vc::float_v fullFade = vValMax * (vOne - vBlend);
+
+            // apply antialias fader
+            d->fadeMaker.apply2DFader(fullFade,excludeMask,xr,yr);
+
+            Vc::float_m mask;
+
+            // Mask in the inner part of the mask
+            mask = fullFade < vZero;
+            fullFade.setZero(mask);
+
+            // Mask the outer part of the mask
+            mask = fullFade > vValMax;
+            fullFade(mask) = vValMax;
+
+            Vc::float_v vFade = fullFade / vValMax;
+
+            // return original vValue values before vFade transform
+            vFade(excludeMask) = vValue;
+            vFade.store(bufferPointer, Vc::Aligned);
+
+        } else {
+          vValue.store(bufferPointer, Vc::Aligned);
+      }
+      currentIndices = currentIndices + increment;
+
+      bufferPointer += Vc::float_v::size();
+    }
+}
+
 #endif /* defined HAVE_VC */
@@ -28,22 +28,109 @@
 #include "kis_math_toolbox.h"
 
 #include <QMutex>
+#include <QHash>
 #include <QVector>
+#include <QtConcurrentMap>
 #include <QTextStream>
 #include <QFile>
 #include <QDir>
 
 #include <fftw3.h>
 
-template<class _IteratorFactory_> class KisConvolutionWorkerFFT;
-class KisConvolutionWorkerFFTLock
+/**
+ * FFTW planner is not thread-safe, but execution of the existing plans
+ * via the new-array interface is. So the plans are created once per
+ * transform size and then shared between all the workers. The mutex is
+ * taken only to look up the plan, the transforms themselves run
+ * without any locking.
+ */
+class KisFFTWPlanCache
 {
+public:
+    struct Plans {
+        Plans() : forward(0), backward(0), cached(false) {}
+
+        fftw_plan forward;
+        fftw_plan backward;
+        bool cached;
+    };
+
+    /**
+     * Returns in-place plans for \p howMany real-to-complex (and back)
+     * transforms of size \p width x \p height. The transforms are
+     * expected to be laid out in a single buffer one after another,
+     * each one padded as required by FFTW for in-place transforms.
+     *
+     * The plans must be returned back with release().
+     */
+    static Plans acquire(int width, int height, int howMany) {
+        const quint64 key =
+            (quint64(width) << 40) | (quint64(height) << 16) | quint64(howMany);
+
+        QMutexLocker l(&s_mutex);
+
+        auto it = s_plans.constFind(key);
+        if (it != s_plans.constEnd()) {
+            return *it;
+        }
+
+        Plans plans = createPlans(width, height, howMany);
+
+        /**
+         * Cached plans are never destroyed, so don't let the cache grow
+         * infinitely when the sizes are random
+         */
+        if (s_plans.size() < MaxCachedPlans) {
+            plans.cached = true;
+            s_plans.insert(key, plans);
+        }
+
+        return plans;
+    }
+
+    static void release(const Plans &plans) {
+        if (plans.cached) return;
+
+        QMutexLocker l(&s_mutex);
+        fftw_destroy_plan(plans.forward);
+        fftw_destroy_plan(plans.backward);
+    }
+
 private:
-    static QMutex fftwMutex;
-    template<class _IteratorFactory_> friend class KisConvolutionWorkerFFT;
+    static Plans createPlans(int width, int height, int howMany) {
+        const int complexWidth = width / 2 + 1;
+        const int complexLength = height * complexWidth;
+
+        const int realSize[] = {height, width};
+        const int realEmbed[] = {height, 2 * complexWidth};
+        const int complexEmbed[] = {height, complexWidth};
+
+        // FFTW_ESTIMATE doesn't touch the data, but needs a properly aligned buffer
+        fftw_complex *buffer = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * complexLength * howMany);
+
+        Plans plans;
+        plans.forward = fftw_plan_many_dft_r2c(2, realSize, howMany,
+                                               (double*)buffer, realEmbed, 1, 2 * complexLength,
+                                               buffer, complexEmbed, 1, complexLength,
+                                               FFTW_ESTIMATE);
+        plans.backward = fftw_plan_many_dft_c2r(2, realSize, howMany,
+                                                buffer, complexEmbed, 1, complexLength,
+                                                (double*)buffer, realEmbed, 1, 2 * complexLength,
+                                                FFTW_ESTIMATE);
+        fftw_free(buffer);
+
+        return plans;
+    }
+
+private:
+    static const int MaxCachedPlans = 64;
+
+    static QMutex s_mutex;
+    static QHash<quint64, Plans> s_plans;
 };
 
-QMutex KisConvolutionWorkerFFTLock::fftwMutex;
+QMutex KisFFTWPlanCache::s_mutex;
+QHash<quint64, KisFFTWPlanCache::Plans> KisFFTWPlanCache::s_plans;
 
 
 template<class _IteratorFactory_>
@@ -79,11 +166,21 @@ public:
         addToProgress(0);
         if (isInterrupted()) return;
 
-        const quint32 halfKernelWidth = (kernel->width() - 1) / 2;
-        const quint32 halfKernelHeight = (kernel->height() - 1) / 2;
+        const int halfKernelWidth = (kernel->width() - 1) / 2;
+        const int halfKernelHeight = (kernel->height() - 1) / 2;
 
-        m_fftWidth = areaSize.width() + 4 * halfKernelWidth;
-        m_fftHeight = areaSize.height() + 2 * halfKernelHeight;
+        /**
+         * Big areas are split into blocks of equal size, which are
+         * convolved independently (overlap-save) in parallel. All the
+         * blocks share the same kernel transform and FFTW plans.
+         */
+        const int numBlocksX = numBlocks(areaSize.width(), kernel->width());
+        const int numBlocksY = numBlocks(areaSize.height(), kernel->height());
+        const int blockWidth = (areaSize.width() + numBlocksX - 1) / numBlocksX;
+        const int blockHeight = (areaSize.height() + numBlocksY - 1) / numBlocksY;
+
+        m_fftWidth = blockWidth + 4 * halfKernelWidth;
+        m_fftHeight = blockHeight + 2 * halfKernelHeight;
 
         /**
          * FIXME: check whether this "optimization" is needed to
@@ -100,73 +197,92 @@ public:
         memset(m_kernelFFT, 0, sizeof(fftw_complex) * m_fftLength);
         fftFillKernelMatrix(kernel, m_kernelFFT);
 
+        KisFFTWPlanCache::Plans kernelPlans = KisFFTWPlanCache::acquire(m_fftWidth, m_fftHeight, 1);
+        fftw_execute_dft_r2c(kernelPlans.forward, (double*)m_kernelFFT, m_kernelFFT);
+        KisFFTWPlanCache::release(kernelPlans);
+
         // find out which channels need convolving
         QList<KoChannelInfo*> convChannelList = this->convolvableChannelList(src);
 
-        m_channelFFT.resize(convChannelList.count());
-        for (auto i = m_channelFFT.begin(); i != m_channelFFT.end(); ++i) {
-            *i = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * m_fftLength);
-        }
-
         const double kernelFactor = kernel->factor() ? kernel->factor() : 1;
         const double fftScale = 1.0 / (m_fftHeight * m_fftWidth) / kernelFactor;
 
         FFTInfo info (fftScale, convChannelList, kernel, this->m_painter->device()->colorSpace());
-        int cacheRowStride = m_fftWidth + m_extraMem;
+        const int cacheRowStride = m_fftWidth + m_extraMem;
 
-        fillCacheFromDevice(src,
-                            QRect(srcPos.x() - halfKernelWidth,
-                                  srcPos.y() - halfKernelHeight,
-                                  m_fftWidth,
-                                  m_fftHeight),
-                            cacheRowStride,
-                            info, dataRect);
+        m_plans = KisFFTWPlanCache::acquire(m_fftWidth, m_fftHeight, info.numChannels());
+
+        for (int by = 0; by < numBlocksY; by++) {
+            for (int bx = 0; bx < numBlocksX; bx++) {
+                const QPoint offset(bx * blockWidth, by * blockHeight);
+
+                FFTBlock block;
+                block.srcPos = srcPos + offset;
+                block.dstRect = QRect(dstPos + offset,
+                                      QSize(qMin(blockWidth, areaSize.width() - offset.x()),
+                                            qMin(blockHeight, areaSize.height() - offset.y())));
+                m_blocks.append(block);
+            }
+        }
 
         addToProgress(10);
         if (isInterrupted()) return;
 
-        // calculate number off fft operations required for progress reporting
-        const float progressPerFFT = (100 - 30) / (double)(convChannelList.count() * 2 + 1);
-
-        // perform FFT
-        fftw_plan fftwPlanForward, fftwPlanBackward;
+        /**
+         * The source and destination devices may be the same, so all
+         * the blocks should be read before anything is written
+         */
+        QtConcurrent::blockingMap(m_blocks,
+            [&] (FFTBlock &block) {
+                if (isInterrupted(false)) return;
 
-        KisConvolutionWorkerFFTLock::fftwMutex.lock();
-        fftwPlanForward = fftw_plan_dft_r2c_2d(m_fftHeight, m_fftWidth, (double*)m_kernelFFT, m_kernelFFT, FFTW_ESTIMATE);
-        fftwPlanBackward = fftw_plan_dft_c2r_2d(m_fftHeight, m_fftWidth, m_kernelFFT, (double*)m_kernelFFT, FFTW_ESTIMATE);
-        KisConvolutionWorkerFFTLock::fftwMutex.unlock();
+                block.data = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * m_fftLength * info.numChannels());
 
-        fftw_execute(fftwPlanForward);
-        addToProgress(progressPerFFT);
-        if (isInterrupted()) return;
+                QVector<fftw_complex*> channels = blockChannels(block, info);
 
-        for (auto k = m_channelFFT.begin(); k != m_channelFFT.end(); ++k)
-        {
-            fftw_execute_dft_r2c(fftwPlanForward, (double*)(*k), *k);
-            addToProgress(progressPerFFT);
-            if (isInterrupted()) return;
+                fillCacheFromDevice(src,
+                                    QRect(block.srcPos.x() - halfKernelWidth,
+                                          block.srcPos.y() - halfKernelHeight,
+                                          m_fftWidth,
+                                          m_fftHeight),
+                                    cacheRowStride,
+                                    channels,
+                                    info, dataRect);
 
-            fftMultiply(*k, m_kernelFFT);
+                fftw_execute_dft_r2c(m_plans.forward, (double*)block.data, block.data);
 
-            fftw_execute_dft_c2r(fftwPlanBackward, *k, (double*)*k);
-            addToProgress(progressPerFFT);
-            if (isInterrupted()) return;
-        }
+                Q_FOREACH (fftw_complex *channel, channels) {
+                    fftMultiply(channel, m_kernelFFT);
+                }
 
-        KisConvolutionWorkerFFTLock::fftwMutex.lock();
-        fftw_destroy_plan(fftwPlanForward);
-        fftw_destroy_plan(fftwPlanBackward);
-        KisConvolutionWorkerFFTLock::fftwMutex.unlock();
+                fftw_execute_dft_c2r(m_plans.backward, block.data, (double*)block.data);
+            });
 
+        addToProgress(70);
+        if (isInterrupted()) return;
 
-        writeResultToDevice(QRect(dstPos.x(), dstPos.y(), areaSize.width(), areaSize.height()),
-                            cacheRowStride, halfKernelWidth, halfKernelHeight,
-                            info, dataRect);
+        QtConcurrent::blockingMap(m_blocks,
+            [&] (FFTBlock &block) {
+                writeResultToDevice(block.dstRect,
+                                    cacheRowStride, halfKernelWidth, halfKernelHeight,
+                                    blockChannels(block, info),
+                                    info, dataRect);
+            });
 
         addToProgress(20);
         cleanUp();
     }
 
+    struct FFTBlock {
+        FFTBlock() : data(0) {}
+
+        QPoint srcPos;
+        QRect dstRect;
+
+        // transforms of all the channels, one after another
+        fftw_complex *data;
+    };
+
     struct FFTInfo {
         FFTInfo(qreal _fftScale,
                 const QList<KoChannelInfo*> &_convChannelList,
@@ -221,6 +337,7 @@ public:
     void fillCacheFromDevice(KisPaintDeviceSP src,
                              const QRect &rect,
                              const int cacheRowStride,
+                             const QVector<fftw_complex*> &channels,
                              const FFTInfo &info,
                              const QRect &dataRect) {
 
@@ -234,7 +351,7 @@ public:
         const auto channelPtrBegin = channelPtr.begin();
         const auto channelPtrEnd = channelPtr.end();
 
-        auto iFFt = m_channelFFT.constBegin();
+        auto iFFt = channels.constBegin();
         for (auto i = channelPtrBegin; i != channelPtrEnd; ++i, ++iFFt) {
             *i = (double*)*iFFt;
         }
@@ -312,6 +429,7 @@ public:
                              const int cacheRowStride,
                              const int halfKernelWidth,
                              const int halfKernelHeight,
+                             const QVector<fftw_complex*> &channels,
                              const FFTInfo &info,
                              const QRect &dataRect) {
 
@@ -327,7 +445,7 @@ public:
         const auto channelPtrBegin = channelPtr.begin();
         const auto channelPtrEnd = channelPtr.end();
 
-        auto iFFt = m_channelFFT.constBegin();
+        auto iFFt = channels.constBegin();
         for (auto i = channelPtrBegin; i != channelPtrEnd; ++i, ++iFFt) {
             *i = (double*)*iFFt + initialOffset;
         }
@@ -400,6 +518,26 @@ public:
     }
 
 private:
+    /**
+     * Number of blocks the dimension of \p size pixels should be split
+     * into. The blocks should still be big enough for the padding
+     * around them to be small compared to the block itself.
+     */
+    static int numBlocks(int size, int kernelSize)
+    {
+        const int preferredBlockSize = qMax(512, 4 * kernelSize);
+        return qMax(1, size / preferredBlockSize);
+    }
+
+    QVector<fftw_complex*> blockChannels(const FFTBlock &block, const FFTInfo &info) const
+    {
+        QVector<fftw_complex*> channels(info.numChannels());
+        for (int i = 0; i < channels.size(); i++) {
+            channels[i] = block.data + i * m_fftLength;
+        }
+        return channels;
+    }
+
     void fftFillKernelMatrix(const KisConvolutionKernelSP kernel, fftw_complex *m_kernelFFT)
     {
         // find central item
@@ -472,14 +610,12 @@ private:
 
     void fftLogMatrix(double* channel, const QString &f)
     {
-        KisConvolutionWorkerFFTLock::fftwMutex.lock();
         QString filename(QDir::homePath() + "/log_" + f + ".txt");
         dbgKrita << "Log File Name: " << filename;
         QFile file (filename);
         if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
         {
             dbgKrita << "Failed";
-            KisConvolutionWorkerFFTLock::fftwMutex.unlock();
             return;
         }
 
@@ -496,7 +632,6 @@ private:
             }
             in << "\n";
         }
-        KisConvolutionWorkerFFTLock::fftwMutex.unlock();
     }
 
     void addToProgress(float amount)
@@ -508,10 +643,16 @@ private:
         }
     }
 
-    bool isInterrupted()
+    /**
+     * Can be called from the block processing threads with
+     * \p cleanUpOnInterrupt set to false
+     */
+    bool isInterrupted(bool cleanUpOnInterrupt = true)
     {
         if (this->m_progress && this->m_progress->interrupted()) {
-            cleanUp();
+            if (cleanUpOnInterrupt) {
+                cleanUp();
+            }
             return true;
         }
 
@@ -523,19 +664,28 @@ private:
         // free kernel fft data
         if (m_kernelFFT) {
             fftw_free(m_kernelFFT);
+            m_kernelFFT = 0;
+        }
+
+        Q_FOREACH (const FFTBlock &block, m_blocks) {
+            if (block.data) {
+                fftw_free(block.data);
+            }
         }
+        m_blocks.clear();
 
-        Q_FOREACH (fftw_complex *channel, m_channelFFT) {
-            fftw_free(channel);
+        if (m_plans.forward) {
+            KisFFTWPlanCache::release(m_plans);
+            m_plans = KisFFTWPlanCache::Plans();
         }
-        m_channelFFT.clear();
     }
 private:
     quint32 m_fftWidth, m_fftHeight, m_fftLength, m_extraMem;
     float m_currentProgress;
 
     fftw_complex* m_kernelFFT;
-    QVector<fftw_complex*> m_channelFFT;
+    QVector<FFTBlock> m_blocks;
+    KisFFTWPlanCache::Plans m_plans;
 };
 
 #endif
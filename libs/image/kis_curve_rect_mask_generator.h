@@ -19,6 +19,7 @@
 #ifndef _KIS_CURVE_RECT_MASK_GENERATOR_H_
 #define _KIS_CURVE_RECT_MASK_GENERATOR_H_
 
+#include <QScopedPointer>
 #include "kritaimage_export.h"
 
 class KisCubicCurve;
@@ -32,7 +33,8 @@ class QDomDocument;
  */
 class KRITAIMAGE_EXPORT KisCurveRectangleMaskGenerator : public KisMaskGenerator
 {
-
+public:
+    struct FastRowProcessor;
 public:
 
     KisCurveRectangleMaskGenerator(qreal radius, qreal ratio, qreal fh, qreal fv, int spikes, const KisCubicCurve& curve, bool antialiasEdges);
@@ -48,9 +50,13 @@ public:
     
     void setSoftness(qreal softness) override;
 
+    bool shouldVectorize() const override;
+    KisBrushMaskApplicatorBase* applicator() override;
+    void resetMaskApplicator(bool forceScalar);
+
 private:
     struct Private;
-    Private* const d;
+    const QScopedPointer<Private> d;
 };
 
 #endif
@@ -22,6 +22,8 @@
 #include "kis_convolution_kernel.h"
 #include <kis_convolution_painter.h>
 #include <kis_transaction.h>
+#include "kis_recursive_gaussian_blur.h"
+#include "kis_paint_device.h"
 #include <QRect>
 
 
@@ -35,6 +37,15 @@ int KisGaussianKernel::kernelSizeFromRadius(qreal radius)
     return 6 * ceil(sigmaFromRadius(radius)) + 1;
 }
 
+qreal KisGaussianKernel::recursiveBlurThreshold()
+{
+    /**
+     * Below this radius the convolution is still fast enough and
+     * its result is a bit more precise
+     */
+    return 32.0;
+}
+
 
 Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic>
 KisGaussianKernel::createHorizontalMatrix(qreal radius)
@@ -105,8 +116,27 @@ void KisGaussianKernel::applyGaussian(KisPaintDeviceSP device,
                                       qreal xRadius, qreal yRadius,
                                       const QBitArray &channelFlags,
                                       KoUpdater *progressUpdater,
-                                      bool createTransaction)
+                                      bool createTransaction,
+                                      BlurMethod method)
 {
+    if (method == AutoBlur) {
+        method = qMax(xRadius, yRadius) >= recursiveBlurThreshold() ?
+            RecursiveBlur : ConvolutionBlur;
+    }
+
+    if (method == RecursiveBlur &&
+        KisRecursiveGaussianBlur::supportsColorSpace(device->colorSpace())) {
+
+        /**
+         * The recursive filter reads all the data it needs before
+         * writing, so it never needs a transaction
+         */
+        KisRecursiveGaussianBlur::apply(device, rect,
+                                        xRadius, yRadius,
+                                        channelFlags, progressUpdater);
+        return;
+    }
+
     QPoint srcTopLeft = rect.topLeft();
 
     if (xRadius > 0.0 && yRadius > 0.0) {
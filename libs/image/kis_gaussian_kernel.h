@@ -29,6 +29,19 @@ class QRect;
 class KRITAIMAGE_EXPORT KisGaussianKernel
 {
 public:
+    /**
+     * The algorithm used by applyGaussian(). The convolution with the
+     * Gaussian kernel costs O(radius) per pixel, the recursive filter
+     * (see KisRecursiveGaussianBlur) has a constant cost, but is a bit
+     * less precise for small radii. AutoBlur selects the recursive
+     * filter for the radii bigger than recursiveBlurThreshold().
+     */
+    enum BlurMethod {
+        AutoBlur = 0,
+        ConvolutionBlur,
+        RecursiveBlur
+    };
+
     static Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic>
         createHorizontalMatrix(qreal radius);
 
@@ -43,13 +56,15 @@ public:
 
     static qreal sigmaFromRadius(qreal radius);
     static int kernelSizeFromRadius(qreal radius);
+    static qreal recursiveBlurThreshold();
 
     static void applyGaussian(KisPaintDeviceSP device,
                               const QRect& rect,
                               qreal xRadius, qreal yRadius,
                               const QBitArray &channelFlags,
                               KoUpdater *updater,
-                              bool createTransaction = false);
+                              bool createTransaction = false,
+                              BlurMethod method = AutoBlur);
 
     static Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> createLoGMatrix(qreal radius, qreal coeff = 1.0);
 
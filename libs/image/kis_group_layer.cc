@@ -37,6 +37,7 @@
 #include "kis_selection_mask.h"
 #include "kis_psd_layer_style.h"
 #include "kis_layer_properties_icons.h"
+#include "KisGroupBelowCache.h"
 
 
 struct Q_DECL_HIDDEN KisGroupLayer::Private
@@ -54,6 +55,7 @@ public:
     qint32 x;
     qint32 y;
     bool passThroughMode;
+    KisGroupBelowCache belowCache;
 };
 
 KisGroupLayer::KisGroupLayer(KisImageWSP image, const QString &name, quint8 opacity) :
@@ -201,6 +203,13 @@ void KisGroupLayer::resetCache(const KoColorSpace *colorSpace)
 
         m_d->paintDevice->clear();
     }
+
+    m_d->belowCache.reset();
+}
+
+KisGroupBelowCache* KisGroupLayer::belowCache() const
+{
+    return &m_d->belowCache;
 }
 
 KisLayer* KisGroupLayer::onlyMeaningfulChild() const
@@ -296,6 +305,7 @@ void KisGroupLayer::setPassThroughMode(bool value)
     if (m_d->passThroughMode == value) return;
 
     m_d->passThroughMode = value;
+    m_d->belowCache.reset();
 
     baseNodeChangedCallback();
     baseNodeInvalidateAllFramesCallback();
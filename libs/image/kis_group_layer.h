@@ -23,6 +23,7 @@
 #include "kis_types.h"
 
 class KoColorSpace;
+class KisGroupBelowCache;
 
 /**
  * A KisLayer that bundles child layers into a single layer.
@@ -107,6 +108,12 @@ public:
 
     bool projectionIsValid() const;
 
+    /**
+     * The cache of the composition of the children lying below the
+     * currently updated one. Used by KisAsyncMerger.
+     */
+    KisGroupBelowCache* belowCache() const;
+
 protected:
     KisLayer* onlyMeaningfulChild() const;
     KisPaintDeviceSP tryObligeChild() const;
@@ -228,6 +228,8 @@ public:
     KisCompositeProgressProxy compositeProgressProxy;
 
     bool blockLevelOfDetail = false;
+    int desiredLevelOfDetail = 0;
+    int warmUpLevelOfDetail = 0;
 
     QPointF axesCenter;
 
@@ -1699,9 +1701,20 @@ void KisImage::setDesiredLevelOfDetail(int lod)
         return;
     }
 
+    m_d->desiredLevelOfDetail = lod;
     m_d->scheduler.setDesiredLevelOfDetail(lod);
 }
 
+void KisImage::setWarmUpLevelOfDetail(int lod)
+{
+    m_d->warmUpLevelOfDetail = lod;
+}
+
+int KisImage::warmUpLevelOfDetail() const
+{
+    return m_d->warmUpLevelOfDetail;
+}
+
 int KisImage::currentLevelOfDetail() const
 {
     if (m_d->blockLevelOfDetail) {
@@ -1716,6 +1729,7 @@ void KisImage::setLevelOfDetailBlocked(bool value)
     KisImageBarrierLockerRaw l(this);
 
     if (value && !m_d->blockLevelOfDetail) {
+        m_d->desiredLevelOfDetail = 0;
         m_d->scheduler.setDesiredLevelOfDetail(0);
     }
 
@@ -1727,6 +1741,23 @@ void KisImage::explicitRegenerateLevelOfDetail()
     if (!m_d->blockLevelOfDetail) {
         m_d->scheduler.explicitRegenerateLevelOfDetail();
     }
+
+    /**
+     * When LoD mode is not active, we still keep the LoD caches of the
+     * devices warm, so that switching into it later would need to
+     * regenerate only the areas changed after this moment.
+     */
+    if ((m_d->blockLevelOfDetail || !m_d->desiredLevelOfDetail) &&
+        m_d->warmUpLevelOfDetail > 0) {
+
+        const int lod = m_d->warmUpLevelOfDetail;
+
+        KisStrokeId id = startStroke(new KisSyncLodCacheStrokeStrategy(KisImageWSP(this), true, lod));
+        Q_FOREACH (KisStrokeJobData *data, KisSyncLodCacheStrokeStrategy::createJobsData(KisImageWSP(this), true)) {
+            addJob(id, data);
+        }
+        endStroke(id);
+    }
 }
 
 bool KisImage::levelOfDetailBlocked() const
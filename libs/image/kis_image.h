@@ -639,6 +639,19 @@ public:
      */
     void setDesiredLevelOfDetail(int lod);
 
+    /**
+     * Notify KisImage which level of detail it is likely to be switched
+     * to, e.g. the one matching the current zoom of the canvas. While the
+     * image is idle and not in LoD mode, the LoD caches of its devices
+     * are kept up-to-date for this level in background, so that the
+     * switch doesn't need to regenerate the whole image. Zero disables
+     * warming up.
+     *
+     * \see explicitRegenerateLevelOfDetail()
+     */
+    void setWarmUpLevelOfDetail(int lod);
+    int warmUpLevelOfDetail() const;
+
     /**
      * Relative position of the mirror axis center
      *     0,0 - topleft corner of the image
@@ -657,7 +670,9 @@ public Q_SLOTS:
     /**
      * Explicitly start regeneration of LoD planes of all the devices
      * in the image. This call should be performed when the user is idle,
-     * just to make the quality of image updates better.
+     * just to make the quality of image updates better. If the image is
+     * not in LoD mode, the LoD caches for warmUpLevelOfDetail() are
+     * updated instead.
      */
     void explicitRegenerateLevelOfDetail();
 
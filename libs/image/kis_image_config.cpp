@@ -21,6 +21,7 @@
 #include <ksharedconfig.h>
 
 #include <KoConfig.h>
+#include <config-tile-compression.h>
 #include <KoColorProfile.h>
 #include <KoColorSpaceRegistry.h>
 #include <KoColorConversionTransformation.h>
@@ -114,6 +115,16 @@ void KisImageConfig::setUpdatePatchWidth(int value)
     m_config.writeEntry("updatePatchWidth", value);
 }
 
+int KisImageConfig::updateJobTargetTime() const
+{
+    return m_config.readEntry("updateJobTargetTime", 2000); // in usec
+}
+
+void KisImageConfig::setUpdateJobTargetTime(int value)
+{
+    m_config.writeEntry("updateJobTargetTime", value);
+}
+
 qreal KisImageConfig::maxCollectAlpha() const
 {
     return m_config.readEntry("maxCollectAlpha", 2.5);
@@ -173,6 +184,46 @@ void KisImageConfig::setSwapWindowSize(int value)
     m_config.writeEntry("swapWindowSize", value);
 }
 
+int KisImageConfig::swapReadWindows() const
+{
+    return m_config.readEntry("swapReadWindows", 4);
+}
+
+void KisImageConfig::setSwapReadWindows(int value)
+{
+    m_config.writeEntry("swapReadWindows", value);
+}
+
+QString KisImageConfig::swapTileCompression(bool requestDefault) const
+{
+#ifdef HAVE_LZ4
+    const QString defaultValue = "LZ4";
+#else
+    const QString defaultValue = "LZF";
+#endif
+
+    return !requestDefault ?
+        m_config.readEntry("swapTileCompression", defaultValue) : defaultValue;
+}
+
+void KisImageConfig::setSwapTileCompression(const QString &value)
+{
+    m_config.writeEntry("swapTileCompression", value);
+}
+
+QString KisImageConfig::tileCompression(bool requestDefault) const
+{
+    const QString defaultValue = "LZF";
+
+    return !requestDefault ?
+        m_config.readEntry("tileCompression", defaultValue) : defaultValue;
+}
+
+void KisImageConfig::setTileCompression(const QString &value)
+{
+    m_config.writeEntry("tileCompression", value);
+}
+
 int KisImageConfig::tilesHardLimit() const
 {
     qreal hp = qreal(memoryHardLimitPercent()) / 100.0;
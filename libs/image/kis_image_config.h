@@ -43,6 +43,16 @@ public:
     int updatePatchWidth() const;
     void setUpdatePatchWidth(int value);
 
+    /**
+     * The desired duration of a single merge job in microseconds. The
+     * update queue adjusts the size of the update patches of every
+     * node to make its jobs take about that time. Zero disables the
+     * adjustment and the patches always have the size defined by
+     * updatePatchWidth() and updatePatchHeight().
+     */
+    int updateJobTargetTime() const;
+    void setUpdateJobTargetTime(int value);
+
     qreal maxCollectAlpha() const;
     qreal maxMergeAlpha() const;
     qreal maxMergeCollectAlpha() const;
@@ -58,6 +68,25 @@ public:
     int swapWindowSize() const;
     void setSwapWindowSize(int value);
 
+    int swapReadWindows() const;
+    void setSwapReadWindows(int value);
+
+    /**
+     * The name of the algorithm used for compressing the tiles in
+     * the swap file (see KisCompressionFactory)
+     */
+    QString swapTileCompression(bool requestDefault = false) const;
+    void setSwapTileCompression(const QString &value);
+
+    /**
+     * The name of the algorithm used for compressing the tiles when
+     * saving .kra files. The setting is read once per save. Anything
+     * other than LZF switches the tiles to the VERSION 3 format, and
+     * older versions of Krita abort with a fatal error when loading it.
+     */
+    QString tileCompression(bool requestDefault = false) const;
+    void setTileCompression(const QString &value);
+
     int tilesHardLimit() const; // MiB
     int tilesSoftLimit() const; // MiB
     int poolLimit() const; // MiB
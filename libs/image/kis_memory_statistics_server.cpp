@@ -156,6 +156,9 @@ KisMemoryStatisticsServer::fetchMemoryStatistics(KisImageSP image) const
     stats.poolSize = tileStats.poolSize;
 
     stats.swapSize = tileStats.swapSize;
+    stats.swapWindowHits = tileStats.swapWindowHits;
+    stats.swapWindowMisses = tileStats.swapWindowMisses;
+    stats.swapMappedSize = tileStats.swapMappedSize;
 
     KisImageConfig cfg(true);
 
@@ -45,6 +45,9 @@ public:
               poolSize(0),
 
               swapSize(0),
+              swapWindowHits(0),
+              swapWindowMisses(0),
+              swapMappedSize(0),
 
               totalMemoryLimit(0),
               tilesHardLimit(0),
@@ -64,6 +67,9 @@ public:
         qint64 poolSize;
 
         qint64 swapSize;
+        qint64 swapWindowHits;
+        qint64 swapWindowMisses;
+        qint64 swapMappedSize;
 
         qint64 totalMemoryLimit;
         qint64 tilesHardLimit;
@@ -26,6 +26,8 @@
 #include <QRect>
 #include <QCoreApplication>
 
+#include <limits>
+
 #include <KoProperties.h>
 
 #include "kis_global.h"
@@ -93,6 +95,8 @@ public:
             , nodeProgressProxy(0)
             , busyProgressIndicator(0)
             , projectionLeaf(new KisProjectionLeaf(node))
+            , updateCost(0)
+            , testingUpdateCost(0)
     {
     }
 
@@ -105,6 +109,17 @@ public:
 
     KisProjectionLeafSP projectionLeaf;
 
+    /**
+     * Moving average of the update cost in fixed point format,
+     * see UPDATE_COST_SCALE
+     */
+    QAtomicInt updateCost;
+
+    /**
+     * The cost set by the unittests, overrides the measured one
+     */
+    QAtomicInt testingUpdateCost;
+
     const KisNode* findSymmetricClone(const KisNode *srcRoot,
                                       const KisNode *dstRoot,
                                       const KisNode *srcTarget);
@@ -567,6 +582,46 @@ KisBusyProgressIndicator* KisNode::busyProgressIndicator() const
     return 0;
 }
 
+/**
+ * The cost is stored in 1/16th of a nanosecond per pixel, and the new
+ * samples are added with the weight of 1/8, so that a few first jobs
+ * define the cost, but a single slow job doesn't change it too much.
+ */
+static const int UPDATE_COST_SCALE = 16;
+static const int UPDATE_COST_SAMPLE_WEIGHT = 8;
+
+void KisNode::reportUpdateCost(qint64 nsecs, qint64 pixels)
+{
+    if (pixels <= 0) return;
+
+    const int sample =
+        qBound(qint64(1), UPDATE_COST_SCALE * nsecs / pixels, qint64(std::numeric_limits<int>::max()));
+
+    /**
+     * The update of the average is not atomic, but losing one
+     * sample in a race doesn't matter for the estimation
+     */
+    const int oldCost = m_d->updateCost.load();
+    const int newCost = oldCost ?
+        oldCost + (sample - oldCost) / UPDATE_COST_SAMPLE_WEIGHT :
+        sample;
+
+    m_d->updateCost.store(qMax(1, newCost));
+}
+
+qreal KisNode::updateCostPerPixel() const
+{
+    const int testingCost = m_d->testingUpdateCost.load();
+
+    return qreal(testingCost ? testingCost : m_d->updateCost.load()) / UPDATE_COST_SCALE;
+}
+
+void KisNode::testingSetUpdateCostPerPixel(qreal nsecs)
+{
+    m_d->testingUpdateCost.store(
+        nsecs > 0 ? qMax(1, qRound(UPDATE_COST_SCALE * nsecs)) : 0);
+}
+
 void KisNode::createNodeProgressProxy()
 {
     if (!m_d->nodeProgressProxy) {
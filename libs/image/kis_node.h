@@ -360,6 +360,30 @@ public:
 
     KisBusyProgressIndicator* busyProgressIndicator() const;
 
+    /**
+     * Reports the time spent on merging an update of \p pixels pixels
+     * that started from this node. The values are accumulated into a
+     * moving average, which the update queue uses to choose the size
+     * of the update patches for this node.
+     *
+     * THREAD-SAFETY: can be called from any thread
+     */
+    void reportUpdateCost(qint64 nsecs, qint64 pixels);
+
+    /**
+     * Returns the average time in nanoseconds needed to merge one
+     * pixel of an update started from this node, or zero if no
+     * updates have been reported yet.
+     */
+    qreal updateCostPerPixel() const;
+
+    /**
+     * Makes updateCostPerPixel() return \p nsecs and ignore the costs
+     * reported by the merge jobs. Zero returns the node to the measured
+     * costs. Used by the unittests only.
+     */
+    void testingSetUpdateCostPerPixel(qreal nsecs);
+
 private:
 
     /**
@@ -151,6 +151,7 @@ public:
     {
 
         m_lodData.reset();
+        m_lodCache.reset();
         m_externalFrameData.reset();
 
         if (!m_frames.isEmpty()) {
@@ -402,10 +403,15 @@ public:
     void uploadFrameData(DataSP srcData, DataSP dstData);
 
     struct LodDataStructImpl;
+    struct LodCache;
     LodDataStruct* createLodDataStruct(int lod);
+    LodDataStruct* createIncrementalLodDataStruct(int lod);
     void updateLodDataStruct(LodDataStruct *dst, const QRect &srcRect);
     void uploadLodDataStruct(LodDataStruct *dst);
+    void cacheLodDataStruct(LodDataStruct *dst);
     QRegion regionForLodSyncing() const;
+    QRegion regionForLodSyncing(LodDataStruct *dst) const;
+    bool lodCacheIsValid(Data *srcData, int lod) const;
 
     void updateLodDataManager(KisDataManager *srcDataManager,
                               KisDataManager *dstDataManager, const QPoint &srcOffset, const QPoint &dstOffset,
@@ -437,6 +443,10 @@ public:
             lodData += estimateDataSize(m_lodData.data());
         }
 
+        if (m_lodCache) {
+            lodData += estimateDataSize(m_lodCache->data.data());
+        }
+
         if (m_externalFrameData) {
             temporaryData += estimateDataSize(m_externalFrameData.data());
         }
@@ -565,6 +575,7 @@ private:
 private:
     DataSP m_data;
     mutable QScopedPointer<Data> m_lodData;
+    QScopedPointer<LodCache> m_lodCache;
     mutable QScopedPointer<Data> m_externalFrameData;
     mutable QMutex m_dataSwitchLock;
 
@@ -646,6 +657,28 @@ struct KisPaintDevice::Private::StrategyPolicy {
 struct KisPaintDevice::Private::LodDataStructImpl : public KisPaintDevice::LodDataStruct {
     LodDataStructImpl(Data *_lodData) : lodData(_lodData) {}
     QScopedPointer<Data> lodData;
+
+    /**
+     * The fields below are used by the incremental structs only, they
+     * describe the state of the source data the struct is synced with
+     */
+    QRegion dirtyRegion;
+    KisDataManagerSP sourceDataManager;
+    QPoint sourceOffset;
+    QScopedPointer<KisTiledDataManager::TileDataSnapshot> sourceSnapshot;
+};
+
+/**
+ * A LoD plane that has been generated from the source data only, without
+ * any LoDN strokes applied on top of it. Together with the snapshot of the
+ * source tiles it allows regenerating only the parts of the plane that have
+ * actually changed since the last synchronization.
+ */
+struct KisPaintDevice::Private::LodCache {
+    QScopedPointer<Data> data;
+    KisDataManagerSP sourceDataManager;
+    QPoint sourceOffset;
+    QScopedPointer<KisTiledDataManager::TileDataSnapshot> sourceSnapshot;
 };
 
 QRegion KisPaintDevice::Private::regionForLodSyncing() const
@@ -654,6 +687,35 @@ QRegion KisPaintDevice::Private::regionForLodSyncing() const
     return srcData->dataManager()->region().translated(srcData->x(), srcData->y());
 }
 
+QRegion KisPaintDevice::Private::regionForLodSyncing(LodDataStruct *_dst) const
+{
+    LodDataStructImpl *dst = dynamic_cast<LodDataStructImpl*>(_dst);
+    KIS_SAFE_ASSERT_RECOVER(dst && dst->sourceSnapshot) {
+        return regionForLodSyncing();
+    }
+
+    return dst->dirtyRegion;
+}
+
+bool KisPaintDevice::Private::lodCacheIsValid(Data *srcData, int lod) const
+{
+    if (!m_lodCache) return false;
+
+    Data *cacheData = m_lodCache->data.data();
+
+    /**
+     * We compare color spaces as pure pointers, because they must be
+     * exactly the same, since they come from the common source.
+     */
+    return m_lodCache->sourceDataManager == srcData->dataManager() &&
+        m_lodCache->sourceOffset == QPoint(srcData->x(), srcData->y()) &&
+        cacheData->levelOfDetail() == lod &&
+        cacheData->colorSpace() == srcData->colorSpace() &&
+        !memcmp(cacheData->dataManager()->defaultPixel(),
+                srcData->dataManager()->defaultPixel(),
+                srcData->dataManager()->pixelSize());
+}
+
 KisPaintDevice::LodDataStruct* KisPaintDevice::Private::createLodDataStruct(int newLod)
 {
     KIS_SAFE_ASSERT_RECOVER_NOOP(newLod > 0);
@@ -691,6 +753,65 @@ KisPaintDevice::LodDataStruct* KisPaintDevice::Private::createLodDataStruct(int
     return lodStruct;
 }
 
+KisPaintDevice::LodDataStruct* KisPaintDevice::Private::createIncrementalLodDataStruct(int lod)
+{
+    KIS_SAFE_ASSERT_RECOVER_NOOP(lod > 0);
+
+    Data *srcData = currentNonLodData();
+    LodDataStructImpl *lodStruct = 0;
+
+    /**
+     * The snapshot is taken before the dirty region is calculated and the
+     * region is the difference between the two snapshots. A write that
+     * lands after the snapshot is missing from both of them, so it is
+     * picked up by the next sync.
+     */
+    QScopedPointer<KisTiledDataManager::TileDataSnapshot> sourceSnapshot(
+        new KisTiledDataManager::TileDataSnapshot());
+    srcData->dataManager()->takeTileDataSnapshot(sourceSnapshot.data());
+
+    if (lodCacheIsValid(srcData, lod)) {
+        // the tiles are shared with the cache, no pixels are copied here
+        Data *lodData = new Data(m_lodCache->data.data(), true);
+        lodData->cache()->invalidate();
+
+        lodStruct = new LodDataStructImpl(lodData);
+        lodStruct->dirtyRegion =
+            KisTiledDataManager::regionChangedSince(*m_lodCache->sourceSnapshot, *sourceSnapshot)
+                .translated(srcData->x(), srcData->y());
+    } else {
+        lodStruct = static_cast<LodDataStructImpl*>(createLodDataStruct(lod));
+        lodStruct->dirtyRegion = regionForLodSyncing();
+    }
+
+    lodStruct->sourceDataManager = srcData->dataManager();
+    lodStruct->sourceOffset = QPoint(srcData->x(), srcData->y());
+    lodStruct->sourceSnapshot.reset(sourceSnapshot.take());
+
+    return lodStruct;
+}
+
+void KisPaintDevice::Private::cacheLodDataStruct(LodDataStruct *_dst)
+{
+    LodDataStructImpl *dst = dynamic_cast<LodDataStructImpl*>(_dst);
+    KIS_SAFE_ASSERT_RECOVER_RETURN(dst);
+
+    // non-incremental structs are not guaranteed to cover the whole device
+    if (!dst->sourceSnapshot) return;
+
+    /**
+     * The source has been switched (e.g. to another frame) while the
+     * struct was being generated, so it is outdated already
+     */
+    if (dst->sourceDataManager != currentNonLodData()->dataManager()) return;
+
+    m_lodCache.reset(new LodCache());
+    m_lodCache->data.reset(new Data(dst->lodData.data(), true));
+    m_lodCache->sourceDataManager = dst->sourceDataManager;
+    m_lodCache->sourceOffset = dst->sourceOffset;
+    m_lodCache->sourceSnapshot.swap(dst->sourceSnapshot);
+}
+
 void KisPaintDevice::Private::updateLodDataManager(KisDataManager *srcDataManager,
                                                    KisDataManager *dstDataManager,
                                                    const QPoint &srcOffset,
@@ -825,6 +946,8 @@ void KisPaintDevice::Private::uploadLodDataStruct(LodDataStruct *_dst)
 
     m_lodData->prepareClone(dst->lodData.data());
     m_lodData->dataManager()->bitBltRough(dst->lodData->dataManager(), dst->lodData->dataManager()->extent());
+
+    cacheLodDataStruct(dst);
 }
 
 void KisPaintDevice::Private::transferFromData(Data *data, KisPaintDeviceSP targetDevice)
@@ -2043,11 +2166,26 @@ QRegion KisPaintDevice::regionForLodSyncing() const
     return m_d->regionForLodSyncing();
 }
 
+QRegion KisPaintDevice::regionForLodSyncing(LodDataStruct *dst) const
+{
+    return m_d->regionForLodSyncing(dst);
+}
+
 KisPaintDevice::LodDataStruct* KisPaintDevice::createLodDataStruct(int lod)
 {
     return m_d->createLodDataStruct(lod);
 }
 
+KisPaintDevice::LodDataStruct* KisPaintDevice::createIncrementalLodDataStruct(int lod)
+{
+    return m_d->createIncrementalLodDataStruct(lod);
+}
+
+void KisPaintDevice::cacheLodDataStruct(LodDataStruct *dst)
+{
+    m_d->cacheLodDataStruct(dst);
+}
+
 void KisPaintDevice::updateLodDataStruct(LodDataStruct *dst, const QRect &srcRect)
 {
     m_d->updateLodDataStruct(dst, srcRect);
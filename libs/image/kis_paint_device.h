@@ -842,6 +842,28 @@ public:
     void updateLodDataStruct(LodDataStruct *dst, const QRect &srcRect);
     void uploadLodDataStruct(LodDataStruct *dst);
 
+    /**
+     * Creates a LoD data struct based on the LoD cache of the device.
+     * The device keeps the LoD plane generated during the last sync
+     * and tracks which tiles of the source have changed since then, so
+     * only regionForLodSyncing(dst) needs to be regenerated in the
+     * returned struct. If the cache is absent or outdated (different
+     * LoD, color space, offset or frame), the whole device is marked
+     * dirty.
+     *
+     * The cache is updated when an incremental struct is uploaded with
+     * uploadLodDataStruct() or cacheLodDataStruct().
+     */
+    LodDataStruct* createIncrementalLodDataStruct(int lod);
+    QRegion regionForLodSyncing(LodDataStruct *dst) const;
+
+    /**
+     * Saves \p dst as the LoD cache of the device without uploading it
+     * into the current LoD plane. It lets the cache be warmed up in the
+     * background while the device is not in LoD mode.
+     */
+    void cacheLodDataStruct(LodDataStruct *dst);
+
     void generateLodCloneDevice(KisPaintDeviceSP dst, const QRect &originalRect, int lod);
 
     void setProjectionDevice(bool value);
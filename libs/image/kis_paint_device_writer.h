@@ -19,12 +19,24 @@
 #define KIS_PAINT_DEVICE_WRITER_H
 
 #include <kritaimage_export.h>
+#include <QString>
 
 class KRITAIMAGE_EXPORT KisPaintDeviceWriter {
 public:
     virtual ~KisPaintDeviceWriter() {}
     virtual bool write(const QByteArray &data) = 0;
     virtual bool write(const char* data, qint64 length) = 0;
+
+    /**
+     * The name of the algorithm the tiles should be compressed with
+     * (see KisCompressionFactory). An empty string means the default
+     * LZF compression, which keeps the data readable by older versions
+     * of Krita. Any other algorithm switches the tiles stream to a
+     * format these versions cannot load at all.
+     */
+    virtual QString tileCompression() const {
+        return QString();
+    }
 };
 
 
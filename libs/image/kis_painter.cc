@@ -58,6 +58,7 @@
 #include "kis_paintop_registry.h"
 #include "kis_perspective_math.h"
 #include "tiles3/kis_random_accessor.h"
+#include "kis_datamanager.h"
 #include <kis_distance_information.h>
 #include <KoColorSpaceMaths.h>
 #include "kis_lod_transform.h"
@@ -473,6 +474,56 @@ inline bool KisPainter::Private::tryReduceSourceRect(const KisPaintDevice *srcDe
     return false;
 }
 
+inline bool KisPainter::Private::canBlendUniformTiles(const KisPaintDevice *srcDev) const
+{
+    /**
+     * The fill of the destination device must write exactly the
+     * same pixels the iterators would write, so the devices are
+     * not allowed to wrap, and the composite op should not depend
+     * on the position of the pixel.
+     */
+    return !selection &&
+        compositeOp->id() != COMPOSITE_DISSOLVE &&
+        !srcDev->defaultBounds()->wrapAroundMode() &&
+        !device->defaultBounds()->wrapAroundMode();
+}
+
+inline bool KisPainter::Private::tryBlendUniformTiles(const KisPaintDeviceSP srcDev, bool useOldSrcData,
+                                                      const QRect &srcRect, const QPoint &dstPos,
+                                                      quint8 *srcPixel, quint8 *dstPixel)
+{
+    /**
+     * The rect is supposed to lie within a single tile of both the
+     * devices. If both the tiles are filled with a single color, the
+     * result is going to be uniform as well, so we can blend only one
+     * pixel and fill the destination with it.
+     */
+
+    if (!srcDev->dataManager()->tryGetUniformPixel(srcRect.x() - srcDev->x(),
+                                                   srcRect.y() - srcDev->y(),
+                                                   srcPixel, useOldSrcData) ||
+        !device->dataManager()->tryGetUniformPixel(dstPos.x() - device->x(),
+                                                   dstPos.y() - device->y(),
+                                                   dstPixel)) {
+        return false;
+    }
+
+    KoCompositeOp::ParameterInfo localParamInfo(paramInfo);
+    localParamInfo.dstRowStart   = dstPixel;
+    localParamInfo.dstRowStride  = pixelSize;
+    localParamInfo.srcRowStart   = srcPixel;
+    localParamInfo.srcRowStride  = 0;
+    localParamInfo.maskRowStart  = 0;
+    localParamInfo.maskRowStride = 0;
+    localParamInfo.rows          = 1;
+    localParamInfo.cols          = 1;
+    colorSpace->bitBlt(srcDev->colorSpace(), localParamInfo, compositeOp, renderingIntent, conversionFlags);
+
+    device->fill(dstPos.x(), dstPos.y(), srcRect.width(), srcRect.height(), dstPixel);
+
+    return true;
+}
+
 void KisPainter::bitBltWithFixedSelection(qint32 dstX, qint32 dstY,
                                           const KisPaintDeviceSP srcDev,
                                           const KisFixedPaintDeviceSP selection,
@@ -713,6 +764,9 @@ void KisPainter::bitBltImpl(qint32 dstX, qint32 dstY,
         }
     }
     else {
+        const bool canBlendUniformTiles = d->canBlendUniformTiles(srcDev.data());
+        QVector<quint8> uniformSrcPixel(srcDev->pixelSize());
+        QVector<quint8> uniformDstPixel(d->pixelSize);
 
         while (rowsRemaining > 0) {
 
@@ -733,6 +787,19 @@ void KisPainter::bitBltImpl(qint32 dstX, qint32 dstY,
                 qint32 columns = qMin(numContiguousDstColumns, numContiguousSrcColumns);
                 columns = qMin(columns, columnsRemaining);
 
+                if (canBlendUniformTiles &&
+                    d->tryBlendUniformTiles(srcDev, useOldSrcData,
+                                            QRect(srcX_, srcY_, columns, rows),
+                                            QPoint(dstX_, dstY_),
+                                            uniformSrcPixel.data(),
+                                            uniformDstPixel.data())) {
+
+                    srcX_ += columns;
+                    dstX_ += columns;
+                    columnsRemaining -= columns;
+                    continue;
+                }
+
                 qint32 srcRowStride = srcIt->rowStride(srcX_, srcY_);
                 srcIt->moveTo(srcX_, srcY_);
 
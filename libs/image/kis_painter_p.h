@@ -85,6 +85,12 @@ struct Q_DECL_HIDDEN KisPainter::Private {
                              qint32 *dstX,
                              qint32 *dstY);
 
+    bool canBlendUniformTiles(const KisPaintDevice *srcDev) const;
+
+    bool tryBlendUniformTiles(const KisPaintDeviceSP srcDev, bool useOldSrcData,
+                              const QRect &srcRect, const QPoint &dstPos,
+                              quint8 *srcPixel, quint8 *dstPixel);
+
     void fillPainterPathImpl(const QPainterPath& path, const QRect &requestedRect);
 
     void applyDevice(const QRect &applyRect,
@@ -0,0 +1,399 @@
+/*
+ *  Copyright (c) 2019 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_recursive_gaussian_blur.h"
+
+#include <cmath>
+#include <cstring>
+
+#include <QRect>
+#include <QBitArray>
+#include <QVector>
+#include <QtConcurrentMap>
+
+#include <KoColorSpace.h>
+#include <KoChannelInfo.h>
+#include <KoUpdater.h>
+
+#include <kis_debug.h>
+
+#include "kis_paint_device.h"
+#include "kis_default_bounds_base.h"
+#include "kis_math_toolbox.h"
+#include "kis_gaussian_kernel.h"
+#include "tiles3/kis_tile_data.h"
+
+
+namespace {
+
+/**
+ * Coefficients of the third-order recursive filter from the paper
+ * by Young and van Vliet. They are already normalized by b0.
+ */
+struct RecursiveCoefficients
+{
+    RecursiveCoefficients(qreal sigma)
+    {
+        // the approximation is not valid for very small sigmas
+        sigma = qMax(sigma, qreal(0.5));
+
+        const qreal q = sigma >= 2.5 ?
+            0.98711 * sigma - 0.96330 :
+            3.97156 - 4.14554 * std::sqrt(1.0 - 0.26891 * sigma);
+
+        const qreal q2 = q * q;
+        const qreal q3 = q2 * q;
+
+        const qreal b0 = 1.57825 + 2.44413 * q + 1.4281 * q2 + 0.422205 * q3;
+
+        b1 = (2.44413 * q + 2.85619 * q2 + 1.26661 * q3) / b0;
+        b2 = -(1.4281 * q2 + 1.26661 * q3) / b0;
+        b3 = 0.422205 * q3 / b0;
+        B = 1.0 - (b1 + b2 + b3);
+    }
+
+    qreal B;
+    qreal b1;
+    qreal b2;
+    qreal b3;
+};
+
+/**
+ * Filters the \p line in place with a causal and then an anti-causal
+ * pass. The values beyond the ends of the line are considered to be
+ * equal to the border values.
+ */
+inline void filterLine(qreal *line, int size, const RecursiveCoefficients &c)
+{
+    if (size <= 0) return;
+
+    qreal w1 = line[0];
+    qreal w2 = w1;
+    qreal w3 = w1;
+
+    for (int i = 0; i < size; i++) {
+        const qreal w = c.B * line[i] + c.b1 * w1 + c.b2 * w2 + c.b3 * w3;
+        line[i] = w;
+        w3 = w2;
+        w2 = w1;
+        w1 = w;
+    }
+
+    qreal y1 = line[size - 1];
+    qreal y2 = y1;
+    qreal y3 = y1;
+
+    for (int i = size - 1; i >= 0; i--) {
+        const qreal y = c.B * line[i] + c.b1 * y1 + c.b2 * y2 + c.b3 * y3;
+        line[i] = y;
+        y3 = y2;
+        y2 = y1;
+        y1 = y;
+    }
+}
+
+struct BlurContext
+{
+    QList<KoChannelInfo*> channels;
+    QVector<PtrToDouble> toDouble;
+    QVector<PtrFromDouble> fromDouble;
+    QVector<qreal> minClamp;
+    QVector<qreal> maxClamp;
+    int alphaIndex = -1;
+    int pixelSize = 0;
+};
+
+/**
+ * Blurs one stripe of the device along \p orientation. The pixels in
+ * range [lineBegin, lineEnd) along the filtering axis are read from
+ * \p src, but only \p dstStripe is written into \p dst. Since all the
+ * data is read before writing, \p src and \p dst may be the same
+ * device.
+ */
+void processStripe(const BlurContext &ctx,
+                   const RecursiveCoefficients &coeffs,
+                   KisPaintDeviceSP src, KisPaintDeviceSP dst,
+                   const QRect &dstStripe,
+                   Qt::Orientation orientation,
+                   int lineBegin, int lineEnd)
+{
+    const bool horizontal = orientation == Qt::Horizontal;
+
+    const QRect srcStripe = horizontal ?
+        QRect(lineBegin, dstStripe.y(), lineEnd - lineBegin, dstStripe.height()) :
+        QRect(dstStripe.x(), lineBegin, dstStripe.width(), lineEnd - lineBegin);
+
+    const int pixelSize = ctx.pixelSize;
+    const int numLines = horizontal ? dstStripe.height() : dstStripe.width();
+    const int srcLength = lineEnd - lineBegin;
+    const int dstLength = horizontal ? dstStripe.width() : dstStripe.height();
+    const int dstOffset = (horizontal ? dstStripe.x() : dstStripe.y()) - lineBegin;
+
+    QVector<quint8> srcBytes(srcStripe.width() * srcStripe.height() * pixelSize);
+    src->readBytes(srcBytes.data(), srcStripe);
+
+    QVector<quint8> dstBytes(dstStripe.width() * dstStripe.height() * pixelSize);
+
+    /**
+     * A "line" is a row for the horizontal pass and a column for the
+     * vertical one, so we just swap the strides
+     */
+    const int srcPixelStride = horizontal ? pixelSize : srcStripe.width() * pixelSize;
+    const int srcLineStride = horizontal ? srcStripe.width() * pixelSize : pixelSize;
+    const int dstPixelStride = horizontal ? pixelSize : dstStripe.width() * pixelSize;
+    const int dstLineStride = horizontal ? dstStripe.width() * pixelSize : pixelSize;
+
+    // no alpha is rare case, so just multiply by 1.0 in that case
+    QVector<qreal> alpha(srcLength, 1.0);
+    QVector<qreal> blurredAlpha(srcLength, 1.0);
+    QVector<qreal> values(srcLength);
+
+    for (int line = 0; line < numLines; line++) {
+        const quint8 *srcLinePtr = srcBytes.constData() + line * srcLineStride;
+        quint8 *dstLinePtr = dstBytes.data() + line * dstLineStride;
+
+        // the channels that are not blurred are kept as they are
+        for (int i = 0; i < dstLength; i++) {
+            memcpy(dstLinePtr + i * dstPixelStride,
+                   srcLinePtr + (i + dstOffset) * srcPixelStride,
+                   pixelSize);
+        }
+
+        if (ctx.alphaIndex >= 0) {
+            const PtrToDouble toDouble = ctx.toDouble[ctx.alphaIndex];
+            const PtrFromDouble fromDouble = ctx.fromDouble[ctx.alphaIndex];
+            const int pos = ctx.channels[ctx.alphaIndex]->pos();
+
+            for (int i = 0; i < srcLength; i++) {
+                alpha[i] = toDouble(srcLinePtr + i * srcPixelStride, pos);
+            }
+
+            std::copy(alpha.constBegin(), alpha.constEnd(), blurredAlpha.begin());
+            filterLine(blurredAlpha.data(), srcLength, coeffs);
+
+            for (int i = 0; i < dstLength; i++) {
+                const qreal value = qBound(ctx.minClamp[ctx.alphaIndex],
+                                           blurredAlpha[i + dstOffset],
+                                           ctx.maxClamp[ctx.alphaIndex]);
+                fromDouble(dstLinePtr + i * dstPixelStride, pos, value);
+            }
+        }
+
+        for (int k = 0; k < ctx.channels.size(); k++) {
+            if (k == ctx.alphaIndex) continue;
+
+            const PtrToDouble toDouble = ctx.toDouble[k];
+            const PtrFromDouble fromDouble = ctx.fromDouble[k];
+            const int pos = ctx.channels[k]->pos();
+
+            for (int i = 0; i < srcLength; i++) {
+                values[i] = toDouble(srcLinePtr + i * srcPixelStride, pos) * alpha[i];
+            }
+
+            filterLine(values.data(), srcLength, coeffs);
+
+            for (int i = 0; i < dstLength; i++) {
+                const qreal alphaValue = blurredAlpha[i + dstOffset];
+                const qreal value = alphaValue > 0.0 ?
+                    qBound(ctx.minClamp[k], values[i + dstOffset] / alphaValue, ctx.maxClamp[k]) :
+                    0.0;
+
+                fromDouble(dstLinePtr + i * dstPixelStride, pos, value);
+            }
+        }
+    }
+
+    dst->writeBytes(dstBytes.constData(), dstStripe);
+}
+
+struct StripeProcessor {
+    StripeProcessor(const BlurContext &ctx,
+                    const RecursiveCoefficients &coeffs,
+                    KisPaintDeviceSP src, KisPaintDeviceSP dst,
+                    Qt::Orientation orientation,
+                    int lineBegin, int lineEnd)
+        : m_ctx(ctx), m_coeffs(coeffs),
+          m_src(src), m_dst(dst),
+          m_orientation(orientation),
+          m_lineBegin(lineBegin), m_lineEnd(lineEnd)
+    {
+    }
+
+    inline void operator() (const QRect &stripe) {
+        processStripe(m_ctx, m_coeffs, m_src, m_dst, stripe,
+                      m_orientation, m_lineBegin, m_lineEnd);
+    }
+
+    const BlurContext &m_ctx;
+    const RecursiveCoefficients &m_coeffs;
+    KisPaintDeviceSP m_src;
+    KisPaintDeviceSP m_dst;
+    Qt::Orientation m_orientation;
+    int m_lineBegin;
+    int m_lineEnd;
+};
+
+inline int alignToTile(int value, int step)
+{
+    return value >= 0 ? value / step * step : -((-value + step - 1) / step * step);
+}
+
+/**
+ * Splits \p rect into stripes parallel to the filtering axis. The
+ * borders of the stripes are aligned to the tile grid, so different
+ * threads never write into the same tile.
+ */
+QVector<QRect> splitIntoStripes(const QRect &rect, Qt::Orientation orientation)
+{
+    QVector<QRect> stripes;
+
+    if (orientation == Qt::Horizontal) {
+        const int step = KisTileData::HEIGHT;
+        int y = rect.top();
+        while (y <= rect.bottom()) {
+            const int nextY = qMin(alignToTile(y, step) + step, rect.bottom() + 1);
+            stripes << QRect(rect.x(), y, rect.width(), nextY - y);
+            y = nextY;
+        }
+    } else {
+        const int step = KisTileData::WIDTH;
+        int x = rect.left();
+        while (x <= rect.right()) {
+            const int nextX = qMin(alignToTile(x, step) + step, rect.right() + 1);
+            stripes << QRect(x, rect.y(), nextX - x, rect.height());
+            x = nextX;
+        }
+    }
+
+    return stripes;
+}
+
+void runPass(const BlurContext &ctx, qreal radius,
+             KisPaintDeviceSP src, KisPaintDeviceSP dst,
+             const QRect &dstRect, Qt::Orientation orientation,
+             int lineBegin, int lineEnd)
+{
+    const RecursiveCoefficients coeffs(KisGaussianKernel::sigmaFromRadius(radius));
+    QVector<QRect> stripes = splitIntoStripes(dstRect, orientation);
+
+    StripeProcessor processor(ctx, coeffs, src, dst, orientation, lineBegin, lineEnd);
+    QtConcurrent::blockingMap(stripes, processor);
+}
+
+bool initializeContext(const KoColorSpace *cs, const QBitArray &channelFlags, BlurContext *ctx)
+{
+    const QList<KoChannelInfo*> allChannels = cs->channels();
+
+    for (int i = 0; i < allChannels.size(); i++) {
+        if (channelFlags.isEmpty() || channelFlags.testBit(i)) {
+            ctx->channels.append(allChannels[i]);
+        }
+    }
+
+    KisMathToolbox mathToolbox;
+
+    ctx->toDouble = QVector<PtrToDouble>(ctx->channels.size());
+    if (!mathToolbox.getToDoubleChannelPtr(ctx->channels, ctx->toDouble))
+        return false;
+
+    ctx->fromDouble = QVector<PtrFromDouble>(ctx->channels.size());
+    if (!mathToolbox.getFromDoubleChannelPtr(ctx->channels, ctx->fromDouble))
+        return false;
+
+    for (int i = 0; i < ctx->channels.size(); i++) {
+        ctx->minClamp << mathToolbox.minChannelValue(ctx->channels[i]);
+        ctx->maxClamp << mathToolbox.maxChannelValue(ctx->channels[i]);
+
+        if (ctx->channels[i]->channelType() == KoChannelInfo::ALPHA) {
+            ctx->alphaIndex = i;
+        }
+    }
+
+    ctx->pixelSize = cs->pixelSize();
+
+    return true;
+}
+
+}
+
+bool KisRecursiveGaussianBlur::supportsColorSpace(const KoColorSpace *cs)
+{
+    BlurContext ctx;
+    return initializeContext(cs, QBitArray(), &ctx);
+}
+
+void KisRecursiveGaussianBlur::apply(KisPaintDeviceSP device,
+                                     const QRect &rect,
+                                     qreal xRadius, qreal yRadius,
+                                     const QBitArray &channelFlags,
+                                     KoUpdater *progressUpdater)
+{
+    if (rect.isEmpty()) return;
+
+    BlurContext ctx;
+    if (!initializeContext(device->colorSpace(), channelFlags, &ctx)) {
+        warnKrita << "KisRecursiveGaussianBlur: unsupported color space" << device->colorSpace()->id();
+        return;
+    }
+
+    if (progressUpdater) {
+        progressUpdater->setProgress(0);
+    }
+
+    const int xMargin = KisGaussianKernel::kernelSizeFromRadius(xRadius) / 2;
+    const int yMargin = KisGaussianKernel::kernelSizeFromRadius(yRadius) / 2;
+
+    /**
+     * Everything outside the data rect is a repetition of its border
+     * pixels, which is exactly what the initial state of the filter
+     * represents. So there is no need to read it. In wrap-around mode
+     * we should read the real (wrapped) data instead.
+     */
+    QRect dataRect = rect.adjusted(-xMargin, -yMargin, xMargin, yMargin);
+    if (!device->defaultBounds()->wrapAroundMode()) {
+        dataRect &= rect | device->exactBounds();
+    }
+
+    if (xRadius > 0.0 && yRadius > 0.0) {
+        KisPaintDeviceSP interm = new KisPaintDevice(device->colorSpace());
+
+        const QRect horizRect(rect.x(), dataRect.y(), rect.width(), dataRect.height());
+
+        runPass(ctx, xRadius, device, interm, horizRect, Qt::Horizontal,
+                dataRect.left(), dataRect.right() + 1);
+
+        if (progressUpdater) {
+            progressUpdater->setProgress(50);
+        }
+
+        runPass(ctx, yRadius, interm, device, rect, Qt::Vertical,
+                horizRect.top(), horizRect.bottom() + 1);
+
+    } else if (xRadius > 0.0) {
+        runPass(ctx, xRadius, device, device, rect, Qt::Horizontal,
+                dataRect.left(), dataRect.right() + 1);
+
+    } else if (yRadius > 0.0) {
+        runPass(ctx, yRadius, device, device, rect, Qt::Vertical,
+                dataRect.top(), dataRect.bottom() + 1);
+    }
+
+    if (progressUpdater) {
+        progressUpdater->setProgress(100);
+    }
+}
@@ -0,0 +1,67 @@
+/*
+ *  Copyright (c) 2019 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_RECURSIVE_GAUSSIAN_BLUR_H
+#define __KIS_RECURSIVE_GAUSSIAN_BLUR_H
+
+#include "kritaimage_export.h"
+#include "kis_types.h"
+
+class QRect;
+class QBitArray;
+class KoColorSpace;
+
+/**
+ * Gaussian blur implemented as a recursive (IIR) filter, as described
+ * by Young and van Vliet in "Recursive implementation of the Gaussian
+ * filter" (Signal Processing, 44, 1995).
+ *
+ * The cost of the filter does not depend on the radius of the blur, so
+ * for big radii it is much faster than the convolution with a Gaussian
+ * kernel. For small radii the result is slightly less precise than
+ * the one of the convolution, so KisGaussianKernel uses it only when
+ * the radius is big enough.
+ *
+ * The area outside the device's exact bounds is considered to be a
+ * repetition of the border pixels, which is equivalent to BORDER_REPEAT
+ * mode of KisConvolutionPainter.
+ *
+ * The device is processed in the stripes aligned to the tile grid, the
+ * stripes are filtered in parallel.
+ */
+class KRITAIMAGE_EXPORT KisRecursiveGaussianBlur
+{
+public:
+    /**
+     * \return true if all the channels of \p cs can be filtered
+     *         by the recursive blur
+     */
+    static bool supportsColorSpace(const KoColorSpace *cs);
+
+    /**
+     * Blurs \p rect of the \p device in place. The radii have the same
+     * meaning as in KisGaussianKernel::applyGaussian()
+     */
+    static void apply(KisPaintDeviceSP device,
+                      const QRect &rect,
+                      qreal xRadius, qreal yRadius,
+                      const QBitArray &channelFlags,
+                      KoUpdater *progressUpdater);
+};
+
+#endif /* __KIS_RECURSIVE_GAUSSIAN_BLUR_H */
@@ -20,10 +20,12 @@
 
 #include <QMutexLocker>
 #include <QVector>
+#include <QtMath>
 
 #include "kis_image_config.h"
 #include "kis_full_refresh_walker.h"
 #include "kis_spontaneous_job.h"
+#include "tiles3/kis_tile_data.h"
 
 
 //#define ENABLE_DEBUG_JOIN
@@ -76,6 +78,7 @@ void KisSimpleUpdateQueue::updateSettings()
 
     m_patchWidth = config.updatePatchWidth();
     m_patchHeight = config.updatePatchHeight();
+    m_jobTargetTime = config.updateJobTargetTime();
 
     m_maxCollectAlpha = config.maxCollectAlpha();
     m_maxMergeAlpha = config.maxMergeAlpha();
@@ -179,17 +182,27 @@ void KisSimpleUpdateQueue::addFullRefreshJob(KisNodeSP node, const QRect& rc, co
 void KisSimpleUpdateQueue::addJob(KisNodeSP node, const QVector<QRect> &rects,
                                   const QRect& cropRect,
                                   int levelOfDetail,
-                                  KisBaseRectsWalker::UpdateType type)
+                                  KisBaseRectsWalker::UpdateType type,
+                                  bool isSplitPatch)
 {
     QList<KisBaseRectsWalkerSP> walkers;
 
+    /**
+     * The pieces of a split update may be merged only into patches
+     * of the configured size, otherwise the pieces of a big update of
+     * a cheap node would be merged back right away, losing the
+     * parallelism of the update
+     */
+    const QSize mergePatchSize =
+        isSplitPatch ? splitPatchSizeForNode(node) : patchSizeForNode(node);
+
     Q_FOREACH (const QRect &rc, rects) {
         if (rc.isEmpty()) continue;
 
         KisBaseRectsWalkerSP walker;
 
-        if(trySplitJob(node, rc, cropRect, levelOfDetail, type)) continue;
-        if(tryMergeJob(node, rc, cropRect, levelOfDetail, type)) continue;
+        if(!isSplitPatch && trySplitJob(node, rc, cropRect, levelOfDetail, type)) continue;
+        if(tryMergeJob(node, rc, cropRect, levelOfDetail, type, mergePatchSize)) continue;
 
         if (type == KisBaseRectsWalker::UPDATE) {
             walker = new KisMergeWalker(cropRect, KisMergeWalker::DEFAULT);
@@ -246,35 +259,91 @@ qint32 KisSimpleUpdateQueue::sizeMetric() const
     return m_updatesList.size() + m_spontaneousJobsList.size();
 }
 
+/**
+ * The limits for scaling the patch size, so that the jobs
+ * become neither too tiny nor too big
+ */
+static const qreal MIN_PATCH_SCALE = 0.25;
+static const qreal MAX_PATCH_SCALE = 2.0;
+
+/**
+ * The patches are aligned to the tile grid, so that two jobs never
+ * share a tile of the updated devices
+ */
+inline int alignToTiles(qreal size, int tileSize)
+{
+    return qMax(tileSize, int(size) / tileSize * tileSize);
+}
+
+QSize KisSimpleUpdateQueue::splitPatchSizeForNode(KisNodeSP node) const
+{
+    const QSize patchSize = patchSizeForNode(node);
+    return QSize(qMin(patchSize.width(), m_patchWidth),
+                 qMin(patchSize.height(), m_patchHeight));
+}
+
+QSize KisSimpleUpdateQueue::patchSizeForNode(KisNodeSP node) const
+{
+    const qreal costPerPixel = m_jobTargetTime > 0 ? node->updateCostPerPixel() : 0.0;
+
+    if (costPerPixel <= 0.0) {
+        return QSize(m_patchWidth, m_patchHeight);
+    }
+
+    /**
+     * Choose the patch area so that a merge job of this node would
+     * take about m_jobTargetTime. That is, the subtrees with expensive
+     * filters get split finer, to let more threads work on them in
+     * parallel, and cheap paint-only stacks are merged coarser, to
+     * lower the overhead of walking the graph.
+     */
+    const qreal targetArea = 1000.0 * m_jobTargetTime / costPerPixel;
+    const qreal scale = qBound(MIN_PATCH_SCALE,
+                               qSqrt(targetArea / (qreal(m_patchWidth) * m_patchHeight)),
+                               MAX_PATCH_SCALE);
+
+    return QSize(alignToTiles(scale * m_patchWidth, KisTileData::WIDTH),
+                 alignToTiles(scale * m_patchHeight, KisTileData::HEIGHT));
+}
+
 bool KisSimpleUpdateQueue::trySplitJob(KisNodeSP node, const QRect& rc,
                                        const QRect& cropRect,
                                        int levelOfDetail,
                                        KisBaseRectsWalker::UpdateType type)
 {
-    if(rc.width() <= m_patchWidth || rc.height() <= m_patchHeight)
+    /**
+     * Big updates are never split into patches bigger than the
+     * configured ones, the cheap nodes get their bigger patches
+     * only by merging small updates in tryMergeJob()
+     */
+    const QSize patchSize = splitPatchSizeForNode(node);
+    const qint32 patchWidth = patchSize.width();
+    const qint32 patchHeight = patchSize.height();
+
+    if(rc.width() <= patchWidth || rc.height() <= patchHeight)
         return false;
 
     // a bit of recursive splitting...
 
-    qint32 firstCol = rc.x() / m_patchWidth;
-    qint32 firstRow = rc.y() / m_patchHeight;
+    qint32 firstCol = rc.x() / patchWidth;
+    qint32 firstRow = rc.y() / patchHeight;
 
-    qint32 lastCol = (rc.x() + rc.width()) / m_patchWidth;
-    qint32 lastRow = (rc.y() + rc.height()) / m_patchHeight;
+    qint32 lastCol = (rc.x() + rc.width()) / patchWidth;
+    qint32 lastRow = (rc.y() + rc.height()) / patchHeight;
 
     QVector<QRect> splitRects;
 
     for(qint32 i = firstRow; i <= lastRow; i++) {
         for(qint32 j = firstCol; j <= lastCol; j++) {
-            QRect maxPatchRect(j * m_patchWidth, i * m_patchHeight,
-                               m_patchWidth, m_patchHeight);
+            QRect maxPatchRect(j * patchWidth, i * patchHeight,
+                               patchWidth, patchHeight);
             QRect patchRect = rc & maxPatchRect;
             splitRects.append(patchRect);
         }
     }
 
     KIS_SAFE_ASSERT_RECOVER_NOOP(!splitRects.isEmpty());
-    addJob(node, splitRects, cropRect, levelOfDetail, type);
+    addJob(node, splitRects, cropRect, levelOfDetail, type, true);
 
     return true;
 }
@@ -282,7 +351,8 @@ bool KisSimpleUpdateQueue::trySplitJob(KisNodeSP node, const QRect& rc,
 bool KisSimpleUpdateQueue::tryMergeJob(KisNodeSP node, const QRect& rc,
                                        const QRect& cropRect,
                                        int levelOfDetail,
-                                       KisBaseRectsWalker::UpdateType type)
+                                       KisBaseRectsWalker::UpdateType type,
+                                       const QSize &patchSize)
 {
     QMutexLocker locker(&m_lock);
 
@@ -307,14 +377,14 @@ bool KisSimpleUpdateQueue::tryMergeJob(KisNodeSP node, const QRect& rc,
         if(item->cropRect() != cropRect) continue;
         if(item->levelOfDetail() != levelOfDetail) continue;
 
-        if(joinRects(baseRect, item->requestedRect(), m_maxMergeAlpha)) {
+        if(joinRects(baseRect, item->requestedRect(), patchSize, m_maxMergeAlpha)) {
             goodCandidate = item;
             break;
         }
     }
 
     if(goodCandidate)
-        collectJobs(goodCandidate, baseRect, m_maxMergeCollectAlpha);
+        collectJobs(goodCandidate, baseRect, patchSize, m_maxMergeCollectAlpha);
 
     return (bool)goodCandidate;
 }
@@ -328,11 +398,18 @@ void KisSimpleUpdateQueue::optimize()
     KisBaseRectsWalkerSP baseWalker = m_updatesList.first();
     QRect baseRect = baseWalker->requestedRect();
 
-    collectJobs(baseWalker, baseRect, m_maxCollectAlpha);
+    /**
+     * The queue may contain the pieces of split updates, so don't
+     * merge them into patches bigger than the configured ones
+     */
+    collectJobs(baseWalker, baseRect,
+                splitPatchSizeForNode(baseWalker->startNode()),
+                m_maxCollectAlpha);
 }
 
 void KisSimpleUpdateQueue::collectJobs(KisBaseRectsWalkerSP &baseWalker,
                                        QRect baseRect,
+                                       const QSize &patchSize,
                                        const qreal maxAlpha)
 {
     KisBaseRectsWalkerSP item;
@@ -347,7 +424,7 @@ void KisSimpleUpdateQueue::collectJobs(KisBaseRectsWalkerSP &baseWalker,
         if(item->cropRect() != baseWalker->cropRect()) continue;
         if(item->levelOfDetail() != baseWalker->levelOfDetail()) continue;
 
-        if(joinRects(baseRect, item->requestedRect(), maxAlpha)) {
+        if(joinRects(baseRect, item->requestedRect(), patchSize, maxAlpha)) {
             iter.remove();
         }
     }
@@ -358,10 +435,12 @@ void KisSimpleUpdateQueue::collectJobs(KisBaseRectsWalkerSP &baseWalker,
 }
 
 bool KisSimpleUpdateQueue::joinRects(QRect& baseRect,
-                                     const QRect& newRect, qreal maxAlpha)
+                                     const QRect& newRect,
+                                     const QSize &patchSize,
+                                     qreal maxAlpha)
 {
     QRect unitedRect = baseRect | newRect;
-    if(unitedRect.width() > m_patchWidth || unitedRect.height() > m_patchHeight)
+    if(unitedRect.width() > patchSize.width() || unitedRect.height() > patchSize.height())
         return false;
 
     bool result = false;
@@ -56,16 +56,37 @@ public:
     int overrideLevelOfDetail() const;
 
 protected:
-    void addJob(KisNodeSP node, const QVector<QRect> &rects, const QRect& cropRect, int levelOfDetail, KisBaseRectsWalker::UpdateType type);
+    void addJob(KisNodeSP node, const QVector<QRect> &rects, const QRect& cropRect, int levelOfDetail, KisBaseRectsWalker::UpdateType type, bool isSplitPatch = false);
 
     bool processOneJob(KisUpdaterContext &updaterContext);
 
     bool trySplitJob(KisNodeSP node, const QRect& rc, const QRect& cropRect, int levelOfDetail, KisBaseRectsWalker::UpdateType type);
-    bool tryMergeJob(KisNodeSP node, const QRect& rc, const QRect& cropRect, int levelOfDetail, KisBaseRectsWalker::UpdateType type);
+    bool tryMergeJob(KisNodeSP node, const QRect& rc, const QRect& cropRect, int levelOfDetail, KisBaseRectsWalker::UpdateType type, const QSize &patchSize);
 
     void collectJobs(KisBaseRectsWalkerSP &baseWalker, QRect baseRect,
-                     const qreal maxAlpha);
-    bool joinRects(QRect& baseRect, const QRect& newRect, qreal maxAlpha);
+                     const QSize &patchSize, const qreal maxAlpha);
+    bool joinRects(QRect& baseRect, const QRect& newRect, const QSize &patchSize, qreal maxAlpha);
+
+    /**
+     * Returns the size of the update patches for the updates started
+     * from \p node, basing on the historical cost of its updates.
+     *
+     * The cost is read from the start node only, but it is not the cost
+     * of this node alone: the merge job measures the whole walk, so the
+     * reported time already includes all the nodes above the start node
+     * the walker has to recompose.
+     *
+     * \see KisNode::updateCostPerPixel()
+     */
+    QSize patchSizeForNode(KisNodeSP node) const;
+
+    /**
+     * The same as patchSizeForNode(), but never bigger than the
+     * configured patch size. Used for splitting big updates and for
+     * merging their pieces, so that the pieces are not merged back
+     * into a patch bigger than the configured one.
+     */
+    QSize splitPatchSizeForNode(KisNodeSP node) const;
 
 protected:
 
@@ -86,6 +107,12 @@ protected:
     qint32 m_patchWidth;
     qint32 m_patchHeight;
 
+    /**
+     * The desired duration of a merge job in microseconds, the
+     * patch size of every node is scaled to fit into it
+     */
+    qint32 m_jobTargetTime;
+
     /**
      * Maximum coefficient of work while regular optimization()
      */
@@ -29,6 +29,13 @@ struct KisSyncLodCacheStrokeStrategy::Private
     KisImageWSP image;
     QHash<KisPaintDeviceSP, KisPaintDevice::LodDataStruct*> dataObjects;
 
+    /**
+     * When non-zero, the stroke only warms up the LoD caches of
+     * the devices for this level of detail and doesn't touch their
+     * current LoD planes
+     */
+    int warmUpLevelOfDetail = 0;
+
     ~Private() {
         qDeleteAll(dataObjects);
         dataObjects.clear();
@@ -36,12 +43,12 @@ struct KisSyncLodCacheStrokeStrategy::Private
 
     class InitData : public KisStrokeJobData {
     public:
-        InitData(KisPaintDeviceSP _device)
+        InitData(const KisPaintDeviceList &_devices)
             : KisStrokeJobData(SEQUENTIAL),
-              device(_device)
+              devices(_devices)
             {}
 
-        KisPaintDeviceSP device;
+        KisPaintDeviceList devices;
     };
 
     class ProcessData : public KisStrokeJobData {
@@ -66,11 +73,12 @@ struct KisSyncLodCacheStrokeStrategy::Private
     };
 };
 
-KisSyncLodCacheStrokeStrategy::KisSyncLodCacheStrokeStrategy(KisImageWSP image, bool forgettable)
+KisSyncLodCacheStrokeStrategy::KisSyncLodCacheStrokeStrategy(KisImageWSP image, bool forgettable, int warmUpLevelOfDetail)
     : KisSimpleStrokeStrategy("SyncLodCacheStroke", kundo2_i18n("Instant Preview")),
       m_d(new Private)
 {
     m_d->image = image;
+    m_d->warmUpLevelOfDetail = warmUpLevelOfDetail;
 
     /**
      * We shouldn't start syncing before all the updates are
@@ -97,9 +105,32 @@ void KisSyncLodCacheStrokeStrategy::doStrokeCallback(KisStrokeJobData *data)
     Private::AdditionalProcessNode *additionalProcessNode = dynamic_cast<Private::AdditionalProcessNode*>(data);
 
     if (initData) {
-        KisPaintDeviceSP dev = initData->device;
-        const int lod = dev->defaultBounds()->currentLevelOfDetail();
-        m_d->dataObjects.insert(dev, dev->createLodDataStruct(lod));
+        using KritaUtils::splitRegionIntoPatches;
+        using KritaUtils::optimalPatchSize;
+
+        /**
+         * The devices keep their LoD planes cached, so only the areas
+         * changed since the previous sync should be regenerated. The
+         * dirty areas are known only now, when all the updates are
+         * finished, so the processing jobs are created here.
+         */
+        QVector<KisStrokeJobData*> jobsData;
+
+        Q_FOREACH (KisPaintDeviceSP dev, initData->devices) {
+            const int lod = m_d->warmUpLevelOfDetail > 0 ?
+                m_d->warmUpLevelOfDetail :
+                dev->defaultBounds()->currentLevelOfDetail();
+
+            KisPaintDevice::LodDataStruct *data = dev->createIncrementalLodDataStruct(lod);
+            m_d->dataObjects.insert(dev, data);
+
+            const QRegion region = dev->regionForLodSyncing(data);
+            Q_FOREACH (const QRect &rc, splitRegionIntoPatches(region, optimalPatchSize())) {
+                jobsData << new Private::ProcessData(dev, rc);
+            }
+        }
+
+        addMutatedJobs(jobsData);
     } else if (processData) {
         KisPaintDeviceSP dev = processData->device;
         KIS_ASSERT(m_d->dataObjects.contains(dev));
@@ -118,7 +149,12 @@ void KisSyncLodCacheStrokeStrategy::finishStrokeCallback()
 
     for (; it != end; ++it) {
         KisPaintDeviceSP dev = it.key();
-        dev->uploadLodDataStruct(it.value());
+
+        if (m_d->warmUpLevelOfDetail > 0) {
+            dev->cacheLodDataStruct(it.value());
+        } else {
+            dev->uploadLodDataStruct(it.value());
+        }
     }
 
     qDeleteAll(m_d->dataObjects);
@@ -131,11 +167,9 @@ void KisSyncLodCacheStrokeStrategy::cancelStrokeCallback()
     m_d->dataObjects.clear();
 }
 
-QList<KisStrokeJobData*> KisSyncLodCacheStrokeStrategy::createJobsData(KisImageWSP _image)
+QList<KisStrokeJobData*> KisSyncLodCacheStrokeStrategy::createJobsData(KisImageWSP _image, bool warmUpOnly)
 {
     using KisLayerUtils::recursiveApplyNodes;
-    using KritaUtils::splitRegionIntoPatches;
-    using KritaUtils::optimalPatchSize;
 
     KisImageSP image = _image;
 
@@ -149,18 +183,13 @@ QList<KisStrokeJobData*> KisSyncLodCacheStrokeStrategy::createJobsData(KisImageW
 
     KritaUtils::makeContainerUnique(deviceList);
 
-    Q_FOREACH (KisPaintDeviceSP device, deviceList) {
-        jobsData << new Private::InitData(device);
-    }
-
-    Q_FOREACH (KisPaintDeviceSP device, deviceList) {
-        QRegion region = device->regionForLodSyncing();
-        QVector<QRect> rects = splitRegionIntoPatches(region, optimalPatchSize());
+    jobsData << new Private::InitData(deviceList);
 
-        Q_FOREACH (const QRect &rc, rects) {
-            jobsData << new Private::ProcessData(device, rc);
-        }
-    }
+    /**
+     * The nodes sync their LoD planes directly, so they cannot
+     * take part in warming up
+     */
+    if (warmUpOnly) return jobsData;
 
     recursiveApplyNodes(image->root(),
                         [&jobsData](KisNodeSP node) {
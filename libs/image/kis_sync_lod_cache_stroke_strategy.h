@@ -26,10 +26,16 @@
 class KisSyncLodCacheStrokeStrategy : public KisSimpleStrokeStrategy
 {
 public:
-    KisSyncLodCacheStrokeStrategy(KisImageWSP image, bool forgettable);
+    /**
+     * \param warmUpLevelOfDetail when non-zero, the stroke doesn't upload
+     *        the generated LoD planes into the devices, but only keeps
+     *        them in the LoD caches of the devices for this level of
+     *        detail. Use createJobsData(image, true) for such strokes.
+     */
+    KisSyncLodCacheStrokeStrategy(KisImageWSP image, bool forgettable, int warmUpLevelOfDetail = 0);
     ~KisSyncLodCacheStrokeStrategy() override;
 
-    static QList<KisStrokeJobData*> createJobsData(KisImageWSP image);
+    static QList<KisStrokeJobData*> createJobsData(KisImageWSP image, bool warmUpOnly = false);
 
 private:
     void doStrokeCallback(KisStrokeJobData *data) override;
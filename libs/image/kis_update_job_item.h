@@ -23,6 +23,8 @@
 
 #include <QRunnable>
 #include <QReadWriteLock>
+#include <QThread>
+#include <QElapsedTimer>
 
 #include "kis_stroke_job.h"
 #include "kis_spontaneous_job.h"
@@ -43,9 +45,11 @@ public:
     };
 
 public:
-    KisUpdateJobItem(QReadWriteLock *exclusiveJobLock)
+    KisUpdateJobItem(QReadWriteLock *exclusiveJobLock, std::atomic<int> *numRunningJobs)
         : m_exclusiveJobLock(exclusiveJobLock),
+          m_numRunningJobs(numRunningJobs),
           m_atomicType(Type::EMPTY),
+          m_workerThread(0),
           m_runnableJob(0)
     {
         setAutoDelete(false);
@@ -59,6 +63,8 @@ public:
     void run() override {
         if (!isRunning()) return;
 
+        m_workerThread = QThread::currentThreadId();
+
         /**
          * Here we break the idea of QThreadPool a bit. Ideally, we should split the
          * jobs into distinct QRunnable objects and pass all of them to QThreadPool.
@@ -102,10 +108,12 @@ public:
 
             // try to exit the loop. Please note, that no one can flip the state from
             // WAITING to EMPTY except ourselves!
+            m_workerThread = 0;
             Type expectedValue = Type::WAITING;
             if (m_atomicType.compare_exchange_strong(expectedValue, Type::EMPTY)) {
                 break;
             }
+            m_workerThread = QThread::currentThreadId();
         }
     }
 
@@ -114,8 +122,15 @@ public:
         KIS_SAFE_ASSERT_RECOVER_RETURN(m_walker);
         // dbgKrita << "Executing merge job" << m_walker->changeRect()
         //          << "on thread" << QThread::currentThreadId();
+        QElapsedTimer timer;
+        timer.start();
+
         m_merger.startMerge(*m_walker);
 
+        const QRect requestedRect = m_walker->requestedRect();
+        m_walker->startNode()->reportUpdateCost(timer.nsecsElapsed(),
+                                                qint64(requestedRect.width()) * requestedRect.height());
+
         QRect changeRect = m_walker->changeRect();
         emit sigContinueUpdate(changeRect);
     }
@@ -131,6 +146,7 @@ public:
         m_exclusive = false;
         m_runnableJob = 0;
 
+        m_numRunningJobs->fetch_add(1);
         const Type oldState = m_atomicType.exchange(Type::MERGE);
         return oldState == Type::EMPTY;
     }
@@ -146,6 +162,7 @@ public:
         m_walker = 0;
         m_accessRect = m_changeRect = QRect();
 
+        m_numRunningJobs->fetch_add(1);
         const Type oldState = m_atomicType.exchange(Type::STROKE);
         return oldState == Type::EMPTY;
     }
@@ -160,6 +177,7 @@ public:
         m_walker = 0;
         m_accessRect = m_changeRect = QRect();
 
+        m_numRunningJobs->fetch_add(1);
         const Type oldState = m_atomicType.exchange(Type::SPONTANEOUS);
         return oldState == Type::EMPTY;
     }
@@ -168,7 +186,11 @@ public:
         m_walker = 0;
         delete m_runnableJob;
         m_runnableJob = 0;
-        m_atomicType = Type::WAITING;
+
+        const Type oldState = m_atomicType.exchange(Type::WAITING);
+        if (oldState >= Type::MERGE) {
+            m_numRunningJobs->fetch_sub(1);
+        }
     }
 
     inline bool isRunning() const {
@@ -179,6 +201,26 @@ public:
         return m_atomicType;
     }
 
+    /**
+     * Returns true if the item has just finished its job and its
+     * worker is still looping in the calling thread, that is the
+     * job assigned to the item right now will be executed by the
+     * calling thread without any context switches
+     */
+    inline bool isWaitingInCurrentThread() const {
+        return m_atomicType == Type::WAITING &&
+            m_workerThread == QThread::currentThreadId();
+    }
+
+    /**
+     * Returns true if the item has just finished its job, but its
+     * worker thread has not exited yet, so a new job assigned to
+     * the item will not need to be started in the thread pool
+     */
+    inline bool isWaiting() const {
+        return m_atomicType == Type::WAITING;
+    }
+
     inline const QRect& accessRect() const {
         return m_accessRect;
     }
@@ -227,10 +269,22 @@ private:
      */
     QReadWriteLock *m_exclusiveJobLock;
 
+    /**
+     * The counter of running jobs shared by all the items
+     * of the context
+     */
+    std::atomic<int> *m_numRunningJobs;
+
     bool m_exclusive;
 
     std::atomic<Type> m_atomicType;
 
+    /**
+     * The thread currently executing the loop in run(), or null if
+     * the item is not being executed
+     */
+    std::atomic<Qt::HANDLE> m_workerThread;
+
     volatile KisStrokeJobData::Sequentiality m_strokeJobSequentiality;
 
     /**
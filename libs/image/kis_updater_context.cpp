@@ -27,7 +27,8 @@
 const int KisUpdaterContext::useIdealThreadCountTag = -1;
 
 KisUpdaterContext::KisUpdaterContext(qint32 threadCount, QObject *parent)
-    : QObject(parent)
+    : QObject(parent),
+      m_numRunningJobs(0)
 {
     if(threadCount <= 0) {
         threadCount = QThread::idealThreadCount();
@@ -97,15 +98,7 @@ int KisUpdaterContext::currentLevelOfDetail() const
 
 bool KisUpdaterContext::hasSpareThread()
 {
-    bool found = false;
-
-    Q_FOREACH (const KisUpdateJobItem *item, m_jobs) {
-        if(!item->isRunning()) {
-            found = true;
-            break;
-        }
-    }
-    return found;
+    return m_numRunningJobs < m_jobs.size();
 }
 
 bool KisUpdaterContext::isJobAllowed(KisBaseRectsWalkerSP walker)
@@ -235,13 +228,32 @@ bool KisUpdaterContext::walkerIntersectsJob(KisBaseRectsWalkerSP walker,
         (job->accessRect().intersects(walker->changeRect()));
 }
 
+/**
+ * Most of the jobs are added from sigDoSomeUsefulWork() of a job item
+ * that has just finished its own job. Giving the new job to the very
+ * same item lets its worker continue with it right away, without
+ * waking up another thread of the pool. If the calling thread is not
+ * a worker, we still prefer the items whose workers are alive, and
+ * start a new worker only when there are no such items.
+ */
 qint32 KisUpdaterContext::findSpareThread()
 {
-    for(qint32 i=0; i < m_jobs.size(); i++)
-        if(!m_jobs[i]->isRunning())
+    qint32 waitingItem = -1;
+    qint32 emptyItem = -1;
+
+    for(qint32 i=0; i < m_jobs.size(); i++) {
+        const KisUpdateJobItem *item = m_jobs[i];
+
+        if (item->isWaitingInCurrentThread()) {
             return i;
+        } else if (waitingItem < 0 && item->isWaiting()) {
+            waitingItem = i;
+        } else if (emptyItem < 0 && !item->isRunning()) {
+            emptyItem = i;
+        }
+    }
 
-    return -1;
+    return waitingItem >= 0 ? waitingItem : emptyItem;
 }
 
 void KisUpdaterContext::slotJobFinished()
@@ -278,7 +290,7 @@ void KisUpdaterContext::setThreadsLimit(int value)
     m_jobs.resize(value);
 
     for(qint32 i = 0; i < m_jobs.size(); i++) {
-        m_jobs[i] = new KisUpdateJobItem(&m_exclusiveJobLock);
+        m_jobs[i] = new KisUpdateJobItem(&m_exclusiveJobLock, &m_numRunningJobs);
         connect(m_jobs[i], SIGNAL(sigContinueUpdate(const QRect&)),
                 SIGNAL(sigContinueUpdate(const QRect&)),
                 Qt::DirectConnection);
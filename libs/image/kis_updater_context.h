@@ -19,6 +19,8 @@
 #ifndef __KIS_UPDATER_CONTEXT_H
 #define __KIS_UPDATER_CONTEXT_H
 
+#include <atomic>
+
 #include <QObject>
 #include <QMutex>
 #include <QReadWriteLock>
@@ -63,7 +65,8 @@ public:
 
     /**
      * Check whether there is a spare thread for running
-     * one more job
+     * one more job. The check doesn't iterate through the job
+     * items, so it is cheap to call it in a loop.
      */
     bool hasSpareThread();
 
@@ -163,6 +166,13 @@ protected:
 
     QMutex m_lock;
     QVector<KisUpdateJobItem*> m_jobs;
+
+    /**
+     * The number of job items currently running a job. Updated
+     * by the items themselves.
+     */
+    std::atomic<int> m_numRunningJobs;
+
     QThreadPool m_threadPool;
     KisLockFreeLodCounter m_lodCounter;
 };
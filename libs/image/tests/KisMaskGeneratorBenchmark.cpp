@@ -156,4 +156,50 @@ void KisMaskGeneratorBenchmark::testRectangularGaussVectorMask()
     }
 }
 
+void KisMaskGeneratorBenchmark::testRectangularScalarMask()
+{
+    QRect bounds(0,0,1000,1000);
+    {
+    KisRectangleMaskGenerator rectScalar(1000, 1.0, 0.5, 0.5, 2, true);
+    rectScalar.resetMaskApplicator(true); // Force usage of scalar backend
+
+    KisMaskGeneratorBenchmarkTester(rectScalar.applicator(), bounds);
+    }
+}
+
+void KisMaskGeneratorBenchmark::testRectangularVectorMask()
+{
+    QRect bounds(0,0,1000,1000);
+    {
+    KisRectangleMaskGenerator rectVectr(1000, 1.0, 0.5, 0.5, 2, true);
+    KisMaskGeneratorBenchmarkTester(rectVectr.applicator(), bounds);
+    }
+}
+
+void KisMaskGeneratorBenchmark::testRectangularSoftScalarMask()
+{
+    QRect bounds(0,0,1000,1000);
+    KisCubicCurve pointsCurve;
+    pointsCurve.fromString(QString("0,1;1,0"));
+    {
+    KisCurveRectangleMaskGenerator rectScalar(1000, 1.0, 0.5, 0.5, 2, pointsCurve, true);
+    rectScalar.setSoftness(0.5);
+    rectScalar.resetMaskApplicator(true); // Force usage of scalar backend
+
+    KisMaskGeneratorBenchmarkTester(rectScalar.applicator(), bounds);
+    }
+}
+
+void KisMaskGeneratorBenchmark::testRectangularSoftVectorMask()
+{
+    QRect bounds(0,0,1000,1000);
+    KisCubicCurve pointsCurve;
+    pointsCurve.fromString(QString("0,1;1,0"));
+    {
+    KisCurveRectangleMaskGenerator rectVectr(1000, 1.0, 0.5, 0.5, 2, pointsCurve, true);
+    rectVectr.setSoftness(0.5);
+    KisMaskGeneratorBenchmarkTester(rectVectr.applicator(), bounds);
+    }
+}
+
 QTEST_MAIN(KisMaskGeneratorBenchmark)
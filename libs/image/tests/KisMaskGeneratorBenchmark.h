@@ -37,6 +37,12 @@ private Q_SLOTS:
 
     void testRectangularGaussScalarMask();
     void testRectangularGaussVectorMask();
+
+    void testRectangularScalarMask();
+    void testRectangularVectorMask();
+
+    void testRectangularSoftScalarMask();
+    void testRectangularSoftVectorMask();
 };
 
 #endif // KISMASKGENERATORBENCHMARK_H
@@ -32,6 +32,7 @@
 #include "kis_adjustment_layer.h"
 #include "kis_filter_mask.h"
 #include "kis_selection.h"
+#include "KisGroupBelowCache.h"
 
 #include "filter/kis_filter.h"
 #include "filter/kis_filter_configuration.h"
@@ -287,5 +288,90 @@ void KisAsyncMergerTest::testSubgraphingWithoutUpdatingParent()
     }
 }
 
+void KisAsyncMergerTest::testGroupBelowCache()
+{
+    const KoColorSpace *colorSpace = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, 200, 150, colorSpace, "below cache test");
+
+    KisPaintDeviceSP device1 = new KisPaintDevice(colorSpace);
+    device1->fill(image->bounds(), KoColor(Qt::white, colorSpace));
+    KisLayerSP paintLayer1 = new KisPaintLayer(image, "paint1", OPACITY_OPAQUE_U8, device1);
+
+    KisPaintDeviceSP device2 = new KisPaintDevice(colorSpace);
+    device2->fill(QRect(0, 0, 100, 100), KoColor(Qt::red, colorSpace));
+    KisLayerSP paintLayer2 = new KisPaintLayer(image, "paint2", 128, device2);
+
+    KisPaintDeviceSP device3 = new KisPaintDevice(colorSpace);
+    KisLayerSP paintLayer3 = new KisPaintLayer(image, "paint3", 200, device3);
+
+    image->addNode(paintLayer1, image->rootLayer());
+    image->addNode(paintLayer2, image->rootLayer());
+    image->addNode(paintLayer3, image->rootLayer());
+
+    image->initialRefreshGraph();
+
+    KisGroupBelowCache *cache = image->rootLayer()->belowCache();
+    QRect cropRect(image->bounds());
+
+    KisMergeWalker walker(cropRect);
+    KisAsyncMerger merger;
+
+    const QRect strokeRect(20, 20, 150, 50);
+    const QRect innerRect(30, 25, 40, 30);
+
+    // the first stroke generates the cache...
+
+    const int initialHits = cache->testingGetNumCacheHits();
+
+    device3->fill(strokeRect, KoColor(Qt::green, colorSpace));
+    walker.collectRects(paintLayer3, strokeRect);
+    merger.startMerge(walker);
+
+    QCOMPARE(cache->testingGetNumCacheHits(), initialHits);
+
+    // ... and the next one inside it just fetches the lower layers from it
+
+    device3->fill(innerRect, KoColor(Qt::black, colorSpace));
+    walker.collectRects(paintLayer3, innerRect);
+    merger.startMerge(walker);
+
+    QCOMPARE(cache->testingGetNumCacheHits(), initialHits + 1);
+
+    // the change of the lower layer must drop the cache, so the same
+    // stroke generates it again
+
+    const QRect lowerRect(50, 30, 100, 100);
+    device1->fill(lowerRect, KoColor(Qt::blue, colorSpace));
+    walker.collectRects(paintLayer1, lowerRect);
+    merger.startMerge(walker);
+
+    const int hitsAfterLowerChange = cache->testingGetNumCacheHits();
+
+    device3->fill(strokeRect, KoColor(Qt::yellow, colorSpace));
+    walker.collectRects(paintLayer3, strokeRect);
+    merger.startMerge(walker);
+
+    QCOMPARE(cache->testingGetNumCacheHits(), hitsAfterLowerChange);
+
+    device3->fill(innerRect, KoColor(Qt::cyan, colorSpace));
+    walker.collectRects(paintLayer3, innerRect);
+    merger.startMerge(walker);
+
+    QCOMPARE(cache->testingGetNumCacheHits(), hitsAfterLowerChange + 1);
+
+    // the cached result must be the same as the one rendered from scratch
+
+    KisPaintDeviceSP result = new KisPaintDevice(*image->projection());
+
+    KisFullRefreshWalker refreshWalker(cropRect);
+    refreshWalker.collectRects(image->rootLayer(), image->bounds());
+    merger.startMerge(refreshWalker);
+
+    QPoint pt;
+    if (!TestUtil::comparePaintDevices(pt, result, image->projection())) {
+        QFAIL(QString("Failed to compare the projections, first different pixel: %1,%2 ").arg(pt.x()).arg(pt.y()).toLatin1());
+    }
+}
+
 QTEST_MAIN(KisAsyncMergerTest)
 
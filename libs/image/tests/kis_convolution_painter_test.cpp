@@ -437,6 +437,76 @@ void KisConvolutionPainterTest::testGaussianDetailsFFTW()
     testGaussianDetails(true);
 }
 
+void KisConvolutionPainterTest::testGaussianRecursive()
+{
+    QImage referenceImage(TestUtil::fetchDataFileLazy("kritaTransparent.png"));
+    KisPaintDeviceSP dev1 = new KisPaintDevice(KoColorSpaceRegistry::instance()->rgb8());
+    dev1->convertFromQImage(referenceImage, 0, 0, 0);
+    KisPaintDeviceSP dev2 = new KisPaintDevice(*dev1);
+
+    const QRect rc = dev1->exactBounds().adjusted(-20, -10, 30, 40);
+    const qreal radius = 40.0;
+
+    KisGaussianKernel::applyGaussian(dev1, rc, radius, radius, QBitArray(), 0,
+                                     false, KisGaussianKernel::ConvolutionBlur);
+    KisGaussianKernel::applyGaussian(dev2, rc, radius, radius, QBitArray(), 0,
+                                     false, KisGaussianKernel::RecursiveBlur);
+
+    QPoint errpoint;
+    QImage convolutionImage = dev1->convertToQImage(0, rc);
+    QImage recursiveImage = dev2->convertToQImage(0, rc);
+
+    if (!TestUtil::compareQImages(errpoint, convolutionImage, recursiveImage, 5, 5)) {
+        convolutionImage.save("gaussian_recursive_expected.png");
+        recursiveImage.save("gaussian_recursive_result.png");
+        QFAIL(QString("Recursive blur differs from the convolution at %1,%2")
+              .arg(errpoint.x()).arg(errpoint.y()).toLatin1());
+    }
+}
+
+void KisConvolutionPainterTest::testFFTWBlocks()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP src = new KisPaintDevice(cs);
+
+    // the area is big enough to be split into several blocks
+    const QRect rc(0, 0, 1500, 1300);
+
+    for (int i = 0; i < 30; i++) {
+        const QColor color = QColor::fromHsv(i * 12, 255, 255, 55 + 200 * (i % 2));
+        src->fill(QRect(i * 50, i * 43, 200, 70), KoColor(color, cs));
+    }
+
+    Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> matrix(9, 9);
+    matrix.fill(1.0);
+    KisConvolutionKernelSP kernel = KisConvolutionKernel::fromMatrix(matrix, 0, matrix.sum());
+
+    KisPaintDeviceSP spatialDst = new KisPaintDevice(cs);
+    KisConvolutionPainter spatialPainter(spatialDst, KisConvolutionPainter::SPATIAL);
+    spatialPainter.applyMatrix(kernel, src, rc.topLeft(), rc.topLeft(), rc.size(), BORDER_REPEAT);
+
+    KisPaintDeviceSP fftwDst = new KisPaintDevice(cs);
+    KisConvolutionPainter fftwPainter(fftwDst, KisConvolutionPainter::FFTW);
+    fftwPainter.applyMatrix(kernel, src, rc.topLeft(), rc.topLeft(), rc.size(), BORDER_REPEAT);
+
+    // in-place convolution must read all the blocks before writing
+    KisConvolutionPainter inPlacePainter(src, KisConvolutionPainter::FFTW);
+    inPlacePainter.applyMatrix(kernel, src, rc.topLeft(), rc.topLeft(), rc.size(), BORDER_REPEAT);
+
+    const QImage spatialImage = spatialDst->convertToQImage(0, rc);
+
+    QPoint errpoint;
+    if (!TestUtil::compareQImages(errpoint, spatialImage, fftwDst->convertToQImage(0, rc), 1, 1)) {
+        QFAIL(QString("FFTW result differs from the spatial one at %1,%2")
+              .arg(errpoint.x()).arg(errpoint.y()).toLatin1());
+    }
+
+    if (!TestUtil::compareQImages(errpoint, spatialImage, src->convertToQImage(0, rc), 1, 1)) {
+        QFAIL(QString("In-place FFTW result differs from the spatial one at %1,%2")
+              .arg(errpoint.x()).arg(errpoint.y()).toLatin1());
+    }
+}
+
 #include "kis_transaction.h"
 
 void KisConvolutionPainterTest::testDilate()
@@ -57,6 +57,10 @@ private Q_SLOTS:
     void testGaussianDetailsSpatial();
     void testGaussianDetailsFFTW();
 
+    void testGaussianRecursive();
+
+    void testFFTWBlocks();
+
     void testDilate();
     void testErode();
 };
@@ -30,7 +30,7 @@
 #include "krita_utils.h"
 
 enum MaskType {
-    DEFAULT, CIRC_GAUSS, CIRC_SOFT, RECT_GAUSS, RECT_SOFT, STAMP
+    DEFAULT, CIRC_GAUSS, CIRC_SOFT, RECT_DEFAULT, RECT_GAUSS, RECT_SOFT, STAMP
 };
 
 class KisMaskSimilarityTester
@@ -115,6 +115,26 @@ public:
                     KisMaskSimilarityTester(bCircScalar.applicator(), bCircVectr.applicator(), bounds,type,false);
                     break;
 
+                    }
+                case RECT_DEFAULT:
+                    {
+                    KisRectangleMaskGenerator bCircVectr(499.5, k/100.f, i/100.f, j/100.f, 2, true);
+                    KisRectangleMaskGenerator bCircScalar(bCircVectr);
+                    bCircScalar.resetMaskApplicator(true); // Force usage of scalar backend
+
+                    KisMaskSimilarityTester(bCircScalar.applicator(), bCircVectr.applicator(), bounds,type,false);
+                    break;
+                    }
+                case RECT_SOFT:
+                    {
+                    KisCubicCurve pointsCurve;
+                    pointsCurve.fromString(QString("0,1;1,0"));
+                    KisCurveRectangleMaskGenerator bCircVectr(499.5, k/100.f, i/100.f, j/100.f, 2, pointsCurve, true);
+                    KisCurveRectangleMaskGenerator bCircScalar(bCircVectr);
+                    bCircScalar.resetMaskApplicator(true); // Force usage of scalar backend
+
+                    KisMaskSimilarityTester(bCircScalar.applicator(), bCircVectr.applicator(), bounds,type,false);
+                    break;
                     }
                 default:
                     {
@@ -137,6 +157,9 @@ private:
         case CIRC_SOFT:
             strName = "CircSoft";
             break;
+        case RECT_DEFAULT:
+            strName = "RectDefault";
+            break;
         case RECT_GAUSS:
             strName = "RectGauss";
             break;
@@ -222,4 +245,34 @@ void KisMaskSimilarityTest::testGaussRectMask()
     KisMaskSimilarityTester::exahustiveTest(bounds,RECT_GAUSS);
 }
 
+void KisMaskSimilarityTest::testRectMask()
+{
+    QRect bounds(0,0,540,540);
+    {
+        KisRectangleMaskGenerator rectVectr(499.5, 1.0, 0.5, 0.2, 2, true);
+        KisRectangleMaskGenerator rectScalar(rectVectr);
+
+        rectScalar.resetMaskApplicator(true); // Force usage of scalar backend
+        KisMaskSimilarityTester(rectScalar.applicator(), rectVectr.applicator(), bounds, RECT_DEFAULT);
+    }
+
+    KisMaskSimilarityTester::exahustiveTest(bounds,RECT_DEFAULT);
+}
+
+void KisMaskSimilarityTest::testSoftRectMask()
+{
+    QRect bounds(0,0,540,540);
+    KisCubicCurve pointsCurve;
+    pointsCurve.fromString(QString("0,1;1,0"));
+    {
+        KisCurveRectangleMaskGenerator rectVectr(499.5, 1.0, 0.5, 0.2, 2, pointsCurve, true);
+        KisCurveRectangleMaskGenerator rectScalar(rectVectr);
+
+        rectScalar.resetMaskApplicator(true); // Force usage of scalar backend
+        KisMaskSimilarityTester(rectScalar.applicator(), rectVectr.applicator(), bounds, RECT_SOFT);
+    }
+
+    KisMaskSimilarityTester::exahustiveTest(bounds,RECT_SOFT);
+}
+
 QTEST_MAIN(KisMaskSimilarityTest)
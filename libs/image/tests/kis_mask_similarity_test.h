@@ -30,6 +30,8 @@ private Q_SLOTS:
     void testGaussCircleMask();
     void testSoftCircleMask();
     void testGaussRectMask();
+    void testRectMask();
+    void testSoftRectMask();
 };
 
 #endif
@@ -1519,6 +1519,66 @@ void KisPaintDeviceTest::testLodDevice()
                                   "lod", "lod1-offset-6-14"));
 }
 
+void syncIncrementalLodCache(KisPaintDeviceSP dev, int levelOfDetail, QRegion *syncedRegion)
+{
+    KisPaintDevice::LodDataStruct* s = dev->createIncrementalLodDataStruct(levelOfDetail);
+
+    *syncedRegion = dev->regionForLodSyncing(s);
+    Q_FOREACH(QRect rect2, KritaUtils::splitRegionIntoPatches(*syncedRegion, KritaUtils::optimalPatchSize())) {
+        dev->updateLodDataStruct(s, rect2);
+    }
+
+    dev->uploadLodDataStruct(s);
+    delete s;
+}
+
+void KisPaintDeviceTest::testIncrementalLodDevice()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    TestingLodDefaultBounds *bounds = new TestingLodDefaultBounds(QRect(0,0,200,200));
+    dev->setDefaultBounds(bounds);
+
+    fillGradientDevice(dev, QRect(0,0,200,200));
+
+    QRegion syncedRegion;
+
+    // the first sync regenerates the whole device
+    bounds->testingSetLevelOfDetail(1);
+    syncIncrementalLodCache(dev, 1, &syncedRegion);
+    QCOMPARE(syncedRegion, dev->regionForLodSyncing());
+
+    // nothing has changed, nothing to regenerate
+    syncIncrementalLodCache(dev, 1, &syncedRegion);
+    QVERIFY(syncedRegion.isEmpty());
+
+    bounds->testingSetLevelOfDetail(0);
+    dev->fill(QRect(70,70,10,10), KoColor(Qt::red, cs));
+    bounds->testingSetLevelOfDetail(1);
+
+    // only the modified tile is regenerated
+    syncIncrementalLodCache(dev, 1, &syncedRegion);
+    QCOMPARE(syncedRegion, QRegion(QRect(64,64,64,64)));
+
+    KisPaintDeviceSP refDev = new KisPaintDevice(cs);
+    TestingLodDefaultBounds *refBounds = new TestingLodDefaultBounds(QRect(0,0,200,200));
+    refDev->setDefaultBounds(refBounds);
+    bounds->testingSetLevelOfDetail(0);
+    refDev->makeCloneFrom(dev, dev->extent());
+    bounds->testingSetLevelOfDetail(1);
+    refBounds->testingSetLevelOfDetail(1);
+    syncLodCache(refDev, 1);
+
+    QCOMPARE(dev->convertToQImage(0,0,0,100,100),
+             refDev->convertToQImage(0,0,0,100,100));
+
+    // the cache is dropped when the level of detail changes
+    bounds->testingSetLevelOfDetail(2);
+    syncIncrementalLodCache(dev, 2, &syncedRegion);
+    QCOMPARE(syncedRegion, dev->regionForLodSyncing());
+}
+
 void KisPaintDeviceTest::benchmarkLod1Generation()
 {
     const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
@@ -65,6 +65,7 @@ private Q_SLOTS:
 
     void testLodTransform();
     void testLodDevice();
+    void testIncrementalLodDevice();
     void benchmarkLod1Generation();
     void benchmarkLod2Generation();
     void benchmarkLod3Generation();
@@ -862,6 +862,106 @@ void KisPainterTest::testOptimizedCopying()
 
 }
 
+KisPaintDeviceSP createNonUniformCopy(KisPaintDeviceSP dev, const QRect &rc)
+{
+    /**
+     * The data written through writeBytes() is never marked as
+     * uniform, so the copy is always blended in the usual way
+     */
+    KisPaintDeviceSP copy = new KisPaintDevice(dev->colorSpace());
+    QVector<quint8> buffer(rc.width() * rc.height() * dev->pixelSize());
+    dev->readBytes(buffer.data(), rc);
+    copy->writeBytes(buffer.data(), rc);
+    return copy;
+}
+
+void testUniformTilesBitBltImpl(bool useSelection)
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    const QRect srcRect(0, 0, 256, 192);
+    const QRect dstRect(64, 64, 256, 192);
+    const QRect bltRect(10, 20, 320, 260);
+    const QPoint dstPt(30, 15);
+    const QRect processRect = bltRect | bltRect.translated(dstPt - bltRect.topLeft()) | dstRect;
+
+    KoColor srcColor(Qt::red, cs);
+    srcColor.setOpacity(quint8(100));
+    KoColor dstColor(Qt::blue, cs);
+    dstColor.setOpacity(quint8(200));
+
+    KisPaintDeviceSP src = new KisPaintDevice(cs);
+    KisPaintDeviceSP dst = new KisPaintDevice(cs);
+
+    src->fill(srcRect, srcColor);
+    dst->fill(dstRect, dstColor);
+
+    QVector<quint8> pixel(cs->pixelSize());
+    QVERIFY(src->dataManager()->tryGetUniformPixel(64, 64, pixel.data()));
+    QVERIFY(dst->dataManager()->tryGetUniformPixel(128, 128, pixel.data()));
+
+    KisPaintDeviceSP refSrc = createNonUniformCopy(src, processRect);
+    KisPaintDeviceSP refDst = createNonUniformCopy(dst, processRect);
+
+    QVERIFY(!refSrc->dataManager()->tryGetUniformPixel(64, 64, pixel.data()));
+    QVERIFY(!refDst->dataManager()->tryGetUniformPixel(128, 128, pixel.data()));
+
+    KisSelectionSP selection;
+
+    if (useSelection) {
+        selection = new KisSelection();
+        selection->pixelSelection()->select(QRect(50, 40, 200, 150), 180);
+    }
+
+    {
+        KisPainter gc(dst);
+        gc.setSelection(selection);
+        gc.setCompositeOp(COMPOSITE_OVER);
+        gc.setOpacity(quint8(150));
+        gc.bitBlt(dstPt, src, bltRect);
+    }
+
+    {
+        KisPainter gc(refDst);
+        gc.setSelection(selection);
+        gc.setCompositeOp(COMPOSITE_OVER);
+        gc.setOpacity(quint8(150));
+        gc.bitBlt(dstPt, refSrc, bltRect);
+    }
+
+    /**
+     * The uniform tiles are blended with the pixel-by-pixel version of
+     * the composite op, while the usual path may use the vectorized
+     * one, so let the results differ in rounding
+     */
+    const int numBytes = processRect.width() * processRect.height() * cs->pixelSize();
+    QVector<quint8> result(numBytes);
+    QVector<quint8> reference(numBytes);
+
+    dst->readBytes(result.data(), processRect);
+    refDst->readBytes(reference.data(), processRect);
+
+    for (int i = 0; i < numBytes; i++) {
+        if (qAbs(result[i] - reference[i]) > 1) {
+            const int pixelIndex = i / cs->pixelSize();
+            QFAIL(QString("Uniform bitBlt differs from the usual one at %1,%2: %3 vs %4")
+                  .arg(processRect.x() + pixelIndex % processRect.width())
+                  .arg(processRect.y() + pixelIndex / processRect.width())
+                  .arg(result[i]).arg(reference[i]).toLatin1());
+        }
+    }
+}
+
+void KisPainterTest::testUniformTilesBitBlt()
+{
+    testUniformTilesBitBltImpl(false);
+}
+
+void KisPainterTest::testUniformTilesBitBltWithSelection()
+{
+    testUniformTilesBitBltImpl(true);
+}
+
 QTEST_MAIN(KisPainterTest)
 
 
@@ -66,6 +66,9 @@ private Q_SLOTS:
     void benchmarkMassiveBltFixed();
 
     void testOptimizedCopying();
+
+    void testUniformTilesBitBlt();
+    void testUniformTilesBitBltWithSelection();
 };
 
 #endif
@@ -276,5 +276,81 @@ void KisSimpleUpdateQueueTest::testSpontaneousJobsCompression()
     QCOMPARE(jobsList[0], job3);
 }
 
+void KisSimpleUpdateQueueTest::testCostAwarePatches()
+{
+    QRect imageRect(0,0,1024,1024);
+
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "merge test");
+
+    KisPaintLayerSP expensiveLayer = new KisPaintLayer(image, "expensive", OPACITY_OPAQUE_U8);
+    KisPaintLayerSP cheapLayer = new KisPaintLayer(image, "cheap", OPACITY_OPAQUE_U8);
+
+    image->lock();
+    image->addNode(expensiveLayer);
+    image->addNode(cheapLayer);
+    image->unlock();
+    image->waitForDone();
+
+    /**
+     * The merge jobs above have already reported their real costs,
+     * so override them to make the test independent from the timing
+     */
+    expensiveLayer->testingSetUpdateCostPerPixel(1000000);
+    cheapLayer->testingSetUpdateCostPerPixel(0.001);
+
+    {
+        /**
+         * Expensive nodes are split into the patches of
+         * minimal size, aligned to the tiles grid
+         */
+        KisTestableSimpleUpdateQueue queue;
+        KisWalkersList& walkersList = queue.getWalkersList();
+
+        queue.addUpdateJob(expensiveLayer, QRect(0,0,256,256), imageRect, 0);
+
+        QCOMPARE(walkersList.size(), 4);
+        QVERIFY(checkWalker(walkersList[0], QRect(0,0,128,128)));
+        QVERIFY(checkWalker(walkersList[1], QRect(128,0,128,128)));
+        QVERIFY(checkWalker(walkersList[2], QRect(0,128,128,128)));
+        QVERIFY(checkWalker(walkersList[3], QRect(128,128,128,128)));
+    }
+
+    {
+        /**
+         * Cheap nodes are merged into the patches bigger
+         * than the default ones
+         */
+        KisTestableSimpleUpdateQueue queue;
+        KisWalkersList& walkersList = queue.getWalkersList();
+
+        queue.addUpdateJob(cheapLayer, QRect(0,0,400,100), imageRect, 0);
+        queue.addUpdateJob(cheapLayer, QRect(300,0,400,100), imageRect, 0);
+
+        QCOMPARE(walkersList.size(), 1);
+        QVERIFY(checkWalker(walkersList[0], QRect(0,0,700,100)));
+    }
+
+    {
+        /**
+         * The pieces of a big update of a cheap node are not
+         * merged back into the patches bigger than the default ones
+         */
+        KisTestableSimpleUpdateQueue queue;
+        KisWalkersList& walkersList = queue.getWalkersList();
+
+        queue.addUpdateJob(cheapLayer, QRect(0,0,1024,1024), imageRect, 0);
+
+        QCOMPARE(walkersList.size(), 4);
+        QVERIFY(checkWalker(walkersList[0], QRect(0,0,512,512)));
+        QVERIFY(checkWalker(walkersList[1], QRect(512,0,512,512)));
+        QVERIFY(checkWalker(walkersList[2], QRect(0,512,512,512)));
+        QVERIFY(checkWalker(walkersList[3], QRect(512,512,512,512)));
+
+        queue.optimize();
+        QCOMPARE(walkersList.size(), 4);
+    }
+}
+
 QTEST_MAIN(KisSimpleUpdateQueueTest)
 
@@ -62,6 +62,7 @@ KisHLineIterator2::KisHLineIterator2(KisDataManager *dataManager, qint32 x, qint
     for (quint32 i = 0; i < m_tilesCacheSize; i++){
         fetchTileDataForCache(m_tilesCache[i], m_leftCol + i, m_row);
     }
+    prefetchNextTiles();
     m_index = 0;
     switchToTile(m_leftInLeftmostTile);
 }
@@ -219,6 +220,17 @@ void KisHLineIterator2::preallocateTiles()
         unlockTile(m_tilesCache[i].oldtile);
         fetchTileDataForCache(m_tilesCache[i], m_leftCol + i, m_row);
     }
+    prefetchNextTiles();
+}
+
+void KisHLineIterator2::prefetchNextTiles()
+{
+    /**
+     * Ask the store to bring the next row of tiles from the swap
+     * while we are busy with the current one
+     */
+    m_dataManager->prefetchTiles(QRect(m_left, (m_row + 1) * KisTileData::HEIGHT,
+                                       m_right - m_left + 1, KisTileData::HEIGHT));
 }
 
 qint32 KisHLineIterator2::x() const
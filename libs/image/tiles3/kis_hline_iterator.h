@@ -85,5 +85,6 @@ private:
     void switchToTile(qint32 xInTile);
     void fetchTileDataForCache(KisTileInfo& kti, qint32 col, qint32 row);
     void preallocateTiles();
+    void prefetchNextTiles();
 };
 #endif
@@ -199,6 +199,14 @@ void KisTile::lockForWrite()
         m_COWMutex.unlock();
     }
 
+    /**
+     * We don't know what the writer is going to do with the data,
+     * so the data is not considered uniform anymore
+     */
+    if (m_tileData->isUniform()) {
+        m_tileData->setUniform(false);
+    }
+
     DEBUG_LOG_ACTION("lock [W]");
 }
 
@@ -208,6 +216,19 @@ void KisTile::unlock() const
     DEBUG_LOG_ACTION("unlock");
 }
 
+KisTileData* KisTile::referenceTileData()
+{
+    /**
+     * m_tileData can be changed only by COW-ing that happens
+     * under m_COWMutex, so it is enough to hold the mutex to be
+     * sure the tile data will not be released while we ref it
+     */
+    QMutexLocker locker(&m_COWMutex);
+
+    m_tileData->ref();
+    return m_tileData;
+}
+
 
 #include <stdio.h>
 void KisTile::debugPrintInfo()
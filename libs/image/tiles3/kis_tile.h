@@ -113,6 +113,15 @@ public:
         return m_tileData;
     }
 
+    /**
+     * Returns the current tile data with an additional reference
+     * taken. The tile is not locked, so the data may be swapped out.
+     * The caller should release the reference with
+     * KisTileData::deref(). Used for passing the tile data to the
+     * swap prefetcher.
+     */
+    KisTileData* referenceTileData();
+
 private:
     void init(qint32 col, qint32 row,
               KisTileData *defaultTileData, KisMementoManager* mm);
@@ -42,6 +42,7 @@ KisTileData::KisTileData(qint32 pixelSize, const quint8 *defPixel, KisTileDataSt
       m_age(0),
       m_usersCount(0),
       m_refCount(0),
+      m_isUniform(true),
       m_pixelSize(pixelSize),
       m_store(store)
 {
@@ -69,6 +70,7 @@ KisTileData::KisTileData(const KisTileData& rhs, bool checkFreeMemory)
       m_age(0),
       m_usersCount(0),
       m_refCount(0),
+      m_isUniform(false),
       m_pixelSize(rhs.m_pixelSize),
       m_store(rhs.m_store)
 {
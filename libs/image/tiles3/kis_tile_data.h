@@ -38,6 +38,7 @@ inline quint8* KisTileData::data() const {
 void KisTileData::setData(const quint8 *data) {
     Q_ASSERT(m_data);
     memcpy(m_data, data, m_pixelSize*WIDTH*HEIGHT);
+    setUniform(false);
 }
 
 inline quint32 KisTileData::pixelSize() const {
@@ -133,5 +134,13 @@ inline qint32 KisTileData::numUsers() const {
     return m_usersCount;
 }
 
+inline bool KisTileData::isUniform() const {
+    return m_isUniform.load();
+}
+
+inline void KisTileData::setUniform(bool value) {
+    m_isUniform.store(value);
+}
+
 #endif /* KIS_TILE_DATA_H_ */
 
@@ -82,8 +82,8 @@ public:
 
     /**
      * Only refs shared pointer counter.
-     * Used only by KisMementoManager without
-     * consideration of COW.
+     * Used only by KisMementoManager and KisTileDataPrefetcher
+     * without consideration of COW.
      */
     inline bool ref() const;
 
@@ -131,6 +131,16 @@ public:
      */
     inline qint32 numUsers() const;
 
+    /**
+     * Shows whether all the pixels of the tile data are known to
+     * be equal. The flag is set when the tile data is created out
+     * of a single pixel or when KisTiledDataManager::purge() finds
+     * it uniform. It is dropped as soon as any tile locks the data
+     * for writing.
+     */
+    inline bool isUniform() const;
+    inline void setUniform(bool value);
+
     /**
      * Conveniece method. Returns true iff the tile data is linked to
      * information only and therefore can be swapped out easily.
@@ -260,6 +270,11 @@ private:
     mutable QAtomicInt m_refCount;
 
 
+    /**
+     * See isUniform()
+     */
+    QAtomicInt m_isUniform;
+
     qint32 m_pixelSize;
     //qint32 m_timeStamp;
 
@@ -69,16 +69,19 @@ qint64 __preclone_miss_age = 0;
 KisTileDataStore::KisTileDataStore()
     : m_pooler(this),
       m_swapper(this),
+      m_prefetcher(this),
       m_numTiles(0),
       m_memoryMetric(0)
 {
     m_clockIterator = m_tileDataList.end();
     m_pooler.start();
     m_swapper.start();
+    m_prefetcher.start();
 }
 
 KisTileDataStore::~KisTileDataStore()
 {
+    m_prefetcher.terminatePrefetcher();
     m_pooler.terminatePooler();
     m_swapper.terminateSwapper();
 
@@ -116,6 +119,10 @@ KisTileDataStore::MemoryStatistics KisTileDataStore::memoryStatistics()
 
     stats.swapSize = m_swappedStore.totalMemoryMetric() * metricCoeff;
 
+    m_swappedStore.windowStatistics(stats.swapWindowHits,
+                                    stats.swapWindowMisses,
+                                    stats.swapMappedSize);
+
     return stats;
 }
 
@@ -213,32 +220,30 @@ void KisTileDataStore::ensureTileDataLoaded(KisTileData *td)
         /**
          * The order of this heavy locking is very important.
          * Change it only in case, you really know what you are doing.
+         *
+         * The swap lock of the tile data is taken *before*
+         * m_listLock, the same way as duplicateTileData() does
+         * it. A swapped-out tile data is not present in the list,
+         * so nobody holding m_listLock can wait for its swap lock.
+         * That lets us read and decompress the data without
+         * holding m_listLock: the swapped store serializes only
+         * the access to its shards.
          */
-        m_listLock.lock();
+        td->m_swapLock.lockForWrite();
 
         /**
-         * If someone has managed to load the td from swap, then, most
-         * probably, they have already taken the swap lock. This may
-         * lead to a deadlock, because COW mechanism breaks lock
-         * ordering rules in duplicateTileData() (it takes m_listLock
-         * while the swap lock is held). In our case it is enough just
-         * to check whether the other thread has already fetched the
-         * data. Please notice that we do not take both of the locks
-         * while checking this, because holding m_listLock is
-         * enough. Nothing can happen to the tile while we hold
-         * m_listLock.
+         * If someone has managed to load the td from swap while
+         * we were waiting for the lock, there is nothing to do
          */
-
         if(!td->data()) {
-            td->m_swapLock.lockForWrite();
-
             m_swappedStore.swapInTileData(td);
-            registerTileDataImp(td);
 
-            td->m_swapLock.unlock();
+            m_listLock.lock();
+            registerTileDataImp(td);
+            m_listLock.unlock();
         }
 
-        m_listLock.unlock();
+        td->m_swapLock.unlock();
 
         /**
          * <-- In theory, livelock is possible here...
@@ -251,24 +256,69 @@ void KisTileDataStore::ensureTileDataLoaded(KisTileData *td)
 bool KisTileDataStore::trySwapTileData(KisTileData *td)
 {
     /**
-     * This function is called with m_listLock acquired
+     * This function is called with m_listLock acquired, so it
+     * only detaches the tile data from the list. The data is
+     * compressed and written into the swap by
+     * swapOutPendingTileData() when the iteration is finished
+     * and m_listLock is released.
      */
 
-    bool result = false;
-    if(!td->m_swapLock.tryLockForWrite()) return result;
+    if(!td->m_swapLock.tryLockForWrite()) return false;
 
-    if(td->data()) {
-        unregisterTileDataImp(td);
-        if (m_swappedStore.trySwapOutTileData(td)) {
-            result = true;
-        } else {
-            result = false;
+    if(!td->data()) {
+        td->m_swapLock.unlock();
+        return false;
+    }
+
+    /**
+     * Keep the tile data alive while it is being swapped
+     * out. If the last reference has already gone, the tile
+     * data is waiting for m_listLock in freeTileData(), so
+     * just skip it.
+     */
+    int refCount = td->m_refCount.load();
+    do {
+        if (refCount <= 0) {
+            td->m_swapLock.unlock();
+            return false;
+        }
+    } while (!td->m_refCount.testAndSetOrdered(refCount, refCount + 1));
+
+    unregisterTileDataImp(td);
+    m_pendingSwapOut.append(td);
+
+    return true;
+}
+
+void KisTileDataStore::swapOutPendingTileData(const QVector<KisTileData*> &tileData)
+{
+    /**
+     * This function is called with m_listLock released. The
+     * tile data objects are not present in the list and are
+     * locked for writing, so nobody can access them until we
+     * are done.
+     */
+
+    Q_FOREACH (KisTileData *td, tileData) {
+        if (!m_swappedStore.trySwapOutTileData(td)) {
+            m_listLock.lock();
             registerTileDataImp(td);
+            m_listLock.unlock();
         }
+
+        td->m_swapLock.unlock();
+        td->deref();
     }
-    td->m_swapLock.unlock();
+}
 
-    return result;
+void KisTileDataStore::endIterationImpl()
+{
+    QVector<KisTileData*> pendingSwapOut;
+    pendingSwapOut.swap(m_pendingSwapOut);
+
+    m_listLock.unlock();
+
+    swapOutPendingTileData(pendingSwapOut);
 }
 
 KisTileDataStoreIterator* KisTileDataStore::beginIteration()
@@ -279,7 +329,7 @@ KisTileDataStoreIterator* KisTileDataStore::beginIteration()
 void KisTileDataStore::endIteration(KisTileDataStoreIterator* iterator)
 {
     delete iterator;
-    m_listLock.unlock();
+    endIterationImpl();
 }
 
 KisTileDataStoreReverseIterator* KisTileDataStore::beginReverseIteration()
@@ -290,7 +340,7 @@ KisTileDataStoreReverseIterator* KisTileDataStore::beginReverseIteration()
 void KisTileDataStore::endIteration(KisTileDataStoreReverseIterator* iterator)
 {
     delete iterator;
-    m_listLock.unlock();
+    endIterationImpl();
     DEBUG_REPORT_PRECLONE_EFFICIENCY();
 }
 
@@ -303,7 +353,7 @@ void KisTileDataStore::endIteration(KisTileDataStoreClockIterator* iterator)
 {
     m_clockIterator = iterator->getFinalPosition();
     delete iterator;
-    m_listLock.unlock();
+    endIterationImpl();
 }
 
 void KisTileDataStore::debugPrintList()
@@ -349,6 +399,7 @@ void KisTileDataStore::debugClear()
 void KisTileDataStore::testingRereadConfig() {
     m_pooler.testingRereadConfig();
     m_swapper.testingRereadConfig();
+    m_prefetcher.testingRereadConfig();
     kickPooler();
 }
 
@@ -21,10 +21,12 @@
 #include "kritaimage_export.h"
 
 #include <QReadWriteLock>
+#include <QVector>
 #include "kis_tile_data_interface.h"
 
 #include "kis_tile_data_pooler.h"
 #include "swap/kis_tile_data_swapper.h"
+#include "swap/kis_tile_data_prefetcher.h"
 #include "swap/kis_swapped_data_store.h"
 
 class KisTileDataStoreIterator;
@@ -51,6 +53,10 @@ public:
         qint64 poolSize;
 
         qint64 swapSize;
+
+        qint64 swapWindowHits;
+        qint64 swapWindowMisses;
+        qint64 swapMappedSize;
     };
 
     MemoryStatistics memoryStatistics();
@@ -70,6 +76,14 @@ public:
         return m_numTiles;
     }
 
+    /**
+     * Returns true if at least one tile data object is
+     * currently swapped out
+     */
+    inline bool hasSwappedTiles() const {
+        return m_swappedStore.numTiles() > 0;
+    }
+
     inline void checkFreeMemory() {
         m_swapper.checkFreeMemory();
     }
@@ -106,9 +120,24 @@ public:
      * Try swap out the tile data.
      * It may fail in case the tile is being accessed
      * at the same moment of time.
+     *
+     * Should be called during the iteration only. The tile
+     * data is removed from the list immediately, but the actual
+     * compression and writing to the swap happen in endIteration()
+     * after the list lock is released.
      */
     bool trySwapTileData(KisTileData *td);
 
+    /**
+     * Asks the prefetcher thread to load \p td from the swap in
+     * background. The caller should take a reference to the tile
+     * data with KisTileData::ref() before calling this method, the
+     * reference is released by the prefetcher.
+     */
+    inline void prefetchTileData(KisTileData *td) {
+        m_prefetcher.prefetch(td);
+    }
+
 
     /**
      * WARN: The following three method are only for usage
@@ -138,6 +167,8 @@ private:
     void unregisterTileData(KisTileData *td);
     inline void registerTileDataImp(KisTileData *td);
     inline void unregisterTileDataImp(KisTileData *td);
+    void swapOutPendingTileData(const QVector<KisTileData*> &tileData);
+    void endIterationImpl();
     void freeRegisteredTiles();
 
     friend class DeadlockyThread;
@@ -154,6 +185,7 @@ private:
 private:
     KisTileDataPooler m_pooler;
     KisTileDataSwapper m_swapper;
+    KisTileDataPrefetcher m_prefetcher;
 
     friend class KisTileDataStoreTest;
     friend class KisTileDataPoolerTest;
@@ -163,6 +195,12 @@ private:
 
     QMutex m_listLock;
     KisTileDataList m_tileDataList;
+
+    /**
+     * Tile data objects detached from the list by trySwapTileData()
+     * during the current iteration. Protected by m_listLock.
+     */
+    QVector<KisTileData*> m_pendingSwapOut;
     qint32 m_numTiles;
 
     /**
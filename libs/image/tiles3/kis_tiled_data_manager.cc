@@ -20,6 +20,11 @@
 
 #include <QRect>
 #include <QVector>
+#include <QThread>
+#include <QBuffer>
+#include <QQueue>
+#include <QHash>
+#include <QtConcurrent>
 
 #include "kis_tile.h"
 #include "kis_tiled_data_manager.h"
@@ -28,6 +33,7 @@
 #include "kis_memento_manager.h"
 #include "swap/kis_legacy_tile_compressor.h"
 #include "swap/kis_tile_compressor_factory.h"
+#include "swap/kis_compression_factory.h"
 
 #include "kis_paint_device_writer.h"
 
@@ -106,39 +112,171 @@ void KisTiledDataManager::setDefaultPixelImpl(const quint8 *defaultPixel)
 }
 
 bool KisTiledDataManager::write(KisPaintDeviceWriter &store)
+{
+    return writeImpl(store, true);
+}
+
+bool KisTiledDataManager::writeImpl(KisPaintDeviceWriter &store, bool allowParallel)
 {
     QReadLocker locker(&m_lock);
 
     bool retval = true;
 
-    if(CURRENT_VERSION == LEGACY_VERSION) {
+    QString compressionName = store.tileCompression();
+    if (compressionName.isEmpty() ||
+        !KisCompressionFactory::isAvailable(compressionName)) {
+
+        compressionName = KisCompressionFactory::LZF;
+    }
+
+    const qint32 version =
+        compressionName == KisCompressionFactory::LZF ?
+        CURRENT_VERSION : CUSTOM_COMPRESSION_VERSION;
+
+    if(version == LEGACY_VERSION) {
         char str[80];
         sprintf(str, "%d\n", m_hashTable->numTiles());
         retval = store.write(str, strlen(str));
     }
     else {
-        retval = writeTilesHeader(store, m_hashTable->numTiles());
+        retval = writeTilesHeader(store, version, m_hashTable->numTiles());
     }
 
+    if (!retval) return false;
+
+    QVector<KisTileSP> tiles;
+    tiles.reserve(m_hashTable->numTiles());
 
     KisTileHashTableConstIterator iter(m_hashTable);
     KisTileSP tile;
 
+    while ((tile = iter.tile())) {
+        tiles.append(tile);
+        iter.next();
+    }
+
+    if (allowParallel &&
+        QThread::idealThreadCount() > 1 &&
+        tiles.size() > TILES_PER_WRITE_JOB) {
+
+        retval = writeTilesParallel(store, tiles, version, compressionName);
+    } else {
+        retval = writeTilesRange(store, tiles, 0, tiles.size(), version, compressionName);
+    }
+
+    return retval;
+}
+
+namespace {
+
+class KisByteArrayPaintDeviceWriter : public KisPaintDeviceWriter
+{
+public:
+    KisByteArrayPaintDeviceWriter(QByteArray *data)
+        : m_data(data)
+    {
+    }
+
+    bool write(const QByteArray &data) override {
+        m_data->append(data);
+        return true;
+    }
+
+    bool write(const char* data, qint64 length) override {
+        m_data->append(data, length);
+        return true;
+    }
+
+private:
+    QByteArray *m_data;
+};
+
+}
+
+bool KisTiledDataManager::writeTilesRange(KisPaintDeviceWriter &store,
+                                          const QVector<KisTileSP> &tiles,
+                                          int begin, int end,
+                                          qint32 version,
+                                          const QString &compressionName)
+{
     KisAbstractTileCompressorSP compressor =
-        KisTileCompressorFactory::create(CURRENT_VERSION);
+        KisTileCompressorFactory::create(version, compressionName);
 
-    while ((tile = iter.tile())) {
-        retval = compressor->writeTile(tile, store);
-        if (!retval) {
+    for (int i = begin; i < end; i++) {
+        if (!compressor->writeTile(tiles[i], store)) {
             warnFile << "Failed to write tile";
-            break;
+            return false;
         }
-        iter.next();
     }
 
-    return retval;
+    return true;
+}
+
+bool KisTiledDataManager::writeTilesParallel(KisPaintDeviceWriter &store,
+                                             const QVector<KisTileSP> &tiles,
+                                             qint32 version,
+                                             const QString &compressionName)
+{
+    /**
+     * The tiles are compressed by a set of jobs, each job writes
+     * its own range of tiles into a separate buffer. The buffers
+     * are then streamed into the store in the order of the ranges,
+     * so the result is exactly the same as the one of the
+     * sequential writing.
+     *
+     * To limit the memory overhead, the tiles are processed in
+     * batches of a few jobs per thread.
+     */
+    const int jobsPerBatch = 2 * QThread::idealThreadCount();
+    const int tilesPerBatch = jobsPerBatch * TILES_PER_WRITE_JOB;
+
+    for (int batchBegin = 0; batchBegin < tiles.size(); batchBegin += tilesPerBatch) {
+        const int batchEnd = qMin(batchBegin + tilesPerBatch, tiles.size());
+
+        QVector<QByteArray> buffers;
+        QVector<QFuture<bool>> jobs;
+
+        buffers.resize((batchEnd - batchBegin + TILES_PER_WRITE_JOB - 1) / TILES_PER_WRITE_JOB);
+        jobs.reserve(buffers.size());
+
+        for (int i = 0; i < buffers.size(); i++) {
+            const int jobBegin = batchBegin + i * TILES_PER_WRITE_JOB;
+            const int jobEnd = qMin(jobBegin + TILES_PER_WRITE_JOB, batchEnd);
+            QByteArray *buffer = &buffers[i];
+
+            jobs << QtConcurrent::run(
+                [this, &tiles, jobBegin, jobEnd, version, compressionName, buffer] () {
+                    KisByteArrayPaintDeviceWriter writer(buffer);
+                    return writeTilesRange(writer, tiles, jobBegin, jobEnd,
+                                           version, compressionName);
+                });
+        }
+
+        bool retval = true;
+
+        for (int i = 0; i < jobs.size(); i++) {
+            jobs[i].waitForFinished();
+
+            if (retval) {
+                retval = jobs[i].result() && store.write(buffers[i]);
+            }
+        }
+
+        if (!retval) {
+            warnFile << "Failed to write tiles";
+            return false;
+        }
+    }
+
+    return true;
 }
+
 bool KisTiledDataManager::read(QIODevice *stream)
+{
+    return readImpl(stream, true);
+}
+
+bool KisTiledDataManager::readImpl(QIODevice *stream, bool allowParallel)
 {
     clear();
 
@@ -172,21 +310,102 @@ bool KisTiledDataManager::read(QIODevice *stream)
         numTiles = line.toUInt();
     }
 
-    KisAbstractTileCompressorSP compressor =
-        KisTileCompressorFactory::create(tilesVersion);
+    bool readSuccess = true;
+
+    if (allowParallel &&
+        tilesVersion != LEGACY_VERSION &&
+        QThread::idealThreadCount() > 1 &&
+        numTiles > quint32(TILES_PER_READ_JOB)) {
+
+        readSuccess = readTilesParallel(stream, numTiles, tilesVersion);
+
+    } else {
+        KisAbstractTileCompressorSP compressor =
+            KisTileCompressorFactory::create(tilesVersion);
+
+        for (quint32 i = 0; i < numTiles; i++) {
+            if (!compressor->readTile(stream, this)) {
+                readSuccess = false;
+            }
+        }
+    }
+
+    m_mementoManager->commit();
+    return readSuccess;
+}
 
+bool KisTiledDataManager::readTilesParallel(QIODevice *stream, quint32 numTiles, qint32 version)
+{
+    /**
+     * The stream can be read only sequentially, so the raw tiles are
+     * read on the calling thread and passed to the jobs on the global
+     * thread pool, which decompress them while the following tiles
+     * are still being read.
+     *
+     * The number of jobs in flight is limited to keep the amount of
+     * compressed data held in memory low.
+     */
+    const int maxJobsInFlight = 2 * QThread::idealThreadCount();
+
+    KisAbstractTileCompressorSP rawReader =
+        KisTileCompressorFactory::create(version);
+
+    QQueue<QFuture<bool>> jobs;
     bool readSuccess = true;
-    for (quint32 i = 0; i < numTiles; i++) {
-        if (!compressor->readTile(stream, this)) {
+
+    quint32 i = 0;
+    while (i < numTiles) {
+        QVector<QByteArray> rawTiles;
+        rawTiles.reserve(TILES_PER_READ_JOB);
+
+        for (; i < numTiles && rawTiles.size() < TILES_PER_READ_JOB; i++) {
+            QByteArray rawTile;
+
+            if (!rawReader->readRawTile(stream, rawTile)) {
+                readSuccess = false;
+                continue;
+            }
+
+            rawTiles.append(rawTile);
+        }
+
+        while (jobs.size() >= maxJobsInFlight) {
+            if (!jobs.dequeue().result()) {
+                readSuccess = false;
+            }
+        }
+
+        jobs.enqueue(QtConcurrent::run(
+            [this, rawTiles, version] () {
+                KisAbstractTileCompressorSP compressor =
+                    KisTileCompressorFactory::create(version);
+
+                bool result = true;
+
+                Q_FOREACH (const QByteArray &rawTile, rawTiles) {
+                    QBuffer buffer;
+                    buffer.setData(rawTile);
+                    buffer.open(QIODevice::ReadOnly);
+
+                    if (!compressor->readTile(&buffer, this)) {
+                        result = false;
+                    }
+                }
+
+                return result;
+            }));
+    }
+
+    while (!jobs.isEmpty()) {
+        if (!jobs.dequeue().result()) {
             readSuccess = false;
         }
     }
 
-    m_mementoManager->commit();
     return readSuccess;
 }
 
-bool KisTiledDataManager::writeTilesHeader(KisPaintDeviceWriter &store, quint32 numTiles)
+bool KisTiledDataManager::writeTilesHeader(KisPaintDeviceWriter &store, qint32 version, quint32 numTiles)
 {
     QString buffer;
 
@@ -195,7 +414,7 @@ bool KisTiledDataManager::writeTilesHeader(KisPaintDeviceWriter &store, quint32
                      "TILEHEIGHT %3\n"
                      "PIXELSIZE %4\n"
                      "DATA %5\n")
-        .arg(CURRENT_VERSION)
+        .arg(version)
         .arg(KisTileData::WIDTH)
         .arg(KisTileData::HEIGHT)
         .arg(pixelSize())
@@ -271,8 +490,10 @@ wrongString:
 void KisTiledDataManager::purge(const QRect& area)
 {
     QList<KisTileSP> tilesToDelete;
+    QList<QPair<KisTileSP, QByteArray>> uniformTiles;
     {
-        const qint32 tileDataSize = KisTileData::HEIGHT * KisTileData::WIDTH * pixelSize();
+        const qint32 pixelSize = this->pixelSize();
+        const qint32 tileDataSize = KisTileData::HEIGHT * KisTileData::WIDTH * pixelSize;
         KisTileData *tileData = m_hashTable->defaultTileData();
         tileData->blockSwapping();
         const quint8 *defaultData = tileData->data();
@@ -283,8 +504,20 @@ void KisTiledDataManager::purge(const QRect& area)
         while ((tile = iter.tile())) {
             if (tile->extent().intersects(area)) {
                 tile->lockForRead();
-                if(memcmp(defaultData, tile->data(), tileDataSize) == 0) {
+                const quint8 *data = tile->data();
+
+                if(memcmp(defaultData, data, tileDataSize) == 0) {
                     tilesToDelete.push_back(tile);
+                } else if (tile->tileData()->isUniform() ||
+                           // all the pixels are equal iff the data is periodic with the period of one pixel
+                           memcmp(data, data + pixelSize, tileDataSize - pixelSize) == 0) {
+
+                    /**
+                     * The flag is set while the tile is still locked,
+                     * so a writer coming after us will surely drop it
+                     */
+                    tile->tileData()->setUniform(true);
+                    uniformTiles.push_back(qMakePair(tile, QByteArray(reinterpret_cast<const char*>(data), pixelSize)));
                 }
                 tile->unlock();
             }
@@ -297,6 +530,83 @@ void KisTiledDataManager::purge(const QRect& area)
         m_extentManager.notifyTileRemoved(tile->col(), tile->row());
         m_hashTable->deleteTile(tile);
     }
+
+    /**
+     * Make all the uniform tiles of the same color share a single tile
+     * data. Writing into any of them will just detach it as usual.
+     */
+    QHash<QByteArray, KisTileData*> sharedTileData;
+
+    for (auto it = uniformTiles.begin(); it != uniformTiles.end(); ++it) {
+        KisTileSP tile = it->first;
+        KisTileData *td = tile->tileData();
+
+        // the tile has been written into after we checked it
+        if (!td->isUniform()) continue;
+
+        auto sharedIt = sharedTileData.find(it->second);
+
+        if (sharedIt == sharedTileData.end()) {
+            sharedTileData.insert(it->second, td);
+        } else if (*sharedIt != td) {
+            m_hashTable->deleteTile(tile);
+            KisTileSP sharedTile = KisTileSP(new KisTile(tile->col(), tile->row(), *sharedIt, m_mementoManager));
+            m_hashTable->addTile(sharedTile);
+        }
+    }
+}
+
+bool KisTiledDataManager::fetchUniformPixel(KisTileSP tile, quint8 *pixel) const
+{
+    tile->lockForRead();
+
+    const bool isUniform = tile->tileData()->isUniform();
+    if (isUniform) {
+        memcpy(pixel, tile->data(), pixelSize());
+    }
+
+    tile->unlock();
+
+    return isUniform;
+}
+
+bool KisTiledDataManager::tryGetUniformPixel(qint32 x, qint32 y, quint8 *pixel, bool useOldData)
+{
+    const qint32 column = xToCol(x);
+    const qint32 row = yToRow(y);
+
+    bool unused;
+    KisTileSP tile = useOldData ?
+        getOldTile(column, row, unused) :
+        getReadOnlyTileLazy(column, row, unused);
+
+    return fetchUniformPixel(tile, pixel);
+}
+
+void KisTiledDataManager::prefetchTiles(const QRect &rect)
+{
+    KisTileDataStore *store = KisTileDataStore::instance();
+    if (!store->hasSwappedTiles() || rect.isEmpty()) return;
+
+    const qint32 firstColumn = xToCol(rect.left());
+    const qint32 firstRow = yToRow(rect.top());
+    const qint32 lastColumn = xToCol(rect.right());
+    const qint32 lastRow = yToRow(rect.bottom());
+
+    for (qint32 row = firstRow; row <= lastRow; row++) {
+        for (qint32 column = firstColumn; column <= lastColumn; column++) {
+            KisTileSP tile = m_hashTable->getExistingTile(column, row);
+            if (!tile) continue;
+
+            KisTileData *td = tile->referenceTileData();
+
+            if (!td->data()) {
+                store->prefetchTileData(td);
+            } else {
+                td->deref();
+            }
+        }
+    }
 }
 
 quint8* KisTiledDataManager::duplicatePixel(qint32 num, const quint8 *pixel)
@@ -446,6 +756,9 @@ void KisTiledDataManager::bitBltImpl(KisTiledDataManager *srcDM, const QRect &re
 
     const quint32 rowStride = KisTileData::WIDTH * pixelSize;
 
+    QByteArray srcPixel(pixelSize, 0);
+    QByteArray dstPixel(pixelSize, 0);
+
     qint32 firstColumn = xToCol(rect.left());
     qint32 lastColumn = xToCol(rect.right());
 
@@ -487,6 +800,22 @@ void KisTiledDataManager::bitBltImpl(KisTiledDataManager *srcDM, const QRect &re
                  }
 
             } else {
+                if (srcTile->tileData()->isUniform()) {
+                    /**
+                     * Copying a uniform tile into a tile of the same
+                     * color changes nothing, so don't detach it
+                     */
+                    bool unused;
+                    KisTileSP dstTile = getReadOnlyTileLazy(column, row, unused);
+
+                    if (fetchUniformPixel(srcTile, srcPixel.data()) &&
+                        fetchUniformPixel(dstTile, dstPixel.data()) &&
+                        srcPixel == dstPixel) {
+
+                        continue;
+                    }
+                }
+
                 const qint32 lineSize = cloneTileRect.width() * pixelSize;
                 qint32 rowsRemaining = cloneTileRect.height();
 
@@ -680,6 +1009,119 @@ QRegion KisTiledDataManager::region() const
     return region;
 }
 
+KisTiledDataManager::TileDataSnapshot::TileDataSnapshot()
+{
+}
+
+KisTiledDataManager::TileDataSnapshot::~TileDataSnapshot()
+{
+    clear();
+}
+
+void KisTiledDataManager::TileDataSnapshot::clear()
+{
+    Q_FOREACH (KisTileData *td, m_tiles) {
+        td->release();
+    }
+    m_tiles.clear();
+}
+
+bool KisTiledDataManager::TileDataSnapshot::isEmpty() const
+{
+    return m_tiles.isEmpty();
+}
+
+void KisTiledDataManager::takeTileDataSnapshot(TileDataSnapshot *snapshot) const
+{
+    QReadLocker locker(&m_lock);
+
+    snapshot->clear();
+
+    KisTileHashTableConstIterator iter(m_hashTable);
+    KisTileSP tile;
+
+    while ((tile = iter.tile())) {
+        /**
+         * Acquiring the tile data makes it shared, so the next write
+         * will detach the tile from it
+         */
+        KisTileData *td = tile->tileData();
+        td->acquire();
+        snapshot->m_tiles.insert(TileDataSnapshot::key(tile->col(), tile->row()), td);
+
+        iter.next();
+    }
+}
+
+QRegion KisTiledDataManager::regionChangedSince(const TileDataSnapshot &snapshot) const
+{
+    QReadLocker locker(&m_lock);
+
+    QRegion region;
+    int numUnchangedTiles = 0;
+
+    {
+        KisTileHashTableConstIterator iter(m_hashTable);
+        KisTileSP tile;
+
+        while ((tile = iter.tile())) {
+            KisTileData *td = snapshot.m_tiles.value(TileDataSnapshot::key(tile->col(), tile->row()), 0);
+
+            if (td == tile->tileData()) {
+                numUnchangedTiles++;
+            } else {
+                region += tile->extent();
+            }
+
+            iter.next();
+        }
+    }
+
+    // some of the tiles have been removed from the data manager
+    if (numUnchangedTiles < snapshot.m_tiles.size()) {
+        for (auto it = snapshot.m_tiles.constBegin(); it != snapshot.m_tiles.constEnd(); ++it) {
+            const qint32 col = qint32(it.key() >> 32);
+            const qint32 row = qint32(it.key() & 0xFFFFFFFF);
+
+            if (!m_hashTable->tileExists(col, row)) {
+                region += QRect(col * KisTileData::WIDTH, row * KisTileData::HEIGHT,
+                                KisTileData::WIDTH, KisTileData::HEIGHT);
+            }
+        }
+    }
+
+    return region;
+}
+
+QRegion KisTiledDataManager::regionChangedSince(const TileDataSnapshot &oldSnapshot,
+                                                const TileDataSnapshot &newSnapshot)
+{
+    QRegion region;
+
+    auto addTile = [&region] (quint64 key) {
+        const qint32 col = qint32(key >> 32);
+        const qint32 row = qint32(key & 0xFFFFFFFF);
+
+        region += QRect(col * KisTileData::WIDTH, row * KisTileData::HEIGHT,
+                        KisTileData::WIDTH, KisTileData::HEIGHT);
+    };
+
+    for (auto it = newSnapshot.m_tiles.constBegin(); it != newSnapshot.m_tiles.constEnd(); ++it) {
+        if (oldSnapshot.m_tiles.value(it.key(), 0) != it.value()) {
+            addTile(it.key());
+        }
+    }
+
+    // some of the tiles have been removed from the data manager
+    for (auto it = oldSnapshot.m_tiles.constBegin(); it != oldSnapshot.m_tiles.constEnd(); ++it) {
+        if (!newSnapshot.m_tiles.contains(it.key())) {
+            addTile(it.key());
+        }
+    }
+
+    return region;
+}
+
 void KisTiledDataManager::setPixel(qint32 x, qint32 y, const quint8 * data)
 {
     KisTileDataWrapper tw(this, x, y, KisTileDataWrapper::WRITE);
@@ -22,6 +22,7 @@
 #include <QtGlobal>
 #include <QVector>
 #include <QRegion>
+#include <QHash>
 
 #include <kis_shared.h>
 #include <kis_shared_ptr.h>
@@ -43,6 +44,8 @@
 class KisTiledDataManager;
 typedef KisSharedPtr<KisTiledDataManager> KisTiledDataManagerSP;
 
+class KisTileData;
+
 class KisTiledIterator;
 class KisTiledRandomAccessor;
 class KisPaintDeviceWriter;
@@ -70,6 +73,25 @@ private:
     static const qint32 LEGACY_VERSION = 1;
     static const qint32 CURRENT_VERSION = 2;
 
+    /**
+     * The tiles are written with a compression algorithm other than
+     * LZF. We write CURRENT_VERSION whenever possible, so that the
+     * files could still be opened by older versions of Krita.
+     */
+    static const qint32 CUSTOM_COMPRESSION_VERSION = 3;
+
+    /**
+     * The number of tiles compressed by a single job when the
+     * tiles are written in parallel
+     */
+    static const int TILES_PER_WRITE_JOB = 64;
+
+    /**
+     * The number of tiles decompressed by a single job when the
+     * tiles are read in parallel
+     */
+    static const int TILES_PER_READ_JOB = 64;
+
 protected:
     /*FIXME:*/
 public:
@@ -87,6 +109,7 @@ protected:
     friend class KisTiledRandomAccessor;
     friend class KisRandomAccessor2;
     friend class KisStressJob;
+    friend class KisTiledDataManagerTest;
 
 public:
     void setDefaultPixel(const quint8 *defPixel);
@@ -211,6 +234,11 @@ protected:
     bool write(KisPaintDeviceWriter &store);
     bool read(QIODevice *stream);
 
+    /**
+     * Drops the tiles in \p area filled with the default pixel. The
+     * tiles filled with any other single color are marked as uniform
+     * and made to share the same tile data through copy-on-write.
+     */
     void purge(const QRect& area);
 
     inline quint32 pixelSize() const {
@@ -228,6 +256,59 @@ public:
 
     QRegion region() const;
 
+    /**
+     * Keeps references to the tile data of all the tiles of a data
+     * manager. While the snapshot is alive, the referenced tile data
+     * stays shared, so any write into a tile detaches it through
+     * copy-on-write. Comparing the snapshot with the data manager
+     * later tells exactly which tiles have been changed since then.
+     *
+     * The snapshot does not keep any pixel data alive by itself, but
+     * every tile written after the snapshot has been taken keeps its
+     * older version in memory until the snapshot is cleared.
+     */
+    class KRITAIMAGE_EXPORT TileDataSnapshot
+    {
+    public:
+        TileDataSnapshot();
+        ~TileDataSnapshot();
+
+        void clear();
+        bool isEmpty() const;
+
+    private:
+        Q_DISABLE_COPY(TileDataSnapshot)
+        friend class KisTiledDataManager;
+
+        static inline quint64 key(qint32 col, qint32 row) {
+            return (quint64(quint32(col)) << 32) | quint32(row);
+        }
+
+        QHash<quint64, KisTileData*> m_tiles;
+    };
+
+    /**
+     * Replaces the content of \p snapshot with the references to the
+     * current tiles of the data manager
+     */
+    void takeTileDataSnapshot(TileDataSnapshot *snapshot) const;
+
+    /**
+     * \return the region covered by the tiles that have been written,
+     * added or removed since \p snapshot was taken. Changes of the
+     * default pixel are not tracked.
+     */
+    QRegion regionChangedSince(const TileDataSnapshot &snapshot) const;
+
+    /**
+     * \return the region covered by the tiles that differ between
+     * \p oldSnapshot and \p newSnapshot. Unlike comparing a snapshot
+     * with the live tiles, it doesn't miss the writes that happen
+     * between computing the region and taking the new snapshot.
+     */
+    static QRegion regionChangedSince(const TileDataSnapshot &oldSnapshot,
+                                      const TileDataSnapshot &newSnapshot);
+
     void clear(QRect clearRect, quint8 clearValue);
     void clear(QRect clearRect, const quint8 *clearPixel);
     void clear(qint32 x, qint32 y, qint32 w, qint32 h, quint8 clearValue);
@@ -261,6 +342,25 @@ public:
      */
     void bitBltRoughOldData(KisTiledDataManager *srcDM, const QRect &rect);
 
+    /**
+     * Hints the tile store that the tiles covering \p rect are going
+     * to be accessed soon. The tiles that are currently swapped out
+     * will be loaded into memory by a background thread. Nothing is
+     * done if there are no swapped tiles at all, so the call is cheap.
+     */
+    void prefetchTiles(const QRect &rect);
+
+    /**
+     * Checks whether the tile containing pixel (\p x, \p y) is known to
+     * be filled with a single color. If it is, the color is copied into
+     * \p pixel. The tiles that have never been written to are always
+     * uniform, as well as the tiles shared by clear() and purge().
+     *
+     * \param useOldData check the tile of the last committed revision
+     *                   instead of the current one
+     */
+    bool tryGetUniformPixel(qint32 x, qint32 y, quint8 *pixel, bool useOldData = false);
+
     /**
      * write the specified data to x, y. There is no checking on pixelSize!
      */
@@ -353,15 +453,53 @@ private:
 private:
     void setDefaultPixelImpl(const quint8 *defPixel);
 
-    bool writeTilesHeader(KisPaintDeviceWriter &store, quint32 numTiles);
+    bool writeTilesHeader(KisPaintDeviceWriter &store, qint32 version, quint32 numTiles);
+
+    /**
+     * Writes the tiles into \p store. The tiles are compressed in
+     * parallel only when \p allowParallel is true, otherwise all the
+     * work is done in the calling thread (used by the unittests to
+     * check that both paths produce the same stream).
+     */
+    bool writeImpl(KisPaintDeviceWriter &store, bool allowParallel);
+
+    bool writeTilesRange(KisPaintDeviceWriter &store,
+                         const QVector<KisTileSP> &tiles,
+                         int begin, int end,
+                         qint32 version,
+                         const QString &compressionName);
+
+    /**
+     * Compresses the tiles on the global thread pool and writes
+     * them into \p store in the same order as writeTilesRange()
+     * would do, so the resulting stream is byte-identical
+     */
+    bool writeTilesParallel(KisPaintDeviceWriter &store,
+                            const QVector<KisTileSP> &tiles,
+                            qint32 version,
+                            const QString &compressionName);
     bool processTilesHeader(QIODevice *stream, quint32 &numTiles);
 
+    /**
+     * Reads the tiles from \p stream. The tiles are decompressed in
+     * parallel only when \p allowParallel is true (see writeImpl())
+     */
+    bool readImpl(QIODevice *stream, bool allowParallel);
+
+    /**
+     * Reads the raw tiles from \p stream sequentially and decompresses
+     * them on the global thread pool
+     */
+    bool readTilesParallel(QIODevice *stream, quint32 numTiles, qint32 version);
+
     qint32 divideRoundDown(qint32 x, const qint32 y) const;
 
     void recalculateExtent();
 
     quint8* duplicatePixel(qint32 num, const quint8 *pixel);
 
+    bool fetchUniformPixel(KisTileSP tile, quint8 *pixel) const;
+
     template<bool useOldSrcData>
         void bitBltImpl(KisTiledDataManager *srcDM, const QRect &rect);
     template<bool useOldSrcData>
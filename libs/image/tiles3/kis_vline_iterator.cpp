@@ -66,6 +66,7 @@ KisVLineIterator2::KisVLineIterator2(KisDataManager *dataManager, qint32 x, qint
     for (int i = 0; i < m_tilesCacheSize; i++){
         fetchTileDataForCache(m_tilesCache[i], m_column, m_topRow + i);
     }
+    prefetchNextTiles();
     m_index = 0;
     switchToTile(m_topInTopmostTile);
 }
@@ -221,6 +222,17 @@ void KisVLineIterator2::preallocateTiles()
         unlockTile(m_tilesCache[i].oldtile);
         fetchTileDataForCache(m_tilesCache[i], m_column, m_topRow + i );
     }
+    prefetchNextTiles();
+}
+
+void KisVLineIterator2::prefetchNextTiles()
+{
+    /**
+     * Ask the store to bring the next column of tiles from the swap
+     * while we are busy with the current one
+     */
+    m_dataManager->prefetchTiles(QRect((m_column + 1) * KisTileData::WIDTH, m_top,
+                                       KisTileData::WIDTH, m_bottom - m_top + 1));
 }
 
 qint32 KisVLineIterator2::x() const
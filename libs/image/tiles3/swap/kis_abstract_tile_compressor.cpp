@@ -25,3 +25,10 @@ KisAbstractTileCompressor::KisAbstractTileCompressor()
 KisAbstractTileCompressor::~KisAbstractTileCompressor()
 {
 }
+
+bool KisAbstractTileCompressor::readRawTile(QIODevice *stream, QByteArray &rawTile)
+{
+    Q_UNUSED(stream);
+    Q_UNUSED(rawTile);
+    return false;
+}
@@ -55,6 +55,17 @@ public:
      */
     virtual bool readTile(QIODevice *stream, KisTiledDataManager *dm) = 0;
 
+    /**
+     * Reads the header and the compressed data of the next tile from
+     * the \a stream into \a rawTile without decompressing it. The
+     * raw tile can be decompressed later (possibly in another thread)
+     * by passing it to readTile() wrapped into a QBuffer.
+     *
+     * The default implementation returns false, which means the
+     * compressor doesn't support reading of raw tiles
+     */
+    virtual bool readRawTile(QIODevice *stream, QByteArray &rawTile);
+
     /**
      * Compresses a \a tileData and writes it into the \a buffer.
      * The buffer must be at least tileDataBufferSize() bytes long.
@@ -45,13 +45,26 @@ KisChunkAllocator::~KisChunkAllocator()
 }
 
 KisChunk KisChunkAllocator::getChunk(quint64 size)
+{
+    KisChunk chunk;
+
+    if (!tryGetChunk(size, chunk)) {
+        qFatal("KisChunkAllocator: out of swap space");
+    }
+
+    return chunk;
+}
+
+bool KisChunkAllocator::tryGetChunk(quint64 size, KisChunk &chunk)
 {
     KisChunkDataListIterator startPosition = m_iterator;
     START_COUNTING();
 
     forever {
-        if(tryInsertChunk(m_list, m_iterator, size))
-            return WRAP_PREVIOUS_CHUNK_DATA(m_iterator);
+        if(tryInsertChunk(m_list, m_iterator, size)) {
+            chunk = WRAP_PREVIOUS_CHUNK_DATA(m_iterator);
+            return true;
+        }
 
         if(m_iterator == m_list.end())
             break;
@@ -64,8 +77,10 @@ KisChunk KisChunkAllocator::getChunk(quint64 size)
     m_iterator = m_list.begin();
 
     forever {
-        if(tryInsertChunk(m_list, m_iterator, size))
-            return WRAP_PREVIOUS_CHUNK_DATA(m_iterator);
+        if(tryInsertChunk(m_list, m_iterator, size)) {
+            chunk = WRAP_PREVIOUS_CHUNK_DATA(m_iterator);
+            return true;
+        }
 
         if(m_iterator == m_list.end() || m_iterator == startPosition)
             break;
@@ -77,15 +92,16 @@ KisChunk KisChunkAllocator::getChunk(quint64 size)
     REGISTER_FAIL();
     m_iterator = m_list.end();
 
-    while ((m_storeSize += m_storeSlabSize) <= m_storeMaxSize) {
-        if(tryInsertChunk(m_list, m_iterator, size))
-            return WRAP_PREVIOUS_CHUNK_DATA(m_iterator);
-    }
+    while (m_storeSize + m_storeSlabSize <= m_storeMaxSize) {
+        m_storeSize += m_storeSlabSize;
 
-    qFatal("KisChunkAllocator: out of swap space");
+        if(tryInsertChunk(m_list, m_iterator, size)) {
+            chunk = WRAP_PREVIOUS_CHUNK_DATA(m_iterator);
+            return true;
+        }
+    }
 
-    // just let gcc be happy! :)
-    return KisChunk(m_list.end());
+    return false;
 }
 
 bool KisChunkAllocator::tryInsertChunk(KisChunkDataList &list,
@@ -92,10 +92,11 @@ public:
 class KisChunk
 {
 public:
-    KisChunk() {}
+    KisChunk() : m_shardIndex(0) {}
 
     KisChunk(KisChunkDataListIterator iterator)
-        : m_iterator(iterator)
+        : m_iterator(iterator),
+          m_shardIndex(0)
     {
     }
 
@@ -119,8 +120,23 @@ public:
         return *m_iterator;
     }
 
+    /**
+     * The index of the allocator (shard) the chunk belongs to.
+     * The allocator itself doesn't know anything about sharding,
+     * the index is assigned by the owner of the allocators
+     * (see KisSwappedDataStore).
+     */
+    inline int shardIndex() const {
+        return m_shardIndex;
+    }
+
+    inline void setShardIndex(int index) {
+        m_shardIndex = index;
+    }
+
 private:
     KisChunkDataListIterator m_iterator;
+    int m_shardIndex;
 };
 
 
@@ -136,6 +152,13 @@ public:
     }
 
     KisChunk getChunk(quint64 size);
+
+    /**
+     * The same as getChunk(), but returns false instead of crashing
+     * when the store has reached its hard limit
+     */
+    bool tryGetChunk(quint64 size, KisChunk &chunk);
+
     void freeChunk(KisChunk chunk);
 
     void debugChunks();
@@ -0,0 +1,78 @@
+/*
+ *  Copyright (c) 2019 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_compression_factory.h"
+
+#include <config-tile-compression.h>
+
+#include "kis_lzf_compression.h"
+
+#ifdef HAVE_LZ4
+#include "kis_lz4_compression.h"
+#endif
+
+#ifdef HAVE_ZSTD
+#include "kis_zstd_compression.h"
+#endif
+
+const QString KisCompressionFactory::LZF = "LZF";
+const QString KisCompressionFactory::LZ4 = "LZ4";
+const QString KisCompressionFactory::ZSTD = "ZSTD";
+
+
+KisAbstractCompression* KisCompressionFactory::create(const QString &name)
+{
+    if (name == LZF) {
+        return new KisLzfCompression();
+    }
+
+#ifdef HAVE_LZ4
+    if (name == LZ4) {
+        return new KisLz4Compression();
+    }
+#endif
+
+#ifdef HAVE_ZSTD
+    if (name == ZSTD) {
+        return new KisZstdCompression();
+    }
+#endif
+
+    return 0;
+}
+
+bool KisCompressionFactory::isAvailable(const QString &name)
+{
+    return availableCompressions().contains(name);
+}
+
+QStringList KisCompressionFactory::availableCompressions()
+{
+    QStringList result;
+    result << LZF;
+
+#ifdef HAVE_LZ4
+    result << LZ4;
+#endif
+
+#ifdef HAVE_ZSTD
+    result << ZSTD;
+#endif
+
+    return result;
+}
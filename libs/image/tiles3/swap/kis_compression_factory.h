@@ -0,0 +1,55 @@
+/*
+ *  Copyright (c) 2019 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_COMPRESSION_FACTORY_H
+#define __KIS_COMPRESSION_FACTORY_H
+
+#include "kritaimage_export.h"
+#include <QStringList>
+
+class KisAbstractCompression;
+
+/**
+ * Creates compression algorithms by their names. The names are
+ * written into the headers of the tiles in .kra files, so they
+ * must never be changed.
+ *
+ * LZF is always available, LZ4 and ZSTD are available only if
+ * Krita has been built with the corresponding libraries.
+ */
+class KRITAIMAGE_EXPORT KisCompressionFactory
+{
+public:
+    static const QString LZF;
+    static const QString LZ4;
+    static const QString ZSTD;
+
+    /**
+     * Creates a new compression object or returns null if the
+     * compression \p name is not supported by this build
+     */
+    static KisAbstractCompression* create(const QString &name);
+
+    static bool isAvailable(const QString &name);
+    static QStringList availableCompressions();
+
+private:
+    KisCompressionFactory();
+};
+
+#endif /* __KIS_COMPRESSION_FACTORY_H */
@@ -23,9 +23,10 @@
 
 #define SWP_PREFIX "KRITA_SWAP_FILE_XXXXXX"
 
-KisMemoryWindow::KisMemoryWindow(const QString &swapDir, quint64 writeWindowSize)
-    : m_readWindowEx(writeWindowSize / 4),
-      m_writeWindowEx(writeWindowSize)
+KisMemoryWindow::KisMemoryWindow(const QString &swapDir, quint64 writeWindowSize, int numReadWindows)
+    : m_readWindows(qMax(1, numReadWindows), MappingWindow(writeWindowSize / 4)),
+      m_writeWindowEx(writeWindowSize),
+      m_accessCounter(0)
 {
     m_valid = true;
 
@@ -61,90 +62,151 @@ KisMemoryWindow::~KisMemoryWindow()
 
 quint8* KisMemoryWindow::getReadChunkPtr(const KisChunkData &readChunk)
 {
-    if (!adjustWindow(readChunk, &m_readWindowEx, &m_writeWindowEx)) {
+    m_accessCounter++;
+
+    /**
+     * The chunk could have been written recently, so the write
+     * window may still hold it
+     */
+    if (m_writeWindowEx.contains(readChunk)) {
+        m_statistics.hits++;
+        return m_writeWindowEx.calculatePointer(readChunk);
+    }
+
+    MappingWindow *victim = &m_readWindows[0];
+
+    for (int i = 0; i < m_readWindows.size(); i++) {
+        MappingWindow *window = &m_readWindows[i];
+
+        if (window->contains(readChunk)) {
+            window->lastAccess = m_accessCounter;
+            m_statistics.hits++;
+            return window->calculatePointer(readChunk);
+        }
+
+        if (victim->window &&
+            (!window->window || window->lastAccess < victim->lastAccess)) {
+
+            victim = window;
+        }
+    }
+
+    m_statistics.misses++;
+
+    if (!adjustWindow(readChunk, victim)) {
         return nullptr;
     }
 
-    return m_readWindowEx.calculatePointer(readChunk);
+    victim->lastAccess = m_accessCounter;
+    return victim->calculatePointer(readChunk);
 }
 
 quint8* KisMemoryWindow::getWriteChunkPtr(const KisChunkData &writeChunk)
 {
-    if (!adjustWindow(writeChunk, &m_writeWindowEx, &m_readWindowEx)) {
-        return nullptr;
+    if (m_writeWindowEx.contains(writeChunk)) {
+        m_statistics.hits++;
+    } else {
+        m_statistics.misses++;
+
+        if (!adjustWindow(writeChunk, &m_writeWindowEx)) {
+            return nullptr;
+        }
     }
 
     return m_writeWindowEx.calculatePointer(writeChunk);
 }
 
+KisMemoryWindow::Statistics KisMemoryWindow::statistics() const
+{
+    return m_statistics;
+}
+
+void KisMemoryWindow::unmapWindow(MappingWindow *window)
+{
+    if (window->window) {
+        m_file.unmap(window->window);
+        window->window = 0;
+        m_statistics.mappedSize -= window->chunk.size();
+    }
+}
+
 bool KisMemoryWindow::adjustWindow(const KisChunkData &requestedChunk,
-                                   MappingWindow *adjustingWindow,
-                                   MappingWindow *otherWindow)
+                                   MappingWindow *adjustingWindow)
 {
-    if(!(adjustingWindow->window) ||
-       !(requestedChunk.m_begin >= adjustingWindow->chunk.m_begin &&
-         requestedChunk.m_end <= adjustingWindow->chunk.m_end))
-    {
-        m_file.unmap(adjustingWindow->window);
-
-        quint64 windowSize = adjustingWindow->defaultSize;
-        if(requestedChunk.size() > windowSize) {
-            warnKrita <<
-                "KisMemoryWindow: the requested chunk is too "
-                "big to fit into the mapping! "
-                "Adjusting mapping to avoid SIGSEGV...";
-
-            windowSize = requestedChunk.size();
-        }
+    unmapWindow(adjustingWindow);
+
+    quint64 windowSize = adjustingWindow->defaultSize;
+    if(requestedChunk.size() > windowSize) {
+        warnKrita <<
+            "KisMemoryWindow: the requested chunk is too "
+            "big to fit into the mapping! "
+            "Adjusting mapping to avoid SIGSEGV...";
+
+        windowSize = requestedChunk.size();
+    }
 
-        adjustingWindow->chunk.setChunk(requestedChunk.m_begin, windowSize);
+    adjustingWindow->chunk.setChunk(requestedChunk.m_begin, windowSize);
 
-        if(adjustingWindow->chunk.m_end >= (quint64)m_file.size()) {
-            // Align by 32 bytes
-            quint64 newSize = (adjustingWindow->chunk.m_end + 1 + 32) & (~31ULL);
+    if(adjustingWindow->chunk.m_end >= (quint64)m_file.size()) {
+        // Align by 32 bytes
+        quint64 newSize = (adjustingWindow->chunk.m_end + 1 + 32) & (~31ULL);
 
 #ifdef Q_OS_WIN32
-            /**
-             * Workaround for Qt's "feature"
-             *
-             * On windows QFSEnginePrivate caches the value of
-             * mapHandle which is limited to the size of the file at
-             * the moment of its (handle's) creation. That is we will
-             * not be able to use it after resizing the file.  The
-             * only way to free the handle is to release all the
-             * mappings we have. Sad but true.
-             */
-            if (otherWindow->chunk.size()) {
-                m_file.unmap(otherWindow->window);
+        /**
+         * Workaround for Qt's "feature"
+         *
+         * On windows QFSEnginePrivate caches the value of
+         * mapHandle which is limited to the size of the file at
+         * the moment of its (handle's) creation. That is we will
+         * not be able to use it after resizing the file.  The
+         * only way to free the handle is to release all the
+         * mappings we have. Sad but true.
+         */
+        QVector<MappingWindow*> otherWindows;
+
+        if (m_writeWindowEx.window) {
+            otherWindows << &m_writeWindowEx;
+        }
+
+        for (int i = 0; i < m_readWindows.size(); i++) {
+            if (m_readWindows[i].window) {
+                otherWindows << &m_readWindows[i];
             }
-#else
-            Q_UNUSED(otherWindow);
+        }
+
+        Q_FOREACH (MappingWindow *window, otherWindows) {
+            m_file.unmap(window->window);
+        }
 #endif
 
-            if (!m_file.resize(newSize)) {
-                return false;
-            }
+        if (!m_file.resize(newSize)) {
+            return false;
+        }
 
 #ifdef Q_OS_WIN32
-            if (otherWindow->chunk.size()) {
-                otherWindow->window = m_file.map(otherWindow->chunk.m_begin,
-                                                 otherWindow->chunk.size());
+        Q_FOREACH (MappingWindow *window, otherWindows) {
+            window->window = m_file.map(window->chunk.m_begin,
+                                        window->chunk.size());
+            if (!window->window) {
+                m_statistics.mappedSize -= window->chunk.size();
             }
-#endif
         }
+#endif
+    }
 
 #ifdef Q_OS_UNIX
-        // A workaround for https://bugreports.qt-project.org/browse/QTBUG-6330
-        m_file.exists();
+    // A workaround for https://bugreports.qt-project.org/browse/QTBUG-6330
+    m_file.exists();
 #endif
 
-        adjustingWindow->window = m_file.map(adjustingWindow->chunk.m_begin,
-                                             adjustingWindow->chunk.size());
+    adjustingWindow->window = m_file.map(adjustingWindow->chunk.m_begin,
+                                         adjustingWindow->chunk.size());
 
-        if (!adjustingWindow->window) {
-            return false;
-        }
+    if (!adjustingWindow->window) {
+        return false;
     }
 
-	return true;
+    m_statistics.mappedSize += adjustingWindow->chunk.size();
+
+    return true;
 }
@@ -20,19 +20,64 @@
 #define __KIS_MEMORY_WINDOW_H
 
 #include <QTemporaryFile>
+#include <QVector>
 
 #include "kis_chunk_allocator.h"
 
 
 #define DEFAULT_WINDOW_SIZE (16*MiB)
-
+#define DEFAULT_NUM_READ_WINDOWS 4
+
+/**
+ * Maps the chunks of the swap file into memory. The chunks are
+ * written through a single write window, and read through a small
+ * LRU cache of read windows. Several read windows let random
+ * swap-ins from different parts of the file not evict each other's
+ * mappings, so the number of mmap/munmap calls stays low.
+ */
 class KisMemoryWindow
 {
+public:
+    struct Statistics {
+        Statistics()
+            : hits(0),
+              misses(0),
+              mappedSize(0)
+        {
+        }
+
+        Statistics& operator+=(const Statistics &rhs) {
+            hits += rhs.hits;
+            misses += rhs.misses;
+            mappedSize += rhs.mappedSize;
+            return *this;
+        }
+
+        /**
+         * The number of accesses served by an existing mapping
+         */
+        qint64 hits;
+
+        /**
+         * The number of accesses that needed a window to be remapped
+         */
+        qint64 misses;
+
+        /**
+         * The total size of the currently mapped windows
+         */
+        qint64 mappedSize;
+    };
+
 public:
     /**
      * @param swapDir. If the dir doesn't exist, it'll be created, if it's empty QDir::tempPath will be used.
+     * @param writeWindowSize the size of the write window, the read windows are 4 times smaller
+     * @param numReadWindows the number of read windows kept mapped simultaneously
      */
-    KisMemoryWindow(const QString &swapDir, quint64 writeWindowSize = DEFAULT_WINDOW_SIZE);
+    KisMemoryWindow(const QString &swapDir,
+                    quint64 writeWindowSize = DEFAULT_WINDOW_SIZE,
+                    int numReadWindows = DEFAULT_NUM_READ_WINDOWS);
     ~KisMemoryWindow();
 
     inline quint8* getReadChunkPtr(KisChunk readChunk) {
@@ -46,12 +91,15 @@ public:
     quint8* getReadChunkPtr(const KisChunkData &readChunk);
     quint8* getWriteChunkPtr(const KisChunkData &writeChunk);
 
+    Statistics statistics() const;
+
 private:
     struct MappingWindow {
-        MappingWindow(quint64 _defaultSize)
+        MappingWindow(quint64 _defaultSize = 0)
             : chunk(0,0),
               window(0),
-              defaultSize(_defaultSize)
+              defaultSize(_defaultSize),
+              lastAccess(0)
         {
         }
 
@@ -59,23 +107,34 @@ private:
             return window + other.m_begin - chunk.m_begin;
         }
 
+        bool contains(const KisChunkData &other) const {
+            return window &&
+                other.m_begin >= chunk.m_begin &&
+                other.m_end <= chunk.m_end;
+        }
+
         KisChunkData chunk;
         quint8 *window;
-        const quint64 defaultSize;
+        quint64 defaultSize;
+        quint64 lastAccess;
     };
 
 
 private:
     bool adjustWindow(const KisChunkData &requestedChunk,
-                      MappingWindow *adjustingWindow,
-                      MappingWindow *otherWindow);
+                      MappingWindow *adjustingWindow);
+
+    void unmapWindow(MappingWindow *window);
 
 private:
     QTemporaryFile m_file;
 
     bool m_valid;
-    MappingWindow m_readWindowEx;
+    QVector<MappingWindow> m_readWindows;
     MappingWindow m_writeWindowEx;
+
+    quint64 m_accessCounter;
+    Statistics m_statistics;
 };
 
 #endif /* __KIS_MEMORY_WINDOW_H */
@@ -21,30 +21,100 @@
 #include "kis_memory_window.h"
 #include "kis_image_config.h"
 
+#include <QThread>
+
 #include "kis_tile_compressor_2.h"
 
 //#define COMPRESSOR_VERSION 2
 
+/**
+ * There is no sense in having more shards than the number of
+ * threads that can access the store simultaneously
+ */
+#define MAX_NUM_SHARDS 16
+
+
+struct KisSwappedDataStore::SwapShard
+{
+    SwapShard(const QString &swapDir,
+              quint64 slabSize, quint64 maxSize,
+              quint64 windowSize, int numReadWindows)
+        : allocator(slabSize, maxSize),
+          swapSpace(swapDir, windowSize, numReadWindows)
+    {
+    }
+
+    KisChunkAllocator allocator;
+    KisMemoryWindow swapSpace;
+
+    QMutex lock;
+};
+
+struct KisSwappedDataStore::ThreadContext
+{
+    ThreadContext(const QString &compressionName)
+        : compressor(new KisTileCompressor2(compressionName))
+    {
+    }
+
+    ~ThreadContext() {
+        delete compressor;
+    }
+
+    void prepareBuffer(qint32 size) {
+        if(buffer.size() < size)
+            buffer.resize(size);
+    }
+
+    KisAbstractTileCompressor *compressor;
+    QByteArray buffer;
+};
+
+
 KisSwappedDataStore::KisSwappedDataStore()
-    : m_memoryMetric(0)
+    : m_nextShard(0),
+      m_memoryMetric(0)
 {
     KisImageConfig config(true);
     const quint64 maxSwapSize = config.maxSwapSize() * MiB;
     const quint64 swapSlabSize = config.swapSlabSize() * MiB;
     const quint64 swapWindowSize = config.swapWindowSize() * MiB;
 
-    m_allocator = new KisChunkAllocator(swapSlabSize, maxSwapSize);
-    m_swapSpace = new KisMemoryWindow(config.swapDir(), swapWindowSize);
+    m_compressionName = config.swapTileCompression();
 
-    // FIXME: use a factory after the patch is committed
-    m_compressor = new KisTileCompressor2();
+    /**
+     * The hard limit is split evenly between the shards. Every
+     * shard should be able to hold at least one slab, so reduce
+     * the number of shards when the limit is too small, otherwise
+     * the shards together would exceed the configured limit.
+     */
+    const int maxShardsForSwapSize =
+        swapSlabSize > 0 ? int(qMin(quint64(MAX_NUM_SHARDS), maxSwapSize / swapSlabSize)) : 1;
+
+    const int numShards =
+        qBound(1, qMin(QThread::idealThreadCount(), maxShardsForSwapSize), MAX_NUM_SHARDS);
+
+    const quint64 shardMaxSize = maxSwapSize / numShards;
+
+    for (int i = 0; i < numShards; i++) {
+        m_shards << new SwapShard(config.swapDir(), swapSlabSize,
+                                  shardMaxSize, swapWindowSize,
+                                  config.swapReadWindows());
+    }
 }
 
 KisSwappedDataStore::~KisSwappedDataStore()
 {
-    delete m_compressor;
-    delete m_swapSpace;
-    delete m_allocator;
+    qDeleteAll(m_shards);
+
+    /**
+     * QThreadStorage doesn't delete the data of the threads
+     * that are still alive, so clean up at least the context
+     * of the current thread
+     */
+    if (m_threadContexts.hasLocalData()) {
+        m_threadContexts.setLocalData(0);
+    }
 }
 
 quint64 KisSwappedDataStore::numTiles() const
@@ -52,39 +122,136 @@ quint64 KisSwappedDataStore::numTiles() const
     // We are not acquiring the lock here...
     // Hope QLinkedList will ensure atomic access to it's size...
 
-    return m_allocator->numChunks();
+    quint64 result = 0;
+
+    Q_FOREACH (SwapShard *shard, m_shards) {
+        result += shard->allocator.numChunks();
+    }
+
+    return result;
+}
+
+int KisSwappedDataStore::numShards() const
+{
+    return m_shards.size();
+}
+
+void KisSwappedDataStore::windowStatistics(qint64 &hits, qint64 &misses, qint64 &mappedSize) const
+{
+    KisMemoryWindow::Statistics stats;
+
+    Q_FOREACH (SwapShard *shard, m_shards) {
+        QMutexLocker locker(&shard->lock);
+        stats += shard->swapSpace.statistics();
+    }
+
+    hits = stats.hits;
+    misses = stats.misses;
+    mappedSize = stats.mappedSize;
+}
+
+KisSwappedDataStore::ThreadContext* KisSwappedDataStore::threadContext()
+{
+    ThreadContext *context = m_threadContexts.localData();
+
+    if (!context) {
+        context = new ThreadContext(m_compressionName);
+        m_threadContexts.setLocalData(context);
+    }
+
+    return context;
 }
 
 bool KisSwappedDataStore::trySwapOutTileData(KisTileData *td)
 {
     Q_ASSERT(td->data());
-    QMutexLocker locker(&m_lock);
 
     /**
      * We are expecting that the lock of KisTileData
      * has already been taken by the caller for us.
      * So we can modify the tile data freely.
+     *
+     * The compression happens in the thread-local buffers,
+     * so we don't need any store-wide lock for that.
      */
 
-    const qint32 expectedBufferSize = m_compressor->tileDataBufferSize(td);
-    if(m_buffer.size() < expectedBufferSize)
-        m_buffer.resize(expectedBufferSize);
+    ThreadContext *context = threadContext();
+
+    const qint32 expectedBufferSize = context->compressor->tileDataBufferSize(td);
+    context->prepareBuffer(expectedBufferSize);
 
     qint32 bytesWritten;
-    m_compressor->compressTileData(td, (quint8*) m_buffer.data(), m_buffer.size(), bytesWritten);
+    context->compressor->compressTileData(td, (quint8*) context->buffer.data(),
+                                          context->buffer.size(), bytesWritten);
+
+    /**
+     * Choose the shard in a round-robin way, preferring the
+     * shards that are not locked by other threads at the moment.
+     * If all of them are busy, just wait for the first one.
+     */
+    const int numShards = m_shards.size();
+    const int firstShard = (m_nextShard.fetchAndAddRelaxed(1) & 0x7fffffff) % numShards;
+
+    int shardIndex = -1;
+    for (int i = 0; i < numShards; i++) {
+        const int index = (firstShard + i) % numShards;
+        if (m_shards[index]->lock.tryLock()) {
+            shardIndex = index;
+            break;
+        }
+    }
+
+    if (shardIndex < 0) {
+        shardIndex = firstShard;
+        m_shards[shardIndex]->lock.lock();
+    }
+
+    KisChunk chunk;
+    bool chunkAllocated = false;
+
+    /**
+     * If the selected shard is full, try other shards one by one
+     */
+    for (int i = 0; i < numShards; i++) {
+        SwapShard *shard = m_shards[shardIndex];
+
+        if (i > 0) {
+            shard->lock.lock();
+        }
 
-    KisChunk chunk = m_allocator->getChunk(bytesWritten);
-    quint8 *ptr = m_swapSpace->getWriteChunkPtr(chunk);
+        if (shard->allocator.tryGetChunk(bytesWritten, chunk)) {
+            chunkAllocated = true;
+            break;
+        }
+
+        shard->lock.unlock();
+        shardIndex = (shardIndex + 1) % numShards;
+    }
+
+    if (!chunkAllocated) {
+        qFatal("KisSwappedDataStore: out of swap space");
+    }
+
+    SwapShard *shard = m_shards[shardIndex];
+
+    quint8 *ptr = shard->swapSpace.getWriteChunkPtr(chunk);
     if (!ptr) {
+        shard->allocator.freeChunk(chunk);
+        shard->lock.unlock();
+
         qWarning() << "swap out of tile failed";
         return false;
     }
-    memcpy(ptr, m_buffer.data(), bytesWritten);
+    memcpy(ptr, context->buffer.data(), bytesWritten);
+
+    shard->lock.unlock();
+
+    chunk.setShardIndex(shardIndex);
 
     td->releaseMemory();
     td->setSwapChunk(chunk);
 
-    m_memoryMetric += td->pixelSize();
+    m_memoryMetric.fetchAndAddOrdered(td->pixelSize());
 
     return true;
 }
@@ -92,40 +259,66 @@ bool KisSwappedDataStore::trySwapOutTileData(KisTileData *td)
 void KisSwappedDataStore::swapInTileData(KisTileData *td)
 {
     Q_ASSERT(!td->data());
-    QMutexLocker locker(&m_lock);
 
     // see comment in swapOutTileData()
 
+    ThreadContext *context = threadContext();
+
     KisChunk chunk = td->swapChunk();
+    const qint32 chunkSize = chunk.size();
+    context->prepareBuffer(chunkSize);
 
     td->allocateMemory();
     td->setSwapChunk(KisChunk());
 
-    quint8 *ptr = m_swapSpace->getReadChunkPtr(chunk);
-    Q_ASSERT(ptr);
-    m_compressor->decompressTileData(ptr, chunk.size(), td);
-    m_allocator->freeChunk(chunk);
+    SwapShard *shard = m_shards[chunk.shardIndex()];
 
-    m_memoryMetric -= td->pixelSize();
+    {
+        QMutexLocker locker(&shard->lock);
+
+        /**
+         * Copy the compressed data out of the mapped window so
+         * that other threads could remap the window while we
+         * are decompressing the data
+         */
+        quint8 *ptr = shard->swapSpace.getReadChunkPtr(chunk);
+        Q_ASSERT(ptr);
+        memcpy(context->buffer.data(), ptr, chunkSize);
+        shard->allocator.freeChunk(chunk);
+    }
+
+    context->compressor->decompressTileData((quint8*) context->buffer.data(),
+                                            chunkSize, td);
+
+    m_memoryMetric.fetchAndAddOrdered(-qint64(td->pixelSize()));
 }
 
 void KisSwappedDataStore::forgetTileData(KisTileData *td)
 {
-    QMutexLocker locker(&m_lock);
+    KisChunk chunk = td->swapChunk();
+    SwapShard *shard = m_shards[chunk.shardIndex()];
+
+    {
+        QMutexLocker locker(&shard->lock);
+        shard->allocator.freeChunk(chunk);
+    }
 
-    m_allocator->freeChunk(td->swapChunk());
     td->setSwapChunk(KisChunk());
 
-    m_memoryMetric -= td->pixelSize();
+    m_memoryMetric.fetchAndAddOrdered(-qint64(td->pixelSize()));
 }
 
 qint64 KisSwappedDataStore::totalMemoryMetric() const
 {
-    return m_memoryMetric;
+    return m_memoryMetric.load();
 }
 
 void KisSwappedDataStore::debugStatistics()
 {
-    m_allocator->sanityCheck();
-    m_allocator->debugFragmentation();
+    Q_FOREACH (SwapShard *shard, m_shards) {
+        QMutexLocker locker(&shard->lock);
+
+        shard->allocator.sanityCheck();
+        shard->allocator.debugFragmentation();
+    }
 }
@@ -23,6 +23,10 @@
 
 #include <QMutex>
 #include <QByteArray>
+#include <QVector>
+#include <QAtomicInt>
+#include <QThreadStorage>
+#include <QString>
 
 
 class QMutex;
@@ -31,6 +35,15 @@ class KisAbstractTileCompressor;
 class KisChunkAllocator;
 class KisMemoryWindow;
 
+/**
+ * The swap store is split into a set of independent shards. Each
+ * shard has its own chunk allocator, its own swap file (mapped by a
+ * separate KisMemoryWindow) and its own lock. Compression and
+ * decompression of the tiles is done by per-thread compressors
+ * outside of any lock, so the only serialized part of swapping is
+ * allocation of a chunk and copying of the compressed data into/from
+ * the mapped window of a shard.
+ */
 class KRITAIMAGE_EXPORT KisSwappedDataStore
 {
 public:
@@ -71,21 +84,39 @@ public:
      */
     qint64 totalMemoryMetric() const;
 
+    /**
+     * Returns the number of independent shards the swap
+     * space is split into
+     */
+    int numShards() const;
+
+    /**
+     * Collects the usage counters of the mapping windows of all
+     * the shards: the number of chunk accesses served by already
+     * mapped windows (\p hits), the number of accesses that caused
+     * a remapping (\p misses) and the total size of the currently
+     * mapped windows in bytes (\p mappedSize)
+     */
+    void windowStatistics(qint64 &hits, qint64 &misses, qint64 &mappedSize) const;
+
     /**
      * Some debugging output
      */
     void debugStatistics();
 
 private:
-    QByteArray m_buffer;
-    KisAbstractTileCompressor *m_compressor;
+    struct SwapShard;
+    struct ThreadContext;
 
-    KisChunkAllocator *m_allocator;
-    KisMemoryWindow *m_swapSpace;
+    ThreadContext* threadContext();
 
-    QMutex m_lock;
+private:
+    QVector<SwapShard*> m_shards;
+    QThreadStorage<ThreadContext*> m_threadContexts;
+    QString m_compressionName;
 
-    qint64 m_memoryMetric;
+    QAtomicInt m_nextShard;
+    QAtomicInteger<qint64> m_memoryMetric;
 };
 
 #endif /* __KIS_SWAPPED_DATA_STORE_H */
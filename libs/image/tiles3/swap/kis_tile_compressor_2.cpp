@@ -17,22 +17,62 @@
  */
 
 #include "kis_tile_compressor_2.h"
-#include "kis_lzf_compression.h"
+#include "kis_compression_factory.h"
+#include "kis_abstract_compression.h"
 #include <QIODevice>
 #include "kis_paint_device_writer.h"
+#include "kis_debug.h"
 #define TILE_DATA_SIZE(pixelSize) ((pixelSize) * KisTileData::WIDTH * KisTileData::HEIGHT)
 
-const QString KisTileCompressor2::m_compressionName = "LZF";
 
-
-KisTileCompressor2::KisTileCompressor2()
+KisTileCompressor2::KisTileCompressor2(const QString &compressionName)
+    : m_compression(0)
 {
-    m_compression = new KisLzfCompression();
+    if (!compressionName.isEmpty()) {
+        m_compression = KisCompressionFactory::create(compressionName);
+
+        if (!m_compression) {
+            warnTiles << "Tile compression" << compressionName
+                      << "is not supported by this build of Krita, falling back to LZF";
+        }
+    }
+
+    if (m_compression) {
+        m_compressionName = compressionName;
+    } else {
+        m_compression = KisCompressionFactory::create(KisCompressionFactory::LZF);
+        m_compressionName = KisCompressionFactory::LZF;
+    }
 }
 
 KisTileCompressor2::~KisTileCompressor2()
 {
     delete m_compression;
+    qDeleteAll(m_foreignCompressions);
+}
+
+QString KisTileCompressor2::compressionName() const
+{
+    return m_compressionName;
+}
+
+KisAbstractCompression* KisTileCompressor2::compressionForName(const QString &name)
+{
+    if (name == m_compressionName) {
+        return m_compression;
+    }
+
+    KisAbstractCompression *compression = m_foreignCompressions.value(name, 0);
+
+    if (!compression) {
+        compression = KisCompressionFactory::create(name);
+
+        if (compression) {
+            m_foreignCompressions.insert(name, compression);
+        }
+    }
+
+    return compression;
 }
 
 bool KisTileCompressor2::writeTile(KisTileSP tile, KisPaintDeviceWriter &store)
@@ -75,7 +115,16 @@ bool KisTileCompressor2::readTile(QIODevice *stream, KisTiledDataManager *dm)
         qint32 dataSize = headerItems.takeFirst().toInt();
 
         Q_ASSERT(headerItems.isEmpty());
-        Q_ASSERT(compressionName == m_compressionName);
+
+        KisAbstractCompression *compression = compressionForName(compressionName);
+        if (!compression) {
+            warnFile << "Tile compression" << compressionName
+                     << "is not supported by this build of Krita";
+
+            // skip the data of the tile to keep the stream consistent
+            stream->read(m_streamingBuffer.data(), dataSize);
+            return false;
+        }
 
         qint32 row = yToRow(dm, y);
         qint32 col = xToCol(dm, x);
@@ -85,13 +134,33 @@ bool KisTileCompressor2::readTile(QIODevice *stream, KisTiledDataManager *dm)
         stream->read(m_streamingBuffer.data(), dataSize);
 
         tile->lockForWrite();
-        bool res = decompressTileData((quint8*)m_streamingBuffer.data(), dataSize, tile->tileData());
+        bool res = decompressTileData(compression, (quint8*)m_streamingBuffer.data(), dataSize, tile->tileData());
         tile->unlock();
         return res;
     }
     return false;
 }
 
+bool KisTileCompressor2::readRawTile(QIODevice *stream, QByteArray &rawTile)
+{
+    QByteArray header = stream->readLine(maxHeaderLength());
+
+    QList<QByteArray> headerItems = header.trimmed().split(',');
+    if (headerItems.size() != 4) {
+        return false;
+    }
+
+    const qint32 dataSize = headerItems.last().toInt();
+    if (dataSize < 0) {
+        return false;
+    }
+
+    rawTile = header;
+    rawTile.append(stream->read(dataSize));
+
+    return rawTile.size() == header.size() + dataSize;
+}
+
 void KisTileCompressor2::prepareStreamingBuffer(qint32 tileDataSize)
 {
     /**
@@ -101,9 +170,9 @@ void KisTileCompressor2::prepareStreamingBuffer(qint32 tileDataSize)
     m_streamingBuffer.resize(tileDataSize + 1);
 }
 
-void KisTileCompressor2::prepareWorkBuffers(qint32 tileDataSize)
+void KisTileCompressor2::prepareWorkBuffers(KisAbstractCompression *compression, qint32 tileDataSize)
 {
-    const qint32 bufferSize = m_compression->outputBufferSize(tileDataSize);
+    const qint32 bufferSize = compression->outputBufferSize(tileDataSize);
 
     m_linearizationBuffer.resize(tileDataSize);
     m_compressionBuffer.resize(bufferSize);
@@ -121,7 +190,7 @@ void KisTileCompressor2::compressTileData(KisTileData *tileData,
     Q_UNUSED(bufferSize);
     Q_ASSERT(bufferSize >= tileDataSize + 1);
 
-    prepareWorkBuffers(tileDataSize);
+    prepareWorkBuffers(m_compression, tileDataSize);
 
     KisAbstractCompression::linearizeColors(tileData->data(), (quint8*)m_linearizationBuffer.data(),
                                             tileDataSize, pixelSize);
@@ -129,7 +198,7 @@ void KisTileCompressor2::compressTileData(KisTileData *tileData,
     compressedBytes = m_compression->compress((quint8*)m_linearizationBuffer.data(), tileDataSize,
                                               (quint8*)m_compressionBuffer.data(), m_compressionBuffer.size());
 
-    if(compressedBytes < tileDataSize) {
+    if(compressedBytes > 0 && compressedBytes < tileDataSize) {
         buffer[0] = COMPRESSED_DATA_FLAG;
         memcpy(buffer + 1, m_compressionBuffer.data(), compressedBytes);
         bytesWritten = compressedBytes + 1;
@@ -144,15 +213,23 @@ void KisTileCompressor2::compressTileData(KisTileData *tileData,
 bool KisTileCompressor2::decompressTileData(quint8 *buffer,
                                             qint32 bufferSize,
                                             KisTileData *tileData)
+{
+    return decompressTileData(m_compression, buffer, bufferSize, tileData);
+}
+
+bool KisTileCompressor2::decompressTileData(KisAbstractCompression *compression,
+                                            quint8 *buffer,
+                                            qint32 bufferSize,
+                                            KisTileData *tileData)
 {
     const qint32 pixelSize = tileData->pixelSize();
     const qint32 tileDataSize = TILE_DATA_SIZE(pixelSize);
 
     if(buffer[0] == COMPRESSED_DATA_FLAG) {
-        prepareWorkBuffers(tileDataSize);
+        prepareWorkBuffers(compression, tileDataSize);
 
         qint32 bytesWritten;
-        bytesWritten = m_compression->decompress(buffer + 1, bufferSize - 1,
+        bytesWritten = compression->decompress(buffer + 1, bufferSize - 1,
                                                  (quint8*)m_linearizationBuffer.data(), tileDataSize);
         if (bytesWritten == tileDataSize) {
             KisAbstractCompression::delinearizeColors((quint8*)m_linearizationBuffer.data(),
@@ -20,17 +20,35 @@
 #define __KIS_TILE_COMPRESSOR_2_H
 
 #include "kis_abstract_tile_compressor.h"
+#include <QHash>
 
 class KisAbstractCompression;
 
+/**
+ * Compresses tiles with a compression algorithm selected by name
+ * (see KisCompressionFactory). The name of the algorithm is written
+ * into the header of every tile, so readTile() can decompress the
+ * tiles written with any available algorithm, not only the one the
+ * compressor was created with.
+ */
 class KRITAIMAGE_EXPORT KisTileCompressor2 : public KisAbstractTileCompressor
 {
 public:
-    KisTileCompressor2();
+    /**
+     * Creates a compressor using \p compressionName algorithm. If the
+     * algorithm is not available in this build, LZF is used instead.
+     */
+    KisTileCompressor2(const QString &compressionName = QString());
     ~KisTileCompressor2() override;
 
+    /**
+     * The name of the algorithm actually used for compression
+     */
+    QString compressionName() const;
+
     bool writeTile(KisTileSP tile, KisPaintDeviceWriter &store) override;
     bool readTile(QIODevice *io, KisTiledDataManager *dm) override;
+    bool readRawTile(QIODevice *stream, QByteArray &rawTile) override;
 
 
     void compressTileData(KisTileData *tileData,quint8 *buffer,
@@ -46,9 +64,14 @@ private:
 
     QString getHeader(KisTileSP tile, qint32 compressedSize);
 
-    void prepareWorkBuffers(qint32 tileDataSize);
+    void prepareWorkBuffers(KisAbstractCompression *compression, qint32 tileDataSize);
     void prepareStreamingBuffer(qint32 tileDataSize);
 
+    bool decompressTileData(KisAbstractCompression *compression,
+                            quint8 *buffer, qint32 bufferSize, KisTileData *tileData);
+
+    KisAbstractCompression* compressionForName(const QString &name);
+
 private:
     static const qint8 RAW_DATA_FLAG = 0;
     static const qint8 COMPRESSED_DATA_FLAG = 1;
@@ -58,7 +81,12 @@ private:
     QByteArray m_compressionBuffer;
     QByteArray m_streamingBuffer;
     KisAbstractCompression *m_compression;
-    static const QString m_compressionName;
+    QString m_compressionName;
+
+    /**
+     * Decompressors for the tiles written with other algorithms
+     */
+    QHash<QString, KisAbstractCompression*> m_foreignCompressions;
 };
 
 #endif /* __KIS_TILE_COMPRESSOR_2_H */
@@ -25,7 +25,17 @@
 class KRITAIMAGE_EXPORT KisTileCompressorFactory
 {
 public:
-    static KisAbstractTileCompressorSP create(qint32 version) {
+    /**
+     * Creates a compressor for the tiles stream of \p version.
+     *
+     * Version 3 streams have the same layout as version 2 ones, but
+     * their tiles may be compressed with any algorithm supported by
+     * KisCompressionFactory, not only with LZF. When writing, the
+     * algorithm is selected by \p compressionName, when reading,
+     * it is taken from the header of every tile.
+     */
+    static KisAbstractTileCompressorSP create(qint32 version,
+                                              const QString &compressionName = QString()) {
         switch(version) {
         case 1:
             return KisAbstractTileCompressorSP(new KisLegacyTileCompressor());
@@ -33,6 +43,9 @@ public:
         case 2:
             return KisAbstractTileCompressorSP(new KisTileCompressor2());
             break;
+        case 3:
+            return KisAbstractTileCompressorSP(new KisTileCompressor2(compressionName));
+            break;
         default:
             qFatal("Unknown version of the tiles");
             return KisAbstractTileCompressorSP();
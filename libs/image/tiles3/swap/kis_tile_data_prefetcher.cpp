@@ -0,0 +1,146 @@
+/*
+ *  Copyright (c) 2019 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <QSemaphore>
+#include <QMutex>
+#include <QQueue>
+
+#include "tiles3/swap/kis_tile_data_prefetcher.h"
+#include "tiles3/swap/kis_tile_data_swapper_p.h"
+#include "tiles3/kis_tile_data.h"
+#include "tiles3/kis_tile_data_store.h"
+#include "kis_debug.h"
+
+/**
+ * The queue is limited to keep the prefetcher from loading the tiles
+ * that are too far from the cursor of the iterators. When the limit
+ * is reached, the oldest requests are dropped.
+ */
+const qint32 KisTileDataPrefetcher::MAX_QUEUE_SIZE = 256;
+
+//#define DEBUG_PREFETCHER
+
+#ifdef DEBUG_PREFETCHER
+#define DEBUG_ACTION(action) dbgKrita << action
+#else
+#define DEBUG_ACTION(action)
+#endif
+
+
+struct Q_DECL_HIDDEN KisTileDataPrefetcher::Private
+{
+public:
+    QSemaphore semaphore;
+    QAtomicInt shouldExitFlag;
+    KisTileDataStore *store;
+    KisStoreLimits limits;
+
+    QMutex queueLock;
+    QQueue<KisTileData*> queue;
+};
+
+KisTileDataPrefetcher::KisTileDataPrefetcher(KisTileDataStore *store)
+    : QThread(),
+      m_d(new Private())
+{
+    m_d->shouldExitFlag = 0;
+    m_d->store = store;
+}
+
+KisTileDataPrefetcher::~KisTileDataPrefetcher()
+{
+    delete m_d;
+}
+
+void KisTileDataPrefetcher::prefetch(KisTileData *td)
+{
+    KisTileData *droppedTileData = 0;
+
+    {
+        QMutexLocker locker(&m_d->queueLock);
+
+        if (m_d->queue.size() >= MAX_QUEUE_SIZE) {
+            droppedTileData = m_d->queue.dequeue();
+        }
+
+        m_d->queue.enqueue(td);
+    }
+
+    /**
+     * The tile data may be deleted on deref(), which takes
+     * the locks of the store, so do it without holding
+     * our own lock
+     */
+    if (droppedTileData) {
+        DEBUG_ACTION("Prefetch request dropped");
+        droppedTileData->deref();
+    }
+
+    m_d->semaphore.release();
+}
+
+void KisTileDataPrefetcher::terminatePrefetcher()
+{
+    unsigned long exitTimeout = 100;
+    do {
+        m_d->shouldExitFlag = true;
+        m_d->semaphore.release();
+    } while(!wait(exitTimeout));
+
+    KisTileData *td = 0;
+    while ((td = takeNextTileData())) {
+        td->deref();
+    }
+}
+
+KisTileData* KisTileDataPrefetcher::takeNextTileData()
+{
+    QMutexLocker locker(&m_d->queueLock);
+    return !m_d->queue.isEmpty() ? m_d->queue.dequeue() : 0;
+}
+
+void KisTileDataPrefetcher::run()
+{
+    while (1) {
+        m_d->semaphore.acquire();
+
+        if (m_d->shouldExitFlag)
+            return;
+
+        KisTileData *td = takeNextTileData();
+
+        // the request might have been dropped already
+        if (!td) continue;
+
+        if (!td->data() &&
+            m_d->store->memoryMetric() < m_d->limits.hardLimitThreshold()) {
+
+            DEBUG_ACTION("Prefetching tile data" << td);
+
+            td->blockSwapping();
+            td->unblockSwapping();
+        }
+
+        td->deref();
+    }
+}
+
+void KisTileDataPrefetcher::testingRereadConfig()
+{
+    m_d->limits = KisStoreLimits();
+}
@@ -0,0 +1,70 @@
+/*
+ *  Copyright (c) 2019 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_zstd_compression.h"
+
+#include <zstd.h>
+
+
+struct KisZstdCompression::Private
+{
+    ZSTD_CCtx *compressionContext;
+    ZSTD_DCtx *decompressionContext;
+    int compressionLevel;
+};
+
+KisZstdCompression::KisZstdCompression(int compressionLevel)
+    : m_d(new Private)
+{
+    m_d->compressionContext = ZSTD_createCCtx();
+    m_d->decompressionContext = ZSTD_createDCtx();
+    m_d->compressionLevel = compressionLevel;
+}
+
+KisZstdCompression::~KisZstdCompression()
+{
+    ZSTD_freeCCtx(m_d->compressionContext);
+    ZSTD_freeDCtx(m_d->decompressionContext);
+    delete m_d;
+}
+
+qint32 KisZstdCompression::compress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength)
+{
+    const size_t result =
+        ZSTD_compressCCtx(m_d->compressionContext,
+                          output, outputLength,
+                          input, inputLength,
+                          m_d->compressionLevel);
+
+    return !ZSTD_isError(result) ? qint32(result) : 0;
+}
+
+qint32 KisZstdCompression::decompress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength)
+{
+    const size_t result =
+        ZSTD_decompressDCtx(m_d->decompressionContext,
+                            output, outputLength,
+                            input, inputLength);
+
+    return !ZSTD_isError(result) ? qint32(result) : 0;
+}
+
+qint32 KisZstdCompression::outputBufferSize(qint32 dataSize)
+{
+    return ZSTD_compressBound(dataSize);
+}
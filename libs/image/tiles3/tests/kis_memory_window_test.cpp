@@ -52,6 +52,43 @@ void KisMemoryWindowTest::testWindow()
     QVERIFY(!memcmp(ptr, oddBuf, chunkLength));
 }
 
+void KisMemoryWindowTest::testReadWindowsCache()
+{
+    const int numChunks = 4;
+    KisMemoryWindow memory(QString(QDir::currentPath()), 1024, numChunks);
+
+    const quint8 chunkLength = 10;
+    quint8 buf[chunkLength];
+
+    QVector<KisChunkData> chunks;
+    for (int i = 0; i < numChunks; i++) {
+        chunks << KisChunkData(i * 2048, chunkLength);
+
+        memset(buf, 0xe0 + i, chunkLength);
+        memcpy(memory.getWriteChunkPtr(chunks.last()), buf, chunkLength);
+    }
+
+    KisMemoryWindow::Statistics stats = memory.statistics();
+    QCOMPARE(stats.hits, qint64(0));
+    QCOMPARE(stats.misses, qint64(numChunks));
+
+    /**
+     * The last chunk is still mapped by the write window, the rest
+     * should be mapped once and then be kept by the read windows
+     */
+    for (int round = 0; round < 2; round++) {
+        for (int i = 0; i < numChunks; i++) {
+            memset(buf, 0xe0 + i, chunkLength);
+            QVERIFY(!memcmp(memory.getReadChunkPtr(chunks[i]), buf, chunkLength));
+        }
+    }
+
+    stats = memory.statistics();
+    QCOMPARE(stats.misses, qint64(numChunks + numChunks - 1));
+    QCOMPARE(stats.hits, qint64(numChunks + 1));
+    QCOMPARE(stats.mappedSize, qint64(1024 + (numChunks - 1) * 256));
+}
+
 void KisMemoryWindowTest::testTopReports()
 {
 
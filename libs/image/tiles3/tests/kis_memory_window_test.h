@@ -27,6 +27,7 @@ class KisMemoryWindowTest : public QObject
 
 private Q_SLOTS:
     void testWindow();
+    void testReadWindowsCache();
 
 private:
     // disabled since long-running
@@ -22,6 +22,7 @@
 #include "tiles3/kis_tiled_data_manager.h"
 #include "tiles3/swap/kis_legacy_tile_compressor.h"
 #include "tiles3/swap/kis_tile_compressor_2.h"
+#include "tiles3/swap/kis_compression_factory.h"
 
 #include "tiles_test_utils.h"
 
@@ -179,6 +180,53 @@ void KisTileCompressorsTest::testLowLevelRoundTripIncompressible2()
     delete compressor;
 }
 
+void KisTileCompressorsTest::testRoundTripAllCompressions()
+{
+    Q_FOREACH (const QString &name, KisCompressionFactory::availableCompressions()) {
+        KisTileCompressor2 *compressor = new KisTileCompressor2(name);
+        QCOMPARE(compressor->compressionName(), name);
+
+        doRoundTrip(compressor);
+        doLowLevelRoundTrip(compressor);
+        doLowLevelRoundTripIncompressible(compressor);
+        delete compressor;
+    }
+}
+
+void KisTileCompressorsTest::testReadForeignCompression()
+{
+    const QStringList compressions = KisCompressionFactory::availableCompressions();
+
+    quint8 defaultPixel = 0;
+    quint8 oddPixel1 = 128;
+
+    Q_FOREACH (const QString &writeName, compressions) {
+        Q_FOREACH (const QString &readName, compressions) {
+            KisTiledDataManager dm(1, &defaultPixel);
+            dm.clear(64, 64, 64, 64, &oddPixel1);
+
+            KoStoreFake fakeStore;
+            KisFakePaintDeviceWriter writer(&fakeStore);
+
+            KisTileCompressor2 writeCompressor(writeName);
+            QVERIFY(writeCompressor.writeTile(dm.getTile(1, 1, false), writer));
+
+            fakeStore.startReading();
+            dm.clear();
+
+            /**
+             * The reading compressor should pick the algorithm
+             * from the header of the tile
+             */
+            KisTileCompressor2 readCompressor(readName);
+            QVERIFY(readCompressor.readTile(fakeStore.device(), &dm));
+
+            KisTileSP tile = dm.getTile(1, 1, false);
+            QVERIFY(memoryIsFilled(oddPixel1, tile->data(), TILESIZE));
+        }
+    }
+}
+
 
 QTEST_MAIN(KisTileCompressorsTest)
 
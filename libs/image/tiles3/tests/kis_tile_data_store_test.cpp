@@ -181,5 +181,48 @@ void KisTileDataStoreTest::testSwapping()
     }
 }
 
+void KisTileDataStoreTest::testPrefetching()
+{
+    KisTileDataStore::instance()->debugClear();
+
+    const qint32 pixelSize = 1;
+    const qint32 numTiles = 16;
+    quint8 defaultPixel = 128;
+    KisTiledDataManager dm(pixelSize, &defaultPixel);
+
+    for(qint32 col = 0; col < numTiles; col++) {
+        KisTileSP tile = dm.getTile(col, 0, true);
+        tile->lockForWrite();
+        memset(tile->data(), COLUMN2COLOR(col), TILESIZE);
+        tile->unlock();
+    }
+
+    KisTileDataStore::instance()->debugSwapAll();
+    QVERIFY(KisTileDataStore::instance()->hasSwappedTiles());
+
+    dm.prefetchTiles(QRect(0, 0, numTiles * KisTileData::WIDTH, KisTileData::HEIGHT));
+
+    auto allTilesLoaded = [&dm, numTiles] () {
+        for(qint32 col = 0; col < numTiles; col++) {
+            KisTileSP tile = dm.getTile(col, 0, false);
+            if (!tile->tileData()->data()) return false;
+        }
+        return true;
+    };
+
+    for (int i = 0; i < 100 && !allTilesLoaded(); i++) {
+        QTest::qWait(10);
+    }
+
+    QVERIFY(allTilesLoaded());
+
+    for(qint32 col = 0; col < numTiles; col++) {
+        KisTileSP tile = dm.getTile(col, 0, false);
+        tile->lockForRead();
+        QVERIFY(memoryIsFilled(COLUMN2COLOR(col), tile->data(), TILESIZE));
+        tile->unlock();
+    }
+}
+
 QTEST_MAIN(KisTileDataStoreTest)
 
@@ -539,8 +539,241 @@ void KisTiledDataManagerTest::testUndoSetDefaultPixel()
     QVERIFY(memoryIsFilled(oddPixel2, tile10->data(), TILESIZE));
 }
 
+void KisTiledDataManagerTest::testUniformTiles()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    quint8 oddPixel1 = 128;
+    quint8 pixel = 13;
+
+    // the tiles that were never touched are uniform
+    QVERIFY(dm.tryGetUniformPixel(10, 10, &pixel));
+    QCOMPARE(pixel, defaultPixel);
+
+    // the whole tiles cleared at once share a uniform tile data
+    dm.clear(QRect(0,0,128,64), &oddPixel1);
+
+    QVERIFY(dm.tryGetUniformPixel(70, 10, &pixel));
+    QCOMPARE(pixel, oddPixel1);
+    QVERIFY(dm.getTile(0, 0, false)->tileData() == dm.getTile(1, 0, false)->tileData());
+
+    // copying a uniform tile into a tile of the same color doesn't detach it
+    KisTiledDataManager srcDM(1, &oddPixel1);
+    dm.bitBlt(&srcDM, QRect(10,10,30,30));
+
+    QVERIFY(dm.getTile(0, 0, false)->tileData() == dm.getTile(1, 0, false)->tileData());
+    QVERIFY(dm.tryGetUniformPixel(10, 10, &pixel));
+    QCOMPARE(pixel, oddPixel1);
+
+    // writing into a tile drops the flag, the neighbour stays uniform
+    dm.setPixel(5, 5, &defaultPixel);
+
+    QVERIFY(!dm.tryGetUniformPixel(0, 0, &pixel));
+    QVERIFY(dm.tryGetUniformPixel(64, 0, &pixel));
+    QCOMPARE(pixel, oddPixel1);
+}
+
+void KisTiledDataManagerTest::testPurgeUniformTiles()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    quint8 oddPixel1 = 128;
+    quint8 pixel = 13;
+
+    // make two tiles of the same color with separate tile data
+    dm.clear(QRect(0,0,128,64), &oddPixel1);
+    dm.setPixel(5, 5, &defaultPixel);
+    dm.setPixel(5, 5, &oddPixel1);
+    dm.setPixel(70, 5, &defaultPixel);
+    dm.setPixel(70, 5, &oddPixel1);
+
+    QVERIFY(dm.getTile(0, 0, false)->tileData() != dm.getTile(1, 0, false)->tileData());
+    QVERIFY(!dm.tryGetUniformPixel(0, 0, &pixel));
+    QVERIFY(!dm.tryGetUniformPixel(64, 0, &pixel));
+
+    // purging makes them share a single uniform tile data
+    dm.purge(QRect(0,0,128,64));
+
+    QVERIFY(dm.getTile(0, 0, false)->tileData() == dm.getTile(1, 0, false)->tileData());
+    QVERIFY(dm.tryGetUniformPixel(0, 0, &pixel));
+    QCOMPARE(pixel, oddPixel1);
+    QVERIFY(dm.tryGetUniformPixel(64, 0, &pixel));
+    QCOMPARE(pixel, oddPixel1);
+
+    // writing into one of them detaches it
+    dm.setPixel(70, 5, &defaultPixel);
+
+    QVERIFY(dm.getTile(0, 0, false)->tileData() != dm.getTile(1, 0, false)->tileData());
+
+    dm.readBytes(&pixel, 70, 5, 1, 1);
+    QCOMPARE(pixel, defaultPixel);
+    dm.readBytes(&pixel, 6, 5, 1, 1);
+    QCOMPARE(pixel, oddPixel1);
+
+    QVERIFY(!dm.tryGetUniformPixel(64, 0, &pixel));
+    QVERIFY(dm.tryGetUniformPixel(0, 0, &pixel));
+    QCOMPARE(pixel, oddPixel1);
+}
+
 //#include <valgrind/callgrind.h>
 
+void KisTiledDataManagerTest::testParallelWrite()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager srcDM(1, &defaultPixel);
+
+    /**
+     * Make sure the tiles are split into several write jobs
+     */
+    const int numCols = 32;
+    const int numRows = 8;
+    QVERIFY(numCols * numRows > 2 * KisTiledDataManager::TILES_PER_WRITE_JOB);
+
+    for (int row = 0; row < numRows; row++) {
+        for (int col = 0; col < numCols; col++) {
+            quint8 pixel = 1 + (row * numCols + col) % 255;
+            srcDM.clear(col * 64, row * 64, 64, 64, &pixel);
+        }
+    }
+
+    // the parallel writer (unless we have only one core)
+    KoStoreFake store1;
+    KisFakePaintDeviceWriter writer1(&store1);
+    QVERIFY(srcDM.write(writer1));
+
+    // the sequential writer as a reference
+    KoStoreFake store2;
+    KisFakePaintDeviceWriter writer2(&store2);
+    QVERIFY(srcDM.writeImpl(writer2, false));
+
+    store1.startReading();
+    store2.startReading();
+
+    const QByteArray data1 = store1.device()->readAll();
+    const QByteArray data2 = store2.device()->readAll();
+
+    QVERIFY(!data1.isEmpty());
+    QCOMPARE(data1, data2);
+
+    store1.startReading();
+
+    KisTiledDataManager dstDM(1, &defaultPixel);
+    QVERIFY(dstDM.read(store1.device()));
+
+    for (int row = 0; row < numRows; row++) {
+        for (int col = 0; col < numCols; col++) {
+            quint8 pixel = 1 + (row * numCols + col) % 255;
+
+            KisTileSP tile = dstDM.getTile(col, row, false);
+            tile->lockForRead();
+            QVERIFY(memoryIsFilled(pixel, tile->data(), TILESIZE));
+            tile->unlock();
+        }
+    }
+}
+
+void KisTiledDataManagerTest::testParallelRead()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager srcDM(1, &defaultPixel);
+
+    /**
+     * Make sure the tiles are split into several read jobs
+     */
+    const int numCols = 32;
+    const int numRows = 8;
+    QVERIFY(numCols * numRows > 2 * KisTiledDataManager::TILES_PER_READ_JOB);
+
+    const QRect rect(0, 0, numCols * 64, numRows * 64);
+
+    /**
+     * Uniform tiles are stored compressed, the noisy ones cannot
+     * be compressed, so they are stored raw
+     */
+    QByteArray noise(TILESIZE, 0);
+    quint32 seed = 17;
+
+    for (int row = 0; row < numRows; row++) {
+        for (int col = 0; col < numCols; col++) {
+            if ((row + col) % 3) {
+                quint8 pixel = 1 + (row * numCols + col) % 255;
+                srcDM.clear(col * 64, row * 64, 64, 64, &pixel);
+            } else {
+                for (int i = 0; i < noise.size(); i++) {
+                    seed = seed * 1103515245 + 12345;
+                    noise[i] = char(seed >> 16);
+                }
+                srcDM.writeBytes(reinterpret_cast<const quint8*>(noise.constData()),
+                                 col * 64, row * 64, 64, 64);
+            }
+        }
+    }
+
+    KoStoreFake store;
+    KisFakePaintDeviceWriter writer(&store);
+    QVERIFY(srcDM.write(writer));
+
+    // the parallel reader (unless we have only one core)
+    store.startReading();
+    KisTiledDataManager dstDM1(1, &defaultPixel);
+    QVERIFY(dstDM1.read(store.device()));
+
+    // the sequential reader as a reference
+    store.startReading();
+    KisTiledDataManager dstDM2(1, &defaultPixel);
+    QVERIFY(dstDM2.readImpl(store.device(), false));
+
+    QByteArray srcData(rect.width() * rect.height(), 0);
+    QByteArray dstData1(srcData.size(), 0);
+    QByteArray dstData2(srcData.size(), 0);
+
+    srcDM.readBytes(reinterpret_cast<quint8*>(srcData.data()), rect.x(), rect.y(), rect.width(), rect.height());
+    dstDM1.readBytes(reinterpret_cast<quint8*>(dstData1.data()), rect.x(), rect.y(), rect.width(), rect.height());
+    dstDM2.readBytes(reinterpret_cast<quint8*>(dstData2.data()), rect.x(), rect.y(), rect.width(), rect.height());
+
+    QCOMPARE(dstData2, srcData);
+    QCOMPARE(dstData1, dstData2);
+    QCOMPARE(dstDM1.extent(), srcDM.extent());
+}
+
+void KisTiledDataManagerTest::testRegionChangedBetweenSnapshots()
+{
+    quint8 defaultPixel = 0;
+    quint8 pixel = 13;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    dm.clear(QRect(0,0,192,64), &pixel);
+
+    KisTiledDataManager::TileDataSnapshot snapshot1;
+    dm.takeTileDataSnapshot(&snapshot1);
+
+    dm.setPixel(70, 5, &defaultPixel);
+
+    KisTiledDataManager::TileDataSnapshot snapshot2;
+    dm.takeTileDataSnapshot(&snapshot2);
+
+    // the write that happens after the second snapshot is not included
+    dm.setPixel(130, 5, &defaultPixel);
+
+    QCOMPARE(KisTiledDataManager::regionChangedSince(snapshot1, snapshot2),
+             QRegion(QRect(64,0,64,64)));
+    QCOMPARE(dm.regionChangedSince(snapshot1),
+             QRegion(QRect(64,0,128,64)));
+    QCOMPARE(KisTiledDataManager::regionChangedSince(snapshot2, snapshot2),
+             QRegion());
+
+    // removed tiles are reported as well
+    dm.clear();
+
+    KisTiledDataManager::TileDataSnapshot snapshot3;
+    dm.takeTileDataSnapshot(&snapshot3);
+
+    QCOMPARE(KisTiledDataManager::regionChangedSince(snapshot2, snapshot3),
+             QRegion(QRect(0,0,192,64)));
+}
+
 void KisTiledDataManagerTest::benchmarkReadOnlyTileLazy()
 {
     quint8 defaultPixel = 0;
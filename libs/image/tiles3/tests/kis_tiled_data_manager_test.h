@@ -52,6 +52,11 @@ private Q_SLOTS:
     void testTransactions();
     void testPurgeHistory();
     void testUndoSetDefaultPixel();
+    void testUniformTiles();
+    void testPurgeUniformTiles();
+    void testParallelWrite();
+    void testParallelRead();
+    void testRegionChangedBetweenSnapshots();
 
     void benchmarkReadOnlyTileLazy();
     void benchmarkSharedPointers();
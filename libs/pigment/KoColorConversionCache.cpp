@@ -23,6 +23,7 @@
 #include <QList>
 #include <QMutex>
 #include <QThreadStorage>
+#include <QAtomicInt>
 
 #include <KoColorSpace.h>
 
@@ -67,22 +68,185 @@ struct KoColorConversionCache::CachedTransformation {
     }
 
     bool available() {
-        return use == 0;
+        return use.loadAcquire() == 0;
     }
 
     KoColorConversionTransformation* transfo;
-    int use;
+    QAtomicInt use;
 };
 
-typedef QPair<KoColorConversionCacheKey, KoCachedColorConversionTransformation> FastPathCacheItem;
+namespace {
+
+/**
+ * The key of the thread-local table. Unlike KoColorConversionCacheKey
+ * it compares the color spaces by their addresses, so a lookup never
+ * dereferences a color space that might have been already destroyed.
+ */
+struct FastPathCacheKey {
+    FastPathCacheKey(const KoColorSpace* _src,
+                     const KoColorSpace* _dst,
+                     KoColorConversionTransformation::Intent _renderingIntent,
+                     KoColorConversionTransformation::ConversionFlags _conversionFlags)
+        : src(_src)
+        , dst(_dst)
+        , renderingIntent(_renderingIntent)
+        , conversionFlags(_conversionFlags)
+    {
+    }
+
+    bool operator==(const FastPathCacheKey& rhs) const {
+        return src == rhs.src && dst == rhs.dst
+                && renderingIntent == rhs.renderingIntent
+                && conversionFlags == rhs.conversionFlags;
+    }
+
+    const KoColorSpace* src;
+    const KoColorSpace* dst;
+    KoColorConversionTransformation::Intent renderingIntent;
+    KoColorConversionTransformation::ConversionFlags conversionFlags;
+};
+
+uint qHash(const FastPathCacheKey& key)
+{
+    return qHash(key.src) + qHash(key.dst) + qHash(key.renderingIntent) + qHash(key.conversionFlags);
+}
+
+/**
+ * Counts the cases when the mutex was already taken by someone else
+ */
+struct ContendedMutexLocker {
+    ContendedMutexLocker(QMutex *mutex, QAtomicInt *contentionCounter)
+        : m_mutex(mutex)
+    {
+        if (!m_mutex->tryLock()) {
+            contentionCounter->ref();
+            m_mutex->lock();
+        }
+    }
+
+    ~ContendedMutexLocker() {
+        m_mutex->unlock();
+    }
+
+    void unlock() {
+        m_mutex->unlock();
+    }
+
+    void relock() {
+        m_mutex->lock();
+    }
+
+private:
+    QMutex *m_mutex;
+};
+
+}
+
+/**
+ * The transformations recently used by the current thread. Every
+ * transformation in the table holds one reference to its
+ * CachedTransformation, so the shared cache will never give it to any
+ * other thread.
+ */
+struct ThreadLocalConversionCache {
+    static const int maxItems = 16;
+    static const int hitsPublishBatch = 256;
+
+    ThreadLocalConversionCache(int _generation, QAtomicInt *_hitsCounter)
+        : generation(_generation),
+          unpublishedHits(0),
+          hitsCounter(_hitsCounter)
+    {
+    }
+
+    ~ThreadLocalConversionCache() {
+        clear();
+        publishHits();
+    }
+
+    void clear() {
+        Q_FOREACH (KoColorConversionCache::CachedTransformation *ct, items) {
+            ct->use.deref();
+        }
+        items.clear();
+    }
+
+    void registerHit() {
+        if (++unpublishedHits >= hitsPublishBatch) {
+            publishHits();
+        }
+    }
+
+    void publishHits() {
+        if (unpublishedHits) {
+            hitsCounter->fetchAndAddRelaxed(unpublishedHits);
+            unpublishedHits = 0;
+        }
+    }
+
+    QHash<FastPathCacheKey, KoColorConversionCache::CachedTransformation*> items;
+    int generation;
+    int unpublishedHits;
+    QAtomicInt *hitsCounter;
+};
 
 struct KoColorConversionCache::Private {
     QMultiHash< KoColorConversionCacheKey, CachedTransformation*> cache;
     QMutex cacheMutex;
 
-    QThreadStorage<FastPathCacheItem*> fastStorage;
+    /**
+     * Transformations removed from the cache, but still referenced by
+     * the thread-local tables of other threads. They are deleted as soon
+     * as their threads release them.
+     */
+    QList<CachedTransformation*> retiredTransformations;
+
+    /**
+     * Incremented every time a color space is destroyed. The
+     * thread-local tables created for an older generation are dropped on
+     * the next lookup.
+     */
+    QAtomicInt generation;
+
+    QThreadStorage<ThreadLocalConversionCache*> fastStorage;
+
+    QAtomicInt fastPathHits;
+    QAtomicInt slowPathLookups;
+    QAtomicInt contendedLocks;
+    QAtomicInt createdTransformations;
+
+    ThreadLocalConversionCache* localCache();
+    void pruneRetiredTransformations();
 };
 
+ThreadLocalConversionCache* KoColorConversionCache::Private::localCache()
+{
+    const int currentGeneration = generation.loadAcquire();
+
+    ThreadLocalConversionCache *localCache = fastStorage.localData();
+    if (!localCache) {
+        localCache = new ThreadLocalConversionCache(currentGeneration, &fastPathHits);
+        fastStorage.setLocalData(localCache);
+    } else if (localCache->generation != currentGeneration) {
+        localCache->clear();
+        localCache->generation = currentGeneration;
+    }
+
+    return localCache;
+}
+
+void KoColorConversionCache::Private::pruneRetiredTransformations()
+{
+    for (auto it = retiredTransformations.begin(); it != retiredTransformations.end();) {
+        if ((*it)->available()) {
+            delete *it;
+            it = retiredTransformations.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 
 KoColorConversionCache::KoColorConversionCache() : d(new Private)
 {
@@ -90,9 +254,12 @@ KoColorConversionCache::KoColorConversionCache() : d(new Private)
 
 KoColorConversionCache::~KoColorConversionCache()
 {
+    d->fastStorage.setLocalData(0);
+
     Q_FOREACH (CachedTransformation* transfo, d->cache) {
         delete transfo;
     }
+    qDeleteAll(d->retiredTransformations);
     delete d;
 }
 
@@ -101,58 +268,123 @@ KoCachedColorConversionTransformation KoColorConversionCache::cachedConverter(co
                                                                               KoColorConversionTransformation::Intent _renderingIntent,
                                                                               KoColorConversionTransformation::ConversionFlags _conversionFlags)
 {
-    KoColorConversionCacheKey key(src, dst, _renderingIntent, _conversionFlags);
+    ThreadLocalConversionCache *localCache = d->localCache();
 
-    FastPathCacheItem *cacheItem =
-        d->fastStorage.localData();
+    const FastPathCacheKey fastKey(src, dst, _renderingIntent, _conversionFlags);
 
-    if (cacheItem) {
-        if (cacheItem->first == key) {
-            return cacheItem->second;
-        }
+    auto fastIt = localCache->items.constFind(fastKey);
+    if (fastIt != localCache->items.constEnd()) {
+        localCache->registerHit();
+        return KoCachedColorConversionTransformation(this, fastIt.value());
     }
 
-    cacheItem = 0;
+    localCache->publishHits();
+    d->slowPathLookups.fetchAndAddRelaxed(1);
+
+    if (localCache->items.size() >= ThreadLocalConversionCache::maxItems) {
+        localCache->clear();
+    }
+
+    KoColorConversionCacheKey key(src, dst, _renderingIntent, _conversionFlags);
+    CachedTransformation *cachedTransfo = 0;
+
+    ContendedMutexLocker lock(&d->cacheMutex, &d->contendedLocks);
+
+    d->pruneRetiredTransformations();
 
-    QMutexLocker lock(&d->cacheMutex);
     QList< CachedTransformation* > cachedTransfos = d->cache.values(key);
-    if (cachedTransfos.size() != 0) {
-        Q_FOREACH (CachedTransformation* ct, cachedTransfos) {
-            if (ct->available()) {
-                ct->transfo->setSrcColorSpace(src);
-                ct->transfo->setDstColorSpace(dst);
-
-                cacheItem = new FastPathCacheItem(key, KoCachedColorConversionTransformation(this, ct));
-                break;
-            }
+    Q_FOREACH (CachedTransformation* ct, cachedTransfos) {
+        if (ct->available()) {
+            ct->transfo->setSrcColorSpace(src);
+            ct->transfo->setDstColorSpace(dst);
+            cachedTransfo = ct;
+            break;
         }
     }
-    if (!cacheItem) {
+
+    if (!cachedTransfo) {
+        /**
+         * Creation of a transformation may be rather slow, so don't
+         * block other threads while doing that
+         */
+        lock.unlock();
         KoColorConversionTransformation* transfo = src->createColorConverter(dst, _renderingIntent, _conversionFlags);
-        CachedTransformation* ct = new CachedTransformation(transfo);
-        d->cache.insert(key, ct);
-        cacheItem = new FastPathCacheItem(key, KoCachedColorConversionTransformation(this, ct));
+        d->createdTransformations.fetchAndAddRelaxed(1);
+        lock.relock();
+
+        cachedTransfo = new CachedTransformation(transfo);
+        d->cache.insert(key, cachedTransfo);
     }
 
-    d->fastStorage.setLocalData(cacheItem);
-    return cacheItem->second;
+    /**
+     * The reference of the thread-local table should be taken while the
+     * lock is still held, otherwise another thread might pick the same
+     * transformation up
+     */
+    cachedTransfo->use.ref();
+    localCache->items.insert(fastKey, cachedTransfo);
+
+    return KoCachedColorConversionTransformation(this, cachedTransfo);
 }
 
 void KoColorConversionCache::colorSpaceIsDestroyed(const KoColorSpace* cs)
 {
-    d->fastStorage.setLocalData(0);
+    d->generation.ref();
+
+    ThreadLocalConversionCache *localCache = d->fastStorage.localData();
+    if (localCache) {
+        localCache->clear();
+    }
 
     QMutexLocker lock(&d->cacheMutex);
     QMultiHash< KoColorConversionCacheKey, CachedTransformation*>::iterator endIt = d->cache.end();
     for (QMultiHash< KoColorConversionCacheKey, CachedTransformation*>::iterator it = d->cache.begin(); it != endIt;) {
         if (it.key().src == cs || it.key().dst == cs) {
-            Q_ASSERT(it.value()->available()); // That's terribely evil, if that assert fails, that means that someone is using a color transformation with a color space which is currently being deleted
-            delete it.value();
+            /**
+             * The transformation may still be referenced by a thread-local
+             * table of another thread. That thread will release it on its
+             * next lookup, so just postpone the deletion.
+             */
+            if (it.value()->available()) {
+                delete it.value();
+            } else {
+                d->retiredTransformations.append(it.value());
+            }
             it = d->cache.erase(it);
         } else {
             ++it;
         }
     }
+
+    d->pruneRetiredTransformations();
+}
+
+KoColorConversionCache::Statistics KoColorConversionCache::statistics() const
+{
+    ThreadLocalConversionCache *localCache = d->fastStorage.localData();
+    if (localCache) {
+        localCache->publishHits();
+    }
+
+    Statistics stats;
+    stats.fastPathHits = d->fastPathHits.loadAcquire();
+    stats.slowPathLookups = d->slowPathLookups.loadAcquire();
+    stats.contendedLocks = d->contendedLocks.loadAcquire();
+    stats.createdTransformations = d->createdTransformations.loadAcquire();
+    return stats;
+}
+
+void KoColorConversionCache::resetStatistics()
+{
+    ThreadLocalConversionCache *localCache = d->fastStorage.localData();
+    if (localCache) {
+        localCache->unpublishedHits = 0;
+    }
+
+    d->fastPathHits.storeRelease(0);
+    d->slowPathLookups.storeRelease(0);
+    d->contendedLocks.storeRelease(0);
+    d->createdTransformations.storeRelease(0);
 }
 
 //--------- KoCachedColorConversionTransformation ----------//
@@ -165,21 +397,19 @@ struct KoCachedColorConversionTransformation::Private {
 
 KoCachedColorConversionTransformation::KoCachedColorConversionTransformation(KoColorConversionCache* cache, KoColorConversionCache::CachedTransformation* transfo) : d(new Private)
 {
-    Q_ASSERT(transfo->available());
     d->cache = cache;
     d->transfo = transfo;
-    d->transfo->use++;
+    d->transfo->use.ref();
 }
 
 KoCachedColorConversionTransformation::KoCachedColorConversionTransformation(const KoCachedColorConversionTransformation& rhs) : d(new Private(*rhs.d))
 {
-    d->transfo->use++;
+    d->transfo->use.ref();
 }
 
 KoCachedColorConversionTransformation::~KoCachedColorConversionTransformation()
 {
-    d->transfo->use--;
-    Q_ASSERT(d->transfo->use >= 0);
+    d->transfo->use.deref();
     delete d;
 }
 
@@ -24,16 +24,39 @@ class KoCachedColorConversionTransformation;
 class KoColorSpace;
 
 #include "KoColorConversionTransformation.h"
+#include "kritapigment_export.h"
 
 /**
  * This class holds a cache of KoColorConversionTransformations.
  *
+ * Every thread keeps its own small table of the transformations it has
+ * used recently, so a repeated lookup doesn't take any lock. Since a
+ * transformation referenced by such a table is never handed out to
+ * another thread, every thread effectively works on its own instance
+ * of the (not thread-safe) LCMS transform.
+ *
  * This class is not part of public API, and can be changed without notice.
  */
-class KoColorConversionCache
+class KRITAPIGMENT_EXPORT KoColorConversionCache
 {
 public:
     struct CachedTransformation;
+
+    /**
+     * Counters describing how the cache is used. The values are
+     * collected with relaxed atomics and are meant for profiling only.
+     */
+    struct Statistics {
+        /// lookups resolved by the thread-local table without locking
+        int fastPathHits = 0;
+        /// lookups that had to go to the shared cache
+        int slowPathLookups = 0;
+        /// slow path lookups that had to wait for another thread
+        int contendedLocks = 0;
+        /// number of transformations created by the cache
+        int createdTransformations = 0;
+    };
+
 public:
     KoColorConversionCache();
     ~KoColorConversionCache();
@@ -56,6 +79,20 @@ public:
      * @param src source color space
      */
     void colorSpaceIsDestroyed(const KoColorSpace* src);
+
+    /**
+     * @return the usage counters collected since the creation of the
+     * cache or the last call to resetStatistics(). Fast path hits of
+     * other threads are published in batches, so the value may lag
+     * slightly behind.
+     */
+    Statistics statistics() const;
+
+    /**
+     * Resets all the usage counters to zero
+     */
+    void resetStatistics();
+
 private:
     struct Private;
     Private* const d;
@@ -550,6 +550,17 @@ namespace Arithmetic
     
     template<class T>
     inline T mul(T a, T b, T c) { return KoColorSpaceMaths<T>::multiply(a, b, c); }
+
+    /**
+     * mul(a, b, opacity) for the composite op loops instantiated for
+     * \p fullOpacity. There the opacity is replaced with a compile-time
+     * unit value, so the compiler can fold the multiplication without
+     * changing the result.
+     */
+    template<bool fullOpacity, class T>
+    inline T mulOpacity(T a, T b, T opacity) {
+        return mul(a, b, fullOpacity ? KoColorSpaceMathsTraits<T>::unitValue : opacity);
+    }
     
 //     template<class T>
 //     inline T mul(T a, T b) {
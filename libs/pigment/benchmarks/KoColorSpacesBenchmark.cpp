@@ -21,6 +21,7 @@
 #include <QTest>
 #include <KoColorSpaceRegistry.h>
 #include <KoColorSpace.h>
+#include <KoColorModelStandardIds.h>
 
 #define NB_PIXELS 1000000
 
@@ -146,4 +147,68 @@ void KoColorSpacesBenchmark::benchmarkSetAlpha2IndividualCall()
     END_BENCHMARK
 }
 
+void KoColorSpacesBenchmark::benchmarkConversion_data()
+{
+    QTest::addColumn<QString>("srcDepthID");
+    QTest::addColumn<QString>("dstDepthID");
+    QTest::addColumn<QString>("dstProfileName");
+
+    const QString u8 = Integer8BitsColorDepthID.id();
+    const QString u16 = Integer16BitsColorDepthID.id();
+    const QString f32 = Float32BitsColorDepthID.id();
+
+    // the same profile, handled by the direct conversions
+    QTest::newRow("U8 -> U16") << u8 << u16 << QString();
+    QTest::newRow("U16 -> U8") << u16 << u8 << QString();
+    QTest::newRow("U8 -> F32") << u8 << f32 << QString();
+    QTest::newRow("F32 -> U8") << f32 << u8 << QString();
+    QTest::newRow("U16 -> F32") << u16 << f32 << QString();
+    QTest::newRow("F32 -> U16") << f32 << u16 << QString();
+
+    // a real color transformation, for comparison
+    QTest::newRow("U8 -> U8 linear") << u8 << u8 << "scRGB (linear)";
+}
+
+void KoColorSpacesBenchmark::benchmarkConversion()
+{
+    QFETCH(QString, srcDepthID);
+    QFETCH(QString, dstDepthID);
+    QFETCH(QString, dstProfileName);
+
+    KoColorSpaceRegistry *registry = KoColorSpaceRegistry::instance();
+
+    const KoColorSpace *srcColorSpace = registry->colorSpace(RGBAColorModelID.id(), srcDepthID, 0);
+    const KoColorSpace *dstColorSpace =
+        dstProfileName.isEmpty() ?
+        registry->colorSpace(RGBAColorModelID.id(), dstDepthID, srcColorSpace->profile()) :
+        registry->colorSpace(RGBAColorModelID.id(), dstDepthID, dstProfileName);
+
+    QVERIFY(srcColorSpace);
+    QVERIFY(dstColorSpace);
+
+    quint8 *src = new quint8[NB_PIXELS * srcColorSpace->pixelSize()];
+    quint8 *dst = new quint8[NB_PIXELS * dstColorSpace->pixelSize()];
+
+    // fill the source with some noise, so that LittleCMS couldn't use its cache
+    if (srcDepthID == Float32BitsColorDepthID.id()) {
+        float *it = reinterpret_cast<float*>(src);
+        for (int i = 0; i < NB_PIXELS * int(srcColorSpace->channelCount()); i++) {
+            it[i] = (i % 251) / 250.0f;
+        }
+    } else {
+        for (int i = 0; i < NB_PIXELS * int(srcColorSpace->pixelSize()); i++) {
+            src[i] = i % 251;
+        }
+    }
+
+    QBENCHMARK {
+        srcColorSpace->convertPixelsTo(src, dst, dstColorSpace, NB_PIXELS,
+                                       KoColorConversionTransformation::internalRenderingIntent(),
+                                       KoColorConversionTransformation::internalConversionFlags());
+    }
+
+    delete[] src;
+    delete[] dst;
+}
+
 QTEST_MAIN(KoColorSpacesBenchmark)
@@ -20,12 +20,17 @@
 
 #include "../compositeops/KoCompositeOpAlphaDarken.h"
 #include "../compositeops/KoCompositeOpOver.h"
+#include "../compositeops/KoCompositeOpGeneric.h"
+#include <klocalizedstring.h>
+#include "../compositeops/KoCompositeOps.h"
 #include <KoOptimizedCompositeOpFactory.h>
+#include <KoCompositeOpRegistry.h>
 
 #include <KoColorSpaceTraits.h>
 #include <KoColorSpaceRegistry.h>
 
 #include <QTest>
+#include <QColor>
 
 const int TILE_WIDTH = 64;
 const int TILE_HEIGHT = 64;
@@ -35,6 +40,9 @@ const int IMG_HEIGHT = 4096;
 
 const quint8 OPACITY_HALF = 128;
 
+// big enough for RGBA F32
+const int MAX_PIXEL_SIZE = 16;
+
 const int TILES_IN_WIDTH = IMG_WIDTH / TILE_WIDTH;
 const int TILES_IN_HEIGHT = IMG_HEIGHT / TILE_HEIGHT;
 
@@ -52,8 +60,8 @@ const int TILES_IN_HEIGHT = IMG_HEIGHT / TILE_HEIGHT;
 
 void KoCompositeOpsBenchmark::initTestCase()
 {
-    m_dstBuffer = new quint8[ TILE_WIDTH * TILE_HEIGHT * KoBgrU16Traits::pixelSize ];
-    m_srcBuffer = new quint8[ TILE_WIDTH * TILE_HEIGHT * KoBgrU16Traits::pixelSize ];
+    m_dstBuffer = new quint8[ TILE_WIDTH * TILE_HEIGHT * MAX_PIXEL_SIZE ];
+    m_srcBuffer = new quint8[ TILE_WIDTH * TILE_HEIGHT * MAX_PIXEL_SIZE ];
 }
 
 // this is called before every benchmark
@@ -87,5 +95,254 @@ void KoCompositeOpsBenchmark::benchmarkCompositeAlphaDarken()
     }
 }
 
+/**
+ * Creates the op the same way AddGeneralOps does, that is the optimized
+ * version is selected by the blend function rather than by the id
+ */
+template<class Traits, typename Traits::channels_type compositeFunc(typename Traits::channels_type, typename Traits::channels_type)>
+KoCompositeOp* createGenericSCOpImpl(const KoColorSpace *cs, const QString &id, bool optimized)
+{
+    return optimized ?
+        _Private::OptimizedOpsSelector<Traits>::template createGenericSCOp<compositeFunc>(cs, id, id, QString()) :
+        new KoCompositeOpGenericSC<Traits, compositeFunc>(cs, id, id, QString());
+}
+
+template<class Traits>
+KoCompositeOp* createGenericSCOp(const KoColorSpace *cs, const QString &id, bool optimized = false)
+{
+    typedef typename Traits::channels_type T;
+
+    if (id == COMPOSITE_MULT) return createGenericSCOpImpl<Traits, &cfMultiply<T> >(cs, id, optimized);
+    if (id == COMPOSITE_SCREEN) return createGenericSCOpImpl<Traits, &cfScreen<T> >(cs, id, optimized);
+    if (id == COMPOSITE_ADD) return createGenericSCOpImpl<Traits, &cfAddition<T> >(cs, id, optimized);
+    if (id == COMPOSITE_SUBTRACT) return createGenericSCOpImpl<Traits, &cfSubtract<T> >(cs, id, optimized);
+    if (id == COMPOSITE_DARKEN) return createGenericSCOpImpl<Traits, &cfDarkenOnly<T> >(cs, id, optimized);
+    if (id == COMPOSITE_LIGHTEN) return createGenericSCOpImpl<Traits, &cfLightenOnly<T> >(cs, id, optimized);
+    if (id == COMPOSITE_DIFF) return createGenericSCOpImpl<Traits, &cfDifference<T> >(cs, id, optimized);
+    if (id == COMPOSITE_EXCLUSION) return createGenericSCOpImpl<Traits, &cfExclusion<T> >(cs, id, optimized);
+    if (id == COMPOSITE_OVERLAY) return createGenericSCOpImpl<Traits, &cfOverlay<T> >(cs, id, optimized);
+    if (id == COMPOSITE_HARD_LIGHT) return createGenericSCOpImpl<Traits, &cfHardLight<T> >(cs, id, optimized);
+    if (id == COMPOSITE_DODGE) return createGenericSCOpImpl<Traits, &cfColorDodge<T> >(cs, id, optimized);
+    if (id == COMPOSITE_BURN) return createGenericSCOpImpl<Traits, &cfColorBurn<T> >(cs, id, optimized);
+    if (id == COMPOSITE_LINEAR_BURN) return createGenericSCOpImpl<Traits, &cfLinearBurn<T> >(cs, id, optimized);
+    if (id == COMPOSITE_LINEAR_LIGHT) return createGenericSCOpImpl<Traits, &cfLinearLight<T> >(cs, id, optimized);
+    if (id == COMPOSITE_SOFT_LIGHT_PHOTOSHOP) return createGenericSCOpImpl<Traits, &cfSoftLight<T> >(cs, id, optimized);
+    if (id == COMPOSITE_SOFT_LIGHT_SVG) return createGenericSCOpImpl<Traits, &cfSoftLightSvg<T> >(cs, id, optimized);
+    if (id == COMPOSITE_GRAIN_MERGE) return createGenericSCOpImpl<Traits, &cfGrainMerge<T> >(cs, id, optimized);
+    if (id == COMPOSITE_GRAIN_EXTRACT) return createGenericSCOpImpl<Traits, &cfGrainExtract<T> >(cs, id, optimized);
+    if (id == COMPOSITE_DIVIDE) return createGenericSCOpImpl<Traits, &cfDivide<T> >(cs, id, optimized);
+
+    return 0;
+}
+
+void fillBuffer(const KoColorSpace *cs, quint8 *buffer, int seed)
+{
+    const int pixelSize = cs->pixelSize();
+
+    for (int i = 0; i < TILE_WIDTH * TILE_HEIGHT; i++) {
+        const QColor color((i * 7 + seed) % 256, (i * 13 + seed) % 256, (i * 17 + seed) % 256, 64 + (i + seed) % 192);
+        cs->fromQColor(color, buffer + i * pixelSize);
+    }
+}
+
+QStringList genericSCOpIds()
+{
+    return QStringList({COMPOSITE_MULT, COMPOSITE_SCREEN, COMPOSITE_ADD, COMPOSITE_SUBTRACT,
+                        COMPOSITE_DARKEN, COMPOSITE_LIGHTEN, COMPOSITE_DIFF, COMPOSITE_EXCLUSION,
+                        COMPOSITE_OVERLAY, COMPOSITE_HARD_LIGHT, COMPOSITE_DODGE, COMPOSITE_BURN,
+                        COMPOSITE_LINEAR_BURN, COMPOSITE_LINEAR_LIGHT, COMPOSITE_SOFT_LIGHT_PHOTOSHOP,
+                        COMPOSITE_SOFT_LIGHT_SVG, COMPOSITE_GRAIN_MERGE, COMPOSITE_GRAIN_EXTRACT,
+                        COMPOSITE_DIVIDE});
+}
+
+template<typename channel_type>
+bool compareBuffers(const quint8 *buf1, const quint8 *buf2, channel_type prec)
+{
+    const channel_type *p1 = reinterpret_cast<const channel_type*>(buf1);
+    const channel_type *p2 = reinterpret_cast<const channel_type*>(buf2);
+
+    for (int i = 0; i < TILE_WIDTH * TILE_HEIGHT * 4; i++) {
+        if (qAbs(p1[i] - p2[i]) > prec) {
+            qDebug() << "Wrong result: pixel" << i / 4 << "channel" << i % 4
+                     << "act" << p1[i] << "exp" << p2[i];
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void KoCompositeOpsBenchmark::compareGenericSCOps_data()
+{
+    QTest::addColumn<QString>("colorDepthId");
+    QTest::addColumn<QString>("compositeOpId");
+
+    Q_FOREACH (const QString &depth, QStringList({"U8", "F32"})) {
+        Q_FOREACH (const QString &id, genericSCOpIds()) {
+            QTest::newRow(QString("%1-%2").arg(depth).arg(id).toLatin1()) << depth << id;
+        }
+    }
+}
+
+void KoCompositeOpsBenchmark::compareGenericSCOps()
+{
+    QFETCH(QString, colorDepthId);
+    QFETCH(QString, compositeOpId);
+
+    const bool isFloat = colorDepthId == "F32";
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", colorDepthId, "");
+    QVERIFY(cs);
+
+    QScopedPointer<KoCompositeOp> opAct(isFloat ?
+        createGenericSCOp<KoRgbF32Traits>(cs, compositeOpId, true) :
+        createGenericSCOp<KoBgrU8Traits>(cs, compositeOpId, true));
+
+    if (!opAct) {
+        QSKIP("Vector instructions are not available");
+    }
+
+    QScopedPointer<KoCompositeOp> opExp(isFloat ?
+        createGenericSCOp<KoRgbF32Traits>(cs, compositeOpId) :
+        createGenericSCOp<KoBgrU8Traits>(cs, compositeOpId));
+    QVERIFY(opExp);
+
+    const int rowStride = TILE_WIDTH * cs->pixelSize();
+    const int bufferSize = TILE_HEIGHT * rowStride;
+    QScopedArrayPointer<quint8> expBuffer(new quint8[bufferSize]);
+
+    fillBuffer(cs, m_srcBuffer, 0);
+    fillBuffer(cs, m_dstBuffer, 113);
+    memcpy(expBuffer.data(), m_dstBuffer, bufferSize);
+
+    opAct->composite(m_dstBuffer, rowStride, m_srcBuffer, rowStride, 0, 0,
+                     TILE_WIDTH, TILE_HEIGHT, OPACITY_HALF);
+    opExp->composite(expBuffer.data(), rowStride, m_srcBuffer, rowStride, 0, 0,
+                     TILE_WIDTH, TILE_HEIGHT, OPACITY_HALF);
+
+    // the optimized op rounds exactly like the integer math of the generic one
+    if (isFloat) {
+        QVERIFY(compareBuffers<float>(m_dstBuffer, expBuffer.data(), 1e-5));
+    } else {
+        QVERIFY(compareBuffers<quint8>(m_dstBuffer, expBuffer.data(), 1));
+    }
+}
+
+void KoCompositeOpsBenchmark::benchmarkCompositeGenericSC_data()
+{
+    QTest::addColumn<QString>("colorDepthId");
+    QTest::addColumn<QString>("compositeOpId");
+    QTest::addColumn<bool>("optimized");
+
+    Q_FOREACH (const QString &depth, QStringList({"U8", "F32"})) {
+        Q_FOREACH (const QString &id, genericSCOpIds()) {
+            QTest::newRow(QString("%1-%2-generic").arg(depth).arg(id).toLatin1()) << depth << id << false;
+            QTest::newRow(QString("%1-%2-optimized").arg(depth).arg(id).toLatin1()) << depth << id << true;
+        }
+    }
+}
+
+void KoCompositeOpsBenchmark::benchmarkCompositeGenericSC()
+{
+    QFETCH(QString, colorDepthId);
+    QFETCH(QString, compositeOpId);
+    QFETCH(bool, optimized);
+
+    const bool isFloat = colorDepthId == "F32";
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", colorDepthId, "");
+    QVERIFY(cs);
+
+    KoCompositeOp *compositeOp = 0;
+
+    if (optimized) {
+        compositeOp = isFloat ?
+            createGenericSCOp<KoRgbF32Traits>(cs, compositeOpId, true) :
+            createGenericSCOp<KoBgrU8Traits>(cs, compositeOpId, true);
+
+        if (!compositeOp) {
+            QSKIP("Vector instructions are not available");
+        }
+    } else {
+        compositeOp = isFloat ?
+            createGenericSCOp<KoRgbF32Traits>(cs, compositeOpId) :
+            createGenericSCOp<KoBgrU8Traits>(cs, compositeOpId);
+    }
+    QVERIFY(compositeOp);
+
+    fillBuffer(cs, m_srcBuffer, 0);
+    fillBuffer(cs, m_dstBuffer, 113);
+
+    const int rowStride = TILE_WIDTH * cs->pixelSize();
+
+    QBENCHMARK{
+        for (int y = 0; y < TILES_IN_HEIGHT; y++) {
+            for (int x = 0; x < TILES_IN_WIDTH; x++) {
+                compositeOp->composite(m_dstBuffer, rowStride,
+                                       m_srcBuffer, rowStride,
+                                       0, 0,
+                                       TILE_WIDTH, TILE_HEIGHT,
+                                       OPACITY_HALF);
+            }
+        }
+    }
+
+    delete compositeOp;
+}
+
+void KoCompositeOpsBenchmark::benchmarkCompositeSpecializations_data()
+{
+    QTest::addColumn<QString>("compositeOpId");
+    QTest::addColumn<bool>("useMask");
+    QTest::addColumn<int>("opacity");
+
+    Q_FOREACH (const QString &id, QStringList({COMPOSITE_OVER, COMPOSITE_MULT, COMPOSITE_OVERLAY})) {
+        QTest::newRow(QString("%1-nomask-opaque").arg(id).toLatin1()) << id << false << 255;
+        QTest::newRow(QString("%1-nomask-254-before").arg(id).toLatin1()) << id << false << 254;
+        QTest::newRow(QString("%1-mask-opaque").arg(id).toLatin1()) << id << true << 255;
+        QTest::newRow(QString("%1-mask-254-before").arg(id).toLatin1()) << id << true << 254;
+    }
+}
+
+/**
+ * Measures the non-vectorized ops in the common layer merging case (no mask,
+ * opaque layer). There is no separate "before" implementation: the rows
+ * marked "254-before" use opacity 254, which goes through the same loop
+ * as before the full opacity specialization, that is the opacity is
+ * multiplied into every pixel. Compare them with the "opaque" rows.
+ */
+void KoCompositeOpsBenchmark::benchmarkCompositeSpecializations()
+{
+    QFETCH(QString, compositeOpId);
+    QFETCH(bool, useMask);
+    QFETCH(int, opacity);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16();
+
+    QScopedPointer<KoCompositeOp> compositeOp(compositeOpId == COMPOSITE_OVER ?
+        new KoCompositeOpOver<KoBgrU16Traits>(cs) :
+        createGenericSCOp<KoBgrU16Traits>(cs, compositeOpId));
+    QVERIFY(compositeOp);
+
+    fillBuffer(cs, m_srcBuffer, 0);
+    fillBuffer(cs, m_dstBuffer, 113);
+
+    QScopedArrayPointer<quint8> mask(new quint8[TILE_WIDTH * TILE_HEIGHT]);
+    for (int i = 0; i < TILE_WIDTH * TILE_HEIGHT; i++) {
+        mask[i] = 128 + i % 128;
+    }
+
+    const int rowStride = TILE_WIDTH * cs->pixelSize();
+
+    QBENCHMARK{
+        for (int y = 0; y < TILES_IN_HEIGHT; y++) {
+            for (int x = 0; x < TILES_IN_WIDTH; x++) {
+                compositeOp->composite(m_dstBuffer, rowStride,
+                                       m_srcBuffer, rowStride,
+                                       useMask ? mask.data() : 0, useMask ? TILE_WIDTH : 0,
+                                       TILE_WIDTH, TILE_HEIGHT,
+                                       opacity);
+            }
+        }
+    }
+}
 
 QTEST_GUILESS_MAIN(KoCompositeOpsBenchmark)
@@ -33,6 +33,15 @@ private Q_SLOTS:
     void benchmarkCompositeOver();
     void benchmarkCompositeAlphaDarken();
 
+    void compareGenericSCOps_data();
+    void compareGenericSCOps();
+
+    void benchmarkCompositeGenericSC_data();
+    void benchmarkCompositeGenericSC();
+
+    void benchmarkCompositeSpecializations_data();
+    void benchmarkCompositeSpecializations();
+
 private:
     quint8 * m_dstBuffer;
     quint8 * m_srcBuffer;
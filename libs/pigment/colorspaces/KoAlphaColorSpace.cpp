@@ -58,7 +58,7 @@ public:
         : base_class(cs, COMPOSITE_MULT, i18n("Multiply"), KoCompositeOp::categoryArithmetic()) { }
 
 public:
-    template<bool alphaLocked, bool allChannelFlags>
+    template<bool alphaLocked, bool allChannelFlags, bool fullOpacity>
     inline static channels_type composeColorChannels(const channels_type* src, channels_type srcAlpha,
                                                      channels_type*       dst, channels_type dstAlpha, channels_type maskAlpha,
                                                      channels_type opacity, const QBitArray& channelFlags) {
@@ -72,7 +72,7 @@ public:
         if (!alphaLocked) {
             // use internal parallelism for multiplication!
             srcAlpha = mul(srcAlpha, maskAlpha);
-            dstAlpha = mul(dstAlpha, opacity);
+            dstAlpha = fullOpacity ? dstAlpha : mul(dstAlpha, opacity);
             dstAlpha = mul(srcAlpha, dstAlpha);
         }
 
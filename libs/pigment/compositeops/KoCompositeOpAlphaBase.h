@@ -53,7 +53,7 @@ public:
 public:
     using KoCompositeOp::composite;
 
-    template<bool alphaLocked, bool allChannelFlags>
+    template<bool alphaLocked, bool allChannelFlags, bool useMask, bool fullOpacity>
     void composite(quint8 *dstRowStart,
                    qint32 dststride,
                    const quint8 *srcRowStart,
@@ -81,10 +81,10 @@ public:
                 channels_type srcAlpha = _CSTraits::alpha_pos == -1 ? NATIVE_OPACITY_OPAQUE : _compositeOp::selectAlpha(srcN[_CSTraits::alpha_pos], dstN[_CSTraits::alpha_pos]);
 
                 // apply the alphamask
-                if (mask != 0) {
+                if (useMask) {
                     srcAlpha = KoColorSpaceMaths<quint8, channels_type>::multiply(*mask, srcAlpha, opacity);
                     mask++;
-                } else if (opacity != NATIVE_OPACITY_OPAQUE) {
+                } else if (!fullOpacity) {
                     srcAlpha = KoColorSpaceMaths<channels_type>::multiply(srcAlpha, opacity);
                 }
 
@@ -130,7 +130,7 @@ public:
             rows--;
             srcRowStart += srcstride;
             dstRowStart += dststride;
-            if (maskRowStart) {
+            if (useMask) {
                 maskRowStart += maskstride;
             }
         }
@@ -156,6 +156,40 @@ public:
         }
     }
 
+    /**
+     * Selects the instantiation of the inner loop, so that neither the mask
+     * nor the opacity is checked for every pixel. Full opacity without
+     * a mask is the usual case for merging layers.
+     */
+    template<bool alphaLocked, bool allChannelFlags>
+    void composite(quint8 *dstRowStart,
+                   qint32 dststride,
+                   const quint8 *srcRowStart,
+                   qint32 srcstride,
+                   const quint8 *maskRowStart,
+                   qint32 maskstride,
+                   qint32 rows,
+                   qint32 cols,
+                   quint8 U8_opacity,
+                   const QBitArray & channelFlags) const
+    {
+        const bool fullOpacity = U8_opacity == OPACITY_OPAQUE_U8;
+
+        if (maskRowStart) {
+            if (fullOpacity) {
+                composite<alphaLocked, allChannelFlags, true, true>(dstRowStart, dststride, srcRowStart, srcstride, maskRowStart, maskstride, rows, cols, U8_opacity, channelFlags);
+            } else {
+                composite<alphaLocked, allChannelFlags, true, false>(dstRowStart, dststride, srcRowStart, srcstride, maskRowStart, maskstride, rows, cols, U8_opacity, channelFlags);
+            }
+        } else {
+            if (fullOpacity) {
+                composite<alphaLocked, allChannelFlags, false, true>(dstRowStart, dststride, srcRowStart, srcstride, maskRowStart, maskstride, rows, cols, U8_opacity, channelFlags);
+            } else {
+                composite<alphaLocked, allChannelFlags, false, false>(dstRowStart, dststride, srcRowStart, srcstride, maskRowStart, maskstride, rows, cols, U8_opacity, channelFlags);
+            }
+        }
+    }
+
     void composite(quint8 *dstRowStart,
                            qint32 dststride,
                            const quint8 *srcRowStart,
@@ -28,7 +28,7 @@
  *
  * @param _compositeOp this template parameter is a class that must be
  *        derived fom KoCompositeOpBase and must define the static member function
- *        template<bool alphaLocked, bool allChannelFlags>
+ *        template<bool alphaLocked, bool allChannelFlags, bool fullOpacity>
  *        inline static channels_type composeColorChannels(
  *            const channels_type* src,
  *            channels_type srcAlpha,
@@ -39,7 +39,9 @@
  *            const QBitArray& channelFlags
  *        )
  *
- *        where channels_type is _CSTraits::channels_type
+ *        where channels_type is _CSTraits::channels_type. When \p fullOpacity
+ *        is true, \p opacity is always unitValue, so the op may skip
+ *        applying it (\see Arithmetic::mulOpacity())
  */
 template<class _CSTraits, class _compositeOp>
 class KoCompositeOpBase : public KoCompositeOp
@@ -61,37 +63,43 @@ public:
         bool             allChannelFlags = params.channelFlags.isEmpty() || params.channelFlags == QBitArray(channels_nb,true);
         bool             alphaLocked     = (alpha_pos != -1) && !flags.testBit(alpha_pos);
         bool             useMask         = params.maskRowStart != 0;
+        bool             fullOpacity     = params.opacity == 1.0f;
 
+        /**
+         * Layer merging mostly happens with full opacity and without
+         * a mask, so these cases get their own instantiations with
+         * the opacity known in compile-time
+         */
         if(useMask) {
-            if(alphaLocked) {
-                if(allChannelFlags) { genericComposite<true,true,true> (params, flags); }
-                else                { genericComposite<true,true,false>(params, flags); }
-            }
-            else {
-                if(allChannelFlags) { genericComposite<true,false,true> (params, flags); }
-                else                { genericComposite<true,false,false>(params, flags); }
-            }
+            if(fullOpacity) { dispatchComposite<true,true> (params, flags, alphaLocked, allChannelFlags); }
+            else            { dispatchComposite<true,false>(params, flags, alphaLocked, allChannelFlags); }
         }
         else {
-            if(alphaLocked) {
-                if(allChannelFlags) { genericComposite<false,true,true> (params, flags); }
-                else                { genericComposite<false,true,false>(params, flags); }
-            }
-            else {
-                if(allChannelFlags) { genericComposite<false,false,true> (params, flags); }
-                else                { genericComposite<false,false,false>(params, flags); }
-            }
+            if(fullOpacity) { dispatchComposite<false,true> (params, flags, alphaLocked, allChannelFlags); }
+            else            { dispatchComposite<false,false>(params, flags, alphaLocked, allChannelFlags); }
         }
     }
 
 private:
-    template<bool useMask, bool alphaLocked, bool allChannelFlags>
+    template<bool useMask, bool fullOpacity>
+    void dispatchComposite(const KoCompositeOp::ParameterInfo& params, const QBitArray& flags, bool alphaLocked, bool allChannelFlags) const {
+        if(alphaLocked) {
+            if(allChannelFlags) { genericComposite<useMask,true,true,fullOpacity> (params, flags); }
+            else                { genericComposite<useMask,true,false,fullOpacity>(params, flags); }
+        }
+        else {
+            if(allChannelFlags) { genericComposite<useMask,false,true,fullOpacity> (params, flags); }
+            else                { genericComposite<useMask,false,false,fullOpacity>(params, flags); }
+        }
+    }
+
+    template<bool useMask, bool alphaLocked, bool allChannelFlags, bool fullOpacity>
     void genericComposite(const KoCompositeOp::ParameterInfo& params, const QBitArray& channelFlags) const {
 
         using namespace Arithmetic;
 
         qint32        srcInc       = (params.srcRowStride == 0) ? 0 : channels_nb;
-        channels_type opacity      = scale<channels_type>(params.opacity);
+        channels_type opacity      = fullOpacity ? unitValue<channels_type>() : scale<channels_type>(params.opacity);
         quint8*       dstRowStart  = params.dstRowStart;
         const quint8* srcRowStart  = params.srcRowStart;
         const quint8* maskRowStart = params.maskRowStart;
@@ -110,7 +118,7 @@ private:
                     memset(dst, 0, pixel_size);
                 }
 
-                channels_type newDstAlpha = _compositeOp::template composeColorChannels<alphaLocked,allChannelFlags>(
+                channels_type newDstAlpha = _compositeOp::template composeColorChannels<alphaLocked,allChannelFlags,fullOpacity>(
                     src, srcAlpha, dst, dstAlpha, mskAlpha, opacity, channelFlags
                 );
 
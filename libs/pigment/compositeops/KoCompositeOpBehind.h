@@ -39,7 +39,7 @@ public:
         : base_class(cs, COMPOSITE_BEHIND, i18n("Behind"), KoCompositeOp::categoryMix()) { }
 
 public:
-    template<bool alphaLocked, bool allChannelFlags>
+    template<bool alphaLocked, bool allChannelFlags, bool fullOpacity>
     inline static channels_type composeColorChannels(const channels_type* src, channels_type srcAlpha,
                                                      channels_type*       dst, channels_type dstAlpha,
                                                      channels_type  maskAlpha, channels_type  opacity,
@@ -47,7 +47,7 @@ public:
         using namespace Arithmetic;
                 
         if (dstAlpha     == unitValue<channels_type>()) return dstAlpha;
-        channels_type appliedAlpha       = mul(maskAlpha, srcAlpha, opacity);
+        channels_type appliedAlpha       = mulOpacity<fullOpacity>(maskAlpha, srcAlpha, opacity);
         
         if (appliedAlpha == zeroValue<channels_type>()) return dstAlpha;
         channels_type newDstAlpha        = unionShapeOpacity(dstAlpha, appliedAlpha);
@@ -45,12 +45,12 @@ public:
         : base_class(cs, COMPOSITE_COPY, i18n("Copy"), KoCompositeOp::categoryMisc()) { }
 
 public:
-    template<bool alphaLocked, bool allChannelFlags>
+    template<bool alphaLocked, bool allChannelFlags, bool fullOpacity>
     inline static channels_type composeColorChannels(const channels_type* src, channels_type srcAlpha,
                                                      channels_type*       dst, channels_type dstAlpha, channels_type maskAlpha,
                                                      channels_type opacity, const QBitArray& channelFlags) {
         using namespace Arithmetic;
-        opacity = mul(maskAlpha, opacity);
+        opacity = fullOpacity ? maskAlpha : mul(maskAlpha, opacity);
 
         channels_type newAlpha = zeroValue<channels_type>();
 
@@ -47,13 +47,13 @@ public:
         : base_class(cs, id, description, category) { }
 
 public:
-    template<bool alphaLocked, bool allChannelFlags>
+    template<bool alphaLocked, bool allChannelFlags, bool fullOpacity>
     inline static channels_type composeColorChannels(const channels_type* src, channels_type srcAlpha,
                                                      channels_type*       dst, channels_type dstAlpha, channels_type maskAlpha,
                                                      channels_type opacity, const QBitArray& channelFlags) {
         using namespace Arithmetic;
         
-        srcAlpha = mul(srcAlpha, maskAlpha, opacity);
+        srcAlpha = mulOpacity<fullOpacity>(srcAlpha, maskAlpha, opacity);
         
         if(alphaLocked) {
             if(dstAlpha != zeroValue<channels_type>()) {
@@ -105,13 +105,13 @@ public:
         : base_class(cs, id, description, category) { }
     
 public:
-    template<bool alphaLocked, bool allChannelFlags>
+    template<bool alphaLocked, bool allChannelFlags, bool fullOpacity>
     inline static channels_type composeColorChannels(const channels_type* src, channels_type srcAlpha,
                                                      channels_type*       dst, channels_type dstAlpha, channels_type maskAlpha,
                                                      channels_type opacity, const QBitArray& channelFlags) {
         using namespace Arithmetic;
         
-        srcAlpha = mul(srcAlpha, maskAlpha, opacity);
+        srcAlpha = mulOpacity<fullOpacity>(srcAlpha, maskAlpha, opacity);
         
         if(alphaLocked) {
             if(dstAlpha != zeroValue<channels_type>()) {
@@ -49,6 +49,52 @@ struct AddGeneralOps
     static void add(KoColorSpace* cs) { Q_UNUSED(cs); }
 };
 
+/**
+ * Maps a scalar blend function from KoCompositeOpFunctions.h to the id
+ * of its vectorized version, \see KoStreamedBlendFunctions.h. Only the
+ * channel types having optimized ops (8-bit integer and 32-bit float)
+ * are mapped, all the other functions get KoStreamedBlend::NoFunctionId.
+ */
+template<typename T, T compositeFunc(T, T)>
+struct StreamedBlendFunctionId
+{
+    static const KoStreamedBlend::FunctionId value = KoStreamedBlend::NoFunctionId;
+};
+
+#define DECLARE_STREAMED_BLEND_FUNCTION(_compositeFunc, _functionId)                       \
+    template<>                                                                              \
+    struct StreamedBlendFunctionId<quint8, &_compositeFunc<quint8> >                        \
+    {                                                                                       \
+        static const KoStreamedBlend::FunctionId value = KoStreamedBlend::_functionId;      \
+    };                                                                                      \
+    template<>                                                                              \
+    struct StreamedBlendFunctionId<float, &_compositeFunc<float> >                          \
+    {                                                                                       \
+        static const KoStreamedBlend::FunctionId value = KoStreamedBlend::_functionId;      \
+    }
+
+DECLARE_STREAMED_BLEND_FUNCTION(cfMultiply, MultiplyId);
+DECLARE_STREAMED_BLEND_FUNCTION(cfScreen, ScreenId);
+DECLARE_STREAMED_BLEND_FUNCTION(cfAddition, AdditionId);
+DECLARE_STREAMED_BLEND_FUNCTION(cfSubtract, SubtractId);
+DECLARE_STREAMED_BLEND_FUNCTION(cfDarkenOnly, DarkenId);
+DECLARE_STREAMED_BLEND_FUNCTION(cfLightenOnly, LightenId);
+DECLARE_STREAMED_BLEND_FUNCTION(cfDifference, DifferenceId);
+DECLARE_STREAMED_BLEND_FUNCTION(cfExclusion, ExclusionId);
+DECLARE_STREAMED_BLEND_FUNCTION(cfOverlay, OverlayId);
+DECLARE_STREAMED_BLEND_FUNCTION(cfHardLight, HardLightId);
+DECLARE_STREAMED_BLEND_FUNCTION(cfColorDodge, ColorDodgeId);
+DECLARE_STREAMED_BLEND_FUNCTION(cfColorBurn, ColorBurnId);
+DECLARE_STREAMED_BLEND_FUNCTION(cfLinearBurn, LinearBurnId);
+DECLARE_STREAMED_BLEND_FUNCTION(cfLinearLight, LinearLightId);
+DECLARE_STREAMED_BLEND_FUNCTION(cfSoftLight, SoftLightId);
+DECLARE_STREAMED_BLEND_FUNCTION(cfSoftLightSvg, SoftLightSvgId);
+DECLARE_STREAMED_BLEND_FUNCTION(cfGrainMerge, GrainMergeId);
+DECLARE_STREAMED_BLEND_FUNCTION(cfGrainExtract, GrainExtractId);
+DECLARE_STREAMED_BLEND_FUNCTION(cfDivide, DivideId);
+
+#undef DECLARE_STREAMED_BLEND_FUNCTION
+
 template<class Traits>
 struct OptimizedOpsSelector
 {
@@ -58,6 +104,11 @@ struct OptimizedOpsSelector
     static KoCompositeOp* createOverOp(const KoColorSpace *cs) {
         return new KoCompositeOpOver<Traits>(cs);
     }
+    template<typename Traits::channels_type compositeFunc(typename Traits::channels_type, typename Traits::channels_type)>
+    static KoCompositeOp* createGenericSCOp(const KoColorSpace *cs, const QString& id, const QString& description, const QString& category) {
+        Q_UNUSED(cs); Q_UNUSED(id); Q_UNUSED(description); Q_UNUSED(category);
+        return 0;
+    }
 };
 
 template<>
@@ -69,6 +120,10 @@ struct OptimizedOpsSelector<KoBgrU8Traits>
     static KoCompositeOp* createOverOp(const KoColorSpace *cs) {
         return KoOptimizedCompositeOpFactory::createOverOp32(cs);
     }
+    template<quint8 compositeFunc(quint8, quint8)>
+    static KoCompositeOp* createGenericSCOp(const KoColorSpace *cs, const QString& id, const QString& description, const QString& category) {
+        return KoOptimizedCompositeOpFactory::createGenericSCOp32(cs, StreamedBlendFunctionId<quint8, compositeFunc>::value, id, description, category);
+    }
 };
 
 template<>
@@ -80,6 +135,10 @@ struct OptimizedOpsSelector<KoLabU8Traits>
     static KoCompositeOp* createOverOp(const KoColorSpace *cs) {
         return KoOptimizedCompositeOpFactory::createOverOp32(cs);
     }
+    template<quint8 compositeFunc(quint8, quint8)>
+    static KoCompositeOp* createGenericSCOp(const KoColorSpace *cs, const QString& id, const QString& description, const QString& category) {
+        return KoOptimizedCompositeOpFactory::createGenericSCOp32(cs, StreamedBlendFunctionId<quint8, compositeFunc>::value, id, description, category);
+    }
 };
 
 template<>
@@ -91,6 +150,10 @@ struct OptimizedOpsSelector<KoRgbF32Traits>
     static KoCompositeOp* createOverOp(const KoColorSpace *cs) {
         return KoOptimizedCompositeOpFactory::createOverOp128(cs);
     }
+    template<float compositeFunc(float, float)>
+    static KoCompositeOp* createGenericSCOp(const KoColorSpace *cs, const QString& id, const QString& description, const QString& category) {
+        return KoOptimizedCompositeOpFactory::createGenericSCOp128(cs, StreamedBlendFunctionId<float, compositeFunc>::value, id, description, category);
+    }
 };
 
 template<class Traits>
@@ -102,7 +165,8 @@ struct AddGeneralOps<Traits, true>
 
      template<CompositeFunc func>
      static void add(KoColorSpace* cs, const QString& id, const QString& description, const QString& category) {
-         cs->addCompositeOp(new KoCompositeOpGenericSC<Traits, func>(cs, id, description, category));
+         KoCompositeOp *op = OptimizedOpsSelector<Traits>::template createGenericSCOp<func>(cs, id, description, category);
+         cs->addCompositeOp(op ? op : new KoCompositeOpGenericSC<Traits, func>(cs, id, description, category));
      }
 
      static void add(KoColorSpace* cs) {
@@ -44,3 +44,13 @@ KoCompositeOp* KoOptimizedCompositeOpFactory::createOverOp128(const KoColorSpace
 {
     return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOver128> >(cs);
 }
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createGenericSCOp32(const KoColorSpace *cs, KoStreamedBlend::FunctionId function, const QString &id, const QString &description, const QString &category)
+{
+    return createOptimizedClass<KoOptimizedGenericSCOpFactoryPerArch<KoOptimizedCompositeOpGenericSC32> >(KoOptimizedGenericSCOpParams(cs, function, id, description, category));
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createGenericSCOp128(const KoColorSpace *cs, KoStreamedBlend::FunctionId function, const QString &id, const QString &description, const QString &category)
+{
+    return createOptimizedClass<KoOptimizedGenericSCOpFactoryPerArch<KoOptimizedCompositeOpGenericSC128> >(KoOptimizedGenericSCOpParams(cs, function, id, description, category));
+}
@@ -21,9 +21,11 @@
 #define KOOPTIMIZEDCOMPOSITEOPFACTORY_H
 
 #include "kritapigment_export.h"
+#include "KoStreamedBlendFunctionId.h"
 
 class KoCompositeOp;
 class KoColorSpace;
+class QString;
 
 /**
  * The creation of the optimized composite ops is moved into a separate
@@ -44,6 +46,17 @@ public:
     static KoCompositeOp* createOverOp32(const KoColorSpace *cs);
     static KoCompositeOp* createAlphaDarkenOp128(const KoColorSpace *cs);
     static KoCompositeOp* createOverOp128(const KoColorSpace *cs);
+
+    /**
+     * Create a vectorized version of a separable blending op
+     * (multiply, screen, overlay, etc.) using the blend \p function.
+     * The op is registered as \p id. Returns null if the function has
+     * no optimized version or if the CPU doesn't support vector
+     * instructions. In such case the caller should use
+     * KoCompositeOpGenericSC instead.
+     */
+    static KoCompositeOp* createGenericSCOp32(const KoColorSpace *cs, KoStreamedBlend::FunctionId function, const QString &id, const QString &description, const QString &category);
+    static KoCompositeOp* createGenericSCOp128(const KoColorSpace *cs, KoStreamedBlend::FunctionId function, const QString &id, const QString &description, const QString &category);
 };
 
 #endif /* KOOPTIMIZEDCOMPOSITEOPFACTORY_H */
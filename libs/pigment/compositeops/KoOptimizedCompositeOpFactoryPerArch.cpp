@@ -26,6 +26,8 @@
 #include "KoOptimizedCompositeOpAlphaDarken128.h"
 #include "KoOptimizedCompositeOpOver32.h"
 #include "KoOptimizedCompositeOpOver128.h"
+#include "KoOptimizedCompositeOpGenericSC32.h"
+#include "KoOptimizedCompositeOpGenericSC128.h"
 
 #include <QString>
 #include "DebugPigment.h"
@@ -67,3 +69,41 @@ KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOver128>::create<Vc::
 {
     return new KoOptimizedCompositeOpOver128<Vc::CurrentImplementation::current()>(param);
 }
+
+namespace {
+
+template<template<Vc::Implementation I, class BlendFunc> class CompositeOp>
+struct GenericSCOpCreator
+{
+    typedef KoCompositeOp* ReturnType;
+
+    GenericSCOpCreator(const KoOptimizedGenericSCOpParams &_params)
+        : params(_params)
+    {
+    }
+
+    template<class BlendFunc>
+    ReturnType create() const {
+        return new CompositeOp<Vc::CurrentImplementation::current(), BlendFunc>(params.cs, params.id, params.description, params.category);
+    }
+
+    const KoOptimizedGenericSCOpParams &params;
+};
+
+}
+
+template<>
+template<>
+KoOptimizedGenericSCOpFactoryPerArch<KoOptimizedCompositeOpGenericSC32>::ReturnType
+KoOptimizedGenericSCOpFactoryPerArch<KoOptimizedCompositeOpGenericSC32>::create<Vc::CurrentImplementation::current()>(ParamType param)
+{
+    return KoStreamedBlend::createForFunctionId(param.function, GenericSCOpCreator<KoOptimizedCompositeOpGenericSC32>(param));
+}
+
+template<>
+template<>
+KoOptimizedGenericSCOpFactoryPerArch<KoOptimizedCompositeOpGenericSC128>::ReturnType
+KoOptimizedGenericSCOpFactoryPerArch<KoOptimizedCompositeOpGenericSC128>::create<Vc::CurrentImplementation::current()>(ParamType param)
+{
+    return KoStreamedBlend::createForFunctionId(param.function, GenericSCOpCreator<KoOptimizedCompositeOpGenericSC128>(param));
+}
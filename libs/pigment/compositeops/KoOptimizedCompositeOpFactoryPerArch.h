@@ -22,6 +22,8 @@
 
 
 #include <compositeops/KoVcMultiArchBuildSupport.h>
+#include <compositeops/KoStreamedBlendFunctionId.h>
+#include <QString>
 
 
 class KoCompositeOp;
@@ -40,6 +42,12 @@ class KoOptimizedCompositeOpAlphaDarken128;
 template<Vc::Implementation _impl>
 class KoOptimizedCompositeOpOver128;
 
+template<Vc::Implementation _impl, class BlendFunc>
+class KoOptimizedCompositeOpGenericSC32;
+
+template<Vc::Implementation _impl, class BlendFunc>
+class KoOptimizedCompositeOpGenericSC128;
+
 template<template<Vc::Implementation I> class CompositeOp>
 struct KoOptimizedCompositeOpFactoryPerArch
 {
@@ -50,5 +58,35 @@ struct KoOptimizedCompositeOpFactoryPerArch
     static ReturnType create(ParamType param);
 };
 
+struct KoOptimizedGenericSCOpParams
+{
+    KoOptimizedGenericSCOpParams(const KoColorSpace *_cs, KoStreamedBlend::FunctionId _function,
+                                 const QString &_id, const QString &_description, const QString &_category)
+        : cs(_cs), function(_function), id(_id), description(_description), category(_category)
+    {
+    }
+
+    const KoColorSpace *cs;
+    KoStreamedBlend::FunctionId function;
+    QString id;
+    QString description;
+    QString category;
+};
+
+/**
+ * Creates a vectorized separable composite op for the blend function
+ * passed in the params. The created object returns null if there is
+ * no optimized version of the requested function.
+ */
+template<template<Vc::Implementation I, class BlendFunc> class CompositeOp>
+struct KoOptimizedGenericSCOpFactoryPerArch
+{
+    typedef KoOptimizedGenericSCOpParams ParamType;
+    typedef KoCompositeOp* ReturnType;
+
+    template<Vc::Implementation _impl>
+    static ReturnType create(ParamType param);
+};
+
 
 #endif /* KOOPTIMIZEDCOMPOSITEOPFACTORYPERARCH_H */
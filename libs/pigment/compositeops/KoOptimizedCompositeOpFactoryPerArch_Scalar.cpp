@@ -55,3 +55,26 @@ KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOver128>::create<Vc::
 {
     return new KoCompositeOpOver<KoRgbF32Traits>(param);
 }
+
+/**
+ * There is no point in creating a scalar copy of the generic
+ * separable ops, the callers fall back to KoCompositeOpGenericSC
+ */
+
+template<>
+template<>
+KoOptimizedGenericSCOpFactoryPerArch<KoOptimizedCompositeOpGenericSC32>::ReturnType
+KoOptimizedGenericSCOpFactoryPerArch<KoOptimizedCompositeOpGenericSC32>::create<Vc::ScalarImpl>(ParamType param)
+{
+    Q_UNUSED(param);
+    return 0;
+}
+
+template<>
+template<>
+KoOptimizedGenericSCOpFactoryPerArch<KoOptimizedCompositeOpGenericSC128>::ReturnType
+KoOptimizedGenericSCOpFactoryPerArch<KoOptimizedCompositeOpGenericSC128>::create<Vc::ScalarImpl>(ParamType param)
+{
+    Q_UNUSED(param);
+    return 0;
+}
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2019 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOOPTIMIZEDCOMPOSITEOPGENERICSC128_H_
+#define KOOPTIMIZEDCOMPOSITEOPGENERICSC128_H_
+
+#include "KoCompositeOpBase.h"
+#include "KoCompositeOpRegistry.h"
+#include "KoStreamedMath.h"
+#include "KoStreamedBlendFunctions.h"
+
+/**
+ * A vectorized equivalent of KoCompositeOpGenericSC for 128-bit
+ * floating point pixels, \see GenericSCCompositor32 for the formula.
+ * The result of the blend function is not clamped, just like
+ * the generic version does for floating point channels.
+ */
+template<class BlendFunc, bool alphaLocked, bool allChannelsFlag>
+struct GenericSCCompositor128 {
+    struct OptionalParams {
+        OptionalParams(const KoCompositeOp::ParameterInfo& params)
+            : channelFlags(params.channelFlags)
+        {
+        }
+        const QBitArray &channelFlags;
+    };
+
+    struct Pixel {
+        float red;
+        float green;
+        float blue;
+        float alpha;
+    };
+
+    static ALWAYS_INLINE Vc::float_v composeChannel(Vc::float_v::AsArg s, Vc::float_v::AsArg d,
+                                                    Vc::float_v::AsArg src_alpha, Vc::float_v::AsArg dst_alpha,
+                                                    Vc::float_v::AsArg norm_coeff, const Vc::float_m &keep_dst)
+    {
+        const Vc::float_v oneValue(Vc::One);
+        const Vc::float_v f = BlendFunc::template apply<KoStreamedBlend::FloatArithmetic>(s, d);
+
+        Vc::float_v result;
+
+        if (alphaLocked) {
+            result = d + src_alpha * (f - d);
+        } else {
+            result = ((oneValue - src_alpha) * dst_alpha * d +
+                      (oneValue - dst_alpha) * src_alpha * s +
+                      src_alpha * dst_alpha * f) * norm_coeff;
+        }
+
+        return Vc::iif(keep_dst, d, result);
+    }
+
+    // \see docs in AlphaDarkenCompositor32
+    template<bool haveMask, bool src_aligned, Vc::Implementation _impl>
+    static ALWAYS_INLINE void compositeVector(const quint8 *src, quint8 *dst, const quint8 *mask, float opacity, const OptionalParams &oparams)
+    {
+        Q_UNUSED(oparams);
+
+        const Pixel *sp = reinterpret_cast<const Pixel*>(src);
+        Pixel *dp = reinterpret_cast<Pixel*>(dst);
+
+        Vc::float_v src_alpha;
+        Vc::float_v dst_alpha;
+
+        Vc::float_v src_c1;
+        Vc::float_v src_c2;
+        Vc::float_v src_c3;
+
+        const Vc::float_v::IndexType indexes(Vc::IndexesFromZero);
+        Vc::InterleavedMemoryWrapper<Pixel, Vc::float_v> data(const_cast<Pixel*>(sp));
+        tie(src_c1, src_c2, src_c3, src_alpha) = data[indexes];
+
+        src_alpha *= Vc::float_v(opacity);
+
+        if (haveMask) {
+            const Vc::float_v uint8MaxRec1((float)1.0 / 255);
+            Vc::float_v mask_vec = KoStreamedMath<_impl>::fetch_mask_8(mask);
+            src_alpha *= mask_vec * uint8MaxRec1;
+        }
+
+        const Vc::float_v zeroValue(Vc::Zero);
+        // The source cannot change the colors in the destination,
+        // since its fully transparent
+        if ((src_alpha == zeroValue).isFull()) {
+            return;
+        }
+
+        Vc::float_v dst_c1;
+        Vc::float_v dst_c2;
+        Vc::float_v dst_c3;
+
+        Vc::InterleavedMemoryWrapper<Pixel, Vc::float_v> dataDest(dp);
+        tie(dst_c1, dst_c2, dst_c3, dst_alpha) = dataDest[indexes];
+
+        Vc::float_v new_alpha;
+        Vc::float_v norm_coeff(Vc::One);
+        Vc::float_m keep_dst;
+
+        if (alphaLocked) {
+            keep_dst = dst_alpha == zeroValue;
+            if (keep_dst.isFull()) {
+                return;
+            }
+            new_alpha = dst_alpha;
+        } else {
+            /**
+             * The lanes with zero new_alpha get NaN coefficients,
+             * but they are masked out by keep_dst anyway
+             */
+            new_alpha = src_alpha + dst_alpha - src_alpha * dst_alpha;
+            keep_dst = new_alpha == zeroValue;
+            norm_coeff /= new_alpha;
+        }
+
+        dst_c1 = composeChannel(src_c1, dst_c1, src_alpha, dst_alpha, norm_coeff, keep_dst);
+        dst_c2 = composeChannel(src_c2, dst_c2, src_alpha, dst_alpha, norm_coeff, keep_dst);
+        dst_c3 = composeChannel(src_c3, dst_c3, src_alpha, dst_alpha, norm_coeff, keep_dst);
+
+        dataDest[indexes] = tie(dst_c1, dst_c2, dst_c3, new_alpha);
+    }
+
+    template <bool haveMask, Vc::Implementation _impl>
+    static ALWAYS_INLINE void compositeOnePixelScalar(const quint8 *src, quint8 *dst, const quint8 *mask, float opacity, const OptionalParams &oparams)
+    {
+        const qint32 alpha_pos = 3;
+
+        const float *s = reinterpret_cast<const float*>(src);
+        float *d = reinterpret_cast<float*>(dst);
+
+        float srcAlpha = s[alpha_pos] * opacity;
+
+        if (haveMask) {
+            const float uint8Rec1 = 1.0 / 255;
+            srcAlpha *= float(*mask) * uint8Rec1;
+        }
+
+        const float dstAlpha = d[alpha_pos];
+
+        if (!allChannelsFlag && dstAlpha == 0.0) {
+            KoStreamedMathFunctions::clearPixel<16>(dst);
+        }
+
+        if (srcAlpha == 0.0 || (alphaLocked && dstAlpha == 0.0)) {
+            return;
+        }
+
+        const float newAlpha = alphaLocked ? dstAlpha : srcAlpha + dstAlpha - srcAlpha * dstAlpha;
+
+        for (int i = 0; i < 3; i++) {
+            if (!allChannelsFlag && !oparams.channelFlags.testBit(i)) continue;
+
+            const float f = BlendFunc::template apply<KoStreamedBlend::FloatArithmetic>(s[i], d[i]);
+
+            d[i] = alphaLocked ?
+                d[i] + srcAlpha * (f - d[i]) :
+                ((1.0f - srcAlpha) * dstAlpha * d[i] +
+                 (1.0f - dstAlpha) * srcAlpha * s[i] +
+                 srcAlpha * dstAlpha * f) / newAlpha;
+        }
+
+        if (!alphaLocked) {
+            d[alpha_pos] = newAlpha;
+        }
+    }
+};
+
+/**
+ * An optimized version of a separable composite op for the use in 16 byte
+ * colorspaces with alpha channel placed at the last byte of
+ * the pixel: C1_C2_C3_A.
+ */
+template<Vc::Implementation _impl, class BlendFunc>
+class KoOptimizedCompositeOpGenericSC128 : public KoCompositeOp
+{
+public:
+    KoOptimizedCompositeOpGenericSC128(const KoColorSpace* cs, const QString& id, const QString& description, const QString& category)
+        : KoCompositeOp(cs, id, description, category) {}
+
+    using KoCompositeOp::composite;
+
+    virtual void composite(const KoCompositeOp::ParameterInfo& params) const
+    {
+        if(params.maskRowStart) {
+            composite<true>(params);
+        } else {
+            composite<false>(params);
+        }
+    }
+
+    template <bool haveMask>
+    inline void composite(const KoCompositeOp::ParameterInfo& params) const {
+        if (params.channelFlags.isEmpty() ||
+            params.channelFlags == QBitArray(4, true)) {
+
+            KoStreamedMath<_impl>::template genericComposite128<haveMask, false, GenericSCCompositor128<BlendFunc, false, true> >(params);
+        } else {
+            const bool allChannelsFlag =
+                params.channelFlags.at(0) &&
+                params.channelFlags.at(1) &&
+                params.channelFlags.at(2);
+
+            const bool alphaLocked =
+                !params.channelFlags.at(3);
+
+            if (allChannelsFlag && alphaLocked) {
+                KoStreamedMath<_impl>::template genericComposite128<haveMask, false, GenericSCCompositor128<BlendFunc, true, true> >(params);
+            } else if (!allChannelsFlag && !alphaLocked) {
+                KoStreamedMath<_impl>::template genericComposite128_novector<haveMask, false, GenericSCCompositor128<BlendFunc, false, false> >(params);
+            } else /*if (!allChannelsFlag && alphaLocked) */{
+                KoStreamedMath<_impl>::template genericComposite128_novector<haveMask, false, GenericSCCompositor128<BlendFunc, true, false> >(params);
+            }
+        }
+    }
+};
+
+#endif // KOOPTIMIZEDCOMPOSITEOPGENERICSC128_H_
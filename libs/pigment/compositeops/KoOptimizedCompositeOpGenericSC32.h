@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2019 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOOPTIMIZEDCOMPOSITEOPGENERICSC32_H_
+#define KOOPTIMIZEDCOMPOSITEOPGENERICSC32_H_
+
+#include "KoCompositeOpBase.h"
+#include "KoCompositeOpRegistry.h"
+#include "KoStreamedMath.h"
+#include "KoStreamedBlendFunctions.h"
+
+/**
+ * A vectorized equivalent of KoCompositeOpGenericSC for 32-bit pixels:
+ *
+ * newAlpha = srcAlpha + dstAlpha - srcAlpha * dstAlpha
+ * dstColor = ((1 - srcAlpha) * dstAlpha * dst +
+ *             (1 - dstAlpha) * srcAlpha * src +
+ *             srcAlpha * dstAlpha * BlendFunc(src, dst)) / newAlpha
+ *
+ * The math is done in floats, but every operation is rounded exactly
+ * like the integer one of the generic op (\see Uint8Arithmetic), so both
+ * ops give the same results. The only exception is a source pixel with
+ * zero alpha: the generic op requantizes the destination color, while
+ * this op leaves the destination pixel untouched.
+ */
+template<class BlendFunc, bool alphaLocked, bool allChannelsFlag>
+struct GenericSCCompositor32 {
+    typedef KoStreamedBlend::Uint8Arithmetic Arithmetic;
+
+    struct OptionalParams {
+        OptionalParams(const KoCompositeOp::ParameterInfo& params)
+            : channelFlags(params.channelFlags),
+              opacity(KoColorSpaceMaths<float, quint8>::scaleToA(params.opacity))
+        {
+        }
+        const QBitArray &channelFlags;
+        const float opacity;
+    };
+
+    /**
+     * All the values are integers in [0, 255] range. The result may be
+     * 256 or more, the caller takes its lowest byte, just like
+     * the generic op does
+     */
+    template<typename T>
+    static ALWAYS_INLINE T composeChannel(const T &src_c, const T &dst_c,
+                                          const T &src_alpha, const T &dst_alpha,
+                                          const T &new_alpha)
+    {
+        const T unitValue(Arithmetic::unitValue());
+        const T f = BlendFunc::template apply<Arithmetic>(src_c, dst_c);
+
+        if (alphaLocked) {
+            return Arithmetic::lerp(dst_c, f, src_alpha);
+        }
+
+        T result = Arithmetic::mul(unitValue - src_alpha, dst_alpha, dst_c) +
+                   Arithmetic::mul(unitValue - dst_alpha, src_alpha, src_c) +
+                   Arithmetic::mul(dst_alpha, src_alpha, f);
+
+        // Arithmetic::blend() returns quint8
+        result = KoStreamedBlend::blendSelect(result > unitValue, result - T(256.0f), result);
+
+        return Arithmetic::div(result, new_alpha);
+    }
+
+    // \see docs in AlphaDarkenCompositor32
+    template<bool haveMask, bool src_aligned, Vc::Implementation _impl>
+    static ALWAYS_INLINE void compositeVector(const quint8 *src, quint8 *dst, const quint8 *mask, float opacity, const OptionalParams &oparams)
+    {
+        Q_UNUSED(opacity);
+
+        const Vc::float_v zeroValue(Vc::Zero);
+        const Vc::float_v unitValue(Arithmetic::unitValue());
+
+        Vc::float_v src_alpha = KoStreamedMath<_impl>::template fetch_alpha_32<src_aligned>(src);
+        const Vc::float_v mask_vec = haveMask ? KoStreamedMath<_impl>::fetch_mask_8(mask) : unitValue;
+        src_alpha = Arithmetic::mul(src_alpha, mask_vec, Vc::float_v(oparams.opacity));
+
+        // The source cannot change the colors in the destination,
+        // since its fully transparent
+        if ((src_alpha == zeroValue).isFull()) {
+            return;
+        }
+
+        const Vc::float_v dst_alpha = KoStreamedMath<_impl>::template fetch_alpha_32<true>(dst);
+
+        Vc::float_v new_alpha;
+        Vc::float_m keep_dst;
+
+        if (alphaLocked) {
+            keep_dst = dst_alpha == zeroValue;
+            if (keep_dst.isFull()) {
+                return;
+            }
+            new_alpha = dst_alpha;
+        } else {
+            /**
+             * The lanes with zero new_alpha divide by zero,
+             * but they are masked out by keep_dst anyway
+             */
+            new_alpha = src_alpha + dst_alpha - Arithmetic::mul(src_alpha, dst_alpha);
+            keep_dst = new_alpha == zeroValue;
+        }
+
+        Vc::float_v src_c1;
+        Vc::float_v src_c2;
+        Vc::float_v src_c3;
+
+        Vc::float_v dst_c1;
+        Vc::float_v dst_c2;
+        Vc::float_v dst_c3;
+
+        KoStreamedMath<_impl>::template fetch_colors_32<src_aligned>(src, src_c1, src_c2, src_c3);
+        KoStreamedMath<_impl>::template fetch_colors_32<true>(dst, dst_c1, dst_c2, dst_c3);
+
+        dst_c1 = Vc::iif(keep_dst, dst_c1, composeChannel(src_c1, dst_c1, src_alpha, dst_alpha, new_alpha));
+        dst_c2 = Vc::iif(keep_dst, dst_c2, composeChannel(src_c2, dst_c2, src_alpha, dst_alpha, new_alpha));
+        dst_c3 = Vc::iif(keep_dst, dst_c3, composeChannel(src_c3, dst_c3, src_alpha, dst_alpha, new_alpha));
+
+        KoStreamedMath<_impl>::write_channels_32(dst, new_alpha, dst_c1, dst_c2, dst_c3);
+    }
+
+    template <bool haveMask, Vc::Implementation _impl>
+    static ALWAYS_INLINE void compositeOnePixelScalar(const quint8 *src, quint8 *dst, const quint8 *mask, float opacity, const OptionalParams &oparams)
+    {
+        Q_UNUSED(opacity);
+
+        const qint32 alpha_pos = 3;
+
+        const float maskAlpha = haveMask ? float(*mask) : Arithmetic::unitValue();
+        const float srcAlpha = Arithmetic::mul(float(src[alpha_pos]), maskAlpha, oparams.opacity);
+        const float dstAlpha = dst[alpha_pos];
+
+        if (!allChannelsFlag && dstAlpha == 0.0f) {
+            KoStreamedMathFunctions::clearPixel<4>(dst);
+        }
+
+        if (srcAlpha == 0.0f || (alphaLocked && dstAlpha == 0.0f)) {
+            return;
+        }
+
+        const float newAlpha = alphaLocked ? dstAlpha : srcAlpha + dstAlpha - Arithmetic::mul(srcAlpha, dstAlpha);
+
+        for (int i = 0; i < 3; i++) {
+            if (!allChannelsFlag && !oparams.channelFlags.testBit(i)) continue;
+
+            const float result = composeChannel(float(src[i]), float(dst[i]), srcAlpha, dstAlpha, newAlpha);
+            dst[i] = quint8(int(result));
+        }
+
+        if (!alphaLocked) {
+            dst[alpha_pos] = quint8(newAlpha);
+        }
+    }
+};
+
+/**
+ * An optimized version of a separable composite op for the use in 4 byte
+ * colorspaces with alpha channel placed at the last byte of
+ * the pixel: C1_C2_C3_A.
+ */
+template<Vc::Implementation _impl, class BlendFunc>
+class KoOptimizedCompositeOpGenericSC32 : public KoCompositeOp
+{
+public:
+    KoOptimizedCompositeOpGenericSC32(const KoColorSpace* cs, const QString& id, const QString& description, const QString& category)
+        : KoCompositeOp(cs, id, description, category) {}
+
+    using KoCompositeOp::composite;
+
+    virtual void composite(const KoCompositeOp::ParameterInfo& params) const
+    {
+        if(params.maskRowStart) {
+            composite<true>(params);
+        } else {
+            composite<false>(params);
+        }
+    }
+
+    template <bool haveMask>
+    inline void composite(const KoCompositeOp::ParameterInfo& params) const {
+        if (params.channelFlags.isEmpty() ||
+            params.channelFlags == QBitArray(4, true)) {
+
+            KoStreamedMath<_impl>::template genericComposite32<haveMask, false, GenericSCCompositor32<BlendFunc, false, true> >(params);
+        } else {
+            const bool allChannelsFlag =
+                params.channelFlags.at(0) &&
+                params.channelFlags.at(1) &&
+                params.channelFlags.at(2);
+
+            const bool alphaLocked =
+                !params.channelFlags.at(3);
+
+            if (allChannelsFlag && alphaLocked) {
+                KoStreamedMath<_impl>::template genericComposite32<haveMask, false, GenericSCCompositor32<BlendFunc, true, true> >(params);
+            } else if (!allChannelsFlag && !alphaLocked) {
+                KoStreamedMath<_impl>::template genericComposite32_novector<haveMask, false, GenericSCCompositor32<BlendFunc, false, false> >(params);
+            } else /*if (!allChannelsFlag && alphaLocked) */{
+                KoStreamedMath<_impl>::template genericComposite32_novector<haveMask, false, GenericSCCompositor32<BlendFunc, true, false> >(params);
+            }
+        }
+    }
+};
+
+#endif // KOOPTIMIZEDCOMPOSITEOPGENERICSC32_H_
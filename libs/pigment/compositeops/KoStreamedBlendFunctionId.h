@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2019 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOSTREAMEDBLENDFUNCTIONID_H
+#define KOSTREAMEDBLENDFUNCTIONID_H
+
+namespace KoStreamedBlend {
+
+/**
+ * Identifies the blend functions which have a vectorized version in
+ * KoStreamedBlendFunctions.h. The per-arch factories cannot be templated
+ * by the scalar blend function of the colorspace, so the function is
+ * passed to them as an id.
+ *
+ * \see StreamedBlendFunctionId in KoCompositeOps.h
+ */
+enum FunctionId {
+    NoFunctionId = 0,
+    MultiplyId,
+    ScreenId,
+    AdditionId,
+    SubtractId,
+    DarkenId,
+    LightenId,
+    DifferenceId,
+    ExclusionId,
+    OverlayId,
+    HardLightId,
+    ColorDodgeId,
+    ColorBurnId,
+    LinearBurnId,
+    LinearLightId,
+    SoftLightId,
+    SoftLightSvgId,
+    GrainMergeId,
+    GrainExtractId,
+    DivideId
+};
+
+}
+
+#endif // KOSTREAMEDBLENDFUNCTIONID_H
@@ -0,0 +1,400 @@
+/*
+ * Copyright (c) 2019 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOSTREAMEDBLENDFUNCTIONS_H
+#define KOSTREAMEDBLENDFUNCTIONS_H
+
+#include <QtGlobal>
+#include <cmath>
+
+#include "KoCompositeOpBase.h"
+#include "KoStreamedMath.h"
+#include "KoStreamedBlendFunctionId.h"
+
+/**
+ * Separable blend functions used by the vectorized generic composite ops
+ * (KoOptimizedCompositeOpGenericSC32 and KoOptimizedCompositeOpGenericSC128).
+ *
+ * Every function is written once as a template over the value type, so the
+ * same code is used for a single float (the unaligned head/tail of a row)
+ * and for a whole Vc::float_v.
+ *
+ * The \p Arithmetic template parameter defines the range of the values
+ * and the way they are multiplied, divided and clamped, just like
+ * KoColorSpaceMaths does for the scalar functions in KoCompositeOpFunctions.h:
+ *
+ * FloatArithmetic: the values are normalized to the [0, 1] range and are
+ *                  never clamped, to keep HDR values intact
+ *
+ * Uint8Arithmetic: the values are integers in the [0, 255] range, all the
+ *                  operations are rounded exactly like the ones of
+ *                  KoColorSpaceMaths<quint8>
+ */
+namespace KoStreamedBlend {
+
+ALWAYS_INLINE float blendSelect(bool cond, float a, float b) {
+    return cond ? a : b;
+}
+
+ALWAYS_INLINE Vc::float_v blendSelect(const Vc::float_m &cond, Vc::float_v::AsArg a, Vc::float_v::AsArg b) {
+    return Vc::iif(cond, a, b);
+}
+
+ALWAYS_INLINE float blendMin(float a, float b) {
+    return qMin(a, b);
+}
+
+ALWAYS_INLINE Vc::float_v blendMin(Vc::float_v::AsArg a, Vc::float_v::AsArg b) {
+    return Vc::min(a, b);
+}
+
+ALWAYS_INLINE float blendMax(float a, float b) {
+    return qMax(a, b);
+}
+
+ALWAYS_INLINE Vc::float_v blendMax(Vc::float_v::AsArg a, Vc::float_v::AsArg b) {
+    return Vc::max(a, b);
+}
+
+ALWAYS_INLINE float blendSqrt(float a) {
+    return std::sqrt(a);
+}
+
+ALWAYS_INLINE Vc::float_v blendSqrt(Vc::float_v::AsArg a) {
+    return Vc::sqrt(a);
+}
+
+ALWAYS_INLINE float blendFloor(float a) {
+    return std::floor(a);
+}
+
+ALWAYS_INLINE Vc::float_v blendFloor(Vc::float_v::AsArg a) {
+    return Vc::floor(a);
+}
+
+ALWAYS_INLINE float blendRound(float a) {
+    return std::rint(a);
+}
+
+ALWAYS_INLINE Vc::float_v blendRound(Vc::float_v::AsArg a) {
+    return Vc::round(a);
+}
+
+struct FloatArithmetic {
+    static float unitValue() { return 1.0f; }
+    static float halfValue() { return 0.5f; }
+
+    template<typename T>
+    static ALWAYS_INLINE T mul(const T &a, const T &b) {
+        return a * b;
+    }
+
+    template<typename T>
+    static ALWAYS_INLINE T div(const T &a, const T &b) {
+        return a / b;
+    }
+
+    template<typename T>
+    static ALWAYS_INLINE T clamp(const T &a) {
+        return a;
+    }
+
+    template<typename T>
+    static ALWAYS_INLINE T toFloat(const T &a) {
+        return a;
+    }
+
+    template<typename T>
+    static ALWAYS_INLINE T fromFloat(const T &a) {
+        return a;
+    }
+};
+
+/**
+ * The integer math of KoIntegerMaths.h done on floats. All the
+ * intermediate values are integers below 2^24, so they are represented
+ * exactly and the results are the same as the ones of the integer
+ * version. Shifting right is replaced with multiplying by a power of two
+ * and rounding down.
+ */
+struct Uint8Arithmetic {
+    static float unitValue() { return 255.0f; }
+    static float halfValue() { return 127.0f; }
+
+    // \see UINT8_MULT()
+    template<typename T>
+    static ALWAYS_INLINE T mul(const T &a, const T &b) {
+        const T c = a * b + T(128.0f);
+        return blendFloor((blendFloor(c * T(1.0f / 256.0f)) + c) * T(1.0f / 256.0f));
+    }
+
+    // \see UINT8_MULT3()
+    template<typename T>
+    static ALWAYS_INLINE T mul(const T &a, const T &b, const T &c) {
+        const T t = a * b * c + T(32603.0f);
+        return blendFloor((blendFloor(t * T(1.0f / 128.0f)) + t) * T(1.0f / 65536.0f));
+    }
+
+    // \see UINT8_DIVIDE()
+    template<typename T>
+    static ALWAYS_INLINE T div(const T &a, const T &b) {
+        return blendFloor((a * T(255.0f) + blendFloor(b * T(0.5f))) / b);
+    }
+
+    // \see Arithmetic::lerp() and UINT8_BLEND()
+    template<typename T>
+    static ALWAYS_INLINE T lerp(const T &a, const T &b, const T &alpha) {
+        const T c = (b - a) * alpha + T(128.0f);
+        return blendFloor((blendFloor(c * T(1.0f / 256.0f)) + c) * T(1.0f / 256.0f)) + a;
+    }
+
+    template<typename T>
+    static ALWAYS_INLINE T clamp(const T &a) {
+        return blendMin(blendMax(a, T(0.0f)), T(255.0f));
+    }
+
+    // \see KoColorSpaceMaths<quint8, double>::scaleToA()
+    template<typename T>
+    static ALWAYS_INLINE T toFloat(const T &a) {
+        return a / T(255.0f);
+    }
+
+    // \see KoColorSpaceMaths<double, quint8>::scaleToA()
+    template<typename T>
+    static ALWAYS_INLINE T fromFloat(const T &a) {
+        return blendRound(clamp(a * T(255.0f)));
+    }
+};
+
+/**
+ * screen(2 * src - 1, dst) for the upper half of the source range and
+ * multiply(2 * src, dst) for the lower one, \see cfHardLight()
+ */
+template<class Arithmetic, typename T>
+ALWAYS_INLINE T hardLight(const T &src, const T &dst) {
+    const T src2 = src + src;
+    const T src2m1 = src2 - T(Arithmetic::unitValue());
+    return blendSelect(src > T(Arithmetic::halfValue()),
+                       src2m1 + dst - Arithmetic::mul(src2m1, dst),
+                       Arithmetic::mul(src2, dst));
+}
+
+/**
+ * The darkening half of both soft light variants, \see cfSoftLight().
+ * The values are normalized.
+ */
+template<typename T>
+ALWAYS_INLINE T softLightDarken(const T &src, const T &dst) {
+    return dst - (T(1.0f) - (src + src)) * dst * (T(1.0f) - dst);
+}
+
+struct Multiply {
+    template<class Arithmetic, typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        return Arithmetic::mul(src, dst);
+    }
+};
+
+struct Screen {
+    template<class Arithmetic, typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        return src + dst - Arithmetic::mul(src, dst);
+    }
+};
+
+struct Addition {
+    template<class Arithmetic, typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        return Arithmetic::clamp(src + dst);
+    }
+};
+
+struct Subtract {
+    template<class Arithmetic, typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        return Arithmetic::clamp(dst - src);
+    }
+};
+
+struct Darken {
+    template<class Arithmetic, typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        return blendMin(src, dst);
+    }
+};
+
+struct Lighten {
+    template<class Arithmetic, typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        return blendMax(src, dst);
+    }
+};
+
+struct Difference {
+    template<class Arithmetic, typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        return blendMax(src, dst) - blendMin(src, dst);
+    }
+};
+
+struct Exclusion {
+    template<class Arithmetic, typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        const T x = Arithmetic::mul(src, dst);
+        return Arithmetic::clamp(dst + src - (x + x));
+    }
+};
+
+struct Overlay {
+    template<class Arithmetic, typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        return hardLight<Arithmetic>(dst, src);
+    }
+};
+
+struct HardLight {
+    template<class Arithmetic, typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        return hardLight<Arithmetic>(src, dst);
+    }
+};
+
+struct ColorDodge {
+    template<class Arithmetic, typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        const T unit(Arithmetic::unitValue());
+        const T invSrc = unit - src;
+
+        // the lanes with division by zero are masked out below
+        T result = blendSelect(invSrc < dst, unit, Arithmetic::clamp(Arithmetic::div(dst, invSrc)));
+        return blendSelect(dst == T(0.0f), T(0.0f), result);
+    }
+};
+
+struct ColorBurn {
+    template<class Arithmetic, typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        const T unit(Arithmetic::unitValue());
+        const T invDst = unit - dst;
+
+        T result = blendSelect(src < invDst, T(0.0f), unit - Arithmetic::clamp(Arithmetic::div(invDst, src)));
+        return blendSelect(dst == unit, unit, result);
+    }
+};
+
+struct LinearBurn {
+    template<class Arithmetic, typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        return Arithmetic::clamp(src + dst - T(Arithmetic::unitValue()));
+    }
+};
+
+struct LinearLight {
+    template<class Arithmetic, typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        return Arithmetic::clamp(src + src + dst - T(Arithmetic::unitValue()));
+    }
+};
+
+struct SoftLight {
+    template<class Arithmetic, typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        const T fsrc = Arithmetic::toFloat(src);
+        const T fdst = Arithmetic::toFloat(dst);
+
+        const T lighten = fdst + (fsrc + fsrc - T(1.0f)) * (blendSqrt(fdst) - fdst);
+        return Arithmetic::fromFloat(blendSelect(fsrc > T(0.5f), lighten, softLightDarken(fsrc, fdst)));
+    }
+};
+
+struct SoftLightSvg {
+    template<class Arithmetic, typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        const T fsrc = Arithmetic::toFloat(src);
+        const T fdst = Arithmetic::toFloat(dst);
+
+        const T D = blendSelect(fdst > T(0.25f),
+                                blendSqrt(fdst),
+                                ((T(16.0f) * fdst - T(12.0f)) * fdst + T(4.0f)) * fdst);
+        const T lighten = fdst + (fsrc + fsrc - T(1.0f)) * (D - fdst);
+        return Arithmetic::fromFloat(blendSelect(fsrc > T(0.5f), lighten, softLightDarken(fsrc, fdst)));
+    }
+};
+
+struct GrainMerge {
+    template<class Arithmetic, typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        return Arithmetic::clamp(dst + src - T(Arithmetic::halfValue()));
+    }
+};
+
+struct GrainExtract {
+    template<class Arithmetic, typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        return Arithmetic::clamp(dst - src + T(Arithmetic::halfValue()));
+    }
+};
+
+struct Divide {
+    template<class Arithmetic, typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        const T unit(Arithmetic::unitValue());
+        const T result = Arithmetic::clamp(Arithmetic::div(dst, src));
+        return blendSelect(src == T(0.0f),
+                           blendSelect(dst == T(0.0f), T(0.0f), unit),
+                           result);
+    }
+};
+
+/**
+ * Calls \p creator.create<BlendFunc>() for the blend function with the
+ * given \p function id. Returns null if there is no such function.
+ */
+template<class Creator>
+typename Creator::ReturnType createForFunctionId(FunctionId function, const Creator &creator)
+{
+    switch (function) {
+    case MultiplyId: return creator.template create<Multiply>();
+    case ScreenId: return creator.template create<Screen>();
+    case AdditionId: return creator.template create<Addition>();
+    case SubtractId: return creator.template create<Subtract>();
+    case DarkenId: return creator.template create<Darken>();
+    case LightenId: return creator.template create<Lighten>();
+    case DifferenceId: return creator.template create<Difference>();
+    case ExclusionId: return creator.template create<Exclusion>();
+    case OverlayId: return creator.template create<Overlay>();
+    case HardLightId: return creator.template create<HardLight>();
+    case ColorDodgeId: return creator.template create<ColorDodge>();
+    case ColorBurnId: return creator.template create<ColorBurn>();
+    case LinearBurnId: return creator.template create<LinearBurn>();
+    case LinearLightId: return creator.template create<LinearLight>();
+    case SoftLightId: return creator.template create<SoftLight>();
+    case SoftLightSvgId: return creator.template create<SoftLightSvg>();
+    case GrainMergeId: return creator.template create<GrainMerge>();
+    case GrainExtractId: return creator.template create<GrainExtract>();
+    case DivideId: return creator.template create<Divide>();
+    case NoFunctionId: break;
+    }
+
+    return 0;
+}
+
+}
+
+#endif // KOSTREAMEDBLENDFUNCTIONS_H
@@ -113,6 +113,9 @@ protected:
     KoResource(const KoResource &rhs);
 
 private:
+    // lets the resource servers restore the md5 sum from their index
+    friend class KoResourceServerBase;
+
     struct Private;
     Private* const d;
 };
@@ -186,6 +186,150 @@ void TestColorConversionSystem::testAlphaU16Conversions()
     }
 }
 
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSet>
+#include <QThread>
+#include <KoColorConversionCache.h>
+
+void TestColorConversionSystem::testConversionCacheFastPath()
+{
+    const KoColorSpace *rgb8 = KoColorSpaceRegistry::instance()->rgb8();
+    const KoColorSpace *rgb16 = KoColorSpaceRegistry::instance()->rgb16();
+    KoColorConversionCache *cache = KoColorSpaceRegistry::instance()->colorConversionCache();
+
+    QByteArray src(rgb8->pixelSize(), '\x80');
+    QByteArray dst(rgb16->pixelSize(), '\0');
+
+    // warm up the cache of the current thread
+    rgb8->convertPixelsTo((quint8*)src.data(), (quint8*)dst.data(), rgb16, 1,
+                          KoColorConversionTransformation::internalRenderingIntent(),
+                          KoColorConversionTransformation::internalConversionFlags());
+
+    cache->resetStatistics();
+
+    for (int i = 0; i < 100; i++) {
+        rgb8->convertPixelsTo((quint8*)src.data(), (quint8*)dst.data(), rgb16, 1,
+                              KoColorConversionTransformation::internalRenderingIntent(),
+                              KoColorConversionTransformation::internalConversionFlags());
+    }
+
+    KoColorConversionCache::Statistics stats = cache->statistics();
+    QCOMPARE(stats.fastPathHits, 100);
+    QCOMPARE(stats.slowPathLookups, 0);
+    QCOMPARE(stats.createdTransformations, 0);
+}
+
+namespace {
+struct ConversionJob : public QRunnable
+{
+    ConversionJob(const KoColorSpace *_srcCS, const QByteArray &_src,
+                  const QVector<const KoColorSpace*> &_dstSpaces)
+        : srcCS(_srcCS), src(_src), dstSpaces(_dstSpaces)
+    {
+        setAutoDelete(false);
+        results.resize(dstSpaces.size());
+    }
+
+    static const int numIterations = 200;
+
+    void run() override {
+        thread = QThread::currentThread();
+
+        const int numPixels = src.size() / srcCS->pixelSize();
+
+        for (int i = 0; i < numIterations; i++) {
+            for (int j = 0; j < dstSpaces.size(); j++) {
+                QByteArray dst(numPixels * dstSpaces[j]->pixelSize(), '\0');
+                srcCS->convertPixelsTo((const quint8*)src.constData(), (quint8*)dst.data(),
+                                       dstSpaces[j], numPixels,
+                                       KoColorConversionTransformation::internalRenderingIntent(),
+                                       KoColorConversionTransformation::internalConversionFlags());
+                if (results[j].isEmpty()) {
+                    results[j] = dst;
+                } else if (results[j] != dst) {
+                    hasMismatches = true;
+                }
+            }
+        }
+    }
+
+    const KoColorSpace *srcCS;
+    QByteArray src;
+    QVector<const KoColorSpace*> dstSpaces;
+    QVector<QByteArray> results;
+    bool hasMismatches = false;
+    QThread *thread = 0;
+};
+}
+
+void TestColorConversionSystem::testConversionCacheThreads()
+{
+    const KoColorSpace *rgb8 = KoColorSpaceRegistry::instance()->rgb8();
+    QVector<const KoColorSpace*> dstSpaces;
+    dstSpaces << KoColorSpaceRegistry::instance()->rgb16();
+    dstSpaces << KoColorSpaceRegistry::instance()->lab16();
+
+    const int numPixels = 256;
+    QByteArray src(numPixels * rgb8->pixelSize(), '\0');
+    for (int i = 0; i < src.size(); i++) {
+        src[i] = (i * 7) & 0xFF;
+    }
+
+    QVector<QByteArray> reference;
+    Q_FOREACH (const KoColorSpace *dstCS, dstSpaces) {
+        QByteArray dst(numPixels * dstCS->pixelSize(), '\0');
+        rgb8->convertPixelsTo((const quint8*)src.constData(), (quint8*)dst.data(),
+                              dstCS, numPixels,
+                              KoColorConversionTransformation::internalRenderingIntent(),
+                              KoColorConversionTransformation::internalConversionFlags());
+        reference << dst;
+    }
+
+    KoColorConversionCache *cache = KoColorSpaceRegistry::instance()->colorConversionCache();
+    cache->resetStatistics();
+
+    const int numJobs = 4;
+    QVector<ConversionJob*> jobs;
+
+    {
+        QThreadPool pool;
+        pool.setMaxThreadCount(numJobs);
+
+        for (int i = 0; i < numJobs; i++) {
+            ConversionJob *job = new ConversionJob(rgb8, src, dstSpaces);
+            jobs << job;
+            pool.start(job);
+        }
+
+        /**
+         * The destruction of the pool joins its threads, so all
+         * the hits counted in the thread-local tables get published
+         */
+    }
+
+    QSet<QThread*> threads;
+
+    Q_FOREACH (ConversionJob *job, jobs) {
+        QVERIFY(!job->hasMismatches);
+        QCOMPARE(job->results, reference);
+        threads.insert(job->thread);
+    }
+    qDeleteAll(jobs);
+
+    /**
+     * Every thread goes to the shared cache only once per destination
+     * color space, all the other lookups are resolved locally. The pool
+     * may run several jobs in one thread.
+     */
+    const int totalLookups = numJobs * ConversionJob::numIterations * dstSpaces.size();
+    const int expectedSlowLookups = threads.size() * dstSpaces.size();
+
+    KoColorConversionCache::Statistics stats = cache->statistics();
+    QCOMPARE(stats.slowPathLookups, expectedSlowLookups);
+    QCOMPARE(stats.fastPathHits, totalLookups - expectedSlowLookups);
+}
+
 void TestColorConversionSystem::benchmarkAlphaToRgbConversion()
 {
     const KoColorSpace *alpha8 = KoColorSpaceRegistry::instance()->alpha8();
@@ -43,6 +43,8 @@ private Q_SLOTS:
     void testGoodConnections();
     void testAlphaConversions();
     void testAlphaU16Conversions();
+    void testConversionCacheFastPath();
+    void testConversionCacheThreads();
     void benchmarkAlphaToRgbConversion();
     void benchmarkRgbToAlphaConversion();
 private:
@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2019 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "TestKoOptimizedCompositeOps.h"
+
+#include <QTest>
+#include <QBitArray>
+#include <limits>
+
+#include <klocalizedstring.h>
+
+#include <KoColorSpaceRegistry.h>
+#include <KoColorSpaceTraits.h>
+#include <KoColorSpaceMaths.h>
+#include <KoCompositeOpRegistry.h>
+#include "compositeops/KoCompositeOps.h"
+
+namespace {
+
+const int TEST_WIDTH = 67; // not aligned to the vector size
+const int TEST_HEIGHT = 5;
+const int TEST_PIXELS = TEST_WIDTH * TEST_HEIGHT;
+
+struct OpsPair
+{
+    OpsPair() : function(KoStreamedBlend::NoFunctionId) {}
+
+    QScopedPointer<KoCompositeOp> optimized;
+    QScopedPointer<KoCompositeOp> generic;
+    KoStreamedBlend::FunctionId function;
+};
+
+/**
+ * Creates the optimized op exactly the way AddGeneralOps does, that is
+ * by the blend function itself, and the reference generic op for the
+ * same function
+ */
+template<class Traits, typename Traits::channels_type compositeFunc(typename Traits::channels_type, typename Traits::channels_type)>
+void createOps(const KoColorSpace *cs, const QString &id, OpsPair *ops)
+{
+    typedef typename Traits::channels_type T;
+
+    ops->optimized.reset(_Private::OptimizedOpsSelector<Traits>::template createGenericSCOp<compositeFunc>(cs, id, id, QString()));
+    ops->generic.reset(new KoCompositeOpGenericSC<Traits, compositeFunc>(cs, id, id, QString()));
+    ops->function = _Private::StreamedBlendFunctionId<T, compositeFunc>::value;
+}
+
+template<class Traits>
+bool createOpsForId(const KoColorSpace *cs, const QString &id, OpsPair *ops)
+{
+    typedef typename Traits::channels_type T;
+
+    if (id == COMPOSITE_OVERLAY) { createOps<Traits, &cfOverlay<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_GRAIN_MERGE) { createOps<Traits, &cfGrainMerge<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_GRAIN_EXTRACT) { createOps<Traits, &cfGrainExtract<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_HARD_MIX) { createOps<Traits, &cfHardMix<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_HARD_MIX_PHOTOSHOP) { createOps<Traits, &cfHardMixPhotoshop<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_GEOMETRIC_MEAN) { createOps<Traits, &cfGeometricMean<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_PARALLEL) { createOps<Traits, &cfParallel<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_ALLANON) { createOps<Traits, &cfAllanon<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_HARD_OVERLAY) { createOps<Traits, &cfHardOverlay<T> >(cs, id, ops); return true; }
+
+    if (id == COMPOSITE_SCREEN) { createOps<Traits, &cfScreen<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_DODGE) { createOps<Traits, &cfColorDodge<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_LINEAR_DODGE) { createOps<Traits, &cfAddition<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_LIGHTEN) { createOps<Traits, &cfLightenOnly<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_HARD_LIGHT) { createOps<Traits, &cfHardLight<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_SOFT_LIGHT_SVG) { createOps<Traits, &cfSoftLightSvg<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_SOFT_LIGHT_PHOTOSHOP) { createOps<Traits, &cfSoftLight<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_GAMMA_LIGHT) { createOps<Traits, &cfGammaLight<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_VIVID_LIGHT) { createOps<Traits, &cfVividLight<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_PIN_LIGHT) { createOps<Traits, &cfPinLight<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_LINEAR_LIGHT) { createOps<Traits, &cfLinearLight<T> >(cs, id, ops); return true; }
+
+    if (id == COMPOSITE_BURN) { createOps<Traits, &cfColorBurn<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_LINEAR_BURN) { createOps<Traits, &cfLinearBurn<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_DARKEN) { createOps<Traits, &cfDarkenOnly<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_GAMMA_DARK) { createOps<Traits, &cfGammaDark<T> >(cs, id, ops); return true; }
+
+    if (id == COMPOSITE_ADD) { createOps<Traits, &cfAddition<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_SUBTRACT) { createOps<Traits, &cfSubtract<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_INVERSE_SUBTRACT) { createOps<Traits, &cfInverseSubtract<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_MULT) { createOps<Traits, &cfMultiply<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_DIVIDE) { createOps<Traits, &cfDivide<T> >(cs, id, ops); return true; }
+
+    if (id == COMPOSITE_ARC_TANGENT) { createOps<Traits, &cfArcTangent<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_DIFF) { createOps<Traits, &cfDifference<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_EXCLUSION) { createOps<Traits, &cfExclusion<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_EQUIVALENCE) { createOps<Traits, &cfEquivalence<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_ADDITIVE_SUBTRACTIVE) { createOps<Traits, &cfAdditiveSubtractive<T> >(cs, id, ops); return true; }
+
+    if (id == COMPOSITE_REFLECT) { createOps<Traits, &cfReflect<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_GLOW) { createOps<Traits, &cfGlow<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_FREEZE) { createOps<Traits, &cfFreeze<T> >(cs, id, ops); return true; }
+    if (id == COMPOSITE_HEAT) { createOps<Traits, &cfHeat<T> >(cs, id, ops); return true; }
+
+    return false;
+}
+
+/**
+ * All the separable ops registered by AddGeneralOps
+ */
+QStringList genericSCOpIds()
+{
+    return QStringList({COMPOSITE_OVERLAY, COMPOSITE_GRAIN_MERGE, COMPOSITE_GRAIN_EXTRACT,
+                        COMPOSITE_HARD_MIX, COMPOSITE_HARD_MIX_PHOTOSHOP, COMPOSITE_GEOMETRIC_MEAN,
+                        COMPOSITE_PARALLEL, COMPOSITE_ALLANON, COMPOSITE_HARD_OVERLAY,
+                        COMPOSITE_SCREEN, COMPOSITE_DODGE, COMPOSITE_LINEAR_DODGE, COMPOSITE_LIGHTEN,
+                        COMPOSITE_HARD_LIGHT, COMPOSITE_SOFT_LIGHT_SVG, COMPOSITE_SOFT_LIGHT_PHOTOSHOP,
+                        COMPOSITE_GAMMA_LIGHT, COMPOSITE_VIVID_LIGHT, COMPOSITE_PIN_LIGHT,
+                        COMPOSITE_LINEAR_LIGHT, COMPOSITE_BURN, COMPOSITE_LINEAR_BURN,
+                        COMPOSITE_DARKEN, COMPOSITE_GAMMA_DARK, COMPOSITE_ADD, COMPOSITE_SUBTRACT,
+                        COMPOSITE_INVERSE_SUBTRACT, COMPOSITE_MULT, COMPOSITE_DIVIDE,
+                        COMPOSITE_ARC_TANGENT, COMPOSITE_DIFF, COMPOSITE_EXCLUSION,
+                        COMPOSITE_EQUIVALENCE, COMPOSITE_ADDITIVE_SUBTRACTIVE, COMPOSITE_REFLECT,
+                        COMPOSITE_GLOW, COMPOSITE_FREEZE, COMPOSITE_HEAT});
+}
+
+template<class Traits>
+void fillPixels(quint8 *buffer, int seed)
+{
+    typedef typename Traits::channels_type T;
+    T *pixels = reinterpret_cast<T*>(buffer);
+
+    for (int i = 0; i < TEST_PIXELS; i++) {
+        for (int ch = 0; ch < int(Traits::channels_nb); ch++) {
+            const int value = ch == Traits::alpha_pos ?
+                (i * 13 + seed) % 256 : // has both transparent and opaque pixels
+                (i * 7 + ch * 31 + seed) % 256;
+
+            pixels[i * Traits::channels_nb + ch] = KoColorSpaceMaths<quint8, T>::scaleToA(value);
+        }
+    }
+}
+
+/**
+ * The color of fully transparent pixels is undefined, the generic op
+ * may clear it when the alpha channel is locked
+ */
+template<class Traits>
+bool comparePixels(const quint8 *buf1, const quint8 *buf2, qreal prec)
+{
+    typedef typename Traits::channels_type T;
+    const T *p1 = reinterpret_cast<const T*>(buf1);
+    const T *p2 = reinterpret_cast<const T*>(buf2);
+
+    for (int i = 0; i < TEST_PIXELS; i++) {
+        const T *px1 = p1 + i * Traits::channels_nb;
+        const T *px2 = p2 + i * Traits::channels_nb;
+
+        for (int ch = 0; ch < int(Traits::channels_nb); ch++) {
+            if (ch != Traits::alpha_pos &&
+                px1[Traits::alpha_pos] == KoColorSpaceMathsTraits<T>::zeroValue &&
+                px2[Traits::alpha_pos] == KoColorSpaceMathsTraits<T>::zeroValue) {
+
+                continue;
+            }
+
+            const qreal act = px1[ch];
+            const qreal exp = px2[ch];
+
+            // float channels may go out of [0, 1] range, compare them relatively
+            const qreal scale = std::numeric_limits<T>::is_integer ? 1.0 : qMax(qreal(1.0), qAbs(exp));
+
+            if (qAbs(act - exp) > prec * scale) {
+                qDebug() << "Wrong result: pixel" << i << "channel" << ch
+                         << "act" << act << "exp" << exp;
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+template<class Traits>
+void testGenericSCOp(const QString &compositeOpId, qreal opacity, bool useMask, bool alphaLocked, qreal prec)
+{
+    // the ops never access their colorspace
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    OpsPair ops;
+    QVERIFY(createOpsForId<Traits>(cs, compositeOpId, &ops));
+    QVERIFY(ops.generic);
+
+    if (ops.function == KoStreamedBlend::NoFunctionId) {
+        QVERIFY(!ops.optimized);
+        return;
+    }
+
+    if (!ops.optimized) {
+        QSKIP("Vector instructions are not available");
+    }
+
+    const int pixelSize = Traits::pixelSize;
+    const int rowStride = TEST_WIDTH * pixelSize;
+
+    QScopedArrayPointer<quint8> src(new quint8[TEST_PIXELS * pixelSize]);
+    QScopedArrayPointer<quint8> dstAct(new quint8[TEST_PIXELS * pixelSize]);
+    QScopedArrayPointer<quint8> dstExp(new quint8[TEST_PIXELS * pixelSize]);
+    QScopedArrayPointer<quint8> dstOrig(new quint8[TEST_PIXELS * pixelSize]);
+    QScopedArrayPointer<quint8> mask(new quint8[TEST_PIXELS]);
+
+    fillPixels<Traits>(src.data(), 0);
+    fillPixels<Traits>(dstOrig.data(), 113);
+    memcpy(dstAct.data(), dstOrig.data(), TEST_PIXELS * pixelSize);
+    memcpy(dstExp.data(), dstOrig.data(), TEST_PIXELS * pixelSize);
+
+    for (int i = 0; i < TEST_PIXELS; i++) {
+        mask[i] = (i * 29) % 256;
+    }
+
+    QBitArray channelFlags;
+    if (alphaLocked) {
+        channelFlags = QBitArray(Traits::channels_nb, true);
+        channelFlags.clearBit(Traits::alpha_pos);
+    }
+
+    KoCompositeOp::ParameterInfo params;
+    params.srcRowStart = src.data();
+    params.srcRowStride = rowStride;
+    params.maskRowStart = useMask ? mask.data() : 0;
+    params.maskRowStride = useMask ? TEST_WIDTH : 0;
+    params.rows = TEST_HEIGHT;
+    params.cols = TEST_WIDTH;
+    params.opacity = opacity;
+    params.channelFlags = channelFlags;
+
+    params.dstRowStart = dstAct.data();
+    params.dstRowStride = rowStride;
+    ops.optimized->composite(params);
+
+    params.dstRowStart = dstExp.data();
+    params.dstRowStride = rowStride;
+    ops.generic->composite(params);
+
+    /**
+     * When the source alpha multiplied by the mask and the opacity is
+     * zero, the generic op requantizes the destination color, while
+     * the optimized op may leave the pixel untouched. Both are fine.
+     */
+    typedef typename Traits::channels_type T;
+    const T *srcPixels = reinterpret_cast<const T*>(src.data());
+    const T opacityValue = KoColorSpaceMaths<float, T>::scaleToA(opacity);
+
+    for (int i = 0; i < TEST_PIXELS; i++) {
+        const T maskValue = useMask ?
+            KoColorSpaceMaths<quint8, T>::scaleToA(mask[i]) :
+            KoColorSpaceMathsTraits<T>::unitValue;
+        const T srcAlpha = Arithmetic::mul(srcPixels[i * Traits::channels_nb + Traits::alpha_pos], maskValue, opacityValue);
+        const int offset = i * pixelSize;
+
+        if (srcAlpha == KoColorSpaceMathsTraits<T>::zeroValue &&
+            !memcmp(dstAct.data() + offset, dstOrig.data() + offset, pixelSize)) {
+
+            memcpy(dstExp.data() + offset, dstOrig.data() + offset, pixelSize);
+        }
+    }
+
+    QVERIFY(comparePixels<Traits>(dstAct.data(), dstExp.data(), prec));
+}
+
+}
+
+void TestKoOptimizedCompositeOps::testGenericSCOps_data()
+{
+    QTest::addColumn<QString>("colorDepthId");
+    QTest::addColumn<QString>("compositeOpId");
+    QTest::addColumn<qreal>("opacity");
+    QTest::addColumn<bool>("useMask");
+    QTest::addColumn<bool>("alphaLocked");
+
+    Q_FOREACH (const QString &depth, QStringList({"U8", "F32"})) {
+        Q_FOREACH (const QString &id, genericSCOpIds()) {
+            Q_FOREACH (qreal opacity, QList<qreal>({1.0, 0.5})) {
+                Q_FOREACH (bool useMask, QList<bool>({false, true})) {
+                    Q_FOREACH (bool alphaLocked, QList<bool>({false, true})) {
+                        QTest::newRow(QString("%1-%2-%3%4%5")
+                                      .arg(depth).arg(id)
+                                      .arg(opacity < 1.0 ? "half" : "opaque")
+                                      .arg(useMask ? "-mask" : "")
+                                      .arg(alphaLocked ? "-locked" : "").toLatin1())
+                            << depth << id << opacity << useMask << alphaLocked;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void TestKoOptimizedCompositeOps::testGenericSCOps()
+{
+    QFETCH(QString, colorDepthId);
+    QFETCH(QString, compositeOpId);
+    QFETCH(qreal, opacity);
+    QFETCH(bool, useMask);
+    QFETCH(bool, alphaLocked);
+
+    if (colorDepthId == "F32") {
+        testGenericSCOp<KoRgbF32Traits>(compositeOpId, opacity, useMask, alphaLocked, 1e-5);
+    } else {
+        // the optimized op rounds exactly like the integer math of the generic one
+        testGenericSCOp<KoBgrU8Traits>(compositeOpId, opacity, useMask, alphaLocked, 1);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestKoOptimizedCompositeOps)
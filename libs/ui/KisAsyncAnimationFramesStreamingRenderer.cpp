@@ -0,0 +1,64 @@
+/*
+ *  Copyright (c) 2019 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "KisAsyncAnimationFramesStreamingRenderer.h"
+
+#include "kis_image.h"
+#include "kis_paint_device.h"
+
+
+KisAsyncAnimationFramesStreamingRenderer::KisAsyncAnimationFramesStreamingRenderer()
+{
+    connect(this, SIGNAL(sigCompleteRegenerationInternal(int)), SLOT(notifyFrameCompleted(int)));
+    connect(this, SIGNAL(sigCancelRegenerationInternal(int)), SLOT(notifyFrameCancelled(int)));
+}
+
+KisAsyncAnimationFramesStreamingRenderer::~KisAsyncAnimationFramesStreamingRenderer()
+{
+}
+
+void KisAsyncAnimationFramesStreamingRenderer::frameCompletedCallback(int frame, const QRegion &requestedRegion)
+{
+    KisImageSP image = requestedImage();
+    if (!image) return;
+
+    KIS_SAFE_ASSERT_RECOVER (requestedRegion == image->bounds()) {
+        emit sigCancelRegenerationInternal(frame);
+        return;
+    }
+
+    /**
+     * The conversion happens right here, in the worker thread, so the
+     * receiver has nothing to do but to push the bytes further. Both
+     * signals are queued to the GUI thread in the order of emission,
+     * so the frame is always delivered before its completion.
+     */
+    QImage frameImage = image->projection()->convertToQImage(0, image->bounds());
+
+    if (frameImage.isNull()) {
+        emit sigCancelRegenerationInternal(frame);
+        return;
+    }
+
+    emit sigFrameReady(frame, frameImage);
+    emit sigCompleteRegenerationInternal(frame);
+}
+
+void KisAsyncAnimationFramesStreamingRenderer::frameCancelledCallback(int frame)
+{
+    notifyFrameCancelled(frame);
+}
@@ -0,0 +1,50 @@
+/*
+ *  Copyright (c) 2019 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#ifndef KISASYNCANIMATIONFRAMESSTREAMINGRENDERER_H
+#define KISASYNCANIMATIONFRAMESSTREAMINGRENDERER_H
+
+#include <KisAsyncAnimationRendererBase.h>
+
+#include <QImage>
+
+/**
+ * A renderer that doesn't save the frames anywhere, but passes them
+ * further as raw 8-bit RGBA images via sigFrameReady()
+ *
+ * NOTE: sigFrameReady() is emitted from the context of an image worker
+ *       thread, so connect to it via a queued connection only.
+ */
+class KisAsyncAnimationFramesStreamingRenderer : public KisAsyncAnimationRendererBase
+{
+    Q_OBJECT
+public:
+    KisAsyncAnimationFramesStreamingRenderer();
+    ~KisAsyncAnimationFramesStreamingRenderer();
+
+protected:
+    void frameCompletedCallback(int frame, const QRegion &requestedRegion) override;
+    void frameCancelledCallback(int frame) override;
+
+Q_SIGNALS:
+    void sigFrameReady(int frame, const QImage &image);
+
+    void sigCompleteRegenerationInternal(int frame);
+    void sigCancelRegenerationInternal(int frame);
+};
+
+#endif // KISASYNCANIMATIONFRAMESSTREAMINGRENDERER_H
@@ -154,6 +154,13 @@ public:
         return lodAllowedInImage && !bootstrapLodBlocked;
     }
 
+    bool lodSupportedByCanvas() {
+        return currentCanvasIsOpenGL &&
+            KisOpenGL::supportsLoD() &&
+            (openGLFilterMode == KisOpenGL::TrilinearFilterMode ||
+             openGLFilterMode == KisOpenGL::HighQualityFiltering);
+    }
+
     void setActiveShapeManager(KoShapeManager *shapeManager);
 };
 
@@ -891,8 +898,6 @@ void KisCanvas2::slotTrySwitchShapeManager()
 
 void KisCanvas2::notifyLevelOfDetailChange()
 {
-    if (!m_d->effectiveLodAllowedInImage()) return;
-
     const qreal effectiveZoom = m_d->coordinatesConverter->effectiveZoom();
 
     KisConfig cfg(true);
@@ -900,8 +905,15 @@ void KisCanvas2::notifyLevelOfDetailChange()
 
     const int lod = KisLodTransform::scaleToLod(effectiveZoom, maxLod);
 
+    KisImageSP image = this->image();
+
+    /**
+     * Even when LoD is not allowed, the image keeps the LoD caches of
+     * the current zoom warm, so that enabling instant preview is quick
+     */
+    image->setWarmUpLevelOfDetail(m_d->lodSupportedByCanvas() ? lod : 0);
+
     if (m_d->effectiveLodAllowedInImage()) {
-        KisImageSP image = this->image();
         image->setDesiredLevelOfDetail(lod);
     }
 }
@@ -1102,12 +1114,7 @@ void KisCanvas2::setLodAllowedInCanvas(bool value)
         qWarning() << "WARNING: Level of Detail functionality is available only with openGL + GLSL 1.3 support";
     }
 
-    m_d->lodAllowedInImage =
-        value &&
-        m_d->currentCanvasIsOpenGL &&
-        KisOpenGL::supportsLoD() &&
-        (m_d->openGLFilterMode == KisOpenGL::TrilinearFilterMode ||
-         m_d->openGLFilterMode == KisOpenGL::HighQualityFiltering);
+    m_d->lodAllowedInImage = value && m_d->lodSupportedByCanvas();
 
     KisImageSP image = this->image();
 
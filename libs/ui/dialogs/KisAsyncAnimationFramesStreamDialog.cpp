@@ -0,0 +1,182 @@
+/*
+ *  Copyright (c) 2019 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "KisAsyncAnimationFramesStreamDialog.h"
+
+#include <QIODevice>
+#include <QImage>
+#include <QMap>
+
+#include <kis_time_range.h>
+
+#include <KisAsyncAnimationFramesStreamingRenderer.h>
+
+namespace {
+/**
+ * The maximum amount of data we let to pile up in the device's buffer
+ * and in the reorder buffer. The frames come faster than an encoder can
+ * digest them, so without the limit all the video would end up in memory.
+ */
+const qint64 maxBytesToWrite = 64 * 1024 * 1024;
+
+qint64 frameSize(const QImage &image)
+{
+    return image.bytesPerLine() * image.height();
+}
+}
+
+struct KisAsyncAnimationFramesStreamDialog::Private {
+    Private(KisAsyncAnimationFramesStreamDialog *_q, const KisTimeRange &_range, QIODevice *_device)
+        : q(_q),
+          range(_range),
+          device(_device),
+          nextFrame(_range.start())
+    {
+    }
+
+    KisAsyncAnimationFramesStreamDialog *q;
+    KisTimeRange range;
+    QIODevice *device;
+
+    /**
+     * Frames rendered out-of-order wait here for their predecessors, and
+     * all the frames wait here while the device's buffer is full. No new
+     * frames are dispatched while the buffer is full (see
+     * isReadyForNextFrame()), so this buffer stays small.
+     */
+    QMap<int, QImage> pendingFrames;
+    int nextFrame;
+    bool writeFailed = false;
+
+    qint64 pendingBytes() const;
+    void writePendingFrames();
+};
+
+qint64 KisAsyncAnimationFramesStreamDialog::Private::pendingBytes() const
+{
+    qint64 result = 0;
+    Q_FOREACH (const QImage &image, pendingFrames) {
+        result += frameSize(image);
+    }
+    return result;
+}
+
+void KisAsyncAnimationFramesStreamDialog::Private::writePendingFrames()
+{
+    if (writeFailed) return;
+
+    /**
+     * We never wait for the reader here, that would freeze the GUI. The
+     * rest of the frames is written when bytesWritten() reports that the
+     * device's buffer has been drained.
+     */
+    while (device->bytesToWrite() < maxBytesToWrite && pendingFrames.contains(nextFrame)) {
+        const QImage frameImage = pendingFrames.take(nextFrame);
+        const qint64 size = frameSize(frameImage);
+
+        if (device->write(reinterpret_cast<const char*>(frameImage.constBits()), size) != size) {
+            writeFailed = true;
+            pendingFrames.clear();
+            q->abortRegeneration();
+            return;
+        }
+
+        nextFrame++;
+    }
+}
+
+KisAsyncAnimationFramesStreamDialog::KisAsyncAnimationFramesStreamDialog(KisImageSP image,
+                                                                         const KisTimeRange &range,
+                                                                         QIODevice *device)
+    : KisAsyncAnimationRenderDialogBase("Rendering frames...", image, 0),
+      m_d(new Private(this, range, device))
+{
+    connect(device, &QIODevice::bytesWritten, this,
+            [this] () {
+                m_d->writePendingFrames();
+                resumeFrameRegeneration();
+            });
+}
+
+KisAsyncAnimationFramesStreamDialog::~KisAsyncAnimationFramesStreamDialog()
+{
+}
+
+KisAsyncAnimationRenderDialogBase::Result KisAsyncAnimationFramesStreamDialog::regenerateRange(KisViewManager *viewManager)
+{
+    m_d->pendingFrames.clear();
+    m_d->nextFrame = m_d->range.start();
+    m_d->writeFailed = false;
+
+    Result result = KisAsyncAnimationRenderDialogBase::regenerateRange(viewManager);
+
+    // the rendering might have been cancelled with some frames still pending
+    m_d->pendingFrames.clear();
+
+    if (result == RenderComplete &&
+        (m_d->writeFailed || m_d->nextFrame <= m_d->range.end())) {
+
+        result = RenderFailed;
+    }
+
+    return result;
+}
+
+QList<int> KisAsyncAnimationFramesStreamDialog::calcDirtyFrames() const
+{
+    QList<int> result;
+    for (int i = m_d->range.start(); i <= m_d->range.end(); i++) {
+        result.append(i);
+    }
+    return result;
+}
+
+bool KisAsyncAnimationFramesStreamDialog::isReadyForNextFrame() const
+{
+    return !m_d->writeFailed &&
+        m_d->device->bytesToWrite() + m_d->pendingBytes() < maxBytesToWrite;
+}
+
+bool KisAsyncAnimationFramesStreamDialog::hasPendingFrames() const
+{
+    return !m_d->pendingFrames.isEmpty();
+}
+
+KisAsyncAnimationRendererBase *KisAsyncAnimationFramesStreamDialog::createRenderer(KisImageSP image)
+{
+    Q_UNUSED(image);
+
+    KisAsyncAnimationFramesStreamingRenderer *renderer = new KisAsyncAnimationFramesStreamingRenderer();
+
+    // the context object lives in the GUI thread, so the connection is queued
+    connect(renderer, &KisAsyncAnimationFramesStreamingRenderer::sigFrameReady, this,
+            [this] (int frame, const QImage &image) {
+                if (m_d->writeFailed) return;
+
+                m_d->pendingFrames.insert(frame, image);
+                m_d->writePendingFrames();
+            });
+
+    return renderer;
+}
+
+void KisAsyncAnimationFramesStreamDialog::initializeRendererForFrame(KisAsyncAnimationRendererBase *renderer, KisImageSP image, int frame)
+{
+    Q_UNUSED(renderer);
+    Q_UNUSED(image);
+    Q_UNUSED(frame);
+}
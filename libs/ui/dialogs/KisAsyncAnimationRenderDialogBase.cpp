@@ -272,11 +272,32 @@ void KisAsyncAnimationRenderDialogBase::cancelProcessingImpl(bool isUserCancelle
 }
 
 
+bool KisAsyncAnimationRenderDialogBase::isReadyForNextFrame() const
+{
+    return true;
+}
+
+bool KisAsyncAnimationRenderDialogBase::hasPendingFrames() const
+{
+    return false;
+}
+
+void KisAsyncAnimationRenderDialogBase::resumeFrameRegeneration()
+{
+    tryInitiateFrameRegeneration();
+    updateProgressLabel();
+}
+
+void KisAsyncAnimationRenderDialogBase::abortRegeneration()
+{
+    cancelProcessingImpl(false);
+}
+
 void KisAsyncAnimationRenderDialogBase::tryInitiateFrameRegeneration()
 {
     bool hadWorkOnPreviousCycle = false;
 
-    while (!m_d->stillDirtyFrames.isEmpty()) {
+    while (!m_d->stillDirtyFrames.isEmpty() && isReadyForNextFrame()) {
         for (auto &pair : m_d->asyncRenderers) {
             if (!pair.renderer->isActive()) {
                 const int currentDirtyFrame = m_d->stillDirtyFrames.takeFirst();
@@ -326,7 +347,9 @@ void KisAsyncAnimationRenderDialogBase::updateProgressLabel()
         m_d->progressDialog->setValue(processedFramesCount);
     }
 
-    if (!m_d->numDirtyFramesLeft()) {
+    if (!m_d->numDirtyFramesLeft() &&
+        (m_d->result != RenderComplete || !hasPendingFrames())) {
+
         m_d->waitLoop.quit();
     }
 }
@@ -143,6 +143,31 @@ protected:
     virtual void initializeRendererForFrame(KisAsyncAnimationRendererBase *renderer,
                                             KisImageSP image, int frame) = 0;
 
+    /**
+     * @brief lets the subclass pause dispatching of the frames to the renderers
+     *
+     * E.g. when the frames are consumed slower than they are rendered. Call
+     * resumeFrameRegeneration() when the subclass is ready again.
+     */
+    virtual bool isReadyForNextFrame() const;
+
+    /**
+     * @brief returns true while the subclass still has some rendered frames
+     *        to process. The regeneration doesn't finish until then.
+     */
+    virtual bool hasPendingFrames() const;
+
+    /**
+     * @brief dispatches the frames to the renderers after isReadyForNextFrame()
+     *        or hasPendingFrames() have changed
+     */
+    void resumeFrameRegeneration();
+
+    /**
+     * @brief cancels the regeneration with RenderFailed result
+     */
+    void abortRegeneration();
+
 private:
     struct Private;
     const QScopedPointer<Private> m_d;
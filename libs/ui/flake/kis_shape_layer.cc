@@ -478,6 +478,18 @@ void KisShapeLayer::forceUpdateTimedNode()
     m_d->canvas->forceRepaint();
 }
 
+int KisShapeLayer::testingNumSnapshotRepaints() const
+{
+    KisShapeLayerCanvas *canvas = dynamic_cast<KisShapeLayerCanvas*>(m_d->canvas);
+    return canvas ? canvas->testingNumSnapshotRepaints() : 0;
+}
+
+int KisShapeLayer::testingNumGuiThreadRepaints() const
+{
+    KisShapeLayerCanvas *canvas = dynamic_cast<KisShapeLayerCanvas*>(m_d->canvas);
+    return canvas ? canvas->testingNumGuiThreadRepaints() : 0;
+}
+
 #include "SvgWriter.h"
 #include "SvgParser.h"
 
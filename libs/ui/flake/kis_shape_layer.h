@@ -156,6 +156,18 @@ protected:
 
     KoShapeBasedDocumentBase *shapeController() const;
 
+    /**
+     * The number of times the cache of the layer has been rendered from
+     * a copy of the shapes in a worker thread, for unittests only
+     */
+    int testingNumSnapshotRepaints() const;
+
+    /**
+     * The number of times the cache of the layer has been rendered in
+     * the GUI thread, for unittests only
+     */
+    int testingNumGuiThreadRepaints() const;
+
 Q_SIGNALS:
     /**
      * These signals are forwarded from the local shape manager
@@ -42,6 +42,8 @@
 #include <QApplication>
 
 #include <kis_spontaneous_job.h>
+#include <KoShapeLayer.h>
+#include "krita_utils.h"
 #include "kis_image.h"
 #include "kis_global.h"
 
@@ -137,7 +139,7 @@ KisShapeLayerCanvas::KisShapeLayerCanvas(KisShapeLayer *parent, KisImageWSP imag
     m_shapeManager->addShape(parent, KoShapeManager::AddWithoutRepaint);
     m_shapeManager->selection()->setActiveLayer(parent);
 
-    connect(this, SIGNAL(forwardRepaint()), SLOT(repaint()), Qt::QueuedConnection);
+    connect(this, SIGNAL(forwardRepaint()), SLOT(slotStartDirectSyncRepaint()), Qt::QueuedConnection);
     connect(&m_asyncUpdateSignalCompressor, SIGNAL(timeout()), SLOT(slotStartAsyncRepaint()));
 
     connect(m_image, SIGNAL(sigSizeChanged(const QPointF &, const QPointF &)), SLOT(slotImageSizeChanged()));
@@ -160,12 +162,33 @@ void KisShapeLayerCanvas::setImage(KisImageWSP image)
 #endif
 
 
+/**
+ * A copy of the shapes of the layer made in the GUI thread. The worker
+ * thread renders the copy, so the user may continue editing the original
+ * shapes while the rendering is in progress.
+ */
+struct KisShapeLayerCanvas::ShapesSnapshot
+{
+    ShapesSnapshot(int _seqNo, const QRegion &_region)
+        : seqNo(_seqNo),
+          region(_region),
+          root(new KoShapeLayer())
+    {
+    }
+
+    int seqNo;
+    QRegion region;
+    QScopedPointer<KoShapeLayer> root;
+};
+
 class KisRepaintShapeLayerLayerJob : public KisSpontaneousJob
 {
 public:
-    KisRepaintShapeLayerLayerJob(KisShapeLayerSP layer, KisShapeLayerCanvas *canvas)
+    KisRepaintShapeLayerLayerJob(KisShapeLayerSP layer, KisShapeLayerCanvas *canvas,
+                                 KisShapeLayerCanvas::ShapesSnapshot *snapshot = 0)
         : m_layer(layer),
-          m_canvas(canvas)
+          m_canvas(canvas),
+          m_snapshot(snapshot)
     {
     }
 
@@ -173,11 +196,21 @@ public:
         const KisRepaintShapeLayerLayerJob *otherJob =
             dynamic_cast<const KisRepaintShapeLayerLayerJob*>(_otherJob);
 
-        return otherJob && otherJob->m_canvas == m_canvas;
+        /**
+         * A newer snapshot always covers the region of the older one
+         * that is still pending (see slotStartDirectSyncRepaint()), but
+         * it doesn't cover the region of the asynchronous repaint.
+         */
+        return otherJob && otherJob->m_canvas == m_canvas &&
+            bool(otherJob->m_snapshot) == bool(m_snapshot);
     }
 
     void run() override {
-        m_canvas->repaint();
+        if (m_snapshot) {
+            m_canvas->repaintSnapshot(m_snapshot.data());
+        } else {
+            m_canvas->repaint();
+        }
     }
 
     int levelOfDetail() const override {
@@ -191,6 +224,7 @@ private:
     KisShapeLayerSP m_layer;
 
     KisShapeLayerCanvas *m_canvas;
+    QScopedPointer<KisShapeLayerCanvas::ShapesSnapshot> m_snapshot;
 };
 
 
@@ -224,11 +258,15 @@ void KisShapeLayerCanvas::updateCanvas(const QVector<QRectF> &region)
      *
      * 2) If the layer is modified by a gui thread, it means that we are being accessed by
      *    a legacy vector tool. It this case just emit a queued signal to make sure the updates
-     *    are compressed a little bit (TODO: add a compressor?)
+     *    are compressed a little bit. When the signal arrives, we copy the dirty shapes and
+     *    render the copy in a spontaneous job, so the GUI thread is not blocked.
      */
 
     if (qApp->thread() == QThread::currentThread()) {
-        emit forwardRepaint();
+        if (!m_hasDirectSyncRepaintInitiated) {
+            m_hasDirectSyncRepaintInitiated = true;
+            emit forwardRepaint();
+        }
     } else {
         m_asyncUpdateSignalCompressor.start();
         m_hasUpdateInCompressor = true;
@@ -247,6 +285,67 @@ void KisShapeLayerCanvas::slotStartAsyncRepaint()
     m_image->addSpontaneousJob(new KisRepaintShapeLayerLayerJob(m_parentLayer, this));
 }
 
+void KisShapeLayerCanvas::slotStartDirectSyncRepaint()
+{
+    m_hasDirectSyncRepaintInitiated = false;
+
+    if (!m_parentLayer->image() || m_isDestroying) {
+        return;
+    }
+
+    QRegion region;
+    int seqNo = 0;
+
+    {
+        QMutexLocker locker(&m_dirtyRegionMutex);
+        if (m_dirtyRegion.isEmpty()) return;
+
+        /**
+         * The new job will override the pending one (if any), so
+         * it should render its region as well
+         */
+        region = m_dirtyRegion | m_pendingSnapshotRegion;
+        m_dirtyRegion = QRegion();
+
+        m_pendingSnapshotRegion = region;
+        seqNo = ++m_lastSnapshotSeqNo;
+    }
+
+    QScopedPointer<ShapesSnapshot> snapshot(new ShapesSnapshot(seqNo, region));
+    snapshot->root->setTransformation(m_parentLayer->absoluteTransformation(0));
+
+    const QRectF documentRect = m_viewConverter->viewToDocument(region.boundingRect());
+
+    Q_FOREACH (KoShape *shape, m_parentLayer->shapes()) {
+        if (!shape->boundingRect().intersects(documentRect)) continue;
+
+        KoShape *clonedShape = shape->cloneShape();
+
+        if (!clonedShape) {
+            /**
+             * The shape cannot be copied, so fall back to rendering in the GUI
+             * thread. The region includes the regions of the older snapshots
+             * that are still queued, so they must not repaint it afterwards
+             * with the stale shapes (see repaintSnapshot()).
+             */
+            {
+                QMutexLocker locker(&m_dirtyRegionMutex);
+                if (m_lastSnapshotSeqNo == seqNo) {
+                    m_pendingSnapshotRegion = QRegion();
+                }
+                m_lastGuiThreadRepaintSeqNo = seqNo;
+            }
+
+            repaintImpl(region, m_shapeManager.data());
+            return;
+        }
+
+        snapshot->root->addShape(clonedShape);
+    }
+
+    m_image->addSpontaneousJob(new KisRepaintShapeLayerLayerJob(m_parentLayer, this, snapshot.take()));
+}
+
 void KisShapeLayerCanvas::slotImageSizeChanged()
 {
     QRegion dirtyCacheRegion;
@@ -265,43 +364,82 @@ void KisShapeLayerCanvas::slotImageSizeChanged()
 
 void KisShapeLayerCanvas::repaint()
 {
-
-    QRect r;
+    QRegion region;
 
     {
         QMutexLocker locker(&m_dirtyRegionMutex);
-        r = m_dirtyRegion.boundingRect();
+        region = m_dirtyRegion;
         m_dirtyRegion = QRegion();
     }
 
-    if (r.isEmpty()) return;
+    repaintImpl(region, m_shapeManager.data());
+}
+
+void KisShapeLayerCanvas::repaintSnapshot(ShapesSnapshot *snapshot)
+{
+    {
+        QMutexLocker locker(&m_dirtyRegionMutex);
+
+        // the region has already been repainted in the GUI thread
+        if (snapshot->seqNo < m_lastGuiThreadRepaintSeqNo) return;
+
+        if (m_lastSnapshotSeqNo == snapshot->seqNo) {
+            m_pendingSnapshotRegion = QRegion();
+        }
+    }
+
+    KoShapeManager shapeManager(this);
+    shapeManager.addShape(snapshot->root.data(), KoShapeManager::AddWithoutRepaint);
+
+    repaintImpl(snapshot->region, &shapeManager);
+
+    m_numSnapshotRepaints.ref();
+}
+
+void KisShapeLayerCanvas::repaintImpl(const QRegion &region, KoShapeManager *shapeManager)
+{
+    if (qApp->thread() == QThread::currentThread()) {
+        m_numGuiThreadRepaints.ref();
+    }
 
     // Crop the update rect by the image bounds. We keep the cache consistent
     // by tracking the size of the image in slotImageSizeChanged()
-    r = r.intersected(m_parentLayer->image()->bounds());
+    const QRegion croppedRegion = region & m_parentLayer->image()->bounds();
+    if (croppedRegion.isEmpty()) return;
+
+    /**
+     * Render the region in patches. Small images are cheap to fill and to
+     * convert, and the patches not covered by any shape are just cleared.
+     */
+    const QVector<QRect> patches =
+        KritaUtils::splitRegionIntoPatches(croppedRegion, KritaUtils::optimalPatchSize());
 
-    QImage image(r.width(), r.height(), QImage::Format_ARGB32);
-    image.fill(0);
-    QPainter p(&image);
+    Q_FOREACH (const QRect &rc, patches) {
+        if (shapeManager->shapesAt(m_viewConverter->viewToDocument(rc)).isEmpty()) {
+            m_projection->clear(rc);
+            continue;
+        }
+
+        QImage image(rc.width(), rc.height(), QImage::Format_ARGB32);
+        image.fill(0);
+        QPainter p(&image);
 
-    p.setRenderHint(QPainter::Antialiasing);
-    p.setRenderHint(QPainter::TextAntialiasing);
-    p.translate(-r.x(), -r.y());
-    p.setClipRect(r);
+        p.setRenderHint(QPainter::Antialiasing);
+        p.setRenderHint(QPainter::TextAntialiasing);
+        p.translate(-rc.x(), -rc.y());
+        p.setClipRect(rc);
 #ifdef DEBUG_REPAINT
-    QColor color = QColor(random() % 255, random() % 255, random() % 255);
-    p.fillRect(r, color);
+        QColor color = QColor(random() % 255, random() % 255, random() % 255);
+        p.fillRect(rc, color);
 #endif
 
-    m_shapeManager->paint(p, *m_viewConverter, false);
-    p.end();
+        shapeManager->paint(p, *m_viewConverter, false);
+        p.end();
 
-    KisPaintDeviceSP dev = new KisPaintDevice(m_projection->colorSpace());
-    dev->convertFromQImage(image, 0);
-
-    KisPainter::copyAreaOptimized(r.topLeft(), dev, m_projection, QRect(QPoint(), r.size()));
+        m_projection->convertFromQImage(image, 0, rc.x(), rc.y());
+    }
 
-    m_parentLayer->setDirty(r);
+    m_parentLayer->setDirty(patches);
 
     m_hasChangedWhileBeingInvisible |= !m_parentLayer->visible(true);
 }
@@ -321,6 +459,12 @@ void KisShapeLayerCanvas::forceRepaint()
         m_asyncUpdateSignalCompressor.stop();
         slotStartAsyncRepaint();
     }
+
+    if (m_hasDirectSyncRepaintInitiated &&
+        qApp->thread() == QThread::currentThread()) {
+
+        slotStartDirectSyncRepaint();
+    }
 }
 
 void KisShapeLayerCanvas::resetCache()
@@ -19,6 +19,7 @@
 #define KIS_SHAPE_LAYER_CANVAS_H
 
 #include <QMutex>
+#include <QAtomicInt>
 #include <QRegion>
 #include <KoCanvasBase.h>
 
@@ -101,28 +102,50 @@ public:
     void resetCache() override;
     void rerenderAfterBeingInvisible() override;
 
+    int testingNumSnapshotRepaints() const {
+        return m_numSnapshotRepaints.load();
+    }
+
+    int testingNumGuiThreadRepaints() const {
+        return m_numGuiThreadRepaints.load();
+    }
+
 private Q_SLOTS:
     friend class KisRepaintShapeLayerLayerJob;
     void repaint();
     void slotStartAsyncRepaint();
+    void slotStartDirectSyncRepaint();
     void slotImageSizeChanged();
 
 Q_SIGNALS:
     void forwardRepaint();
 
+private:
+    struct ShapesSnapshot;
+
+    void repaintSnapshot(ShapesSnapshot *snapshot);
+    void repaintImpl(const QRegion &region, KoShapeManager *shapeManager);
+
 private:
     KisPaintDeviceSP m_projection;
     KisShapeLayer *m_parentLayer;
 
     KisThreadSafeSignalCompressor m_asyncUpdateSignalCompressor;
     volatile bool m_hasUpdateInCompressor = false;
+    bool m_hasDirectSyncRepaintInitiated = false;
 
     QRegion m_dirtyRegion;
+    QRegion m_pendingSnapshotRegion;
+    int m_lastSnapshotSeqNo = 0;
+    int m_lastGuiThreadRepaintSeqNo = 0;
     QMutex m_dirtyRegionMutex;
 
     QRect m_cachedImageRect;
 
     KisImageWSP m_image;
+
+    QAtomicInt m_numSnapshotRepaints;
+    QAtomicInt m_numGuiThreadRepaints;
 };
 
 #endif
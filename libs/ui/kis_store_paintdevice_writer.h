@@ -23,8 +23,9 @@
 
 class KisStorePaintDeviceWriter : public KisPaintDeviceWriter {
 public:
-    KisStorePaintDeviceWriter(KoStore *store)
-        : m_store(store)
+    KisStorePaintDeviceWriter(KoStore *store, const QString &tileCompression = QString())
+        : m_store(store),
+          m_tileCompression(tileCompression)
     {
     }
 
@@ -40,7 +41,12 @@ public:
         return (length == len);
     }
 
+    QString tileCompression() const override {
+        return m_tileCompression;
+    }
+
     KoStore *m_store;
+    QString m_tileCompression;
 
 };
 
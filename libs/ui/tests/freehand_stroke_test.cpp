@@ -21,13 +21,22 @@
 #include <QTest>
 #include <KoCompositeOpRegistry.h>
 #include <KoColor.h>
+#include <KoColorSpace.h>
 #include "stroke_testing_utils.h"
 #include "strokes/freehand_stroke.h"
 #include "strokes/KisFreehandStrokeInfo.h"
 #include "kis_resources_snapshot.h"
 #include "kis_image.h"
 #include "kis_painter.h"
+#include "kis_paint_layer.h"
+#include "kis_selection.h"
+#include "kis_pixel_selection.h"
+#include "kis_image_config.h"
+#include "kis_canvas_resource_provider.h"
+#include "commands/kis_set_global_selection_command.h"
 #include <brushengine/kis_paint_information.h>
+#include <brushengine/kis_paintop_preset.h>
+#include "testutil.h"
 
 
 class FreehandStrokeTester : public utils::StrokeTester
@@ -171,6 +180,96 @@ void FreehandStrokeTest::testMixDullCompositioning()
     tester.test();
 }
 
+class ColorSmudgeStripesTester : public FreehandStrokeTester
+{
+public:
+    ColorSmudgeStripesTester()
+        : FreehandStrokeTester("testing_200px_colorsmudge_default.kpp")
+    {
+    }
+
+    KisPaintDeviceSP result() const {
+        return m_result;
+    }
+
+protected:
+    using FreehandStrokeTester::initImage;
+    void initImage(KisImageWSP image, KisNodeSP activeNode) override {
+        KisPaintLayer *layer = dynamic_cast<KisPaintLayer*>(activeNode.data());
+        QVERIFY(layer);
+
+        const QRect rc = image->bounds();
+        const QRect leftHalf(rc.x(), rc.y(), rc.width() / 2, rc.height());
+        const QRect rightHalf(leftHalf.right() + 1, rc.y(), rc.width() - leftHalf.width(), rc.height());
+
+        layer->paintDevice()->fill(leftHalf, KoColor(Qt::yellow, image->colorSpace()));
+        layer->paintDevice()->fill(rightHalf, KoColor(Qt::cyan, image->colorSpace()));
+
+        QBitArray channelFlags(image->colorSpace()->channelCount(), true);
+        channelFlags.clearBit(1);
+        layer->setChannelLockFlags(channelFlags);
+
+        KisSelectionSP selection = new KisSelection();
+        selection->pixelSelection()->select(QRect(120, 150, 260, 230));
+        KisSetGlobalSelectionCommand(image, selection).redo();
+    }
+
+    using FreehandStrokeTester::modifyResourceManager;
+    void modifyResourceManager(KoCanvasResourceManager *manager,
+                               KisImageWSP image,
+                               int iteration) override {
+
+        FreehandStrokeTester::modifyResourceManager(manager, image, iteration);
+
+        KisPaintOpPresetSP preset =
+            manager->resource(KisCanvasResourceProvider::CurrentPaintOpPreset).value<KisPaintOpPresetSP>();
+        preset->settings()->setPaintOpSize(400);
+
+        QVariant i;
+        i.setValue(COMPOSITE_MULT);
+        manager->setResource(KisCanvasResourceProvider::CurrentCompositeOp, i);
+    }
+
+    void beforeCheckingResult(KisImageWSP image, KisNodeSP activeNode) override {
+        FreehandStrokeTester::beforeCheckingResult(image, activeNode);
+        m_result = new KisPaintDevice(*activeNode->paintDevice());
+    }
+
+private:
+    KisPaintDeviceSP m_result;
+};
+
+void FreehandStrokeTest::testColorSmudgeStripes()
+{
+    /**
+     * Dabs bigger than 256x256 are painted in stripes, one stripe
+     * per thread. With a single thread allowed the dab is painted
+     * with one painter, so both runs must give exactly the same result.
+     */
+
+    KisImageConfig cfg(false);
+    const int oldNumThreads = cfg.maxNumberOfThreads();
+
+    cfg.setMaxNumberOfThreads(1);
+    ColorSmudgeStripesTester singleTester;
+    singleTester.testSimpleStrokeNoVerification();
+
+    cfg.setMaxNumberOfThreads(4);
+    ColorSmudgeStripesTester stripesTester;
+    stripesTester.testSimpleStrokeNoVerification();
+
+    cfg.setMaxNumberOfThreads(oldNumThreads);
+
+    QVERIFY(singleTester.result());
+    QVERIFY(stripesTester.result());
+
+    QPoint errorPoint;
+    if (!TestUtil::comparePaintDevices(errorPoint, singleTester.result(), stripesTester.result())) {
+        QFAIL(QString("Striped color smudge dab differs from the single painter one at %1,%2")
+              .arg(errorPoint.x()).arg(errorPoint.y()).toLatin1());
+    }
+}
+
 void FreehandStrokeTest::testAutoBrushStrokeLod()
 {
     FreehandStrokeTester tester("Basic_tip_default.kpp", true);
@@ -30,6 +30,7 @@ private Q_SLOTS:
     void testAutoBrushStroke();
     void testHatchingStroke();
     void testColorSmudgeStroke();
+    void testColorSmudgeStripes();
     void testAutoTextured17();
     void testAutoTextured38();
     void testMixDullCompositioning();
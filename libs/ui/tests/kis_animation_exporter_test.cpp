@@ -19,8 +19,10 @@
 #include "kis_animation_exporter_test.h"
 
 #include "dialogs/KisAsyncAnimationFramesSaveDialog.h"
+#include "dialogs/KisAsyncAnimationFramesStreamDialog.h"
 
 #include <QTest>
+#include <QBuffer>
 #include <testutil.h>
 #include "KisPart.h"
 #include "kis_image.h"
@@ -90,4 +92,57 @@ void KisAnimationExporterTest::testAnimationExport()
     QCOMPARE(exported, frame2);
 }
 
+void KisAnimationExporterTest::testAnimationStreaming()
+{
+    KisDocument *document = KisPart::instance()->createDocument();
+    QRect rect(0,0,64,64);
+    QRect fillRect(10,0,54,64);
+    TestUtil::MaskParent p(rect);
+    document->setCurrentImage(p.image);
+    const KoColorSpace *cs = p.image->colorSpace();
+
+    KUndo2Command parentCommand;
+
+    p.layer->enableAnimation();
+    KisKeyframeChannel *rasterChannel = p.layer->getKeyframeChannel(KisKeyframeChannel::Content.id(), true);
+
+    rasterChannel->addKeyframe(1, &parentCommand);
+    rasterChannel->addKeyframe(2, &parentCommand);
+    p.image->animationInterface()->setFullClipRange(KisTimeRange::fromTime(0, 2));
+
+    KisPaintDeviceSP dev = p.layer->paintDevice();
+
+    QVector<QImage> frames;
+    const QColor colors[] = {Qt::red, Qt::green, Qt::blue};
+
+    for (int i = 0; i < 3; i++) {
+        p.image->animationInterface()->switchCurrentTimeAsync(i);
+        p.image->waitForDone();
+        dev->fill(fillRect, KoColor(colors[i], cs));
+        frames << dev->convertToQImage(0, rect);
+    }
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+
+    KisAsyncAnimationFramesStreamDialog exporter(document->image(),
+                                                 KisTimeRange::fromTime(0,2),
+                                                 &buffer);
+
+    exporter.setBatchMode(true);
+    QCOMPARE(exporter.regenerateRange(0), KisAsyncAnimationRenderDialogBase::RenderComplete);
+
+    const QByteArray data = buffer.data();
+    const int frameSize = rect.width() * rect.height() * 4;
+
+    QCOMPARE(data.size(), 3 * frameSize);
+
+    // the frames should be written strictly in order
+    for (int i = 0; i < 3; i++) {
+        QImage streamed(reinterpret_cast<const uchar*>(data.constData() + i * frameSize),
+                        rect.width(), rect.height(), QImage::Format_ARGB32);
+        QCOMPARE(streamed, frames[i]);
+    }
+}
+
 QTEST_MAIN(KisAnimationExporterTest)
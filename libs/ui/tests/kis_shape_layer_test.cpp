@@ -306,4 +306,135 @@ void KisShapeLayerTest::testCloneScaledLayer()
     QVERIFY(chk.testPassed());
 }
 
+void KisShapeLayerTest::testRenderingWhileEditing()
+{
+    QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+
+    const QRect refRect(0,0,64,64);
+    TestUtil::MaskParent p(refRect);
+
+    const qreal resolution = 72.0 / 72.0;
+    p.image->setResolution(resolution, resolution);
+
+    doc->setCurrentImage(p.image);
+
+    KisShapeLayerSP shapeLayer = new KisShapeLayer(doc->shapeController(), p.image, "shapeLayer", 255);
+
+    KoPathShape* path = new KoPathShape();
+    path->setShapeId(KoPathShapeId);
+    path->moveTo(QPointF(5, 5));
+    path->lineTo(QPointF(5, 55));
+    path->lineTo(QPointF(20, 55));
+    path->lineTo(QPointF(20,  5));
+    path->close();
+    path->normalize();
+    path->setBackground(toQShared(new KoColorBackground(Qt::red)));
+    shapeLayer->addShape(path);
+
+    p.image->addNode(shapeLayer);
+    shapeLayer->setDirty();
+    p.waitForImageAndShapeLayers();
+
+    QCOMPARE(shapeLayer->original()->exactBounds(), QRect(5, 5, 15, 50));
+
+    const int numSnapshotRepaints = shapeLayer->testingNumSnapshotRepaints();
+    const int numGuiThreadRepaints = shapeLayer->testingNumGuiThreadRepaints();
+
+    // the first move is rendered from a copy of the shape...
+    path->update();
+    path->setPosition(QPointF(25, 5));
+    path->update();
+    qApp->processEvents();
+
+    // ...so the shape can be changed while the copy is being rendered
+    path->update();
+    path->setPosition(QPointF(40, 5));
+    path->update();
+
+    // the update of the second move is still waiting in the event queue,
+    // so the layer must contain the copy made before the second move
+    p.image->waitForDone();
+
+    QCOMPARE(shapeLayer->original()->exactBounds(), QRect(25, 5, 15, 50));
+    QCOMPARE(shapeLayer->testingNumSnapshotRepaints(), numSnapshotRepaints + 1);
+    QCOMPARE(shapeLayer->testingNumGuiThreadRepaints(), numGuiThreadRepaints);
+
+    p.waitForImageAndShapeLayers();
+
+    QCOMPARE(shapeLayer->original()->exactBounds(), QRect(40, 5, 15, 50));
+    QCOMPARE(shapeLayer->testingNumSnapshotRepaints(), numSnapshotRepaints + 2);
+    QCOMPARE(shapeLayer->testingNumGuiThreadRepaints(), numGuiThreadRepaints);
+}
+
+namespace {
+struct UncopyablePathShape : public KoPathShape
+{
+    KoShape *cloneShape() const override {
+        return allowCloning ? KoPathShape::cloneShape() : 0;
+    }
+
+    bool allowCloning = true;
+};
+}
+
+void KisShapeLayerTest::testGuiThreadRepaintOverridesSnapshot()
+{
+    QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+
+    const QRect refRect(0,0,64,64);
+    TestUtil::MaskParent p(refRect);
+
+    const qreal resolution = 72.0 / 72.0;
+    p.image->setResolution(resolution, resolution);
+
+    doc->setCurrentImage(p.image);
+
+    KisShapeLayerSP shapeLayer = new KisShapeLayer(doc->shapeController(), p.image, "shapeLayer", 255);
+
+    UncopyablePathShape* path = new UncopyablePathShape();
+    path->setShapeId(KoPathShapeId);
+    path->moveTo(QPointF(5, 5));
+    path->lineTo(QPointF(5, 55));
+    path->lineTo(QPointF(20, 55));
+    path->lineTo(QPointF(20,  5));
+    path->close();
+    path->normalize();
+    path->setBackground(toQShared(new KoColorBackground(Qt::red)));
+    shapeLayer->addShape(path);
+
+    p.image->addNode(shapeLayer);
+    shapeLayer->setDirty();
+    p.waitForImageAndShapeLayers();
+
+    QCOMPARE(shapeLayer->original()->exactBounds(), QRect(5, 5, 15, 50));
+
+    const int numSnapshotRepaints = shapeLayer->testingNumSnapshotRepaints();
+    const int numGuiThreadRepaints = shapeLayer->testingNumGuiThreadRepaints();
+
+    // keep the snapshot job in the queue
+    p.image->barrierLock();
+
+    path->update();
+    path->setPosition(QPointF(25, 5));
+    path->update();
+    qApp->processEvents();
+
+    // the shape cannot be copied anymore, so it is rendered in the GUI thread
+    path->allowCloning = false;
+
+    path->update();
+    path->setPosition(QPointF(40, 5));
+    path->update();
+    qApp->processEvents();
+
+    QCOMPARE(shapeLayer->testingNumGuiThreadRepaints(), numGuiThreadRepaints + 1);
+
+    p.image->unlock();
+    p.waitForImageAndShapeLayers();
+
+    // the queued snapshot must not bring back the old position of the shape
+    QCOMPARE(shapeLayer->original()->exactBounds(), QRect(40, 5, 15, 50));
+    QCOMPARE(shapeLayer->testingNumSnapshotRepaints(), numSnapshotRepaints);
+}
+
 QTEST_MAIN(KisShapeLayerTest)
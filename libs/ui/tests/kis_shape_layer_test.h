@@ -31,6 +31,9 @@ private Q_SLOTS:
     void testMergingShapeZIndexes();
 
     void testCloneScaledLayer();
+
+    void testRenderingWhileEditing();
+    void testGuiThreadRepaintOverridesSnapshot();
 };
 
 #endif // KISSHAPELAYERTEST_H
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2019 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#include "KoResourceIndex.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QSaveFile>
+
+#include "WidgetsDebug.h"
+
+namespace {
+const quint32 indexMagic = 0x4B524958; // "KRIX"
+const quint32 indexVersion = 1;
+}
+
+KoResourceIndex::KoResourceIndex(const QString &indexFileName)
+    : m_indexFileName(indexFileName)
+{
+}
+
+KoResourceIndex::~KoResourceIndex()
+{
+}
+
+void KoResourceIndex::load()
+{
+    m_entries.clear();
+    m_usedEntries.clear();
+    m_isModified = false;
+
+    QFile file(m_indexFileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 numEntries = 0;
+
+    stream >> magic >> version >> numEntries;
+    if (magic != indexMagic || version != indexVersion) {
+        warnWidgets << "Resource index" << m_indexFileName << "has unknown format, ignoring it";
+        return;
+    }
+
+    for (quint32 i = 0; i < numEntries; i++) {
+        QString filename;
+        Entry entry;
+
+        stream >> filename >> entry.size >> entry.lastModified >> entry.md5;
+
+        if (stream.status() != QDataStream::Ok) {
+            warnWidgets << "Resource index" << m_indexFileName << "is broken, ignoring it";
+            m_entries.clear();
+            return;
+        }
+
+        m_entries.insert(filename, entry);
+    }
+}
+
+void KoResourceIndex::save()
+{
+    // the index should also be rewritten when some of the files were removed
+    if (!m_isModified && m_usedEntries.size() == m_entries.size()) {
+        return;
+    }
+
+    QSaveFile file(m_indexFileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        warnWidgets << "Cannot write resource index" << m_indexFileName;
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    stream << indexMagic << indexVersion << quint32(m_usedEntries.size());
+
+    for (auto it = m_usedEntries.constBegin(); it != m_usedEntries.constEnd(); ++it) {
+        stream << it.key() << it.value().size << it.value().lastModified << it.value().md5;
+    }
+
+    if (!file.commit()) {
+        warnWidgets << "Cannot write resource index" << m_indexFileName;
+        return;
+    }
+
+    m_entries = m_usedEntries;
+    m_isModified = false;
+}
+
+QByteArray KoResourceIndex::md5(const QFileInfo &fileInfo)
+{
+    const QString filename = fileInfo.absoluteFilePath();
+
+    auto it = m_entries.constFind(filename);
+    if (it == m_entries.constEnd() ||
+        it->size != fileInfo.size() ||
+        it->lastModified != fileInfo.lastModified()) {
+
+        return QByteArray();
+    }
+
+    m_usedEntries.insert(filename, *it);
+    return it->md5;
+}
+
+void KoResourceIndex::setMd5(const QFileInfo &fileInfo, const QByteArray &md5)
+{
+    Entry entry;
+    entry.size = fileInfo.size();
+    entry.lastModified = fileInfo.lastModified();
+    entry.md5 = md5;
+
+    m_usedEntries.insert(fileInfo.absoluteFilePath(), entry);
+    m_isModified = true;
+}
+
+int KoResourceIndex::size() const
+{
+    return m_entries.size();
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2019 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef KORESOURCEINDEX_H
+#define KORESOURCEINDEX_H
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QDateTime>
+
+#include "kritawidgets_export.h"
+
+class QFileInfo;
+
+/**
+ * KoResourceIndex is an on-disk cache of the metadata of the resource
+ * files of a resource server. For every file it remembers the size and
+ * the modification time the file had when its MD5 sum was calculated,
+ * so the sum of an unchanged file can be taken from the index instead
+ * of reading and hashing the whole file again on every startup.
+ *
+ * Only the entries fetched or stored since the last load() are written
+ * back by save(), so the entries of the removed files disappear from
+ * the index automatically.
+ */
+class KRITAWIDGETS_EXPORT KoResourceIndex
+{
+public:
+    KoResourceIndex(const QString &indexFileName);
+    ~KoResourceIndex();
+
+    /**
+     * Reads the index file. A missing, broken or outdated file results
+     * in an empty index.
+     */
+    void load();
+
+    /**
+     * Writes the index file, if anything has been changed since load()
+     */
+    void save();
+
+    /**
+     * @return the MD5 sum stored for \p fileInfo or an empty array if
+     * the file is not in the index or has been changed since then
+     */
+    QByteArray md5(const QFileInfo &fileInfo);
+
+    void setMd5(const QFileInfo &fileInfo, const QByteArray &md5);
+
+    int size() const;
+
+private:
+    struct Entry {
+        qint64 size = 0;
+        QDateTime lastModified;
+        QByteArray md5;
+    };
+
+    QString m_indexFileName;
+    QHash<QString, Entry> m_entries;
+    QHash<QString, Entry> m_usedEntries;
+    bool m_isModified = false;
+};
+
+#endif // KORESOURCEINDEX_H
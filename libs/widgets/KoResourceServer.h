@@ -34,10 +34,12 @@
 
 #include <QTemporaryFile>
 #include <QDomDocument>
+#include <QtConcurrent>
 #include "resources/KoResource.h"
 #include "KoResourceServerPolicies.h"
 #include "KoResourceServerObserver.h"
 #include "KoResourceTagStore.h"
+#include "KoResourceIndex.h"
 #include "KoResourcePaths.h"
 
 
@@ -63,6 +65,7 @@ public:
     KoResourceServerBase(const QString& type, const QString& extensions)
         : m_type(type)
         , m_extensions(extensions)
+        , m_concurrentLoadingEnabled(false)
     {
     }
 
@@ -80,6 +83,14 @@ public:
     */
     QString extensions() const { return m_extensions; }
 
+    /**
+     * Lets loadResources() call KoResource::load() for several resources
+     * at once on the global thread pool. Enable it only if loading of the
+     * resources of the server doesn't touch any shared state.
+     */
+    void setConcurrentLoadingEnabled(bool value) { m_concurrentLoadingEnabled = value; }
+    bool concurrentLoadingEnabled() const { return m_concurrentLoadingEnabled; }
+
     QStringList fileNames()
     {
         QStringList extensionList = m_extensions.split(':');
@@ -99,9 +110,14 @@ protected:
     virtual KoResource *byMd5(const QByteArray &md5) const = 0;
     virtual KoResource *byFileName(const QString &fileName) const = 0;
 
+    static void setResourceMd5(KoResource *resource, const QByteArray &md5) {
+        resource->setMD5(md5);
+    }
+
 private:
     QString m_type;
     QString m_extensions;
+    bool m_concurrentLoadingEnabled;
 
 protected:
 
@@ -138,6 +154,7 @@ public:
     typedef KoResourceServerObserver<T, Policy> ObserverType;
     KoResourceServer(const QString& type, const QString& extensions)
         : KoResourceServerBase(type, extensions)
+        , m_index(KoResourcePaths::locateLocal("data", type + ".index"))
     {
         m_blackListFile = KoResourcePaths::locateLocal("data", type + ".blacklist");
         m_blackListFileNames = readBlackListFile();
@@ -174,8 +191,20 @@ public:
      */
     void loadResources(QStringList filenames) override {
 
+        struct LoadItem {
+            PointerType resource;
+            QString filename;
+            QString shortName;
+            bool canUseIndex;
+            bool md5FromIndex;
+            bool loaded;
+        };
+
+        QVector<LoadItem> items;
         QStringList uniqueFiles;
 
+        m_index.load();
+
         while (!filenames.empty()) {
 
             QString front = filenames.first();
@@ -195,34 +224,81 @@ public:
             //      the resource to find out whether they are really the same, but for now this
             //      will prevent the same brush etc. showing up twice.
             if (!uniqueFiles.contains(fname)) {
-                m_loadLock.lock();
                 uniqueFiles.append(fname);
-                QList<PointerType> resources = createResources(front);
+
+                /**
+                 * The resources are created in the GUI thread, because some
+                 * of the servers update their state (e.g. tags) while doing that
+                 */
+                QList<PointerType> resources = createResourcesForLoading(front);
+
                 Q_FOREACH (PointerType resource, resources) {
                     Q_CHECK_PTR(resource);
-                    if (resource->load() && resource->valid() && !resource->md5().isEmpty()) {
-                        addResourceToMd5Registry(resource);
 
-                        m_resourcesByFilename[resource->shortFilename()] = resource;
-
-                        if (resource->name().isEmpty()) {
-                            resource->setName(fname);
-                        }
-                        if (m_resourcesByName.contains(resource->name())) {
-                            resource->setName(resource->name() + "(" + resource->shortFilename() + ")");
+                    LoadItem item;
+                    item.resource = resource;
+                    item.filename = front;
+                    item.shortName = fname;
+                    item.canUseIndex = resources.size() == 1 && resource && resource->filename() == front;
+                    item.md5FromIndex = false;
+                    item.loaded = false;
+
+                    if (item.canUseIndex) {
+                        const QByteArray md5 = m_index.md5(QFileInfo(front));
+                        if (!md5.isEmpty()) {
+                            setResourceMd5(Policy::toResourcePointer(resource), md5);
+                            item.md5FromIndex = true;
                         }
-                        m_resourcesByName[resource->name()] = resource;
-                        notifyResourceAdded(resource);
                     }
-                    else {
-                        warnWidgets << "Loading resource " << front << "failed";
-                        Policy::deleteResource(resource);
+
+                    items.append(item);
+                }
+            }
+        }
+
+        auto loadItem = [this] (LoadItem &item) {
+            item.loaded = item.resource && loadResource(item.resource);
+        };
+
+        if (concurrentLoadingEnabled()) {
+            QtConcurrent::blockingMap(items, loadItem);
+        } else {
+            std::for_each(items.begin(), items.end(), loadItem);
+        }
+
+        Q_FOREACH (const LoadItem &item, items) {
+            m_loadLock.lock();
+
+            if (item.loaded) {
+                if (item.canUseIndex && !item.md5FromIndex) {
+                    m_index.setMd5(QFileInfo(item.filename), item.resource->md5());
+                }
+
+                Q_FOREACH (PointerType resource, unpackLoadedResource(item.resource)) {
+                    addResourceToMd5Registry(resource);
+
+                    m_resourcesByFilename[resource->shortFilename()] = resource;
+
+                    if (resource->name().isEmpty()) {
+                        resource->setName(item.shortName);
+                    }
+                    if (m_resourcesByName.contains(resource->name())) {
+                        resource->setName(resource->name() + "(" + resource->shortFilename() + ")");
                     }
+                    m_resourcesByName[resource->name()] = resource;
+                    notifyResourceAdded(resource);
                 }
-                m_loadLock.unlock();
             }
+            else {
+                warnWidgets << "Loading resource " << item.filename << "failed";
+                Policy::deleteResource(item.resource);
+            }
+
+            m_loadLock.unlock();
         }
 
+        m_index.save();
+
         m_resources = sortedResources();
 
         Q_FOREACH (ObserverType* observer, m_observers) {
@@ -586,6 +662,40 @@ public:
 
     virtual PointerType createResource( const QString & filename ) = 0;
 
+    /**
+     * Creates the resources of a file for loadResources(), which loads them
+     * with loadResource() afterwards. By default the same as createResources().
+     * @param filename the filename of the resource or resource collection
+     */
+    virtual QList<PointerType> createResourcesForLoading(const QString &filename)
+    {
+        return createResources(filename);
+    }
+
+    /**
+     * Loads a resource created by createResourcesForLoading(). It is called
+     * on the global thread pool if concurrent loading is enabled, so it
+     * must not touch the state of the server.
+     * @return true if the resource can be added to the server
+     */
+    virtual bool loadResource(PointerType resource)
+    {
+        return resource->load() && resource->valid() && !resource->md5().isEmpty();
+    }
+
+    /**
+     * Returns the resources to add to the server for a resource loaded
+     * by loadResource(). A file may contain a collection of resources
+     * (e.g. an ABR file), then the resources of the collection are
+     * returned instead of the collection itself. Called in the GUI thread.
+     */
+    virtual QList<PointerType> unpackLoadedResource(PointerType resource)
+    {
+        QList<PointerType> resources;
+        resources.append(resource);
+        return resources;
+    }
+
     /// Return the currently stored resources in alphabetical order, overwrite for customized sorting
     virtual QList<PointerType> sortedResources()
     {
@@ -742,6 +852,7 @@ private:
     QList<ObserverType*> m_observers;
     QString m_blackListFile;
     KoResourceTagStore* m_tagStore;
+    KoResourceIndex m_index;
 
 };
 
@@ -25,6 +25,7 @@
 #include <klocalizedstring.h>
 
 #include "LcmsColorSpace.h"
+#include "IccDirectColorConversions.h"
 
 // -- KoLcmsColorConversionTransformation --
 
@@ -254,6 +255,13 @@ KoColorConversionTransformation *IccColorSpaceEngine::createColorTransformation(
     Q_ASSERT(srcColorSpace);
     Q_ASSERT(dstColorSpace);
 
+    KoColorConversionTransformation *directTransformation =
+        IccDirectColorConversions::create(srcColorSpace, dstColorSpace, renderingIntent, conversionFlags);
+
+    if (directTransformation) {
+        return directTransformation;
+    }
+
     return new KoLcmsColorConversionTransformation(
                 srcColorSpace, computeColorSpaceType(srcColorSpace),
                 dynamic_cast<const IccColorProfile *>(srcColorSpace->profile())->asLcms(), dstColorSpace, computeColorSpaceType(dstColorSpace),
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2019 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "IccDirectColorConversions.h"
+
+#include <QHash>
+
+#include <KoColorSpace.h>
+#include <KoColorProfile.h>
+#include <KoColorSpaceMaths.h>
+#include <KoColorModelStandardIds.h>
+
+
+namespace {
+
+/**
+ * Rescales the channels of every pixel. The number of channels and
+ * their order are known at compile time, so the compiler can unroll
+ * and vectorize the inner loop.
+ */
+template <typename SrcChannel, typename DstChannel, int channelsNb, bool swapRedBlue>
+class DirectColorConversionTransformation : public KoColorConversionTransformation
+{
+public:
+    DirectColorConversionTransformation(const KoColorSpace *srcCs,
+                                        const KoColorSpace *dstCs,
+                                        Intent renderingIntent,
+                                        ConversionFlags conversionFlags)
+        : KoColorConversionTransformation(srcCs, dstCs, renderingIntent, conversionFlags)
+    {
+    }
+
+    void transform(const quint8 *srcU8, quint8 *dstU8, qint32 nPixels) const override
+    {
+        const SrcChannel *src = reinterpret_cast<const SrcChannel*>(srcU8);
+        DstChannel *dst = reinterpret_cast<DstChannel*>(dstU8);
+
+        for (qint32 i = 0; i < nPixels; i++) {
+            for (int ch = 0; ch < channelsNb; ch++) {
+                const int dstCh = swapRedBlue && ch < 3 ? 2 - ch : ch;
+                dst[dstCh] = KoColorSpaceMaths<SrcChannel, DstChannel>::scaleToA(src[ch]);
+            }
+
+            src += channelsNb;
+            dst += channelsNb;
+        }
+    }
+};
+
+typedef KoColorConversionTransformation* (*CreateFunction)(const KoColorSpace*,
+                                                           const KoColorSpace*,
+                                                           KoColorConversionTransformation::Intent,
+                                                           KoColorConversionTransformation::ConversionFlags);
+
+template <typename SrcChannel, typename DstChannel, int channelsNb, bool swapRedBlue>
+KoColorConversionTransformation* createTransformation(const KoColorSpace *srcColorSpace,
+                                                      const KoColorSpace *dstColorSpace,
+                                                      KoColorConversionTransformation::Intent renderingIntent,
+                                                      KoColorConversionTransformation::ConversionFlags conversionFlags)
+{
+    return new DirectColorConversionTransformation<SrcChannel, DstChannel, channelsNb, swapRedBlue>(
+        srcColorSpace, dstColorSpace, renderingIntent, conversionFlags);
+}
+
+QString conversionKey(const QString &modelId, const QString &srcDepthId, const QString &dstDepthId)
+{
+    return modelId + '/' + srcDepthId + '/' + dstDepthId;
+}
+
+struct DirectConversionsRegistry
+{
+    DirectConversionsRegistry() {
+        const QString rgb = RGBAColorModelID.id();
+        const QString gray = GrayAColorModelID.id();
+        const QString u8 = Integer8BitsColorDepthID.id();
+        const QString u16 = Integer16BitsColorDepthID.id();
+        const QString f32 = Float32BitsColorDepthID.id();
+
+        // integer RGB color spaces are stored as BGRA, float ones as RGBA
+        add(rgb, u8, u16, &createTransformation<quint8, quint16, 4, false>);
+        add(rgb, u16, u8, &createTransformation<quint16, quint8, 4, false>);
+        add(rgb, u8, f32, &createTransformation<quint8, float, 4, true>);
+        add(rgb, f32, u8, &createTransformation<float, quint8, 4, true>);
+        add(rgb, u16, f32, &createTransformation<quint16, float, 4, true>);
+        add(rgb, f32, u16, &createTransformation<float, quint16, 4, true>);
+
+        add(gray, u8, u16, &createTransformation<quint8, quint16, 2, false>);
+        add(gray, u16, u8, &createTransformation<quint16, quint8, 2, false>);
+        add(gray, u8, f32, &createTransformation<quint8, float, 2, false>);
+        add(gray, f32, u8, &createTransformation<float, quint8, 2, false>);
+        add(gray, u16, f32, &createTransformation<quint16, float, 2, false>);
+        add(gray, f32, u16, &createTransformation<float, quint16, 2, false>);
+    }
+
+    void add(const QString &modelId, const QString &srcDepthId, const QString &dstDepthId, CreateFunction func) {
+        functions.insert(conversionKey(modelId, srcDepthId, dstDepthId), func);
+    }
+
+    QHash<QString, CreateFunction> functions;
+};
+
+Q_GLOBAL_STATIC(DirectConversionsRegistry, s_registry)
+
+}
+
+KoColorConversionTransformation* IccDirectColorConversions::create(const KoColorSpace *srcColorSpace,
+                                                                   const KoColorSpace *dstColorSpace,
+                                                                   KoColorConversionTransformation::Intent renderingIntent,
+                                                                   KoColorConversionTransformation::ConversionFlags conversionFlags)
+{
+    if (srcColorSpace->colorModelId() != dstColorSpace->colorModelId()) return 0;
+
+    const KoColorProfile *srcProfile = srcColorSpace->profile();
+    const KoColorProfile *dstProfile = dstColorSpace->profile();
+
+    /**
+     * The values of the channels are rescaled only, so the conversion
+     * is exact when both the color spaces share the same profile. The
+     * rendering intent doesn't matter in this case.
+     */
+    if (!srcProfile || !dstProfile ||
+        (!(*srcProfile == *dstProfile) &&
+         srcProfile->uniqueId() != dstProfile->uniqueId())) {
+
+        return 0;
+    }
+
+    CreateFunction func =
+        s_registry->functions.value(conversionKey(srcColorSpace->colorModelId().id(),
+                                                  srcColorSpace->colorDepthId().id(),
+                                                  dstColorSpace->colorDepthId().id()));
+
+    return func ? func(srcColorSpace, dstColorSpace, renderingIntent, conversionFlags) : 0;
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2019 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _ICC_DIRECT_COLOR_CONVERSIONS_H_
+#define _ICC_DIRECT_COLOR_CONVERSIONS_H_
+
+#include <KoColorConversionTransformation.h>
+
+/**
+ * A registry of the conversions that can be done without LittleCMS.
+ *
+ * When two color spaces share the color model and the profile and
+ * differ only in the channel depth, the conversion is a per-channel
+ * rescaling of the values (and a swap of red and blue channels, since
+ * the integer RGB color spaces are stored as BGRA). Doing it directly
+ * is both much faster and more precise than passing the pixels through
+ * the PCS of LittleCMS.
+ */
+class IccDirectColorConversions
+{
+public:
+    /**
+     * \return a direct transformation from \p srcColorSpace into
+     *         \p dstColorSpace or null if there is no exact direct
+     *         kernel for this pair
+     */
+    static KoColorConversionTransformation* create(const KoColorSpace *srcColorSpace,
+                                                   const KoColorSpace *dstColorSpace,
+                                                   KoColorConversionTransformation::Intent renderingIntent,
+                                                   KoColorConversionTransformation::ConversionFlags conversionFlags);
+};
+
+#endif /* _ICC_DIRECT_COLOR_CONVERSIONS_H_ */
@@ -5,6 +5,7 @@
 #include <LcmsColorProfileContainer.h>
 
 #include <KoColor.h>
+#include <KoColorModelStandardIds.h>
 
 #include <QTest>
 
@@ -211,4 +212,49 @@ void TestKoLcmsColorProfile::testProofingConversion()
     Q_ASSERT((dst[0] == alarm[0]) && (dst[1] == alarm[1]) && (dst[2] == alarm[2]));
 
 }
+void TestKoLcmsColorProfile::testDirectDepthConversion()
+{
+    const KoColorSpace *rgb8 = KoColorSpaceRegistry::instance()->rgb8();
+    const KoColorSpace *rgb16 = KoColorSpaceRegistry::instance()->rgb16(rgb8->profile());
+    const KoColorSpace *rgbF32 =
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(),
+                                                     Float32BitsColorDepthID.id(),
+                                                     rgb8->profile());
+    QVERIFY(rgb16);
+    QVERIFY(rgbF32);
+
+    // BGRA
+    quint8 src[4] = {10, 128, 250, 77};
+
+    quint16 dst16[4];
+    rgb8->convertPixelsTo(src, reinterpret_cast<quint8*>(dst16), rgb16, 1,
+                          KoColorConversionTransformation::internalRenderingIntent(),
+                          KoColorConversionTransformation::internalConversionFlags());
+
+    for (int i = 0; i < 4; i++) {
+        QCOMPARE(dst16[i], quint16(src[i] * 257));
+    }
+
+    // RGBA
+    float dstF32[4];
+    rgb8->convertPixelsTo(src, reinterpret_cast<quint8*>(dstF32), rgbF32, 1,
+                          KoColorConversionTransformation::internalRenderingIntent(),
+                          KoColorConversionTransformation::internalConversionFlags());
+
+    QVERIFY(qAbs(dstF32[0] - src[2] / 255.0f) < 1e-6);
+    QVERIFY(qAbs(dstF32[1] - src[1] / 255.0f) < 1e-6);
+    QVERIFY(qAbs(dstF32[2] - src[0] / 255.0f) < 1e-6);
+    QVERIFY(qAbs(dstF32[3] - src[3] / 255.0f) < 1e-6);
+
+    // and back
+    quint8 dst8[4];
+    rgbF32->convertPixelsTo(reinterpret_cast<quint8*>(dstF32), dst8, rgb8, 1,
+                            KoColorConversionTransformation::internalRenderingIntent(),
+                            KoColorConversionTransformation::internalConversionFlags());
+
+    for (int i = 0; i < 4; i++) {
+        QCOMPARE(dst8[i], src[i]);
+    }
+}
+
 QTEST_MAIN(TestKoLcmsColorProfile)
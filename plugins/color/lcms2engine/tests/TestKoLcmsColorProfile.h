@@ -12,6 +12,7 @@ class TestKoLcmsColorProfile : public QObject
 private Q_SLOTS:
     void testConversion();
     void testProofingConversion();
+    void testDirectDepthConversion();
 
 };
 
@@ -101,23 +101,37 @@ void AnimaterionRenderer::slotRenderAnimation()
                 .arg(extension);
 
 
-        const bool batchMode = false; // TODO: fetch correctly!
-        KisAsyncAnimationFramesSaveDialog exporter(doc->image(),
-                                                   KisTimeRange::fromTime(sequenceConfig->getInt("first_frame"), sequenceConfig->getInt("last_frame")),
-                                                   baseFileName,
-                                                   sequenceConfig->getInt("sequence_start"),
-                                                   dlgAnimationRenderer.getFrameExportConfiguration());
-        exporter.setBatchMode(batchMode);
-
-
-        KisAsyncAnimationFramesSaveDialog::Result result =
-            exporter.regenerateRange(viewManager()->mainWindow()->viewManager());
+        KisPropertiesConfigurationSP videoConfig = dlgAnimationRenderer.getVideoConfiguration();
+
+        /**
+         * If the user doesn't need the image sequence, the frames are
+         * streamed directly into the encoder, without saving them into
+         * files first. GIF encoding needs two passes over the frames,
+         * so it still goes through the files.
+         */
+        const bool streamFrames =
+            videoConfig &&
+            videoConfig->getBool("delete_sequence", false) &&
+            QFileInfo(videoConfig->getString("filename")).suffix().toLower() != "gif";
+
+        KisAsyncAnimationFramesSaveDialog::Result result = KisAsyncAnimationFramesSaveDialog::RenderComplete;
+        QString savedFilesMask;
+
+        if (!streamFrames) {
+            const bool batchMode = false; // TODO: fetch correctly!
+            KisAsyncAnimationFramesSaveDialog exporter(doc->image(),
+                                                       KisTimeRange::fromTime(sequenceConfig->getInt("first_frame"), sequenceConfig->getInt("last_frame")),
+                                                       baseFileName,
+                                                       sequenceConfig->getInt("sequence_start"),
+                                                       dlgAnimationRenderer.getFrameExportConfiguration());
+            exporter.setBatchMode(batchMode);
+
+            result = exporter.regenerateRange(viewManager()->mainWindow()->viewManager());
+            savedFilesMask = exporter.savedFilesMask();
+        }
 
         // the folder could have been read-only or something else could happen
         if (result == KisAsyncAnimationFramesSaveDialog::RenderComplete) {
-            QString savedFilesMask = exporter.savedFilesMask();
-
-            KisPropertiesConfigurationSP videoConfig = dlgAnimationRenderer.getVideoConfiguration();
             if (videoConfig) {
                 kisConfig.setExportConfiguration("ANIMATION_RENDERER", videoConfig);
 
@@ -125,6 +139,7 @@ void AnimaterionRenderer::slotRenderAnimation()
                 if (encoderConfig) {
                     kisConfig.setExportConfiguration("FFMPEG_CONFIG", encoderConfig);
                     encoderConfig->setProperty("savedFilesMask", savedFilesMask);
+                    encoderConfig->setProperty("stream_frames", streamFrames);
                 }
 
                 const QString fileName = videoConfig->getString("filename");
@@ -158,7 +173,7 @@ void AnimaterionRenderer::slotRenderAnimation()
                 if (res != KisImportExportFilter::OK) {
                     QMessageBox::critical(0, i18nc("@title:window", "Krita"), i18n("Could not render animation:\n%1", doc->errorMessage()));
                 }
-                if (videoConfig->getBool("delete_sequence", false)) {
+                if (!streamFrames && videoConfig->getBool("delete_sequence", false)) {
                     QDir d(sequenceConfig->getString("directory"));
                     QStringList sequenceFiles = d.entryList(QStringList() << sequenceConfig->getString("basename") + "*." + extension, QDir::Files);
                     Q_FOREACH(const QString &f, sequenceFiles) {
@@ -89,9 +89,18 @@ void KisGaussianBlurFilter::processImpl(KisPaintDeviceSP device,
         channelFlags = QBitArray(device->colorSpace()->channelCount(), true);
     }
 
+    /**
+     * The blur method is not exposed in the GUI, the automatic
+     * selection can be overridden by the scripts or for testing
+     */
+    const KisGaussianKernel::BlurMethod method =
+        KisGaussianKernel::BlurMethod(
+            config->getInt("blurMethod", KisGaussianKernel::AutoBlur));
+
     KisGaussianKernel::applyGaussian(device, rect,
                                      horizontalRadius, verticalRadius,
-                                     channelFlags, progressUpdater);
+                                     channelFlags, progressUpdater,
+                                     false, method);
 }
 
 QRect KisGaussianBlurFilter::neededRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const
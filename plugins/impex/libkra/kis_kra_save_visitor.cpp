@@ -55,6 +55,7 @@
 #include <metadata/kis_meta_data_io_backend.h>
 
 #include "kis_config.h"
+#include "kis_image_config.h"
 #include "kis_store_paintdevice_writer.h"
 #include "flake/kis_shape_selection.h"
 
@@ -75,7 +76,7 @@ KisKraSaveVisitor::KisKraSaveVisitor(KoStore *store, const QString & name, QMap<
     , m_external(false)
     , m_name(name)
     , m_nodeFileNames(nodeFileNames)
-    , m_writer(new KisStorePaintDeviceWriter(store))
+    , m_writer(new KisStorePaintDeviceWriter(store, KisImageConfig(true).tileCompression()))
 {
 }
 
@@ -45,6 +45,7 @@
 #include <QTime>
 
 #include "KisPart.h"
+#include "dialogs/KisAsyncAnimationFramesStreamDialog.h"
 
 class KisFFMpegProgressWatcher : public QObject {
     Q_OBJECT
@@ -107,27 +108,56 @@ public:
                                      const QString &logPath,
                                      int totalFrames)
     {
-        dbgFile << "runFFMpeg: specialArgs" << specialArgs
-                << "actionName" << actionName
-                << "logPath" << logPath
-                << "totalFrames" << totalFrames;
+        startFFMpeg(specialArgs, logPath);
+        return waitForFFMpeg(actionName, totalFrames);
+    }
+
+    /**
+     * Starts ffmpeg without waiting for it to finish, so that the caller
+     * could feed the frames into its standard input (inputDevice()).
+     * Call waitForFFMpeg() when all the data has been written.
+     */
+    bool startFFMpeg(const QStringList &specialArgs,
+                     const QString &logPath)
+    {
+        dbgFile << "startFFMpeg: specialArgs" << specialArgs
+                << "logPath" << logPath;
 
-        QTemporaryFile progressFile(QDir::tempPath() + QDir::separator() + "KritaFFmpegProgress.XXXXXX");
-        progressFile.open();
+        m_progressFile.reset(new QTemporaryFile(QDir::tempPath() + QDir::separator() + "KritaFFmpegProgress.XXXXXX"));
+        m_progressFile->open();
 
         m_process.setStandardOutputFile(logPath);
         m_process.setProcessChannelMode(QProcess::MergedChannels);
         QStringList args;
         args << "-v" << "debug"
              << "-nostdin"
-             << "-progress" << progressFile.fileName()
+             << "-progress" << m_progressFile->fileName()
              << specialArgs;
 
         qDebug() << "\t" << m_ffmpegPath << args.join(" ");
 
         m_cancelled = false;
         m_process.start(m_ffmpegPath, args);
-        return waitForFFMpegProcess(actionName, progressFile, m_process, totalFrames);
+        return m_process.waitForStarted();
+    }
+
+    QIODevice* inputDevice() {
+        return &m_process;
+    }
+
+    KisImageBuilder_Result waitForFFMpeg(const QString &actionName,
+                                         int totalFrames)
+    {
+        KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(m_progressFile, KisImageBuilder_RESULT_FAILURE);
+
+        // let ffmpeg know there will be no more frames
+        m_process.closeWriteChannel();
+
+        KisImageBuilder_Result result =
+            waitForFFMpegProcess(actionName, *m_progressFile, m_process, totalFrames);
+
+        m_progressFile.reset();
+        return result;
     }
 
     void cancel() {
@@ -135,6 +165,16 @@ public:
         m_process.kill();
     }
 
+    /**
+     * Kills ffmpeg started with startFFMpeg() when the frames
+     * for it could not be generated
+     */
+    void abortFFMpeg() {
+        cancel();
+        m_process.waitForFinished();
+        m_progressFile.reset();
+    }
+
 private:
     KisImageBuilder_Result waitForFFMpegProcess(const QString &message,
                                                 QFile &progressFile,
@@ -181,6 +221,7 @@ private:
 
 private:
     QProcess m_process;
+    QScopedPointer<QTemporaryFile> m_progressFile;
     bool m_cancelled;
     QString m_ffmpegPath;
 };
@@ -240,6 +281,10 @@ KisImageBuilder_Result VideoSaver::encode(const QString &filename, KisProperties
                                  sequenceNumberingOffset + configuration->getInt("last_frame", fullRange.end())
     );
 
+    const KisTimeRange renderRange =
+        KisTimeRange::fromTime(configuration->getInt("first_frame", fullRange.start()),
+                               configuration->getInt("last_frame", fullRange.end()));
+
     const bool includeAudio = configuration->getBool("include_audio", true);
 
     const int exportHeight = configuration->getInt("height", int(m_image->height()));
@@ -268,6 +313,13 @@ KisImageBuilder_Result VideoSaver::encode(const QString &filename, KisProperties
 
     const QStringList additionalOptionsList = configuration->getString("customUserOptions").split(' ', QString::SkipEmptyParts);
 
+    /**
+     * In streaming mode nobody has rendered the frames for us, so we
+     * render them ourselves and pipe them into ffmpeg directly. GIF
+     * needs two passes over the frames, so it works with files only.
+     */
+    const bool streamFrames = configuration->getBool("stream_frames", false) && suffix != "gif";
+
     if (suffix == "gif") {
         {
             QStringList args;
@@ -316,10 +368,22 @@ KisImageBuilder_Result VideoSaver::encode(const QString &filename, KisProperties
         }
     } else {
         QStringList args;
-        args << "-r" << QString::number(frameRate)
-             << "-start_number" << QString::number(clipRange.start())
-             << "-i" << savedFilesMask;
 
+        if (streamFrames) {
+            // KisAsyncAnimationFramesStreamDialog writes QImage::Format_ARGB32 frames
+            const QString pixelFormat =
+                QSysInfo::ByteOrder == QSysInfo::LittleEndian ? "bgra" : "argb";
+
+            args << "-f" << "rawvideo"
+                 << "-pix_fmt" << pixelFormat
+                 << "-s" << QString("%1x%2").arg(m_image->width()).arg(m_image->height())
+                 << "-r" << QString::number(frameRate)
+                 << "-i" << "-";
+        } else {
+            args << "-r" << QString::number(frameRate)
+                 << "-start_number" << QString::number(clipRange.start())
+                 << "-i" << savedFilesMask;
+        }
 
 
         QFileInfo audioFileInfo = animation->audioChannelFileName();
@@ -349,14 +413,42 @@ KisImageBuilder_Result VideoSaver::encode(const QString &filename, KisProperties
              << "-y" << resultFile;
 
 
-        result = m_runner->runFFMpeg(args, i18n("Encoding frames..."),
-                                     framesDir.filePath("log_encode.log"),
-                                     clipRange.duration());
+        if (streamFrames) {
+            result = streamFramesToFFMpeg(args, framesDir.filePath("log_encode.log"),
+                                          renderRange);
+        } else {
+            result = m_runner->runFFMpeg(args, i18n("Encoding frames..."),
+                                         framesDir.filePath("log_encode.log"),
+                                         clipRange.duration());
+        }
     }
 
     return result;
 }
 
+KisImageBuilder_Result VideoSaver::streamFramesToFFMpeg(const QStringList &args,
+                                                        const QString &logPath,
+                                                        const KisTimeRange &range)
+{
+    if (!m_runner->startFFMpeg(args, logPath)) {
+        return KisImageBuilder_RESULT_FAILURE;
+    }
+
+    KisAsyncAnimationFramesStreamDialog renderer(m_image, range, m_runner->inputDevice());
+    renderer.setBatchMode(m_batchMode);
+
+    const KisAsyncAnimationRenderDialogBase::Result renderResult = renderer.regenerateRange(0);
+
+    if (renderResult != KisAsyncAnimationRenderDialogBase::RenderComplete) {
+        m_runner->abortFFMpeg();
+
+        return renderResult == KisAsyncAnimationRenderDialogBase::RenderCancelled ?
+            KisImageBuilder_RESULT_CANCEL : KisImageBuilder_RESULT_FAILURE;
+    }
+
+    return m_runner->waitForFFMpeg(i18n("Encoding frames..."), range.duration());
+}
+
 void VideoSaver::cancel()
 {
     m_runner->cancel();
@@ -29,6 +29,7 @@
 #include "kritavideoexport_export.h"
 
 class KisFFMpegRunner;
+class KisTimeRange;
 
 /* The KisImageBuilder_Result definitions come from kis_png_converter.h here */
 
@@ -49,6 +50,11 @@ public:
 private Q_SLOTS:
     void cancel();
 
+private:
+    KisImageBuilder_Result streamFramesToFFMpeg(const QStringList &args,
+                                                const QString &logPath,
+                                                const KisTimeRange &range);
+
 private:
     KisImageSP m_image;
     KisDocument* m_doc;
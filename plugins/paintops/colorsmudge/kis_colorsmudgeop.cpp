@@ -21,6 +21,7 @@
 #include <cmath>
 #include <memory>
 #include <QRect>
+#include <QtConcurrentMap>
 
 #include <KoColorSpaceRegistry.h>
 #include <KoColor.h>
@@ -32,6 +33,7 @@
 #include <kis_paint_device.h>
 #include <kis_painter.h>
 #include <kis_image.h>
+#include <kis_image_config.h>
 #include <kis_selection.h>
 #include <kis_brush_based_paintop_settings.h>
 #include <kis_cross_device_color_picker.h>
@@ -41,10 +43,46 @@
 #include <KoColorModelStandardIds.h>
 
 
+namespace {
+
+/**
+ * Splits a big dab into horizontal stripes that can be processed
+ * in parallel. Small dabs are not worth the threading overhead.
+ */
+QVector<QRect> splitDabIntoStripes(const QRect &rc, bool useOverlayMode, int idealNumStripes)
+{
+    const int minStripeHeight = 64;
+    const int minParallelArea = 256 * 256;
+
+    /**
+     * The overlay mode reads the image projection, which cannot
+     * be done in parallel
+     */
+    const int numStripes =
+        useOverlayMode || rc.width() * rc.height() < minParallelArea ? 1 :
+        qMin(idealNumStripes, rc.height() / minStripeHeight);
+
+    if (numStripes <= 1) {
+        return {rc};
+    }
+
+    QVector<QRect> stripes;
+    const int stripeHeight = (rc.height() + numStripes - 1) / numStripes;
+
+    for (int y = rc.top(); y <= rc.bottom(); y += stripeHeight) {
+        stripes << QRect(rc.left(), y, rc.width(), qMin(stripeHeight, rc.bottom() + 1 - y));
+    }
+
+    return stripes;
+}
+
+}
+
 KisColorSmudgeOp::KisColorSmudgeOp(const KisPaintOpSettingsSP settings, KisPainter* painter, KisNodeSP node, KisImageSP image)
     : KisBrushBasedPaintOp(settings, painter)
     , m_firstRun(true)
     , m_image(image)
+    , m_idealNumStripes(KisImageConfig(true).maxNumberOfThreads())
     , m_preciseWrapper(painter->device())
     , m_tempDev(m_preciseWrapper.createPreciseCompositionSourceDevice())
     , m_backgroundPainter(new KisPainter(m_tempDev))
@@ -222,26 +260,20 @@ KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
 
     const qreal fpOpacity  = (qreal(painter()->opacity()) / 255.0) * m_opacityOption.getOpacityf(info);
 
-    if (m_image && m_overlayModeOption.isChecked()) {
+    const bool useDullingMode = m_smudgeRateOption.getMode() == KisSmudgeOption::DULLING_MODE;
+    const bool useOverlayMode = m_image && m_overlayModeOption.isChecked();
+    const bool useColorRate = m_colorRateOption.isChecked();
+
+    if (useOverlayMode) {
         m_image->blockUpdates();
         m_backgroundPainter->bitBlt(QPoint(), m_image->projection(), srcDabRect);
         m_image->unblockUpdates();
     }
-    else {
-        // IMPORTANT: clear the temporary painting device to color black with zero opacity:
-        //            it will only clear the extents of the brush.
-        m_tempDev->clear(QRect(QPoint(), m_dstDabRect.size()));
-    }
-
-    const bool useDullingMode = m_smudgeRateOption.getMode() == KisSmudgeOption::DULLING_MODE;
 
     // stored in the color space of the paintColor
     KoColor dullingFillColor = m_paintColor;
 
-    if (!useDullingMode) {
-        m_preciseWrapper.readRect(srcDabRect);
-        m_smudgePainter->bitBlt(QPoint(), m_preciseWrapper.preciseDevice(), srcDabRect);
-    } else {
+    if (useDullingMode) {
         QPoint pt = (srcDabRect.topLeft() + hotSpot).toPoint();
 
         if (m_smudgeRadiusOption.isChecked()) {
@@ -264,59 +296,108 @@ KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
         }
     }
 
+    // the current color (foreground color) or a gradient color (if enabled)
+    // that is mixed into the temporary painting device (m_tempDev)
+    KoColor rateColor = m_paintColor;
+
     // if the user selected the color smudge option,
     // we will mix some color into the temporary painting device (m_tempDev)
-    if (m_colorRateOption.isChecked()) {
+    if (useColorRate) {
         // this will apply the opacity (selected by the user) to copyPainter
         // (but fit the rate inbetween the range 0.0 to (1.0-SmudgeRate))
         qreal maxColorRate = qMax<qreal>(1.0 - m_smudgeRateOption.getRate(), 0.2);
         m_colorRateOption.apply(*m_colorRatePainter, info, 0.0, maxColorRate, fpOpacity);
 
-        // paint a rectangle with the current color (foreground color)
-        // or a gradient color (if enabled)
-        // into the temporary painting device and use the user selected
-        // composite mode
-        KoColor color = m_paintColor;
-        m_gradientOption.apply(color, m_gradient, info);
+        m_gradientOption.apply(rateColor, m_gradient, info);
         if (m_hsvTransform) {
             Q_FOREACH (KisPressureHSVOption * option, m_hsvOptions) {
                 option->apply(m_hsvTransform, info);
             }
-            m_hsvTransform->transform(color.data(), color.data(), 1);
+            m_hsvTransform->transform(rateColor.data(), rateColor.data(), 1);
         }
 
         if (!useDullingMode) {
-            KIS_SAFE_ASSERT_RECOVER(*m_colorRatePainter->device()->colorSpace() == *color.colorSpace()) {
-                color.convertTo(m_colorRatePainter->device()->colorSpace());
+            KIS_SAFE_ASSERT_RECOVER(*m_colorRatePainter->device()->colorSpace() == *rateColor.colorSpace()) {
+                rateColor.convertTo(m_colorRatePainter->device()->colorSpace());
             }
-
-            m_colorRatePainter->fill(0, 0, m_dstDabRect.width(), m_dstDabRect.height(), color);
         } else {
-            KIS_SAFE_ASSERT_RECOVER(*dullingFillColor.colorSpace() == *color.colorSpace()) {
-                color.convertTo(dullingFillColor.colorSpace());
+            KIS_SAFE_ASSERT_RECOVER(*dullingFillColor.colorSpace() == *rateColor.colorSpace()) {
+                rateColor.convertTo(dullingFillColor.colorSpace());
             }
             KIS_SAFE_ASSERT_RECOVER_NOOP(*dullingFillColor.colorSpace() == *m_tempDev->colorSpace());
 
             m_preciseColorRateCompositeOp->composite(dullingFillColor.data(), 0,
-                                                     color.data(), 0,
+                                                     rateColor.data(), 0,
                                                      0, 0,
                                                      1, 1,
                                                      m_colorRatePainter->opacity());
         }
     }
 
-    if (useDullingMode) {
-        KIS_SAFE_ASSERT_RECOVER_NOOP(*dullingFillColor.colorSpace() == *m_tempDev->colorSpace());
-        m_tempDev->fill(QRect(0, 0, m_dstDabRect.width(), m_dstDabRect.height()), dullingFillColor);
+    /**
+     * Everything the dab depends on is read from the canvas before
+     * anything is written into it. It lets us process the parts of
+     * the dab in parallel, even though the source and destination
+     * areas overlap.
+     */
+    QVector<QRect> readRects = m_finalPainter->calculateAllMirroredRects(m_dstDabRect);
+    if (!useDullingMode) {
+        readRects << srcDabRect;
     }
+    m_preciseWrapper.readRects(readRects);
 
-    m_preciseWrapper.readRects(m_finalPainter->calculateAllMirroredRects(m_dstDabRect));
+    auto prepareStripe = [&] (const QRect &rc, KisPainter *smudgePainter, KisPainter *colorRatePainter) {
+        if (useDullingMode) {
+            KIS_SAFE_ASSERT_RECOVER_NOOP(*dullingFillColor.colorSpace() == *m_tempDev->colorSpace());
+            m_tempDev->fill(rc, dullingFillColor);
+            return;
+        }
+
+        if (!useOverlayMode) {
+            // IMPORTANT: clear the temporary painting device to color black with zero opacity:
+            //            it will only clear the extents of the brush.
+            m_tempDev->clear(rc);
+        }
+
+        smudgePainter->bitBlt(rc.topLeft(), m_preciseWrapper.preciseDevice(),
+                              rc.translated(srcDabRect.topLeft()));
+
+        if (useColorRate) {
+            colorRatePainter->fill(rc.x(), rc.y(), rc.width(), rc.height(), rateColor);
+        }
+    };
+
+    auto paintStripe = [&] (const QRect &rc, KisPainter *finalPainter) {
+        // then blit the temporary painting device on the canvas at the current brush position
+        // the alpha mask (maskDab) will be used here to only blit the pixels that are in the area (shape) of the brush
+        finalPainter->bitBltWithFixedSelection(m_dstDabRect.x() + rc.x(), m_dstDabRect.y() + rc.y(),
+                                               m_tempDev, m_maskDab,
+                                               rc.x(), rc.y(),
+                                               rc.x(), rc.y(),
+                                               rc.width(), rc.height());
+    };
+
+    const QRect dabRect(QPoint(), m_dstDabRect.size());
+    QVector<QRect> stripes = splitDabIntoStripes(dabRect, useOverlayMode, m_idealNumStripes);
+
+    if (stripes.size() == 1) {
+        prepareStripe(dabRect, m_smudgePainter.data(), m_colorRatePainter.data());
+    } else {
+        QtConcurrent::blockingMap(stripes, [&] (const QRect &rc) {
+            KisPainter smudgePainter(m_tempDev);
+            KisPainter colorRatePainter(m_tempDev);
+            colorRatePainter.setCompositeOp(m_colorRatePainter->compositeOp());
+            colorRatePainter.setOpacity(m_colorRatePainter->opacity());
+
+            prepareStripe(rc, &smudgePainter, &colorRatePainter);
+        });
+    }
 
     // if color is disabled (only smudge) and "overlay mode" is enabled
     // then first blit the region under the brush from the image projection
     // to the painting device to prevent a rapid build up of alpha value
     // if the color to be smudged is semi transparent.
-    if (m_image && m_overlayModeOption.isChecked() && !m_colorRateOption.isChecked()) {
+    if (useOverlayMode && !useColorRate) {
         m_finalPainter->setOpacity(OPACITY_OPAQUE_U8);
         m_image->blockUpdates();
         // TODO: check if this code is correct in mirrored mode! Technically, the
@@ -330,10 +411,22 @@ KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
     // set opacity calculated by the rate option
     m_smudgeRateOption.apply(*m_finalPainter, info, 0.0, 1.0, fpOpacity);
 
-    // then blit the temporary painting device on the canvas at the current brush position
-    // the alpha mask (maskDab) will be used here to only blit the pixels that are in the area (shape) of the brush
+    if (stripes.size() == 1) {
+        paintStripe(dabRect, m_finalPainter.data());
+    } else {
+        QtConcurrent::blockingMap(stripes, [&] (const QRect &rc) {
+            KisPainter finalPainter(m_finalPainter->device());
+            finalPainter.setCompositeOp(m_finalPainter->compositeOp());
+            finalPainter.setOpacity(m_finalPainter->opacity());
+            finalPainter.setSelection(m_finalPainter->selection());
+            finalPainter.setChannelFlags(m_finalPainter->channelFlags());
+
+            paintStripe(rc, &finalPainter);
+        });
+
+        m_finalPainter->addDirtyRect(m_dstDabRect);
+    }
 
-    m_finalPainter->bitBltWithFixedSelection(m_dstDabRect.x(), m_dstDabRect.y(), m_tempDev, m_maskDab, m_dstDabRect.width(), m_dstDabRect.height());
     m_finalPainter->renderMirrorMaskSafe(m_dstDabRect, m_tempDev, 0, 0, m_maskDab, !m_dabCache->needSeparateOriginal());
 
     const QVector<QRect> dirtyRects = m_finalPainter->takeDirtyRegion();
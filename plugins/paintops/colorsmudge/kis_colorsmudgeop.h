@@ -64,6 +64,7 @@ private:
 private:
     bool                      m_firstRun;
     KisImageWSP               m_image;
+    int                       m_idealNumStripes;
     KisPrecisePaintDeviceWrapper m_preciseWrapper;
     KoColor                   m_paintColor;
     KisPaintDeviceSP          m_tempDev;
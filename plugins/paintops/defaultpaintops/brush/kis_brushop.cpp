@@ -44,6 +44,7 @@
 #include "kis_algebra_2d.h"
 #include <KisDabRenderingExecutor.h>
 #include <KisDabCacheUtils.h>
+#include <KisDabMaskCache.h>
 #include <KisRenderedDab.h>
 #include "KisBrushOpResources.h"
 
@@ -54,6 +55,7 @@
 #include <QThread>
 #include "kis_image_config.h"
 #include "kis_wrapped_rect.h"
+#include <kis_auto_brush.h>
 
 
 KisBrushOp::KisBrushOp(const KisPaintOpSettingsSP settings, KisPainter *painter, KisNodeSP node, KisImageSP image)
@@ -101,12 +103,26 @@ KisBrushOp::KisBrushOp(const KisPaintOpSettingsSP settings, KisPainter *painter,
 
     m_rotationOption.applyFanCornersInfo(this);
 
+    /**
+     * Masks of the auto brushes depend on the dab parameters only, so
+     * all the workers can share them. Randomness and density make every
+     * mask unique, so the cache would be useless there.
+     */
+    QSharedPointer<KisDabMaskCache> maskCache;
+    KisAutoBrush *autoBrush = dynamic_cast<KisAutoBrush*>(m_brush.data());
+    if (autoBrush && qFuzzyIsNull(autoBrush->randomness()) &&
+        qFuzzyCompare(autoBrush->density(), 1.0)) {
+
+        maskCache.reset(new KisDabMaskCache());
+    }
+
     KisBrushSP baseBrush = m_brush;
     auto resourcesFactory =
-        [baseBrush, settings, painter] () {
+        [baseBrush, settings, painter, maskCache] () {
             KisDabCacheUtils::DabRenderingResources *resources =
                 new KisBrushOpResources(settings, painter);
             resources->brush = baseBrush->clone();
+            resources->maskCache = maskCache;
 
             return resources;
         };
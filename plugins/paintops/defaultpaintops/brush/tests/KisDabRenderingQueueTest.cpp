@@ -22,9 +22,14 @@
 #include <KoColorSpace.h>
 #include <KoColorSpaceRegistry.h>
 
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSet>
+
 #include <../KisDabRenderingQueue.h>
 #include <../KisRenderedDab.h>
 #include <../KisDabRenderingJob.h>
+#include <KisDabMaskCache.h>
 
 struct SurrogateCacheInterface : public KisDabRenderingQueue::CacheInterface
 {
@@ -538,4 +543,310 @@ void KisDabRenderingQueueTest::testExecutor()
 
 }
 
+KisBrushSP createMaskCacheTestBrush()
+{
+    KisCircleMaskGenerator* circle = new KisCircleMaskGenerator(10, 1.0, 0.5, 0.5, 2, false);
+    return new KisAutoBrush(circle, 0.0, 0.0);
+}
+
+KisFixedPaintDeviceSP createReferenceDab(KisBrushSP brush, const KisDabCacheUtils::DabGenerationInfo &di)
+{
+    KisFixedPaintDeviceSP dab = new KisFixedPaintDevice(di.paintColor.colorSpace());
+    brush->mask(dab, di.paintColor, di.shape, di.info,
+                di.subPixel.x(), di.subPixel.y(), di.softnessFactor);
+    return dab;
+}
+
+/**
+ * Returns the maximum difference in the opacity of the pixels of
+ * the two dabs, or -1 if the dabs have different sizes
+ */
+int maxOpacityDifference(KisFixedPaintDeviceSP dab1, KisFixedPaintDeviceSP dab2, int *totalDifference = 0)
+{
+    if (dab1->bounds() != dab2->bounds()) return -1;
+
+    const KoColorSpace *cs = dab1->colorSpace();
+    const int numPixels = dab1->bounds().width() * dab1->bounds().height();
+
+    int maxDifference = 0;
+    int sum = 0;
+
+    for (int i = 0; i < numPixels; i++) {
+        const int difference =
+            qAbs(int(cs->opacityU8(dab1->data() + i * cs->pixelSize())) -
+                 int(cs->opacityU8(dab2->data() + i * cs->pixelSize())));
+
+        maxDifference = qMax(maxDifference, difference);
+        sum += difference;
+    }
+
+    if (totalDifference) {
+        *totalDifference = sum;
+    }
+
+    return maxDifference;
+}
+
+/**
+ * The cache applies the mask to the color separately, so the dabs may
+ * differ from the ones painted by the brush directly in rounding
+ */
+bool dabsAreEqual(KisFixedPaintDeviceSP dab1, KisFixedPaintDeviceSP dab2)
+{
+    const int difference = maxOpacityDifference(dab1, dab2);
+    return difference >= 0 && difference <= 1;
+}
+
+void KisDabRenderingQueueTest::testMaskCache()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    KisBrushSP brush = createMaskCacheTestBrush();
+
+    KisDabMaskCache cache;
+
+    KisDabCacheUtils::DabGenerationInfo di;
+    di.paintColor = KoColor(Qt::red, cs);
+    di.shape = KisDabShape(1.0, 1.0, 0.0);
+    di.info = KisPaintInformation(QPointF(10, 10));
+    di.subPixel = QPointF(0.25, 0.75);
+    di.softnessFactor = 1.0;
+    di.solidColorFill = true;
+    di.useMaskCache = true;
+    di.maskCacheSubPixelStep = 0.5;
+
+    KisFixedPaintDeviceSP dab1 = new KisFixedPaintDevice(cs);
+    cache.generateDab(di, brush, dab1);
+
+    QCOMPARE(cache.statistics().misses, 1);
+    QCOMPARE(cache.statistics().hits, 0);
+
+    KisFixedPaintDeviceSP dab2 = new KisFixedPaintDevice(cs);
+    cache.generateDab(di, brush, dab2);
+
+    QCOMPARE(cache.statistics().misses, 1);
+    QCOMPARE(cache.statistics().hits, 1);
+
+    // the cached dab should be the same as the one generated by the brush
+    KisFixedPaintDeviceSP refDab = createReferenceDab(brush, di);
+
+    QVERIFY(dabsAreEqual(dab1, refDab));
+    QVERIFY(dabsAreEqual(dab2, refDab));
+
+    // the neighbouring subpixel bucket is resampled from the cached mask
+    di.subPixel = QPointF(0.75, 0.75);
+    KisFixedPaintDeviceSP dab3 = new KisFixedPaintDevice(cs);
+    cache.generateDab(di, brush, dab3);
+
+    KisDabMaskCache::Statistics stats = cache.statistics();
+    QCOMPARE(stats.hits, 1);
+    QCOMPARE(stats.resampled, 1);
+    QCOMPARE(stats.misses, 1);
+
+    /**
+     * The resampled mask is blurred a bit by the bilinear interpolation,
+     * but it should still be much closer to the mask generated for its
+     * own offset than to the one it has been resampled from
+     */
+    KisFixedPaintDeviceSP refDab3 = createReferenceDab(brush, di);
+
+    int differenceFromOwnMask = 0;
+    int differenceFromSourceMask = 0;
+
+    const int maxDifference = maxOpacityDifference(dab3, refDab3, &differenceFromOwnMask);
+    QVERIFY(maxDifference >= 0);
+    QVERIFY(maxDifference <= 40);
+
+    QVERIFY(maxOpacityDifference(dab3, refDab, &differenceFromSourceMask) >= 0);
+    QVERIFY(differenceFromOwnMask < differenceFromSourceMask);
+
+    // the resampled masks are cached as well
+    KisFixedPaintDeviceSP dab4 = new KisFixedPaintDevice(cs);
+    cache.generateDab(di, brush, dab4);
+
+    stats = cache.statistics();
+    QCOMPARE(stats.hits, 2);
+    QCOMPARE(stats.resampled, 1);
+    QCOMPARE(maxOpacityDifference(dab4, dab3), 0);
+
+    cache.clear();
+
+    KisFixedPaintDeviceSP dab5 = new KisFixedPaintDevice(cs);
+    cache.generateDab(di, brush, dab5);
+    QCOMPARE(cache.statistics().misses, stats.misses + 1);
+}
+
+void KisDabRenderingQueueTest::testMaskCacheQuantization()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    KisDabRenderingQueueCache queueCache;
+
+    QScopedPointer<KisDabCacheUtils::DabRenderingResources> resources(testResourcesFactory());
+    resources->maskCache.reset(new KisDabMaskCache());
+
+    KoColor color(Qt::red, cs);
+    QPointF pos(10.3, 10.6);
+    KisPaintInformation pi(pos);
+
+    auto fetchInfo = [&] (const QPointF &cursorPoint, const KisDabShape &shape, qreal softnessFactor) {
+        KisDabCacheUtils::DabRequestInfo request(color, cursorPoint, shape, pi, softnessFactor);
+        KisDabCacheUtils::DabGenerationInfo di;
+        bool shouldUseCache = false;
+        queueCache.getDabType(false, resources.data(), request, &di, &shouldUseCache);
+        return di;
+    };
+
+    /**
+     * With the default precision level the angle is rounded to a degree,
+     * the size to a quarter of a pixel, the softness to 0.01 and the
+     * subpixel offset to the center of a half-pixel bucket
+     */
+    KisDabCacheUtils::DabGenerationInfo di1 =
+        fetchInfo(pos, KisDabShape(1.0, 1.0, 0.3 * M_PI / 180), 1.0);
+    KisDabCacheUtils::DabGenerationInfo di2 =
+        fetchInfo(pos, KisDabShape(1.01, 0.999, 0.1 * M_PI / 180), 1.004);
+
+    QVERIFY(di1.useMaskCache);
+    QCOMPARE(di1.maskCacheSubPixelStep, 0.5);
+
+    QCOMPARE(di1.shape.scale(), di2.shape.scale());
+    QCOMPARE(di1.shape.ratio(), di2.shape.ratio());
+    QCOMPARE(di1.shape.rotation(), di2.shape.rotation());
+    QCOMPARE(di1.softnessFactor, di2.softnessFactor);
+    QCOMPARE(di1.subPixel, di2.subPixel);
+
+    // the dabs from the same bucket share the mask
+    KisFixedPaintDeviceSP dab1 = new KisFixedPaintDevice(cs);
+    resources->maskCache->generateDab(di1, resources->brush, dab1);
+
+    KisFixedPaintDeviceSP dab2 = new KisFixedPaintDevice(cs);
+    resources->maskCache->generateDab(di2, resources->brush, dab2);
+
+    QCOMPARE(resources->maskCache->statistics().misses, 1);
+    QCOMPARE(resources->maskCache->statistics().hits, 1);
+
+    // the subpixel offset always lands in the center of a bucket
+    QSet<qreal> subPixelsX;
+
+    for (int i = 0; i < 10; i++) {
+        const QPointF cursorPoint = pos + QPointF(0.1 * i, 0.0);
+        KisDabCacheUtils::DabGenerationInfo di = fetchInfo(cursorPoint, KisDabShape(), 1.0);
+
+        QVERIFY(qFuzzyCompare(di.subPixel.x(), 0.25) || qFuzzyCompare(di.subPixel.x(), 0.75));
+        QVERIFY(qFuzzyCompare(di.subPixel.y(), 0.25) || qFuzzyCompare(di.subPixel.y(), 0.75));
+
+        subPixelsX.insert(di.subPixel.x());
+    }
+
+    QCOMPARE(subPixelsX.size(), 2);
+
+    // a different angle bucket gets its own mask
+    KisDabCacheUtils::DabGenerationInfo di3 =
+        fetchInfo(pos, KisDabShape(1.0, 1.0, 10 * M_PI / 180), 1.0);
+
+    QVERIFY(di3.shape.rotation() != di1.shape.rotation());
+}
+
+namespace {
+struct MaskCacheJob : public QRunnable
+{
+    MaskCacheJob(KisDabMaskCache *_cache, const QVector<KisDabCacheUtils::DabGenerationInfo> &_infos)
+        : cache(_cache), infos(_infos)
+    {
+        setAutoDelete(false);
+    }
+
+    void run() override {
+        // every worker has its own copy of the brush, like the brush op does
+        KisBrushSP brush = createMaskCacheTestBrush();
+
+        Q_FOREACH (const KisDabCacheUtils::DabGenerationInfo &di, infos) {
+            KisFixedPaintDeviceSP dab = new KisFixedPaintDevice(di.paintColor.colorSpace());
+            cache->generateDab(di, brush, dab);
+            dabs << dab;
+        }
+    }
+
+    KisDabMaskCache *cache;
+    QVector<KisDabCacheUtils::DabGenerationInfo> infos;
+    QVector<KisFixedPaintDeviceSP> dabs;
+};
+}
+
+void KisDabRenderingQueueTest::testMaskCacheThreads()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    QVector<KisDabCacheUtils::DabGenerationInfo> infos;
+
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            KisDabCacheUtils::DabGenerationInfo di;
+            di.paintColor = KoColor(Qt::red, cs);
+            di.shape = KisDabShape(1.0 + 0.25 * i, 1.0, 0.0);
+            di.info = KisPaintInformation(QPointF(10, 10));
+            di.subPixel = QPointF(0.25 + 0.5 * (j & 0x1), 0.25 + 0.5 * (j >> 1));
+            di.softnessFactor = 1.0;
+            di.solidColorFill = true;
+            di.useMaskCache = true;
+
+            // no resampling, so that every dab is exactly the brush mask
+            di.maskCacheSubPixelStep = 0.0;
+
+            infos << di;
+        }
+    }
+
+    const int numRepeats = 10;
+    QVector<KisDabCacheUtils::DabGenerationInfo> jobInfos;
+    for (int i = 0; i < numRepeats; i++) {
+        jobInfos += infos;
+    }
+
+    KisDabMaskCache cache;
+
+    const int numJobs = 4;
+    QVector<MaskCacheJob*> jobs;
+
+    {
+        QThreadPool pool;
+        pool.setMaxThreadCount(numJobs);
+
+        for (int i = 0; i < numJobs; i++) {
+            MaskCacheJob *job = new MaskCacheJob(&cache, jobInfos);
+            jobs << job;
+            pool.start(job);
+        }
+
+        pool.waitForDone();
+    }
+
+    KisBrushSP brush = createMaskCacheTestBrush();
+
+    QVector<KisFixedPaintDeviceSP> refDabs;
+    Q_FOREACH (const KisDabCacheUtils::DabGenerationInfo &di, infos) {
+        refDabs << createReferenceDab(brush, di);
+    }
+
+    Q_FOREACH (MaskCacheJob *job, jobs) {
+        QCOMPARE(job->dabs.size(), jobInfos.size());
+
+        for (int i = 0; i < job->dabs.size(); i++) {
+            QVERIFY(dabsAreEqual(job->dabs[i], refDabs[i % infos.size()]));
+        }
+    }
+    qDeleteAll(jobs);
+
+    /**
+     * Two workers may occasionally generate the same mask at the
+     * same time, so there may be more misses than distinct masks
+     */
+    const KisDabMaskCache::Statistics stats = cache.statistics();
+    QCOMPARE(stats.hits + stats.resampled + stats.misses, numJobs * jobInfos.size());
+    QCOMPARE(stats.resampled, 0);
+    QVERIFY(stats.misses >= infos.size());
+    QVERIFY(stats.misses <= numJobs * infos.size());
+}
+
 QTEST_MAIN(KisDabRenderingQueueTest)
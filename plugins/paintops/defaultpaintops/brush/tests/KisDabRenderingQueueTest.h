@@ -30,6 +30,10 @@ private Q_SLOTS:
     void testRunningJobs();
 
     void testExecutor();
+
+    void testMaskCache();
+    void testMaskCacheQuantization();
+    void testMaskCacheThreads();
 };
 
 #endif // KISDABRENDERINGQUEUETEST_H
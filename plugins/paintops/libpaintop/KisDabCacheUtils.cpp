@@ -22,6 +22,7 @@
 #include "kis_paint_device.h"
 #include "kis_fixed_paint_device.h"
 #include "kis_color_source.h"
+#include "KisDabMaskCache.h"
 
 #include <kis_pressure_sharpness_option.h>
 #include <kis_texture_option.h>
@@ -65,6 +66,8 @@ void generateDab(const DabGenerationInfo &di, DabRenderingResources *resources,
         *dab = resources->brush->paintDevice(cs, di.shape, di.info,
                                             di.subPixel.x(),
                                             di.subPixel.y());
+    } else if (di.solidColorFill && di.useMaskCache && resources->maskCache) {
+        resources->maskCache->generateDab(di, resources->brush, *dab);
     } else if (di.solidColorFill) {
         resources->brush->mask(*dab,
                                di.paintColor,
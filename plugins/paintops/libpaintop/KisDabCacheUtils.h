@@ -21,6 +21,7 @@
 
 #include <QRect>
 #include <QSize>
+#include <QSharedPointer>
 
 #include "kis_types.h"
 
@@ -36,6 +37,7 @@ typedef KisSharedPtr<KisBrush> KisBrushSP;
 class KisColorSource;
 class KisPressureSharpnessOption;
 class KisTextureProperties;
+class KisDabMaskCache;
 
 
 namespace KisDabCacheUtils
@@ -56,6 +58,12 @@ struct PAINTOP_EXPORT DabRenderingResources
 
     KisPaintDeviceSP colorSourceDevice;
 
+    /**
+     * The cache of the dab masks shared by all the resources
+     * of the paintop. Can be null.
+     */
+    QSharedPointer<KisDabMaskCache> maskCache;
+
 private:
     DabRenderingResources(const DabRenderingResources &rhs) = delete;
 };
@@ -99,6 +107,19 @@ struct PAINTOP_EXPORT DabGenerationInfo
     qreal softnessFactor = 1.0;
 
     bool needsPostprocessing = false;
+
+    /**
+     * The parameters of the dab are quantized, so its mask
+     * can be fetched from DabRenderingResources::maskCache
+     */
+    bool useMaskCache = false;
+
+    /**
+     * The step of the subpixel quantization. If nonzero, the mask cache
+     * is allowed to resample the masks of the neighbouring subpixel
+     * offsets.
+     */
+    qreal maskCacheSubPixelStep = 0.0;
 };
 
 PAINTOP_EXPORT QRect correctDabRectWhenFetchedFromCache(const QRect &dabRect,
@@ -0,0 +1,304 @@
+/*
+ *  Copyright (c) 2019 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisDabMaskCache.h"
+
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QByteArray>
+#include <cmath>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include "kis_brush.h"
+#include "kis_fixed_paint_device.h"
+#include "KisDabCacheUtils.h"
+
+namespace {
+
+struct MaskKey {
+    qreal scale;
+    qreal ratio;
+    qreal rotation;
+    qreal softnessFactor;
+    qreal subPixelX;
+    qreal subPixelY;
+    quint32 brushIndex;
+
+    bool operator==(const MaskKey &rhs) const {
+        return scale == rhs.scale &&
+            ratio == rhs.ratio &&
+            rotation == rhs.rotation &&
+            softnessFactor == rhs.softnessFactor &&
+            subPixelX == rhs.subPixelX &&
+            subPixelY == rhs.subPixelY &&
+            brushIndex == rhs.brushIndex;
+    }
+};
+
+inline uint combineHash(uint seed, uint value)
+{
+    return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+/**
+ * The global overloads of qHash() are hidden by this one, so they
+ * are called explicitly
+ */
+uint qHash(const MaskKey &key, uint seed = 0)
+{
+    uint hash = seed;
+    hash = combineHash(hash, ::qHash(key.scale));
+    hash = combineHash(hash, ::qHash(key.ratio));
+    hash = combineHash(hash, ::qHash(key.rotation));
+    hash = combineHash(hash, ::qHash(key.softnessFactor));
+    hash = combineHash(hash, ::qHash(key.subPixelX));
+    hash = combineHash(hash, ::qHash(key.subPixelY));
+    hash = combineHash(hash, ::qHash(key.brushIndex));
+    return hash;
+}
+
+struct Mask {
+    Mask(const QSize &_size, const QByteArray &_alpha, bool _isResampled)
+        : size(_size), alpha(_alpha), isResampled(_isResampled)
+    {
+    }
+
+    QSize size;
+    QByteArray alpha;
+
+    /// resampled masks are never resampled again to avoid accumulating the blur
+    bool isResampled;
+};
+
+/**
+ * Shifts the mask by a (subpixel) offset with bilinear interpolation.
+ * The pixels that come from outside the mask are transparent.
+ */
+QByteArray resampleMask(const QByteArray &src, const QSize &size, qreal dx, qreal dy)
+{
+    QByteArray dst(src.size(), '\0');
+
+    const int ix = std::floor(dx);
+    const int iy = std::floor(dy);
+    const qreal fx = dx - ix;
+    const qreal fy = dy - iy;
+
+    const int w = size.width();
+    const int h = size.height();
+    const quint8 *srcPtr = reinterpret_cast<const quint8*>(src.constData());
+    quint8 *dstPtr = reinterpret_cast<quint8*>(dst.data());
+
+    auto srcPixel = [srcPtr, w, h] (int x, int y) -> qreal {
+        return x >= 0 && x < w && y >= 0 && y < h ? srcPtr[y * w + x] : 0;
+    };
+
+    for (int y = 0; y < h; y++) {
+        // the sample point (x - dx, y - dy) lies between
+        // (sx, sy) and (sx + 1, sy + 1)
+        const int sy = y - iy - 1;
+
+        for (int x = 0; x < w; x++) {
+            const int sx = x - ix - 1;
+
+            const qreal top =
+                fx * srcPixel(sx, sy) + (1.0 - fx) * srcPixel(sx + 1, sy);
+            const qreal bottom =
+                fx * srcPixel(sx, sy + 1) + (1.0 - fx) * srcPixel(sx + 1, sy + 1);
+
+            *dstPtr++ = qBound(0, qRound(fy * top + (1.0 - fy) * bottom), 255);
+        }
+    }
+
+    return dst;
+}
+
+}
+
+struct KisDabMaskCache::Private
+{
+    Private(int memoryLimit)
+        : masks(memoryLimit)
+    {
+    }
+
+    QCache<MaskKey, Mask> masks;
+    mutable QMutex mutex;
+    Statistics stats;
+
+    bool fetchMask(const MaskKey &key, QSize *size, QByteArray *alpha);
+    bool fetchNeighbourMask(const MaskKey &key, qreal subPixelStep,
+                            MaskKey *neighbourKey, QSize *size, QByteArray *alpha);
+    void putMask(const MaskKey &key, const QSize &size, const QByteArray &alpha, bool isResampled);
+};
+
+bool KisDabMaskCache::Private::fetchMask(const MaskKey &key, QSize *size, QByteArray *alpha)
+{
+    Mask *mask = masks.object(key);
+    if (!mask) return false;
+
+    *size = mask->size;
+    *alpha = mask->alpha;
+    return true;
+}
+
+bool KisDabMaskCache::Private::fetchNeighbourMask(const MaskKey &key, qreal subPixelStep,
+                                                  MaskKey *neighbourKey, QSize *size, QByteArray *alpha)
+{
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            if (!dx && !dy) continue;
+
+            MaskKey candidate = key;
+            candidate.subPixelX += dx * subPixelStep;
+            candidate.subPixelY += dy * subPixelStep;
+
+            if (candidate.subPixelX < 0.0 || candidate.subPixelX >= 1.0 ||
+                candidate.subPixelY < 0.0 || candidate.subPixelY >= 1.0) {
+
+                continue;
+            }
+
+            Mask *mask = masks.object(candidate);
+            if (mask && !mask->isResampled) {
+                *neighbourKey = candidate;
+                *size = mask->size;
+                *alpha = mask->alpha;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void KisDabMaskCache::Private::putMask(const MaskKey &key, const QSize &size, const QByteArray &alpha, bool isResampled)
+{
+    masks.insert(key, new Mask(size, alpha, isResampled), qMax(1, alpha.size()));
+}
+
+KisDabMaskCache::KisDabMaskCache(int memoryLimit)
+    : m_d(new Private(memoryLimit))
+{
+}
+
+KisDabMaskCache::~KisDabMaskCache()
+{
+}
+
+void KisDabMaskCache::generateDab(const KisDabCacheUtils::DabGenerationInfo &di,
+                                  KisBrushSP brush,
+                                  KisFixedPaintDeviceSP dab)
+{
+    MaskKey key;
+    key.scale = di.shape.scale();
+    key.ratio = di.shape.ratio();
+    key.rotation = di.shape.rotation();
+    key.softnessFactor = di.softnessFactor;
+    key.subPixelX = di.subPixel.x();
+    key.subPixelY = di.subPixel.y();
+    key.brushIndex = brush->brushIndex(di.info);
+
+    QSize size;
+    QByteArray alpha;
+    bool found = false;
+
+    {
+        QMutexLocker l(&m_d->mutex);
+
+        found = m_d->fetchMask(key, &size, &alpha);
+        if (found) {
+            m_d->stats.hits++;
+        }
+    }
+
+    if (!found && di.maskCacheSubPixelStep > 0.0) {
+        MaskKey neighbourKey;
+        QSize neighbourSize;
+        QByteArray neighbourAlpha;
+
+        bool neighbourFound = false;
+        {
+            QMutexLocker l(&m_d->mutex);
+            neighbourFound = m_d->fetchNeighbourMask(key, di.maskCacheSubPixelStep,
+                                                     &neighbourKey, &neighbourSize, &neighbourAlpha);
+        }
+
+        /**
+         * The size of the mask may depend on the subpixel offset, we can
+         * resample only the masks of exactly the same size
+         */
+        if (neighbourFound &&
+            neighbourSize == QSize(brush->maskWidth(di.shape, key.subPixelX, key.subPixelY, di.info),
+                                   brush->maskHeight(di.shape, key.subPixelX, key.subPixelY, di.info))) {
+
+            size = neighbourSize;
+            alpha = resampleMask(neighbourAlpha, neighbourSize,
+                                 key.subPixelX - neighbourKey.subPixelX,
+                                 key.subPixelY - neighbourKey.subPixelY);
+            found = true;
+
+            QMutexLocker l(&m_d->mutex);
+            m_d->putMask(key, size, alpha, true);
+            m_d->stats.resampled++;
+        }
+    }
+
+    if (!found) {
+        const KoColorSpace *alphaCs = KoColorSpaceRegistry::instance()->alpha8();
+        KisFixedPaintDeviceSP maskDevice = new KisFixedPaintDevice(alphaCs);
+
+        brush->mask(maskDevice, KoColor(Qt::white, alphaCs),
+                    di.shape, di.info,
+                    key.subPixelX, key.subPixelY,
+                    key.softnessFactor);
+
+        size = maskDevice->bounds().size();
+        alpha = QByteArray(reinterpret_cast<const char*>(maskDevice->data()),
+                           size.width() * size.height());
+
+        QMutexLocker l(&m_d->mutex);
+        m_d->putMask(key, size, alpha, false);
+        m_d->stats.misses++;
+    }
+
+    const int numPixels = size.width() * size.height();
+
+    dab->setRect(QRect(QPoint(), size));
+    dab->lazyGrowBufferWithoutInitialization();
+    dab->fill(0, 0, size.width(), size.height(), di.paintColor.data());
+
+    dab->colorSpace()->applyAlphaU8Mask(dab->data(),
+                                        reinterpret_cast<const quint8*>(alpha.constData()),
+                                        numPixels);
+}
+
+void KisDabMaskCache::clear()
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->masks.clear();
+}
+
+KisDabMaskCache::Statistics KisDabMaskCache::statistics() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->stats;
+}
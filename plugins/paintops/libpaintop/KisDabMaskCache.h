@@ -0,0 +1,88 @@
+/*
+ *  Copyright (c) 2019 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISDABMASKCACHE_H
+#define KISDABMASKCACHE_H
+
+#include <QScopedPointer>
+
+#include "kis_types.h"
+#include "kritapaintop_export.h"
+
+class KisBrush;
+typedef KisSharedPtr<KisBrush> KisBrushSP;
+
+namespace KisDabCacheUtils {
+struct DabGenerationInfo;
+}
+
+/**
+ * @brief The KisDabMaskCache class keeps the alpha masks of recently
+ * generated dabs, so that they can be reused by the following dabs of
+ * the stroke.
+ *
+ * The cache is shared between all the rendering resources of a paintop,
+ * so the dab rendering jobs running in different threads use (and fill)
+ * the same set of masks. To make the masks reusable, KisDabCacheBase
+ * quantizes the size, angle, softness and subpixel offset of the dab
+ * according to the precision level set by the user
+ * (see DabGenerationInfo::useMaskCache).
+ *
+ * When there is no mask for the requested subpixel offset, but there is
+ * one for a neighbouring offset, the mask is resampled from it instead of
+ * being generated from scratch.
+ *
+ * The masks are evicted in least-recently-used order when their total
+ * size exceeds the memory limit.
+ *
+ * The class is thread-safe.
+ */
+class PAINTOP_EXPORT KisDabMaskCache
+{
+public:
+    struct Statistics {
+        int hits = 0;
+        int resampled = 0;
+        int misses = 0;
+    };
+
+public:
+    KisDabMaskCache(int memoryLimit = 32 * 1024 * 1024);
+    ~KisDabMaskCache();
+
+    /**
+     * Fills \p dab with the color di.paintColor masked with the mask of
+     * \p brush. The mask is taken from the cache if possible.
+     */
+    void generateDab(const KisDabCacheUtils::DabGenerationInfo &di,
+                     KisBrushSP brush,
+                     KisFixedPaintDeviceSP dab);
+
+    /**
+     * Drops all the cached masks
+     */
+    void clear();
+
+    Statistics statistics() const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISDABMASKCACHE_H
@@ -31,6 +31,8 @@
 
 #include <kundo2command.h>
 
+#include <cmath>
+
 struct PrecisionValues {
     qreal angle;
     qreal sizeFrac;
@@ -89,6 +91,9 @@ struct KisDabCacheBase::Private {
     SavedDabParameters lastSavedDabParameters;
 
     static qreal positiveFraction(qreal x);
+    static qreal quantizeSubPixel(qreal x, qreal step);
+    static KisDabShape quantizeShape(const KisDabShape &shape, KisBrushSP brush,
+                                     const PrecisionValues &prec);
 };
 
 
@@ -171,6 +176,39 @@ qreal KisDabCacheBase::Private::positiveFraction(qreal x) {
     return fraction;
 }
 
+qreal KisDabCacheBase::Private::quantizeSubPixel(qreal x, qreal step) {
+    if (step <= 0.0) return x;
+
+    // use the center of the bucket to halve the positioning error
+    return qMin((std::floor(x / step) + 0.5) * step, 1.0 - 0.5 * step);
+}
+
+KisDabShape KisDabCacheBase::Private::quantizeShape(const KisDabShape &shape, KisBrushSP brush,
+                                                    const PrecisionValues &prec)
+{
+    qreal scale = shape.scale();
+
+    if (scale > 0.0) {
+        if (prec.sizeFrac > 0.0) {
+            // the tolerance is relative, so quantize logarithmically
+            const qreal logStep = std::log1p(prec.sizeFrac);
+            scale = std::exp(qRound(std::log(scale) / logStep) * logStep);
+        } else {
+            // quarter of a pixel of the dab size
+            const qreal brushSize = qMax(brush->width(), brush->height()) * brush->scale();
+            if (brushSize > 0.0) {
+                const qreal step = 0.25 / brushSize;
+                scale = qMax(1, qRound(scale / step)) * step;
+            }
+        }
+    }
+
+    const qreal ratio = qRound(shape.ratio() * 100.0) / 100.0;
+    const qreal rotation = qRound(shape.rotation() / prec.angle) * prec.angle;
+
+    return KisDabShape(scale, ratio, rotation);
+}
+
 inline
 KisDabCacheBase::DabPosition
 KisDabCacheBase::calculateDabRect(KisBrushSP brush,
@@ -178,7 +216,8 @@ KisDabCacheBase::calculateDabRect(KisBrushSP brush,
                                   KisDabShape shape,
                                   const KisPaintInformation& info,
                                   const MirrorProperties &mirrorProperties,
-                                  KisPressureSharpnessOption *sharpnessOption)
+                                  KisPressureSharpnessOption *sharpnessOption,
+                                  qreal subPixelStep)
 {
     qint32 x = 0, y = 0;
     qreal subPixelX = 0.0, subPixelY = 0.0;
@@ -211,17 +250,24 @@ KisDabCacheBase::calculateDabRect(KisBrushSP brush,
         subPixelY = 0;
     }
 
+    if (!m_d->subPixelPrecisionDisabled) {
+        subPixelX = Private::quantizeSubPixel(subPixelX, subPixelStep);
+        subPixelY = Private::quantizeSubPixel(subPixelY, subPixelStep);
+    }
+
     int width = brush->maskWidth(shape, subPixelX, subPixelY, info);
     int height = brush->maskHeight(shape, subPixelX, subPixelY, info);
 
     if (mirrorProperties.horizontalMirror) {
         subPixelX = Private::positiveFraction(-(cursorPoint.x() + hotSpot.x()));
+        subPixelX = Private::quantizeSubPixel(subPixelX, subPixelStep);
         width = brush->maskWidth(shape, subPixelX, subPixelY, info);
         x = qRound(cursorPoint.x() + subPixelX + hotSpot.x()) - width;
     }
 
     if (mirrorProperties.verticalMirror) {
         subPixelY = Private::positiveFraction(-(cursorPoint.y() + hotSpot.y()));
+        subPixelY = Private::quantizeSubPixel(subPixelY, subPixelStep);
         height = brush->maskHeight(shape, subPixelX, subPixelY, info);
         y = qRound(cursorPoint.y() + subPixelY + hotSpot.y()) - height;
     }
@@ -237,8 +283,34 @@ void KisDabCacheBase::fetchDabGenerationInfo(bool hasDabInCache,
                                              KisDabCacheUtils::DabGenerationInfo *di,
                                              bool *shouldUseCache)
 {
+    const int precisionLevel = m_d->precisionOption ? m_d->precisionOption->precisionLevel() - 1 : 3;
+    const PrecisionValues &prec = precisionLevels[precisionLevel];
+
     di->info = request.info;
     di->softnessFactor = request.softnessFactor;
+    di->solidColorFill = !resources->colorSource || resources->colorSource->isUniformColor();
+
+    /**
+     * The shared mask cache can reuse the masks only when the dab parameters
+     * are quantized into buckets of the size allowed by the precision level.
+     * The highest precision level doesn't allow any deviation, so the cache
+     * is not used there.
+     */
+    di->useMaskCache = resources->maskCache && di->solidColorFill && prec.angle > eps;
+    di->maskCacheSubPixelStep = 0.0;
+
+    KisDabShape shape = request.shape;
+    qreal subPixelStep = 0.0;
+
+    if (di->useMaskCache) {
+        shape = Private::quantizeShape(request.shape, resources->brush, prec);
+        di->softnessFactor = qRound(request.softnessFactor / prec.softnessFactor) * prec.softnessFactor;
+        subPixelStep = prec.subPixel;
+
+        if (subPixelStep < 1.0) {
+            di->maskCacheSubPixelStep = subPixelStep;
+        }
+    }
 
     if (m_d->mirrorOption) {
         di->mirrorProperties = m_d->mirrorOption->apply(request.info);
@@ -246,15 +318,15 @@ void KisDabCacheBase::fetchDabGenerationInfo(bool hasDabInCache,
 
     DabPosition position = calculateDabRect(resources->brush,
                                             request.cursorPoint,
-                                            request.shape,
+                                            shape,
                                             request.info,
                                             di->mirrorProperties,
-                                            resources->sharpnessOption.data());
-    di->shape = KisDabShape(request.shape.scale(), request.shape.ratio(), position.realAngle);
+                                            resources->sharpnessOption.data(),
+                                            subPixelStep);
+    di->shape = KisDabShape(shape.scale(), shape.ratio(), position.realAngle);
     di->dstDabRect = position.rect;
     di->subPixel = position.subPixel;
 
-    di->solidColorFill = !resources->colorSource || resources->colorSource->isUniformColor();
     di->paintColor = resources->colorSource && resources->colorSource->isUniformColor() ?
                 resources->colorSource->uniformColor() : request.color;
 
@@ -267,7 +339,6 @@ void KisDabCacheBase::fetchDabGenerationInfo(bool hasDabInCache,
                                                     di->softnessFactor,
                                                     di->mirrorProperties);
 
-    const int precisionLevel = m_d->precisionOption ? m_d->precisionOption->precisionLevel() - 1 : 3;
     *shouldUseCache = hasDabInCache && di->solidColorFill &&
             newParams.compare(m_d->lastSavedDabParameters, precisionLevel);
 
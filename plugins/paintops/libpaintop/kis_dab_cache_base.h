@@ -118,7 +118,8 @@ private:
     calculateDabRect(KisBrushSP brush, const QPointF &cursorPoint,
                      KisDabShape,
                      const KisPaintInformation& info,
-                     const MirrorProperties &mirrorProperties, KisPressureSharpnessOption *sharpnessOption);
+                     const MirrorProperties &mirrorProperties, KisPressureSharpnessOption *sharpnessOption,
+                     qreal subPixelStep);
 
 private:
     struct Private;